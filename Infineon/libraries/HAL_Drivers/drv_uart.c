@@ -8,6 +8,7 @@
  * 2022-06-29     Rbb666          first version
  * 2025-04-21     hydevcode       modify xmc7100d uart
  * 2025-05-12     Passionate0424  update ifx_control
+ * 2026-10-16     Developer       RS-485 driver-enable released on transmit complete
  */
 
 #include <rtthread.h>
@@ -82,6 +83,24 @@ static void uart_isr(struct rt_serial_device *serial)
 
         rt_hw_serial_isr(serial, RT_SERIAL_EVENT_RX_IND);
     }
+
+    if ((uart->config->usart_x->INTR_TX_MASKED & SCB_INTR_TX_MASKED_UART_DONE_Msk) != 0)
+    {
+        /* Last stop bit is out: hand the line back to the slaves at once */
+        uart->config->usart_x->INTR_TX = SCB_INTR_TX_UART_DONE_Msk;
+        uart->config->usart_x->INTR_TX_MASK &= ~SCB_INTR_TX_MASK_UART_DONE_Msk;
+
+        if (uart->de_asserted)
+        {
+            rt_pin_write(uart->de.pin, !uart->de.tx_level);
+            uart->de_asserted = RT_FALSE;
+        }
+
+        if (serial->parent.tx_complete != RT_NULL)
+        {
+            serial->parent.tx_complete(&serial->parent, RT_NULL);
+        }
+    }
 }
 
 #ifdef BSP_USING_UART0
@@ -249,6 +268,27 @@ static rt_err_t ifx_control(struct rt_serial_device *serial, int cmd, void *arg)
         NVIC_EnableIRQ(uart->config->UART_SCB_IRQ_cfg->intrSrc);
 #endif
         break;
+
+    case IFX_UART_CTRL_SET_DE:
+        if (arg == RT_NULL)
+        {
+            return -RT_EINVAL;
+        }
+
+        uart->config->usart_x->INTR_TX_MASK &= ~SCB_INTR_TX_MASK_UART_DONE_Msk;
+        if (uart->de_asserted)
+        {
+            rt_pin_write(uart->de.pin, !uart->de.tx_level);
+            uart->de_asserted = RT_FALSE;
+        }
+
+        uart->de = *(struct ifx_uart_de *)arg;
+        if (uart->de.pin >= 0)
+        {
+            rt_pin_mode(uart->de.pin, PIN_MODE_OUTPUT);
+            rt_pin_write(uart->de.pin, !uart->de.tx_level);
+        }
+        break;
     }
 
     return (RT_EOK);
@@ -267,11 +307,29 @@ static int ifx_uarths_putc(struct rt_serial_device *serial, char c)
 
     uint32_t count = 0;
 
+    /* Driver on before the first byte; the "UART done" interrupt turns it off */
+    if (uart->de.pin >= 0)
+    {
+        if (!uart->de_asserted)
+        {
+            uart->de_asserted = RT_TRUE;
+            rt_pin_write(uart->de.pin, uart->de.tx_level);
+        }
+        uart->config->usart_x->INTR_TX = SCB_INTR_TX_UART_DONE_Msk;
+    }
+
     while (count == 0)
     {
         count = Cy_SCB_UART_Put(uart->config->usart_x, c);
     }
 
+    if (uart->de.pin >= 0)
+    {
+        rt_base_t level = rt_hw_interrupt_disable();
+        uart->config->usart_x->INTR_TX_MASK |= SCB_INTR_TX_MASK_UART_DONE_Msk;
+        rt_hw_interrupt_enable(level);
+    }
+
     return (1);
 }
 
@@ -321,6 +379,7 @@ void rt_hw_uart_init(void)
         uart_obj[index].serial.ops = &_uart_ops;
         uart_obj[index].serial.config = serial_config;
         uart_obj[index].uart_init_flag = RT_FALSE;  /* UART hardware not initialized yet */
+        uart_obj[index].de.pin = -1;
 
         uart_obj[index].config->uart_obj = rt_malloc(sizeof(cyhal_uart_t));
         RT_ASSERT(uart_obj[index].config->uart_obj != RT_NULL);
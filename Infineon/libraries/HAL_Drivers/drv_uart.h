@@ -6,6 +6,7 @@
  * Change Logs:
  * Date           Author       Notes
  * 2022-06-29     Rbb666       first version
+ * 2026-10-16     Developer    RS-485 driver-enable control
  */
 
 #ifndef __DRV_UART_H__
@@ -18,6 +19,21 @@
 
 #define  uart_isr_callback(name) name##_isr_callback
 
+/* rt_device_control() command: RS-485 driver enable, arg is a struct ifx_uart_de */
+#define IFX_UART_CTRL_SET_DE    0x30
+
+/*
+ * Driver-enable pin of a half-duplex transceiver. It is driven to tx_level
+ * before the first byte of a write and back on the SCB "UART done" event,
+ * once the last stop bit has left the shifter; the device's tx_complete
+ * callback runs at that moment.
+ */
+struct ifx_uart_de
+{
+    rt_base_t pin;              /* -1 = no driver-enable control */
+    rt_uint8_t tx_level;        /* Pin level while transmitting */
+};
+
 struct ifx_uart_config
 {
     cyhal_uart_t *uart_obj;
@@ -34,6 +50,8 @@ struct ifx_uart
     struct ifx_uart_config *config;
     struct rt_serial_device serial;
     rt_bool_t uart_init_flag;  /* Track if UART hardware is initialized */
+    struct ifx_uart_de de;
+    volatile rt_bool_t de_asserted;
 };
 
 void rt_hw_uart_init(void);
@@ -6,45 +6,46 @@
  * Change Logs:
  * Date           Author       Notes
  * 2025-11-21     Developer    CO2 monitoring application
+ * 2026-10-16     Developer    Samples from the acquisition service instead of own reads
+ * 2026-10-16     Developer    Latest reading read through the sensor snapshot
+ * 2026-10-16     Developer    Alarm shown as n/a for a sensor not wired to the pin
+ * 2026-10-16     Developer    Monitor thread joined on stop instead of deleted
  */
 
 #include "co2_monitor.h"
+#include "s8_acquire.h"
 
 /* Monitor thread function */
 static void co2_monitor_thread_entry(void *parameter)
 {
     co2_monitor_t *monitor = (co2_monitor_t *)parameter;
-    s8_status_t status;
-    s8_sensor_data_t sensor_data;
+    s8_sample_t sample;
 
     while (monitor->running) {
-        /* Read CO2 data from sensor */
-        status = s8_read_co2_data(monitor->sensor);
-        if (status == S8_STATUS_OK) {
-            /* Get sensor data */
-            if (s8_get_sensor_data(monitor->sensor, &sensor_data) == S8_STATUS_OK) {
-                monitor->current_data = sensor_data;
-                
-                float co2_ppm = s8_co2_to_ppm(sensor_data.co2_ppm);
-                rt_kprintf("[CO2] CO2: %.2f ppm, Alarm: %d\n", 
-                           co2_ppm, sensor_data.alarm_state);
-                
-                /* Check alarm threshold */
-                if (monitor->alarm_threshold > 0 && co2_ppm > monitor->alarm_threshold) {
-                    rt_kprintf("[CO2] WARNING: CO2 level above threshold (%d ppm)\n", 
-                               monitor->alarm_threshold);
-                }
-            }
-        } else {
-            rt_kprintf("[CO2] Failed to read sensor data: %d\n", status);
+        /* Short waits keep stop responsive; the service paces the samples */
+        if (s8_acquire_receive(monitor->subscriber, &sample, rt_tick_from_millisecond(100)) != RT_EOK) {
+            continue;
         }
 
-        /* Use time-slicing approach - short delays with yield to allow MSH responsiveness */
-        for (int i = 0; i < (monitor->read_interval_ms / 50) && monitor->running; i++) {
-            rt_thread_mdelay(50);   /* 50ms short delay */
-            rt_thread_yield();       /* Yield CPU to allow MSH thread to run */
+        if (sample.status == S8_STATUS_OK) {
+            float co2_ppm = s8_co2_to_ppm(sample.data.co2_ppm);
+            if (sample.data.alarm_state == S8_ALARM_UNAVAILABLE) {
+                rt_kprintf("[CO2] CO2: %.2f ppm, Alarm: n/a\n", co2_ppm);
+            } else {
+                rt_kprintf("[CO2] CO2: %.2f ppm, Alarm: %d\n", co2_ppm, sample.data.alarm_state);
+            }
+
+            /* Check alarm threshold */
+            if (monitor->alarm_threshold > 0 && co2_ppm > monitor->alarm_threshold) {
+                rt_kprintf("[CO2] WARNING: CO2 level above threshold (%d ppm)\n", 
+                           monitor->alarm_threshold);
+            }
+        } else {
+            rt_kprintf("[CO2] Failed to read sensor data: %d\n", sample.status);
         }
     }
+
+    rt_sem_release(monitor->exit_sem);
 }
 
 /**
@@ -60,6 +61,11 @@ co2_monitor_t* co2_monitor_init(void)
     }
 
     rt_memset(monitor, 0, sizeof(co2_monitor_t));
+    monitor->exit_sem = rt_sem_create("co2_exit", 0, RT_IPC_FLAG_FIFO);
+    if (!monitor->exit_sem) {
+        rt_free(monitor);
+        return RT_NULL;
+    }
     monitor->read_interval_ms = 5000;  /* Default 5 seconds */
     monitor->alarm_threshold = 1000;   /* Default 1000 ppm */
     
@@ -79,6 +85,7 @@ rt_err_t co2_monitor_deinit(co2_monitor_t *monitor)
     /* Stop monitoring if running */
     co2_monitor_stop(monitor);
 
+    rt_sem_delete(monitor->exit_sem);
     rt_free(monitor);
     rt_kprintf("[CO2] CO2 monitor deinitialized\n");
     return RT_EOK;
@@ -111,6 +118,11 @@ rt_err_t co2_monitor_start(co2_monitor_t *monitor, rt_uint32_t interval_ms)
         return -RT_EBUSY;
     }
 
+    monitor->subscriber = s8_acquire_subscribe_queue(s8_acquire_get(monitor->sensor), interval_ms);
+    if (!monitor->subscriber) {
+        return -RT_ERROR;
+    }
+
     monitor->read_interval_ms = interval_ms;
     monitor->running = RT_TRUE;
 
@@ -124,6 +136,8 @@ rt_err_t co2_monitor_start(co2_monitor_t *monitor, rt_uint32_t interval_ms)
 
     if (!monitor->monitor_thread) {
         monitor->running = RT_FALSE;
+        s8_acquire_unsubscribe(monitor->sensor->acquire, monitor->subscriber);
+        monitor->subscriber = RT_NULL;
         return -RT_ERROR;
     }
 
@@ -146,12 +160,12 @@ rt_err_t co2_monitor_stop(co2_monitor_t *monitor)
         return RT_EOK;
     }
 
+    /* Closing the subscription wakes the thread out of s8_acquire_receive() */
     monitor->running = RT_FALSE;
-
-    if (monitor->monitor_thread) {
-        rt_thread_delete(monitor->monitor_thread);
-        monitor->monitor_thread = RT_NULL;
-    }
+    s8_acquire_unsubscribe(monitor->sensor->acquire, monitor->subscriber);
+    rt_sem_take(monitor->exit_sem, RT_WAITING_FOREVER);
+    monitor->monitor_thread = RT_NULL;
+    monitor->subscriber = RT_NULL;
 
     rt_kprintf("[CO2] Monitoring stopped\n");
     return RT_EOK;
@@ -159,14 +173,15 @@ rt_err_t co2_monitor_stop(co2_monitor_t *monitor)
 
 /**
  * Get current CO2 data
+ * The sensor's latest reading; never waits for the monitor thread or the bus.
  */
 rt_err_t co2_monitor_get_data(co2_monitor_t *monitor, s8_sensor_data_t *data)
 {
-    if (!monitor || !data) {
+    if (!monitor || !monitor->sensor || !data) {
         return -RT_ERROR;
     }
 
-    *data = monitor->current_data;
+    s8_sensor_snapshot(monitor->sensor, data);
     return RT_EOK;
 }
 
@@ -6,6 +6,9 @@
  * Change Logs:
  * Date           Author       Notes
  * 2025-11-21     Developer    CO2 monitoring application header
+ * 2026-10-16     Developer    Samples from the acquisition service instead of own reads
+ * 2026-10-16     Developer    Latest reading read through the sensor snapshot
+ * 2026-10-16     Developer    Monitor thread joined on stop instead of deleted
  */
 
 #ifndef CO2_MONITOR_H__
@@ -18,8 +21,9 @@
 /* CO2 monitor structure */
 typedef struct {
     s8_sensor_device_t *sensor;     /* S8 sensor device */
-    s8_sensor_data_t current_data;   /* Current sensor data */
+    struct s8_subscriber *subscriber; /* Queue of samples from the sensor's acquisition service */
     rt_thread_t monitor_thread;      /* Monitor thread */
+    rt_sem_t exit_sem;               /* Released by the monitor thread as it ends */
     rt_uint32_t read_interval_ms;   /* Read interval in milliseconds */
     rt_bool_t running;               /* Thread running flag */
     rt_uint16_t alarm_threshold;    /* CO2 alarm threshold in ppm */
@@ -7,12 +7,14 @@
  * Date           Author       Notes
  * 2025-11-27     Developer    Simplified main with S8 auto-init
  * 2025-11-29     Developer    Optimized startup output for production use
+ * 2026-10-16     Developer    Sensor checks sampled through the acquisition service
  */
 
 #include <rtthread.h>
 #include <rtdevice.h>
 #include <sys/time.h>
 #include "s8_sensor.h"
+#include "s8_acquire.h"
 #include "tf_card.h"
 #include "nvs_state.h"
 
@@ -67,6 +69,7 @@ static void init_rtc_default_time(void)
 int main(void)
 {
     s8_sensor_device_t *s8_device;  /* Local device pointer */
+    s8_sample_t sample;
     tf_status_t tf_status;
     
     rt_kprintf("=== RT-Thread System Started ===\n");
@@ -118,8 +121,9 @@ int main(void)
     /* Wait for sensor to stabilize */
     rt_thread_mdelay(2000);
     
-    /* Test basic communication */
-    s8_status_t result = s8_read_co2_data(s8_device);
+    /* Test basic communication; the acquisition service is the sensor's only reader */
+    s8_status_t result = s8_acquire_sample(s8_acquire_get(s8_device), &sample,
+                                           rt_tick_from_millisecond(S8_ACQUIRE_SAMPLE_WAIT_MS));
     if (result == S8_STATUS_OK) {
         rt_kprintf("S8 System: READY\n");
     } else {
@@ -164,7 +168,8 @@ int main(void)
                 rt_thread_mdelay(2000);
 
                 /* Test S8 sensor communication */
-                if (s8_read_co2_data(g_main_s8_device) == S8_STATUS_OK)
+                if (s8_acquire_sample(s8_acquire_get(g_main_s8_device), &sample,
+                                      rt_tick_from_millisecond(S8_ACQUIRE_SAMPLE_WAIT_MS)) == S8_STATUS_OK)
                 {
                     /* Prepare continuation state */
                     if (nvs_state_prepare_continuation(&nvs_state) == RT_EOK)
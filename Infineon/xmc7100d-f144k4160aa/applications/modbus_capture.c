@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Timestamped Modbus bus capture to the TF card
+ */
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "modbus_capture.h"
+
+/* Longest encoding of a 32-bit tick delta */
+#define CAPTURE_DELTA_MAX       5
+
+/**
+ * Encode a tick delta as LEB128, returns its length
+ */
+static rt_size_t capture_put_delta(rt_uint8_t *out, rt_uint32_t delta)
+{
+    rt_size_t n = 0;
+
+    while (delta >= 0x80) {
+        out[n++] = (rt_uint8_t)(delta | 0x80);
+        delta >>= 7;
+    }
+    out[n++] = (rt_uint8_t)delta;
+    return n;
+}
+
+/**
+ * Bus tap: queue one record per chunk of traffic for the writer thread
+ * Runs in the bus thread with the bus lock held, so it only copies.
+ */
+static void capture_tap(void *context, rt_uint8_t direction, const rt_uint8_t *bytes, rt_size_t length)
+{
+    modbus_capture_t *capture = (modbus_capture_t *)context;
+    rt_uint8_t head[1 + CAPTURE_DELTA_MAX];
+    rt_tick_t now = rt_tick_get();
+    rt_size_t chunk, n;
+
+    while (length > 0) {
+        chunk = length > MODBUS_CAPTURE_CHUNK_MAX ? MODBUS_CAPTURE_CHUNK_MAX : length;
+        head[0] = (rt_uint8_t)((direction == MODBUS_TAP_RX ? MODBUS_CAPTURE_TAG_RX : 0) | (chunk - 1));
+        n = 1 + capture_put_delta(&head[1], now - capture->last_tick);
+
+        if (rt_ringbuffer_space_len(&capture->ring) < n + chunk) {
+            /* The next record's delta still counts from the last one kept */
+            capture->dropped++;
+        } else {
+            rt_ringbuffer_put(&capture->ring, head, n);
+            rt_ringbuffer_put(&capture->ring, bytes, chunk);
+            capture->last_tick = now;
+            capture->records++;
+        }
+
+        bytes += chunk;
+        length -= chunk;
+    }
+
+    rt_sem_release(capture->data_sem);
+}
+
+/**
+ * Move everything queued so far to the file
+ */
+static void capture_drain(modbus_capture_t *capture)
+{
+    rt_uint8_t block[256];
+    rt_size_t n;
+
+    for (;;) {
+        rt_mutex_take(capture->device->lock, RT_WAITING_FOREVER);
+        n = rt_ringbuffer_get(&capture->ring, block, sizeof(block));
+        rt_mutex_release(capture->device->lock);
+        if (n == 0) {
+            break;
+        }
+
+        if (write(capture->fd, block, n) != (int)n) {
+            capture->write_errors++;
+        } else {
+            capture->bytes_written += n;
+        }
+    }
+}
+
+/**
+ * Writer thread: the card's write latency stays off the bus thread
+ */
+static void capture_thread_entry(void *parameter)
+{
+    modbus_capture_t *capture = (modbus_capture_t *)parameter;
+
+    while (capture->running) {
+        rt_sem_take(capture->data_sem, rt_tick_from_millisecond(100));
+        while (rt_sem_trytake(capture->data_sem) == RT_EOK) {
+        }
+        capture_drain(capture);
+    }
+    capture_drain(capture);
+
+    rt_sem_release(capture->exit_sem);
+}
+
+/**
+ * Header for the current state of a capture
+ */
+static void capture_header(modbus_capture_t *capture, modbus_capture_header_t *header)
+{
+    rt_memset(header, 0, sizeof(modbus_capture_header_t));
+    header->magic = MODBUS_CAPTURE_MAGIC;
+    header->version = MODBUS_CAPTURE_VERSION;
+    header->tick_per_second = RT_TICK_PER_SECOND;
+    header->baud_rate = capture->device->baud_rate;
+    header->records = capture->records;
+    header->dropped = capture->dropped;
+}
+
+/**
+ * Release whatever modbus_capture_start() managed to set up
+ */
+static void capture_free(modbus_capture_t *capture)
+{
+    if (capture->fd >= 0) {
+        close(capture->fd);
+    }
+    if (capture->data_sem) {
+        rt_sem_delete(capture->data_sem);
+    }
+    if (capture->exit_sem) {
+        rt_sem_delete(capture->exit_sem);
+    }
+    if (capture->device) {
+        modbus_rtu_deinit(capture->device);
+    }
+    rt_free(capture);
+}
+
+/**
+ * Start capturing the traffic of the Modbus master on uart_name
+ * path RT_NULL writes MODBUS_CAPTURE_DIR/<uart>.mbc. The capture holds a
+ * reference to the bus, so the bus outlives its other users until stopped.
+ */
+modbus_capture_t *modbus_capture_start(const char *uart_name, const char *path)
+{
+    modbus_capture_t *capture;
+    modbus_capture_header_t header;
+    struct stat st;
+
+    if (!uart_name) {
+        return RT_NULL;
+    }
+
+    capture = (modbus_capture_t *)rt_malloc(sizeof(modbus_capture_t));
+    if (!capture) {
+        rt_kprintf("[MB_CAP] Error: Failed to allocate memory\n");
+        return RT_NULL;
+    }
+    rt_memset(capture, 0, sizeof(modbus_capture_t));
+    capture->fd = -1;
+    rt_ringbuffer_init(&capture->ring, capture->pool, sizeof(capture->pool));
+
+    capture->device = modbus_rtu_init(uart_name);
+    if (!capture->device) {
+        capture_free(capture);
+        return RT_NULL;
+    }
+    if (capture->device->tap) {
+        rt_kprintf("[MB_CAP] Error: %s is already being captured\n", uart_name);
+        capture_free(capture);
+        return RT_NULL;
+    }
+
+    if (path) {
+        rt_strncpy(capture->path, path, sizeof(capture->path) - 1);
+    } else {
+        if (stat(MODBUS_CAPTURE_DIR, &st) != 0 && mkdir(MODBUS_CAPTURE_DIR, 0777) != 0) {
+            rt_kprintf("[MB_CAP] Error: Cannot create %s\n", MODBUS_CAPTURE_DIR);
+            capture_free(capture);
+            return RT_NULL;
+        }
+        rt_snprintf(capture->path, sizeof(capture->path), "%s/%s.mbc", MODBUS_CAPTURE_DIR, uart_name);
+    }
+
+    capture->fd = open(capture->path, O_WRONLY | O_CREAT | O_TRUNC);
+    if (capture->fd < 0) {
+        rt_kprintf("[MB_CAP] Error: Cannot create %s\n", capture->path);
+        capture_free(capture);
+        return RT_NULL;
+    }
+    capture_header(capture, &header);
+    if (write(capture->fd, &header, sizeof(header)) != sizeof(header)) {
+        rt_kprintf("[MB_CAP] Error: Cannot write %s\n", capture->path);
+        capture_free(capture);
+        return RT_NULL;
+    }
+    capture->bytes_written = sizeof(header);
+
+    capture->data_sem = rt_sem_create("mbcap", 0, RT_IPC_FLAG_FIFO);
+    capture->exit_sem = rt_sem_create("mbcapx", 0, RT_IPC_FLAG_FIFO);
+    capture->running = RT_TRUE;
+    capture->thread = rt_thread_create("mbcap", capture_thread_entry, capture, 2048,
+                                       MODBUS_CAPTURE_THREAD_PRIORITY, 10);
+    if (!capture->data_sem || !capture->exit_sem || !capture->thread) {
+        rt_kprintf("[MB_CAP] Error: Failed to create writer thread\n");
+        if (capture->thread) {
+            rt_thread_delete(capture->thread);
+        }
+        capture_free(capture);
+        return RT_NULL;
+    }
+    rt_thread_startup(capture->thread);
+
+    capture->last_tick = rt_tick_get();
+    modbus_set_tap(capture->device, capture_tap, capture);
+
+    return capture;
+}
+
+/**
+ * Stop a capture, flush it to the file and complete the header
+ */
+rt_err_t modbus_capture_stop(modbus_capture_t *capture)
+{
+    modbus_capture_header_t header;
+    rt_err_t result = RT_EOK;
+
+    if (!capture) {
+        return -RT_EINVAL;
+    }
+
+    /* No record arrives once the tap is cleared */
+    modbus_set_tap(capture->device, RT_NULL, RT_NULL);
+    capture->running = RT_FALSE;
+    rt_sem_release(capture->data_sem);
+    rt_sem_take(capture->exit_sem, RT_WAITING_FOREVER);
+
+    capture_header(capture, &header);
+    if (lseek(capture->fd, 0, SEEK_SET) < 0 || write(capture->fd, &header, sizeof(header)) != sizeof(header)) {
+        capture->write_errors++;
+    }
+    if (capture->write_errors) {
+        result = -RT_EIO;
+    }
+
+    rt_kprintf("[MB_CAP] %s: %d records, %d bytes, %d dropped, %d write errors\n",
+               capture->path, capture->records, capture->bytes_written,
+               capture->dropped, capture->write_errors);
+
+    capture_free(capture);
+    return result;
+}
+
+/**
+ * Check a capture loaded into memory, pos is set to its first record
+ */
+rt_err_t modbus_capture_parse(const rt_uint8_t *data, rt_size_t length,
+                              const modbus_capture_header_t **header, rt_size_t *pos)
+{
+    const modbus_capture_header_t *h = (const modbus_capture_header_t *)data;
+
+    if (!data || length < sizeof(modbus_capture_header_t) ||
+        h->magic != MODBUS_CAPTURE_MAGIC || h->version != MODBUS_CAPTURE_VERSION || h->tick_per_second == 0) {
+        return -RT_EINVAL;
+    }
+
+    if (header) {
+        *header = h;
+    }
+    *pos = sizeof(modbus_capture_header_t);
+    return RT_EOK;
+}
+
+/**
+ * Decode the record at *pos and advance past it
+ * Returns -RT_EEMPTY at the end and -RT_EINVAL on a truncated record.
+ */
+rt_err_t modbus_capture_next(const rt_uint8_t *data, rt_size_t length, rt_size_t *pos,
+                             modbus_capture_record_t *record)
+{
+    rt_size_t p = *pos;
+    rt_uint32_t delta = 0;
+    rt_uint8_t shift = 0, tag;
+
+    if (p >= length) {
+        return -RT_EEMPTY;
+    }
+
+    tag = data[p++];
+    do {
+        if (p >= length || shift > 28) {
+            return -RT_EINVAL;
+        }
+        delta |= (rt_uint32_t)(data[p] & 0x7F) << shift;
+        shift += 7;
+    } while (data[p++] & 0x80);
+
+    record->direction = (tag & MODBUS_CAPTURE_TAG_RX) ? MODBUS_TAP_RX : MODBUS_TAP_TX;
+    record->delta_tick = delta;
+    record->length = (tag & 0x7F) + 1;
+    record->bytes = &data[p];
+    if (p + record->length > length) {
+        return -RT_EINVAL;
+    }
+
+    *pos = p + record->length;
+    return RT_EOK;
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+static modbus_capture_t *mb_capture_active;
+
+/**
+ * Capture one bus to the TF card
+ * Usage: mb_capture start <uart> [path] | stop | status
+ */
+static void mb_capture(int argc, char *argv[])
+{
+    modbus_capture_t *capture = mb_capture_active;
+
+    if (argc > 2 && rt_strcmp(argv[1], "start") == 0) {
+        if (capture) {
+            rt_kprintf("[MB_CAP] Already capturing to %s\n", capture->path);
+            return;
+        }
+        mb_capture_active = modbus_capture_start(argv[2], (argc > 3) ? argv[3] : RT_NULL);
+        if (mb_capture_active) {
+            rt_kprintf("[MB_CAP] Capturing %s to %s\n", argv[2], mb_capture_active->path);
+        }
+    } else if (argc > 1 && rt_strcmp(argv[1], "stop") == 0) {
+        if (!capture) {
+            rt_kprintf("[MB_CAP] No capture running\n");
+            return;
+        }
+        mb_capture_active = RT_NULL;
+        modbus_capture_stop(capture);
+    } else if (argc > 1 && rt_strcmp(argv[1], "status") == 0) {
+        if (!capture) {
+            rt_kprintf("[MB_CAP] No capture running\n");
+            return;
+        }
+        rt_kprintf("[MB_CAP] %s: %d records, %d bytes written, %d dropped, %d write errors\n",
+                   capture->path, capture->records, capture->bytes_written,
+                   capture->dropped, capture->write_errors);
+    } else {
+        rt_kprintf("Usage: mb_capture start <uart> [path] | stop | status\n");
+    }
+}
+MSH_CMD_EXPORT(mb_capture, Capture Modbus bus traffic to the TF card);
+#endif
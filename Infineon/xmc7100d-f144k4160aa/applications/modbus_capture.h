@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Timestamped Modbus bus capture to the TF card
+ * 2026-10-16     Developer    C linkage when included from C++
+ */
+
+#ifndef MODBUS_CAPTURE_H__
+#define MODBUS_CAPTURE_H__
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "modbus_rtu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MODBUS_CAPTURE_MAGIC            0x4D424350      /* "MBCP" */
+#define MODBUS_CAPTURE_VERSION          1
+#define MODBUS_CAPTURE_DIR              "/mb_capture"
+#define MODBUS_CAPTURE_PATH_MAX         64
+#define MODBUS_CAPTURE_THREAD_PRIORITY  22              /* Below every poller: the card may stall */
+
+/* RAM between the bus thread and the card; records that do not fit are dropped */
+#ifndef MODBUS_CAPTURE_BUFFER_SIZE
+#define MODBUS_CAPTURE_BUFFER_SIZE      2048
+#endif
+
+/* Largest record payload; longer chunks are split */
+#define MODBUS_CAPTURE_CHUNK_MAX        128
+
+/*
+ * File layout: this header, then one record per chunk of bus traffic:
+ *   tag      bit 7 set for RX, bits 0-6 payload length - 1
+ *   delta    ticks since the previous record, LEB128 (one byte below 128)
+ *   payload  the bytes as written to or read from the UART
+ * A 13-byte S8 reply read in one go costs 2 bytes of overhead.
+ * All header fields are little-endian.
+ */
+typedef struct {
+    rt_uint32_t magic;
+    rt_uint16_t version;
+    rt_uint16_t tick_per_second;         /* Unit of the record deltas */
+    rt_uint32_t baud_rate;
+    rt_uint32_t records;                 /* Written on stop, 0 if the capture was cut short */
+    rt_uint32_t dropped;                 /* Records lost to a full buffer */
+    rt_uint32_t reserved;
+} modbus_capture_header_t;
+
+#define MODBUS_CAPTURE_TAG_RX           0x80
+
+/* One decoded record */
+typedef struct {
+    rt_uint8_t direction;                /* MODBUS_TAP_TX or MODBUS_TAP_RX */
+    rt_uint32_t delta_tick;              /* Since the previous record */
+    const rt_uint8_t *bytes;             /* Points into the capture buffer */
+    rt_size_t length;
+} modbus_capture_record_t;
+
+/* A running capture of one bus */
+typedef struct {
+    modbus_rtu_device_t *device;         /* Holds a bus reference */
+    char path[MODBUS_CAPTURE_PATH_MAX];
+    int fd;
+
+    /* Encoded records on their way to the card */
+    struct rt_ringbuffer ring;
+    rt_uint8_t pool[MODBUS_CAPTURE_BUFFER_SIZE];
+    rt_tick_t last_tick;                 /* Bus thread only */
+    rt_sem_t data_sem;                   /* Released when a record is queued */
+    rt_sem_t exit_sem;
+    rt_thread_t thread;
+    volatile rt_bool_t running;
+
+    /* Statistics */
+    rt_uint32_t records;
+    rt_uint32_t dropped;
+    rt_uint32_t bytes_written;           /* To the file, header included */
+    rt_uint32_t write_errors;
+} modbus_capture_t;
+
+modbus_capture_t *modbus_capture_start(const char *uart_name, const char *path);
+rt_err_t modbus_capture_stop(modbus_capture_t *capture);
+
+rt_err_t modbus_capture_parse(const rt_uint8_t *data, rt_size_t length,
+                              const modbus_capture_header_t **header, rt_size_t *pos);
+rt_err_t modbus_capture_next(const rt_uint8_t *data, rt_size_t length, rt_size_t *pos,
+                             modbus_capture_record_t *record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MODBUS_CAPTURE_H__ */
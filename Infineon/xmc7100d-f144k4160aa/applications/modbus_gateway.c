@@ -0,0 +1,697 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Modbus TCP to RTU gateway with read coalescing
+ * 2026-10-16     Developer    Broadcast writes forget finished reads of every unit
+ * 2026-10-16     Developer    Writes also close reads still queued for their unit
+ */
+
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include "modbus_gateway.h"
+
+/**
+ * Reads are the only requests whose result can be shared
+ */
+static rt_bool_t modbus_gw_is_read(rt_uint8_t function_code)
+{
+    return function_code == MODBUS_FUNC_READ_HOLDING_REGS ||
+           function_code == MODBUS_FUNC_READ_INPUT_REGS;
+}
+
+/**
+ * Fill in the MBAP header for a reply whose PDU ends at 'len', returns len
+ */
+static rt_size_t modbus_gw_seal(rt_uint8_t *out, rt_uint16_t transaction_id, rt_uint8_t unit, rt_size_t len)
+{
+    out[0] = transaction_id >> 8;
+    out[1] = transaction_id & 0xFF;
+    out[2] = 0;                         /* Protocol: Modbus */
+    out[3] = 0;
+    out[4] = (rt_uint8_t)((len - 6) >> 8);
+    out[5] = (rt_uint8_t)((len - 6) & 0xFF);
+    out[6] = unit;
+    return len;
+}
+
+/**
+ * Send a reply to a waiting client, if it is still connected
+ * Never blocks: the caller may be the bus thread.
+ */
+static void modbus_gw_send(modbus_gateway_t *gateway, const modbus_gw_waiter_t *waiter,
+                           const rt_uint8_t *reply, rt_size_t len)
+{
+    modbus_gw_client_t *client = &gateway->clients[waiter->client];
+
+    if (client->sock < 0 || client->generation != waiter->generation ||
+        send(client->sock, reply, len, MSG_DONTWAIT) != (int)len) {
+        gateway->dropped++;
+        return;
+    }
+
+    if (reply[7] & 0x80) {
+        gateway->exceptions++;
+    }
+    modbus_hist_add(&gateway->latency, rt_tick_get() - waiter->arrival_tick);
+}
+
+/**
+ * Answer a client request with an exception without going to the bus
+ */
+static void modbus_gw_exception(modbus_gateway_t *gateway, const modbus_gw_waiter_t *waiter,
+                                rt_uint8_t unit, rt_uint8_t function_code, rt_uint8_t code)
+{
+    rt_uint8_t reply[MODBUS_GW_MBAP_SIZE + 2];
+
+    reply[7] = function_code | 0x80;
+    reply[8] = code;
+    modbus_gw_send(gateway, waiter, reply, modbus_gw_seal(reply, waiter->transaction_id, unit, sizeof(reply)));
+}
+
+/**
+ * Build the TCP reply to a completed transaction for one waiter
+ */
+static rt_size_t modbus_gw_build_reply(const modbus_gw_pending_t *pending, rt_uint16_t transaction_id,
+                                       rt_uint8_t *out)
+{
+    const modbus_txn_t *txn = &pending->txn;
+    rt_size_t n = MODBUS_GW_MBAP_SIZE;
+    rt_uint16_t i;
+
+    out[n++] = txn->function_code;
+    if (txn->result != RT_EOK) {
+        out[n - 1] |= 0x80;
+        out[n++] = txn->exception ? txn->exception : MODBUS_EX_GATEWAY_TARGET;
+        return modbus_gw_seal(out, transaction_id, txn->slave_addr, n);
+    }
+
+    switch (txn->function_code) {
+    case MODBUS_FUNC_READ_HOLDING_REGS:
+    case MODBUS_FUNC_READ_INPUT_REGS:
+    case MODBUS_FUNC_READ_WRITE_REGS:
+        out[n++] = (rt_uint8_t)(txn->reg_count * 2);
+        for (i = 0; i < txn->reg_count; i++) {
+            out[n++] = pending->values[i] >> 8;
+            out[n++] = pending->values[i] & 0xFF;
+        }
+        break;
+
+    default:
+        /* FC06 echoes address and value, FC16 address and quantity */
+        out[n++] = txn->start_addr >> 8;
+        out[n++] = txn->start_addr & 0xFF;
+        out[n++] = txn->reg_count >> 8;
+        out[n++] = txn->reg_count & 0xFF;
+        break;
+    }
+
+    return modbus_gw_seal(out, transaction_id, txn->slave_addr, n);
+}
+
+/**
+ * Transaction callback, runs in the bus thread: answer everyone waiting on it
+ */
+static void modbus_gw_complete(modbus_txn_t *txn)
+{
+    modbus_gw_pending_t *pending = (modbus_gw_pending_t *)txn->user_data;
+    modbus_gateway_t *gateway = pending->gateway;
+    rt_uint8_t reply[MODBUS_GW_ADU_MAX];
+    rt_size_t len;
+    rt_uint8_t i;
+
+    rt_mutex_take(gateway->lock, RT_WAITING_FOREVER);
+    for (i = 0; i < pending->waiter_count; i++) {
+        len = modbus_gw_build_reply(pending, pending->waiters[i].transaction_id, reply);
+        modbus_gw_send(gateway, &pending->waiters[i], reply, len);
+    }
+    pending->waiter_count = 0;
+
+    /* Keep a good read for identical requests arriving shortly after */
+    if (txn->result == RT_EOK && modbus_gw_is_read(txn->function_code) && pending->joinable &&
+        gateway->coalesce_tick > 0) {
+        pending->state = MODBUS_GW_DONE;
+    } else {
+        pending->state = MODBUS_GW_FREE;
+    }
+    rt_mutex_release(gateway->lock);
+}
+
+/**
+ * Transaction whose result answers this read too, or RT_NULL
+ */
+static modbus_gw_pending_t *modbus_gw_match(modbus_gateway_t *gateway, rt_uint8_t unit,
+                                            rt_uint8_t function_code, rt_uint16_t start_addr,
+                                            rt_uint16_t reg_count)
+{
+    modbus_gw_pending_t *pending;
+    rt_uint8_t i;
+
+    for (i = 0; i < MODBUS_GW_PENDING; i++) {
+        pending = &gateway->pending[i];
+        if (pending->state == MODBUS_GW_FREE || !pending->joinable || pending->txn.slave_addr != unit ||
+            pending->txn.function_code != function_code || pending->txn.start_addr != start_addr ||
+            pending->txn.reg_count != reg_count) {
+            continue;
+        }
+        if (pending->state == MODBUS_GW_QUEUED && pending->waiter_count < MODBUS_GW_WAITERS) {
+            return pending;
+        }
+        if (pending->state == MODBUS_GW_DONE &&
+            rt_tick_get() - pending->txn.done_tick < gateway->coalesce_tick) {
+            return pending;
+        }
+    }
+
+    return RT_NULL;
+}
+
+/**
+ * Slot for a new transaction: a free one, else the oldest reusable result
+ */
+static modbus_gw_pending_t *modbus_gw_alloc(modbus_gateway_t *gateway)
+{
+    modbus_gw_pending_t *pending, *oldest = RT_NULL;
+    rt_uint8_t i;
+
+    for (i = 0; i < MODBUS_GW_PENDING; i++) {
+        pending = &gateway->pending[i];
+        if (pending->state == MODBUS_GW_FREE) {
+            return pending;
+        }
+        if (pending->state == MODBUS_GW_DONE &&
+            (!oldest || (rt_int32_t)(pending->txn.done_tick - oldest->txn.done_tick) < 0)) {
+            oldest = pending;
+        }
+    }
+
+    return oldest;
+}
+
+/**
+ * Stop handing out older reads from a unit that is about to be written
+ * Finished reads are dropped; reads still queued ahead of the write answer
+ * only the clients already waiting on them. A broadcast writes every unit,
+ * so it forgets them all.
+ */
+static void modbus_gw_forget(modbus_gateway_t *gateway, rt_uint8_t unit)
+{
+    modbus_gw_pending_t *pending;
+    rt_uint8_t i;
+
+    for (i = 0; i < MODBUS_GW_PENDING; i++) {
+        pending = &gateway->pending[i];
+        if (pending->state == MODBUS_GW_FREE ||
+            (unit != MODBUS_BROADCAST_ADDRESS && pending->txn.slave_addr != unit)) {
+            continue;
+        }
+        if (pending->state == MODBUS_GW_DONE) {
+            pending->state = MODBUS_GW_FREE;
+        } else {
+            pending->joinable = RT_FALSE;
+        }
+    }
+}
+
+/**
+ * Check a request PDU and describe it as a transaction
+ * Returns 0, or the exception code to answer with.
+ */
+static rt_uint8_t modbus_gw_parse(const rt_uint8_t *pdu, rt_size_t len, modbus_txn_t *txn,
+                                  rt_uint16_t *write_values)
+{
+    rt_uint16_t i, byte_count;
+
+    if (len < 5) {
+        return MODBUS_EX_ILLEGAL_VALUE;
+    }
+
+    txn->function_code = pdu[0];
+    txn->start_addr = (pdu[1] << 8) | pdu[2];
+    txn->reg_count = (pdu[3] << 8) | pdu[4];
+
+    switch (pdu[0]) {
+    case MODBUS_FUNC_READ_HOLDING_REGS:
+    case MODBUS_FUNC_READ_INPUT_REGS:
+        if (len != 5 || txn->reg_count == 0 || txn->reg_count > MODBUS_MAX_READ_REGS) {
+            return MODBUS_EX_ILLEGAL_VALUE;
+        }
+        break;
+
+    case MODBUS_FUNC_WRITE_SINGLE_REG:
+        if (len != 5) {
+            return MODBUS_EX_ILLEGAL_VALUE;
+        }
+        break;
+
+    case MODBUS_FUNC_WRITE_MULTIPLE_REGS:
+        byte_count = (len > 5) ? pdu[5] : 0;
+        if (txn->reg_count == 0 || txn->reg_count > MODBUS_MAX_WRITE_REGS ||
+            byte_count != txn->reg_count * 2 || len != 6U + byte_count) {
+            return MODBUS_EX_ILLEGAL_VALUE;
+        }
+        for (i = 0; i < txn->reg_count; i++) {
+            write_values[i] = (pdu[6 + i * 2] << 8) | pdu[7 + i * 2];
+        }
+        txn->write_values = write_values;
+        break;
+
+    case MODBUS_FUNC_READ_WRITE_REGS:
+        if (len < 10) {
+            return MODBUS_EX_ILLEGAL_VALUE;
+        }
+        txn->write_addr = (pdu[5] << 8) | pdu[6];
+        txn->write_count = (pdu[7] << 8) | pdu[8];
+        byte_count = pdu[9];
+        if (txn->reg_count == 0 || txn->reg_count > MODBUS_MAX_READ_REGS ||
+            txn->write_count == 0 || txn->write_count > MODBUS_MAX_RW_WRITE_REGS ||
+            byte_count != txn->write_count * 2 || len != 10U + byte_count) {
+            return MODBUS_EX_ILLEGAL_VALUE;
+        }
+        for (i = 0; i < txn->write_count; i++) {
+            write_values[i] = (pdu[10 + i * 2] << 8) | pdu[11 + i * 2];
+        }
+        txn->write_values = write_values;
+        break;
+
+    default:
+        return MODBUS_EX_ILLEGAL_FUNCTION;
+    }
+
+    return 0;
+}
+
+/**
+ * Handle one complete ADU from a client; called with the lock held
+ */
+static void modbus_gw_request(modbus_gateway_t *gateway, rt_uint8_t client,
+                              const rt_uint8_t *adu, rt_size_t len)
+{
+    modbus_gw_pending_t *pending;
+    modbus_gw_waiter_t waiter;
+    modbus_txn_t probe;
+    rt_uint8_t reply[MODBUS_GW_ADU_MAX];
+    rt_uint16_t probe_values[MODBUS_MAX_WRITE_REGS];
+    rt_uint8_t unit = adu[6], code;
+    const rt_uint8_t *pdu = adu + MODBUS_GW_MBAP_SIZE;
+    rt_size_t pdu_len = len - MODBUS_GW_MBAP_SIZE;
+
+    waiter.client = client;
+    waiter.generation = gateway->clients[client].generation;
+    waiter.transaction_id = (adu[0] << 8) | adu[1];
+    waiter.arrival_tick = rt_tick_get();
+    gateway->requests++;
+
+    rt_memset(&probe, 0, sizeof(probe));
+    probe.slave_addr = unit;
+    code = modbus_gw_parse(pdu, pdu_len, &probe, probe_values);
+    if (code == 0 && unit == MODBUS_BROADCAST_ADDRESS && probe.function_code != MODBUS_FUNC_WRITE_SINGLE_REG &&
+        probe.function_code != MODBUS_FUNC_WRITE_MULTIPLE_REGS) {
+        code = MODBUS_EX_GATEWAY_TARGET;    /* Nobody answers a broadcast read */
+    }
+    if (code != 0) {
+        modbus_gw_exception(gateway, &waiter, unit, pdu[0], code);
+        return;
+    }
+
+    if (modbus_gw_is_read(probe.function_code)) {
+        pending = modbus_gw_match(gateway, unit, probe.function_code, probe.start_addr, probe.reg_count);
+        if (pending) {
+            gateway->coalesced++;
+            if (pending->state == MODBUS_GW_DONE) {
+                modbus_gw_send(gateway, &waiter, reply,
+                               modbus_gw_build_reply(pending, waiter.transaction_id, reply));
+            } else {
+                pending->waiters[pending->waiter_count++] = waiter;
+            }
+            return;
+        }
+    } else {
+        modbus_gw_forget(gateway, unit);
+    }
+
+    pending = modbus_gw_alloc(gateway);
+    if (!pending) {
+        modbus_gw_exception(gateway, &waiter, unit, probe.function_code, MODBUS_EX_GATEWAY_PATH);
+        return;
+    }
+
+    pending->txn = probe;
+    if (probe.write_values) {
+        rt_memcpy(pending->write_values, probe_values, sizeof(pending->write_values));
+        pending->txn.write_values = pending->write_values;
+    }
+    if (modbus_gw_is_read(probe.function_code) || probe.function_code == MODBUS_FUNC_READ_WRITE_REGS) {
+        pending->txn.values = pending->values;
+    }
+    pending->txn.callback = modbus_gw_complete;
+    pending->txn.user_data = pending;
+    pending->gateway = gateway;
+    pending->waiters[0] = waiter;
+    pending->waiter_count = 1;
+    pending->joinable = RT_TRUE;
+    pending->state = MODBUS_GW_QUEUED;
+
+    if (modbus_submit(gateway->device, &pending->txn) != RT_EOK) {
+        pending->state = MODBUS_GW_FREE;
+        pending->waiter_count = 0;
+        modbus_gw_exception(gateway, &waiter, unit, probe.function_code, MODBUS_EX_GATEWAY_PATH);
+        return;
+    }
+    gateway->bus_transactions++;
+}
+
+/**
+ * Close a connection; replies still owed to it are dropped on completion
+ */
+static void modbus_gw_close(modbus_gateway_t *gateway, rt_uint8_t client)
+{
+    rt_mutex_take(gateway->lock, RT_WAITING_FOREVER);
+    closesocket(gateway->clients[client].sock);
+    gateway->clients[client].sock = -1;
+    gateway->clients[client].generation++;
+    gateway->clients[client].rx_len = 0;
+    rt_mutex_release(gateway->lock);
+}
+
+/**
+ * Read what a client sent and handle every complete ADU in it
+ * Returns -RT_ERROR when the connection should be closed.
+ */
+static rt_err_t modbus_gw_receive(modbus_gateway_t *gateway, rt_uint8_t index)
+{
+    modbus_gw_client_t *client = &gateway->clients[index];
+    rt_size_t adu_len;
+    int received;
+
+    received = recv(client->sock, client->rx_buf + client->rx_len,
+                    sizeof(client->rx_buf) - client->rx_len, 0);
+    if (received <= 0) {
+        return -RT_ERROR;
+    }
+    client->rx_len += received;
+
+    rt_mutex_take(gateway->lock, RT_WAITING_FOREVER);
+    while (client->rx_len >= MODBUS_GW_MBAP_SIZE) {
+        adu_len = 6 + ((client->rx_buf[4] << 8) | client->rx_buf[5]);
+        if (client->rx_buf[2] != 0 || client->rx_buf[3] != 0 ||
+            adu_len < MODBUS_GW_MBAP_SIZE + 1 || adu_len > MODBUS_GW_ADU_MAX) {
+            /* Not Modbus, or framing lost: nothing after this can be trusted */
+            rt_mutex_release(gateway->lock);
+            return -RT_ERROR;
+        }
+        if (client->rx_len < adu_len) {
+            break;
+        }
+
+        modbus_gw_request(gateway, index, client->rx_buf, adu_len);
+        client->rx_len -= adu_len;
+        rt_memmove(client->rx_buf, client->rx_buf + adu_len, client->rx_len);
+    }
+    rt_mutex_release(gateway->lock);
+
+    return RT_EOK;
+}
+
+/**
+ * Take a new connection, or refuse it when every slot is in use
+ */
+static void modbus_gw_accept(modbus_gateway_t *gateway)
+{
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    int sock;
+    rt_uint8_t i;
+
+    sock = accept(gateway->listen_sock, (struct sockaddr *)&addr, &addr_len);
+    if (sock < 0) {
+        return;
+    }
+
+    rt_mutex_take(gateway->lock, RT_WAITING_FOREVER);
+    for (i = 0; i < MODBUS_GW_MAX_CLIENTS; i++) {
+        if (gateway->clients[i].sock < 0) {
+            gateway->clients[i].sock = sock;
+            gateway->clients[i].rx_len = 0;
+            gateway->connections++;
+            break;
+        }
+    }
+    rt_mutex_release(gateway->lock);
+
+    if (i >= MODBUS_GW_MAX_CLIENTS) {
+        closesocket(sock);
+    }
+}
+
+/**
+ * Gateway thread: accept connections and turn client requests into bus transactions
+ */
+static void modbus_gw_thread_entry(void *parameter)
+{
+    modbus_gateway_t *gateway = (modbus_gateway_t *)parameter;
+    struct timeval timeout;
+    fd_set readset;
+    int max_fd;
+    rt_uint8_t i;
+
+    while (gateway->running) {
+        FD_ZERO(&readset);
+        FD_SET(gateway->listen_sock, &readset);
+        max_fd = gateway->listen_sock;
+        for (i = 0; i < MODBUS_GW_MAX_CLIENTS; i++) {
+            if (gateway->clients[i].sock >= 0) {
+                FD_SET(gateway->clients[i].sock, &readset);
+                if (gateway->clients[i].sock > max_fd) {
+                    max_fd = gateway->clients[i].sock;
+                }
+            }
+        }
+
+        /* Bounded so a stop request is noticed */
+        timeout.tv_sec = 0;
+        timeout.tv_usec = 100000;
+        if (select(max_fd + 1, &readset, RT_NULL, RT_NULL, &timeout) <= 0) {
+            continue;
+        }
+
+        if (FD_ISSET(gateway->listen_sock, &readset)) {
+            modbus_gw_accept(gateway);
+        }
+        for (i = 0; i < MODBUS_GW_MAX_CLIENTS; i++) {
+            if (gateway->clients[i].sock >= 0 && FD_ISSET(gateway->clients[i].sock, &readset) &&
+                modbus_gw_receive(gateway, i) != RT_EOK) {
+                modbus_gw_close(gateway, i);
+            }
+        }
+    }
+
+    rt_sem_release(gateway->exit_sem);
+}
+
+/**
+ * Serve Modbus TCP on 'port', forwarding to an RTU bus already set up
+ */
+modbus_gateway_t *modbus_gateway_start(modbus_rtu_device_t *device, rt_uint16_t port)
+{
+    modbus_gateway_t *gateway;
+    struct sockaddr_in addr;
+    int reuse = 1;
+    rt_uint8_t i;
+
+    if (!device) {
+        return RT_NULL;
+    }
+
+    gateway = (modbus_gateway_t *)rt_malloc(sizeof(modbus_gateway_t));
+    if (!gateway) {
+        rt_kprintf("[MB_GW] Error: Failed to allocate memory\n");
+        return RT_NULL;
+    }
+    rt_memset(gateway, 0, sizeof(modbus_gateway_t));
+    gateway->device = device;
+    gateway->port = port ? port : MODBUS_GW_PORT;
+    gateway->coalesce_tick = rt_tick_from_millisecond(MODBUS_GW_COALESCE_MS);
+    gateway->since = rt_tick_get();
+    for (i = 0; i < MODBUS_GW_MAX_CLIENTS; i++) {
+        gateway->clients[i].sock = -1;
+    }
+
+    gateway->lock = rt_mutex_create("mbgw", RT_IPC_FLAG_PRIO);
+    gateway->exit_sem = rt_sem_create("mbgw_x", 0, RT_IPC_FLAG_FIFO);
+    if (!gateway->lock || !gateway->exit_sem) {
+        rt_kprintf("[MB_GW] Error: Failed to create IPC objects\n");
+        goto fail;
+    }
+
+    gateway->listen_sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (gateway->listen_sock < 0) {
+        rt_kprintf("[MB_GW] Error: Failed to create socket\n");
+        goto fail;
+    }
+    setsockopt(gateway->listen_sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    rt_memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(gateway->port);
+    addr.sin_addr.s_addr = INADDR_ANY;
+    if (bind(gateway->listen_sock, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(gateway->listen_sock, MODBUS_GW_MAX_CLIENTS) < 0) {
+        rt_kprintf("[MB_GW] Error: Cannot listen on port %d\n", gateway->port);
+        closesocket(gateway->listen_sock);
+        goto fail;
+    }
+
+    gateway->running = RT_TRUE;
+    gateway->thread = rt_thread_create("mbgw", modbus_gw_thread_entry, gateway,
+                                       2048, MODBUS_GW_THREAD_PRIORITY, 10);
+    if (!gateway->thread) {
+        rt_kprintf("[MB_GW] Error: Failed to create thread\n");
+        closesocket(gateway->listen_sock);
+        goto fail;
+    }
+    rt_thread_startup(gateway->thread);
+
+    return gateway;
+
+fail:
+    if (gateway->exit_sem) {
+        rt_sem_delete(gateway->exit_sem);
+    }
+    if (gateway->lock) {
+        rt_mutex_delete(gateway->lock);
+    }
+    rt_free(gateway);
+    return RT_NULL;
+}
+
+/**
+ * Close every connection and wait out transactions still on the bus
+ */
+void modbus_gateway_stop(modbus_gateway_t *gateway)
+{
+    rt_bool_t busy;
+    rt_uint8_t i;
+
+    if (!gateway) {
+        return;
+    }
+
+    gateway->running = RT_FALSE;
+    rt_sem_take(gateway->exit_sem, RT_WAITING_FOREVER);
+
+    for (i = 0; i < MODBUS_GW_MAX_CLIENTS; i++) {
+        if (gateway->clients[i].sock >= 0) {
+            modbus_gw_close(gateway, i);
+        }
+    }
+    closesocket(gateway->listen_sock);
+
+    /* Queued transactions point into this gateway */
+    do {
+        busy = RT_FALSE;
+        rt_mutex_take(gateway->lock, RT_WAITING_FOREVER);
+        for (i = 0; i < MODBUS_GW_PENDING; i++) {
+            if (gateway->pending[i].state == MODBUS_GW_QUEUED) {
+                busy = RT_TRUE;
+            }
+        }
+        rt_mutex_release(gateway->lock);
+        if (busy) {
+            rt_thread_mdelay(10);
+        }
+    } while (busy);
+
+    rt_sem_delete(gateway->exit_sem);
+    rt_mutex_delete(gateway->lock);
+    rt_free(gateway);
+}
+
+/**
+ * Print connection, coalescing and latency statistics
+ */
+void modbus_gateway_dump(modbus_gateway_t *gateway)
+{
+    rt_uint32_t seconds, clients = 0;
+    rt_uint8_t i;
+
+    if (!gateway) {
+        return;
+    }
+
+    rt_mutex_take(gateway->lock, RT_WAITING_FOREVER);
+    for (i = 0; i < MODBUS_GW_MAX_CLIENTS; i++) {
+        if (gateway->clients[i].sock >= 0) {
+            clients++;
+        }
+    }
+    seconds = (rt_tick_get() - gateway->since) / RT_TICK_PER_SECOND;
+
+    rt_kprintf("[MB_GW] Port %d -> %s, %d/%d clients, %d connections\n", gateway->port,
+               gateway->device->serial->parent.parent.name, clients, MODBUS_GW_MAX_CLIENTS,
+               gateway->connections);
+    rt_kprintf("  %d requests in %d s: %d bus transactions, %d coalesced (%d%%), "
+               "%d exceptions, %d dropped\n",
+               gateway->requests, seconds, gateway->bus_transactions, gateway->coalesced,
+               gateway->requests ? gateway->coalesced * 100 / gateway->requests : 0,
+               gateway->exceptions, gateway->dropped);
+    rt_kprintf("  Latency (ms) p50 %d, p90 %d, p99 %d, max %d\n",
+               modbus_hist_percentile(&gateway->latency, 50),
+               modbus_hist_percentile(&gateway->latency, 90),
+               modbus_hist_percentile(&gateway->latency, 99), gateway->latency.max_ms);
+    rt_mutex_release(gateway->lock);
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+#include <stdlib.h>
+
+static modbus_gateway_t *mb_gateway_instance = RT_NULL;
+static modbus_rtu_device_t *mb_gateway_bus = RT_NULL;
+
+/**
+ * Start, stop or show the Modbus TCP gateway
+ * Usage: mb_gateway start <uart> [port] | stop | show
+ */
+static void mb_gateway(int argc, char *argv[])
+{
+    if (argc >= 3 && rt_strcmp(argv[1], "start") == 0) {
+        if (mb_gateway_instance) {
+            rt_kprintf("[MB_GW] Already running\n");
+            return;
+        }
+        mb_gateway_bus = modbus_rtu_init(argv[2]);
+        if (!mb_gateway_bus) {
+            return;
+        }
+        mb_gateway_instance = modbus_gateway_start(mb_gateway_bus, argc > 3 ? atoi(argv[3]) : 0);
+        if (!mb_gateway_instance) {
+            modbus_rtu_deinit(mb_gateway_bus);
+            mb_gateway_bus = RT_NULL;
+            return;
+        }
+        rt_kprintf("[MB_GW] Serving %s on TCP port %d\n", argv[2], mb_gateway_instance->port);
+    } else if (argc >= 2 && rt_strcmp(argv[1], "stop") == 0) {
+        modbus_gateway_stop(mb_gateway_instance);
+        mb_gateway_instance = RT_NULL;
+        if (mb_gateway_bus) {
+            modbus_rtu_deinit(mb_gateway_bus);
+            mb_gateway_bus = RT_NULL;
+        }
+        rt_kprintf("[MB_GW] Stopped\n");
+    } else if (argc >= 2 && rt_strcmp(argv[1], "show") == 0) {
+        if (!mb_gateway_instance) {
+            rt_kprintf("[MB_GW] Not running\n");
+            return;
+        }
+        modbus_gateway_dump(mb_gateway_instance);
+    } else {
+        rt_kprintf("Usage: mb_gateway start <uart> [port] | stop | show\n");
+    }
+}
+MSH_CMD_EXPORT(mb_gateway, Modbus TCP gateway onto an RTU bus);
+#endif
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Modbus TCP to RTU gateway with read coalescing
+ * 2026-10-16     Developer    C linkage when included from C++
+ * 2026-10-16     Developer    Reads queued ahead of a write closed to later reads
+ */
+
+#ifndef MODBUS_GATEWAY_H__
+#define MODBUS_GATEWAY_H__
+
+#include <rtthread.h>
+#include "modbus_rtu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MODBUS_GW_PORT                  502
+#define MODBUS_GW_MAX_CLIENTS           4       /* TCP connections served at once */
+#define MODBUS_GW_PENDING               8       /* Distinct requests on the bus or held for reuse */
+#define MODBUS_GW_WAITERS               8       /* Client requests sharing one bus transaction */
+#define MODBUS_GW_MBAP_SIZE             7       /* Transaction, protocol, length, unit */
+#define MODBUS_GW_ADU_MAX               260     /* MBAP header plus the largest PDU */
+#define MODBUS_GW_THREAD_PRIORITY       14      /* Below the bus threads, above the pollers */
+
+/* How long a completed read is handed to identical requests, 0 = only while on the bus */
+#ifndef MODBUS_GW_COALESCE_MS
+#define MODBUS_GW_COALESCE_MS           20
+#endif
+
+typedef struct modbus_gateway modbus_gateway_t;
+
+/* One TCP connection */
+typedef struct {
+    int sock;                            /* -1 = free */
+    rt_uint16_t generation;              /* Bumped when the slot is reused */
+    rt_uint8_t rx_buf[MODBUS_GW_ADU_MAX];
+    rt_uint16_t rx_len;
+} modbus_gw_client_t;
+
+/* Client request waiting for a bus transaction */
+typedef struct {
+    rt_uint8_t client;
+    rt_uint16_t generation;              /* Reply dropped if the client has gone */
+    rt_uint16_t transaction_id;          /* Echoed in the MBAP header */
+    rt_tick_t arrival_tick;
+} modbus_gw_waiter_t;
+
+typedef enum {
+    MODBUS_GW_FREE = 0,
+    MODBUS_GW_QUEUED,                    /* On the bus, joinable by identical reads */
+    MODBUS_GW_DONE                       /* Result reusable until the coalescing window ends */
+} modbus_gw_state_t;
+
+/* One bus transaction and the client requests it answers */
+typedef struct {
+    modbus_txn_t txn;
+    modbus_gateway_t *gateway;
+    modbus_gw_state_t state;
+    rt_bool_t joinable;                  /* No write to its unit came in after it */
+    rt_uint16_t values[MODBUS_MAX_READ_REGS];
+    rt_uint16_t write_values[MODBUS_MAX_WRITE_REGS];
+    modbus_gw_waiter_t waiters[MODBUS_GW_WAITERS];
+    rt_uint8_t waiter_count;
+} modbus_gw_pending_t;
+
+/*
+ * Modbus TCP server bridging MBAP requests onto one RTU bus. Reads that
+ * match one already on the bus, or one completed within the coalescing
+ * window, are answered from that transaction instead of a new one. Writes
+ * always go to the bus and end reuse of older reads from the same unit.
+ * Replies are sent from the bus thread as soon as a transaction completes.
+ */
+struct modbus_gateway {
+    modbus_rtu_device_t *device;
+    rt_uint16_t port;
+    rt_tick_t coalesce_tick;
+    int listen_sock;
+    rt_thread_t thread;
+    rt_sem_t exit_sem;
+    volatile rt_bool_t running;
+
+    rt_mutex_t lock;                     /* Protects clients, pending and statistics */
+    modbus_gw_client_t clients[MODBUS_GW_MAX_CLIENTS];
+    modbus_gw_pending_t pending[MODBUS_GW_PENDING];
+
+    /* Statistics */
+    rt_uint32_t connections;
+    rt_uint32_t requests;                /* Well-formed client requests */
+    rt_uint32_t coalesced;               /* Answered by another request's transaction */
+    rt_uint32_t bus_transactions;
+    rt_uint32_t exceptions;              /* Exception replies, local or from the slave */
+    rt_uint32_t dropped;                 /* Replies not sent: client gone or send failed */
+    rt_tick_t since;
+    modbus_hist_t latency;               /* Request received -> reply sent */
+};
+
+modbus_gateway_t *modbus_gateway_start(modbus_rtu_device_t *device, rt_uint16_t port);
+void modbus_gateway_stop(modbus_gateway_t *gateway);
+void modbus_gateway_dump(modbus_gateway_t *gateway);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MODBUS_GATEWAY_H__ */
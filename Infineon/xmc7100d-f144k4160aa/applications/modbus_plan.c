@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Register batch planner for input register reads
+ */
+
+#include "modbus_plan.h"
+
+/**
+ * Start an empty plan
+ * max_gap is how many unwanted registers may be read to join two ranges.
+ */
+void modbus_plan_init(modbus_plan_t *plan, rt_uint16_t max_gap)
+{
+    rt_memset(plan, 0, sizeof(modbus_plan_t));
+    plan->max_gap = max_gap;
+}
+
+/**
+ * Add a wanted register; dest receives its value after execution
+ */
+rt_err_t modbus_plan_add(modbus_plan_t *plan, rt_uint16_t addr, rt_uint16_t *dest)
+{
+    rt_uint8_t i;
+
+    if (!plan || !dest) {
+        return -RT_ERROR;
+    }
+
+    if (plan->reg_count >= MODBUS_PLAN_MAX_REGS) {
+        return -RT_EFULL;
+    }
+
+    /* Insertion keeps regs sorted by address */
+    i = plan->reg_count;
+    while (i > 0 && plan->regs[i - 1].addr > addr) {
+        plan->regs[i] = plan->regs[i - 1];
+        i--;
+    }
+    plan->regs[i].addr = addr;
+    plan->regs[i].dest = dest;
+    plan->reg_count++;
+    plan->span_count = 0;
+
+    return RT_EOK;
+}
+
+/**
+ * Merge sorted registers into the fewest spans within gap and span limits
+ */
+rt_err_t modbus_plan_build(modbus_plan_t *plan)
+{
+    modbus_plan_span_t *span = RT_NULL;
+    rt_uint16_t distinct = 0;
+    rt_uint16_t end;
+    rt_uint8_t i;
+
+    if (!plan || plan->reg_count == 0) {
+        return -RT_ERROR;
+    }
+
+    plan->span_count = 0;
+    for (i = 0; i < plan->reg_count; i++) {
+        rt_uint16_t addr = plan->regs[i].addr;
+
+        if (i > 0 && addr == plan->regs[i - 1].addr) {
+            continue;   /* Same register wanted twice */
+        }
+        distinct++;
+
+        if (span) {
+            end = span->start + span->count;    /* One past the last read register */
+            if (addr - end <= plan->max_gap &&
+                addr - span->start < MODBUS_PLAN_MAX_SPAN) {
+                span->count = addr - span->start + 1;
+                continue;
+            }
+        }
+
+        span = &plan->spans[plan->span_count++];
+        span->start = addr;
+        span->count = 1;
+    }
+
+    plan->saved = distinct - plan->span_count;
+    return RT_EOK;
+}
+
+/**
+ * Run the spans and scatter values to their destinations
+ * Destinations are only written once every span has succeeded.
+ */
+rt_err_t modbus_plan_execute(modbus_plan_t *plan, modbus_rtu_device_t *device, rt_uint8_t slave_addr)
+{
+    rt_uint16_t values[MODBUS_PLAN_MAX_REGS];
+    rt_uint16_t buffer[MODBUS_PLAN_MAX_SPAN];
+    rt_uint8_t reg = 0;
+    rt_uint8_t i;
+    rt_err_t result;
+
+    if (!plan || !device) {
+        return -RT_ERROR;
+    }
+
+    if (plan->span_count == 0) {
+        result = modbus_plan_build(plan);
+        if (result != RT_EOK) {
+            return result;
+        }
+    }
+
+    for (i = 0; i < plan->span_count; i++) {
+        modbus_plan_span_t *span = &plan->spans[i];
+
+        result = modbus_read_input_registers(device, slave_addr,
+                                             span->start, span->count, buffer);
+        if (result != RT_EOK) {
+            return result;
+        }
+
+        while (reg < plan->reg_count &&
+               plan->regs[reg].addr < span->start + span->count) {
+            values[reg] = buffer[plan->regs[reg].addr - span->start];
+            reg++;
+        }
+    }
+
+    for (i = 0; i < plan->reg_count; i++) {
+        *plan->regs[i].dest = values[i];
+    }
+
+    return RT_EOK;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Register batch planner for input register reads
+ */
+
+#ifndef MODBUS_PLAN_H__
+#define MODBUS_PLAN_H__
+
+#include <rtthread.h>
+#include "modbus_rtu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MODBUS_PLAN_MAX_REGS        16      /* Wanted registers per plan */
+#define MODBUS_PLAN_MAX_SPAN        32      /* Registers per merged read */
+
+/* One wanted register and where its value goes */
+typedef struct {
+    rt_uint16_t addr;
+    rt_uint16_t *dest;
+} modbus_plan_reg_t;
+
+/* One merged read */
+typedef struct {
+    rt_uint16_t start;
+    rt_uint16_t count;
+} modbus_plan_span_t;
+
+/* Batch plan: wanted registers sorted by address, merged into spans */
+typedef struct {
+    modbus_plan_reg_t regs[MODBUS_PLAN_MAX_REGS];
+    rt_uint8_t reg_count;
+    modbus_plan_span_t spans[MODBUS_PLAN_MAX_REGS];
+    rt_uint8_t span_count;
+    rt_uint16_t max_gap;                 /* Unwanted registers allowed inside a span */
+    rt_uint8_t saved;                    /* Transactions saved per execution */
+} modbus_plan_t;
+
+void modbus_plan_init(modbus_plan_t *plan, rt_uint16_t max_gap);
+rt_err_t modbus_plan_add(modbus_plan_t *plan, rt_uint16_t addr, rt_uint16_t *dest);
+rt_err_t modbus_plan_build(modbus_plan_t *plan);
+rt_err_t modbus_plan_execute(modbus_plan_t *plan, modbus_rtu_device_t *device, rt_uint8_t slave_addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MODBUS_PLAN_H__ */
@@ -6,35 +6,63 @@
  * Change Logs:
  * Date           Author       Notes
  * 2025-11-21     Developer    Modbus RTU protocol for S8 CO2 sensor
+ * 2026-10-16     Developer    Table-driven incremental CRC-16 engine
+ * 2026-10-16     Developer    Event-driven receive with T3.5 frame detection
+ * 2026-10-16     Developer    Incremental frame parser with resynchronisation
+ * 2026-10-16     Developer    Per-bus transaction queue and worker thread
+ * 2026-10-16     Developer    Reference-counted sharing of one bus by many slaves
+ * 2026-10-16     Developer    Table-driven bus configuration for any UART
+ * 2026-10-16     Developer    Read-response cache with per-range TTL
+ * 2026-10-16     Developer    Latency histograms and bus utilisation counters
+ * 2026-10-16     Developer    Prebuilt request frames
+ * 2026-10-16     Developer    Exception replies and per-request retry policy
+ * 2026-10-16     Developer    Verified FC06 echo, FC16 and FC23
+ * 2026-10-16     Developer    UART setup and T3.5 shared with the slave endpoint
+ * 2026-10-16     Developer    Histogram recording and gateway exception codes for the TCP gateway
+ * 2026-10-16     Developer    Response timeouts learned per slave from observed turnaround
+ * 2026-10-16     Developer    Priority classes with aging for queued transactions
+ * 2026-10-16     Developer    RS-485 driver enable released on UART transmit complete
+ * 2026-10-16     Developer    Byte tap on the bus for traffic capture
+ * 2026-10-16     Developer    One wire time estimate for request end and utilisation
+ * 2026-10-16     Developer    Bus lookup-or-create serialised, conflicting line rates refused
+ * 2026-10-16     Developer    Broadcast writes drop every slave's cached reads
+ * 2026-10-16     Developer    Driver enable set once per bus from its table entry
+ * 2026-10-16     Developer    Learned timeouts never cut below the configured bus timeout
+ * 2026-10-16     Developer    Bus table lock created at component init
+ * 2026-10-16     Developer    Writes drop overlapping cached reads of every function
+ * 2026-10-16     Developer    Transactions left at bus exit completed outside the lock
+ * 2026-10-16     Developer    Transaction untouched once its callback has run
+ * 2026-10-16     Developer    Per-transaction failures logged at debug level only
+ * 2026-10-16     Developer    Transactions answered from the cache marked as such
+ * 2026-10-16     Developer    mb_cache walks the bus table under its lock
+ * 2026-10-16     Developer    modbus_stats walks the bus table under its lock
+ * 2026-10-16     Developer    mb_timeout walks the bus table under its lock
  */
 
 #include "modbus_rtu.h"
 #include "board.h"
+#include "drv_uart.h"
 #include <rtthread.h>  /* Add missing RT-Thread header */
 
+/* Per-transaction failures are counted in the bus statistics; the log is for debugging */
+#define DBG_TAG "modbus"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
 /* RT-Thread serial configuration */
 #ifndef BAUD_RATE_9600
 #define BAUD_RATE_9600    9600
 #endif
 
 /**
- * Configure UART2 for S8 sensor
+ * Put a bus UART into 8N1 at the requested baud rate
  * Note: The driver now handles re-initialization gracefully
  */
-static rt_err_t configure_uart2_for_s8(void)
+rt_err_t modbus_configure_uart(struct rt_serial_device *serial, rt_uint32_t baud_rate)
 {
-    rt_device_t uart2;
     struct serial_configure config = RT_SERIAL_CONFIG_DEFAULT;
-    rt_err_t result;
-
-    /* Find UART2 device */
-    uart2 = rt_device_find("uart2");
-    if (!uart2) {
-    return -RT_ENOSYS;
-    }
 
-    /* Configure UART2 for S8 sensor: 9600-8N1 */
-    config.baud_rate = BAUD_RATE_9600;
+    config.baud_rate = baud_rate;
     config.data_bits = DATA_BITS_8;
     config.stop_bits = STOP_BITS_1;
     config.parity = PARITY_NONE;
@@ -42,391 +70,2577 @@ static rt_err_t configure_uart2_for_s8(void)
     config.invert = NRZ_NORMAL;
     config.bufsz = 256;
 
-    /* Configure device - driver handles re-initialization gracefully */
-    result = rt_device_control(uart2, RT_DEVICE_CTRL_CONFIG, &config);
-    /* Continue anyway - device may still work with previous configuration */
+    /* Configure device - driver handles re-initialization gracefully */
+    return rt_device_control((rt_device_t)serial, RT_DEVICE_CTRL_CONFIG, &config);
+}
+
+/*
+ * CRC-16/MODBUS lookup table (reflected polynomial 0xA001).
+ * crc16_table[i] is the CRC of the single byte i with a zero initial value.
+ */
+static const rt_uint16_t crc16_table[256] =
+{
+    0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
+    0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
+    0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
+    0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
+    0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
+    0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
+    0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
+    0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
+    0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
+    0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
+    0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
+    0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
+    0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
+    0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
+    0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
+    0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
+    0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
+    0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
+    0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
+    0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
+    0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
+    0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
+    0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
+    0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
+    0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
+    0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
+    0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
+    0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
+    0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
+    0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
+    0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
+    0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040,
+};
+
+#if (MODBUS_CRC_SLICE_BY > 1)
+/*
+ * Slice-by-N tables: crc16_slice[k][i] is the CRC of byte i followed by k zero
+ * bytes. Derived once from crc16_table on first use (2 KB for slice-by-4,
+ * 4 KB for slice-by-8).
+ */
+static rt_uint16_t crc16_slice[MODBUS_CRC_SLICE_BY][256];
+static volatile rt_bool_t crc16_slice_ready = RT_FALSE;
+
+static void modbus_crc16_slice_setup(void)
+{
+    rt_uint16_t i, k;
+
+    for (i = 0; i < 256; i++) {
+        crc16_slice[0][i] = crc16_table[i];
+    }
+
+    for (k = 1; k < MODBUS_CRC_SLICE_BY; k++) {
+        for (i = 0; i < 256; i++) {
+            rt_uint16_t prev = crc16_slice[k - 1][i];
+            crc16_slice[k][i] = (prev >> 8) ^ crc16_table[prev & 0xFF];
+        }
+    }
+
+    crc16_slice_ready = RT_TRUE;
+}
+#endif /* MODBUS_CRC_SLICE_BY > 1 */
+
+/**
+ * Start an incremental CRC-16 calculation
+ */
+rt_uint16_t modbus_crc16_init(void)
+{
+#if (MODBUS_CRC_SLICE_BY > 1)
+    if (!crc16_slice_ready) {
+        modbus_crc16_slice_setup();
+    }
+#endif
+
+    return MODBUS_CRC16_INIT_VALUE;
+}
+
+/**
+ * Feed bytes into an incremental CRC-16 calculation
+ * Safe to call from the RX ISR once the engine has been set up by modbus_crc16_init().
+ */
+rt_uint16_t modbus_crc16_update(rt_uint16_t crc, const rt_uint8_t *data, rt_size_t length)
+{
+#if (MODBUS_CRC_SLICE_BY == 8)
+    while (length >= 8) {
+        crc ^= (rt_uint16_t)(data[0] | (data[1] << 8));
+        crc = crc16_slice[7][crc & 0xFF] ^ crc16_slice[6][crc >> 8] ^
+              crc16_slice[5][data[2]] ^ crc16_slice[4][data[3]] ^
+              crc16_slice[3][data[4]] ^ crc16_slice[2][data[5]] ^
+              crc16_slice[1][data[6]] ^ crc16_slice[0][data[7]];
+        data += 8;
+        length -= 8;
+    }
+#elif (MODBUS_CRC_SLICE_BY == 4)
+    while (length >= 4) {
+        crc ^= (rt_uint16_t)(data[0] | (data[1] << 8));
+        crc = crc16_slice[3][crc & 0xFF] ^ crc16_slice[2][crc >> 8] ^
+              crc16_slice[1][data[2]] ^ crc16_slice[0][data[3]];
+        data += 4;
+        length -= 4;
+    }
+#endif
+
+    while (length--) {
+        crc = (crc >> 8) ^ crc16_table[(crc ^ *data++) & 0xFF];
+    }
+
+    return crc;
+}
+
+/**
+ * Finish an incremental CRC-16 calculation
+ * Returns the CRC with the first transmitted byte in the high byte, matching modbus_crc16().
+ */
+rt_uint16_t modbus_crc16_final(rt_uint16_t crc)
+{
+    /* Swap high and low bytes */
+    return (rt_uint16_t)((crc >> 8) | (crc << 8));
+}
+
+/**
+ * Calculate CRC-16 for Modbus
+ */
+rt_uint16_t modbus_crc16(rt_uint8_t *data, rt_uint16_t length)
+{
+    return modbus_crc16_final(modbus_crc16_update(modbus_crc16_init(), data, length));
+}
+
+/**
+ * Test CRC calculation with known example from manual (simplified)
+ */
+static void test_crc_example(void)
+{
+    /* CRC test removed to reduce output */
+}
+
+static void modbus_bus_thread_entry(void *parameter);
+
+/* Buses with an active RX callback, looked up from the serial ISR */
+static modbus_rtu_device_t *modbus_bus_table[MODBUS_MAX_BUS];
+
+/* Serialises finding or creating a bus against the last reference going */
+static rt_mutex_t modbus_bus_lock;
+
+/**
+ * Serial RX indication, called from the UART ISR for every received chunk
+ */
+static rt_err_t modbus_rx_indicate(rt_device_t dev, rt_size_t size)
+{
+    rt_uint8_t i;
+
+    RT_UNUSED(size);
+
+    for (i = 0; i < MODBUS_MAX_BUS; i++) {
+        modbus_rtu_device_t *device = modbus_bus_table[i];
+        if (device && (rt_device_t)device->serial == dev) {
+            device->last_rx_tick = rt_tick_get();
+            if (device->rx_armed) {
+                device->first_rx_tick = device->last_rx_tick;
+                device->rx_armed = RT_FALSE;
+            }
+            rt_sem_release(device->rx_sem);
+            break;
+        }
+    }
+
+    return RT_EOK;
+}
+
+/**
+ * Serial TX complete, called from the UART ISR once the last stop bit is out
+ * and the driver enable has been released
+ */
+static rt_err_t modbus_tx_complete(rt_device_t dev, void *buffer)
+{
+    rt_uint8_t i;
+
+    RT_UNUSED(buffer);
+
+    for (i = 0; i < MODBUS_MAX_BUS; i++) {
+        modbus_rtu_device_t *device = modbus_bus_table[i];
+        if (device && (rt_device_t)device->serial == dev) {
+            device->tx_done_tick = rt_tick_get();
+            device->tx_done = RT_TRUE;
+            break;
+        }
+    }
+
+    return RT_EOK;
+}
+
+/**
+ * Let the UART drive an RS-485 transceiver's driver enable pin
+ * The pin is asserted at tx_level before the first byte of each request and
+ * released from the transmit-complete interrupt, so the line is turned round
+ * as the stop bit ends instead of after a fixed delay. The same event gives
+ * the true end of transmission for the turnaround statistics.
+ * Pass pin -1 to hand the pin back.
+ */
+rt_err_t modbus_set_driver_enable(modbus_rtu_device_t *device, rt_base_t pin, rt_uint8_t tx_level)
+{
+    struct ifx_uart_de de;
+    rt_err_t result;
+
+    if (!device) {
+        return -RT_EINVAL;
+    }
+
+    de.pin = pin;
+    de.tx_level = tx_level;
+    result = rt_device_control((rt_device_t)device->serial, IFX_UART_CTRL_SET_DE, &de);
+    if (result != RT_EOK) {
+        rt_kprintf("[MODBUS] Warning: UART has no driver enable control (error: %d)\n", result);
+        return result;
+    }
+
+    device->de_pin = pin;
+    device->tx_done = RT_FALSE;
+    rt_device_set_tx_complete((rt_device_t)device->serial, pin >= 0 ? modbus_tx_complete : RT_NULL);
+
+    return RT_EOK;
+}
+
+/**
+ * Inter-frame silence (T3.5) at a line baud rate, in ticks
+ * Above 19200 baud the Modbus spec fixes T3.5 at 1750 us.
+ */
+rt_tick_t modbus_t35_tick(rt_uint32_t baud_rate)
+{
+    rt_uint32_t t35_us;
+
+    if (baud_rate > 19200) {
+        t35_us = 1750;
+    } else {
+        /* 3.5 characters of 11 bits each */
+        t35_us = (38500000UL + baud_rate - 1) / baud_rate;
+    }
+
+    /* Round up, plus one tick because a tick-based wait may expire early by up to one tick */
+    return (t35_us * RT_TICK_PER_SECOND + 999999UL) / 1000000UL + 1;
+}
+
+/**
+ * Derive the bus timing from the line baud rate
+ */
+static void modbus_update_timing(modbus_rtu_device_t *device)
+{
+    if (device->baud_rate == 0) {
+        device->baud_rate = BAUD_RATE_9600;
+    }
+
+    device->t35_tick = modbus_t35_tick(device->baud_rate);
+}
+
+/**
+ * Hand bytes on the line to the bus tap, if one is set
+ */
+static void modbus_tap_bytes(modbus_rtu_device_t *device, rt_uint8_t direction,
+                             const rt_uint8_t *bytes, rt_size_t length)
+{
+    if (!device->tap) {
+        return;
+    }
+
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    if (device->tap) {
+        device->tap(device->tap_context, direction, bytes, length);
+    }
+    rt_mutex_release(device->lock);
+}
+
+/**
+ * Set or clear (tap = RT_NULL) the tap that sees the bus traffic
+ * Once this returns, a cleared tap is no longer running.
+ */
+void modbus_set_tap(modbus_rtu_device_t *device, modbus_tap_t tap, void *context)
+{
+    if (!device) {
+        return;
+    }
+
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    device->tap = tap;
+    device->tap_context = context;
+    rt_mutex_release(device->lock);
+}
+
+/**
+ * Drop stale bytes left in the RX ring (e.g. unread replies) before a new request
+ */
+static void modbus_flush_rx(modbus_rtu_device_t *device)
+{
+    rt_uint8_t scratch[32];
+    rt_ssize_t received;
+
+    while ((received = rt_device_read((rt_device_t)device->serial, 0, scratch, sizeof(scratch))) > 0) {
+        modbus_tap_bytes(device, MODBUS_TAP_RX, scratch, received);
+    }
+
+    while (rt_sem_trytake(device->rx_sem) == RT_EOK) {
+    }
+}
+
+/**
+ * Release whatever modbus_rtu_init() managed to create
+ */
+static void modbus_rtu_free(modbus_rtu_device_t *device)
+{
+    if (device->serial) {
+        rt_device_close((rt_device_t)device->serial);
+    }
+    if (device->exit_sem) {
+        rt_sem_delete(device->exit_sem);
+    }
+    if (device->slot_sem) {
+        rt_sem_delete(device->slot_sem);
+    }
+    if (device->background_sem) {
+        rt_sem_delete(device->background_sem);
+    }
+    if (device->queue_sem) {
+        rt_sem_delete(device->queue_sem);
+    }
+    if (device->rx_sem) {
+        rt_sem_delete(device->rx_sem);
+    }
+    if (device->lock) {
+        rt_mutex_delete(device->lock);
+    }
+
+    rt_free(device);
+}
+
+/**
+ * Initialize Modbus RTU device
+ * UART2 is wired to the S8 and is always switched to 9600-8N1; other ports
+ * keep their current line settings.
+ */
+modbus_rtu_device_t* modbus_rtu_init(const char *uart_name)
+{
+    modbus_bus_config_t config;
+
+    config.uart_name = uart_name;
+    config.baud_rate = (uart_name && rt_strcmp(uart_name, "uart2") == 0) ? BAUD_RATE_9600 : 0;
+    config.timeout_ms = 0;
+    config.de_pin = MODBUS_DE_NONE;
+    config.de_tx_level = 0;
+
+    return modbus_rtu_init_config(&config);
+}
+
+/**
+ * Create the bus table lock before any thread can open a bus
+ */
+static int modbus_bus_lock_init(void)
+{
+    modbus_bus_lock = rt_mutex_create("mb_bus", RT_IPC_FLAG_PRIO);
+    if (!modbus_bus_lock) {
+        rt_kprintf("[MODBUS] Error: Failed to create the bus table lock\n");
+        return -RT_ENOMEM;
+    }
+
+    return RT_EOK;
+}
+INIT_COMPONENT_EXPORT(modbus_bus_lock_init);
+
+/**
+ * Join the master already on this UART, raising its reference count
+ * Called with the bus table lock held. A different line rate cannot be
+ * served on the same segment and is refused; a different timeout is kept
+ * as the bus has it.
+ */
+static modbus_rtu_device_t *modbus_bus_share(modbus_rtu_device_t *device, const modbus_bus_config_t *bus)
+{
+    rt_tick_t timeout;
+    rt_base_t level;
+
+    if (bus->baud_rate != 0 && bus->baud_rate != device->baud_rate) {
+        rt_kprintf("[MODBUS] Error: %s already runs at %d baud, not %d\n",
+                   bus->uart_name, device->baud_rate, bus->baud_rate);
+        return RT_NULL;
+    }
+
+    timeout = rt_tick_from_millisecond(bus->timeout_ms);
+    if (bus->timeout_ms != 0 && timeout != device->timeout_tick) {
+        rt_kprintf("[MODBUS] Warning: %s keeps its %d ms response timeout, %d ms ignored\n",
+                   bus->uart_name, device->timeout_tick * 1000 / RT_TICK_PER_SECOND, bus->timeout_ms);
+    }
+    if (bus->de_pin != MODBUS_DE_NONE && bus->de_pin != device->de_pin) {
+        rt_kprintf("[MODBUS] Warning: %s keeps its driver enable, pin %d ignored\n",
+                   bus->uart_name, bus->de_pin);
+    }
+
+    level = rt_hw_interrupt_disable();
+    device->refcount++;
+    rt_hw_interrupt_enable(level);
+
+    return device;
+}
+
+/**
+ * Start a master on a UART nobody uses yet
+ * Called with the bus table lock held.
+ */
+static modbus_rtu_device_t *modbus_bus_create(const modbus_bus_config_t *bus, struct rt_serial_device *serial)
+{
+    modbus_rtu_device_t *device;
+    const char *uart_name = bus->uart_name;
+    char thread_name[RT_NAME_MAX];
+    rt_base_t level;
+    rt_uint8_t slot;
+
+    device = (modbus_rtu_device_t*)rt_malloc(sizeof(modbus_rtu_device_t));
+    if (!device) {
+        rt_kprintf("[MODBUS] Error: Failed to allocate memory\n");
+        return RT_NULL;
+    }
+
+    rt_memset(device, 0, sizeof(modbus_rtu_device_t));
+    rt_list_init(&device->queue);
+    device->refcount = 1;
+    device->de_pin = -1;
+    device->stats.since = rt_tick_get();
+    modbus_set_retry(device, RT_NULL);
+
+    /* Build CRC tables now so the RX path never has to */
+    modbus_crc16_init();
+
+    /* Apply the line settings from the bus table */
+    if (bus->baud_rate != 0) {
+        rt_err_t config_result = modbus_configure_uart(serial, bus->baud_rate);
+        if (config_result != RT_EOK) {
+            rt_kprintf("[MODBUS] Warning: %s configuration failed, using defaults (error: %d)\n",
+                       uart_name, config_result);
+        }
+    }
+
+    /* Queue lock, RX wakeup (counts chunks, not bytes), queued work, free slots */
+    device->lock = rt_mutex_create("mb_lock", RT_IPC_FLAG_FIFO);
+    device->rx_sem = rt_sem_create("mb_rx", 0, RT_IPC_FLAG_FIFO);
+    device->queue_sem = rt_sem_create("mb_q", 0, RT_IPC_FLAG_FIFO);
+    device->slot_sem = rt_sem_create("mb_slot", MODBUS_TXN_QUEUE_DEPTH, RT_IPC_FLAG_FIFO);
+    device->background_sem = rt_sem_create("mb_bg", MODBUS_TXN_QUEUE_DEPTH - MODBUS_PRIO_RESERVED,
+                                           RT_IPC_FLAG_FIFO);
+    device->exit_sem = rt_sem_create("mb_exit", 0, RT_IPC_FLAG_FIFO);
+    if (!device->lock || !device->rx_sem || !device->queue_sem ||
+        !device->slot_sem || !device->background_sem || !device->exit_sem) {
+        rt_kprintf("[MODBUS] Error: Failed to create IPC objects\n");
+        modbus_rtu_free(device);
+        return RT_NULL;
+    }
+
+    /* Open serial device */
+    if (rt_device_open((rt_device_t)serial, RT_DEVICE_OFLAG_RDWR | RT_DEVICE_FLAG_INT_RX) != RT_EOK) {
+        rt_kprintf("[MODBUS] Error: Failed to open UART\n");
+        modbus_rtu_free(device);
+        return RT_NULL;
+    }
+
+    device->serial = serial;
+    device->baud_rate = serial->config.baud_rate;
+    device->timeout_tick = rt_tick_from_millisecond(bus->timeout_ms ? bus->timeout_ms : MODBUS_RESPONSE_TIMEOUT_MS);
+    device->wait_tick = device->timeout_tick;
+    device->adapt.enabled = RT_TRUE;
+    device->adapt.min_tick = rt_tick_from_millisecond(MODBUS_ADAPT_MIN_MS);
+    device->adapt.max_tick = rt_tick_from_millisecond(MODBUS_ADAPT_MAX_MS);
+    modbus_update_timing(device);
+
+    /* Claim a bus slot so the RX callback can find this device */
+    level = rt_hw_interrupt_disable();
+    for (slot = 0; slot < MODBUS_MAX_BUS; slot++) {
+        if (modbus_bus_table[slot] == RT_NULL) {
+            modbus_bus_table[slot] = device;
+            break;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+    if (slot >= MODBUS_MAX_BUS) {
+        rt_kprintf("[MODBUS] Error: All %d bus slots in use\n", MODBUS_MAX_BUS);
+        modbus_rtu_free(device);
+        return RT_NULL;
+    }
+    rt_device_set_rx_indicate((rt_device_t)serial, modbus_rx_indicate);
+
+    /* Bus thread owns the serial port from here on */
+    rt_snprintf(thread_name, sizeof(thread_name), "mb_%s", uart_name);
+    device->running = RT_TRUE;
+    device->bus_thread = rt_thread_create(thread_name,
+                                          modbus_bus_thread_entry,
+                                          device,
+                                          2048,
+                                          MODBUS_BUS_THREAD_PRIORITY,
+                                          10);
+    if (!device->bus_thread) {
+        rt_kprintf("[MODBUS] Error: Failed to create bus thread\n");
+        device->running = RT_FALSE;
+        rt_device_set_rx_indicate((rt_device_t)serial, RT_NULL);
+        modbus_bus_table[slot] = RT_NULL;
+        modbus_rtu_free(device);
+        return RT_NULL;
+    }
+
+    /* The transceiver's R/T line follows each request; without UART control it stays at receive */
+    if (bus->de_pin != MODBUS_DE_NONE &&
+        modbus_set_driver_enable(device, bus->de_pin, bus->de_tx_level) != RT_EOK) {
+        rt_pin_mode(bus->de_pin, PIN_MODE_OUTPUT);
+        rt_pin_write(bus->de_pin, !bus->de_tx_level);
+    }
+
+    rt_thread_startup(device->bus_thread);
+
+    return device;
+}
+
+/**
+ * Initialize a Modbus RTU bus from its table entry
+ * A UART that already has a Modbus master returns that device with its
+ * reference count raised, so several slaves can share one RS-485 segment.
+ * Every bus gets its own worker thread, parser buffer and locks.
+ */
+modbus_rtu_device_t* modbus_rtu_init_config(const modbus_bus_config_t *bus)
+{
+    modbus_rtu_device_t *device = RT_NULL;
+    struct rt_serial_device *serial;
+    rt_uint8_t slot;
+
+    if (!bus || !bus->uart_name) {
+        rt_kprintf("[MODBUS] Error: uart_name is NULL\n");
+        return RT_NULL;
+    }
+
+    /* Find serial device */
+    serial = (struct rt_serial_device *)rt_device_find(bus->uart_name);
+    if (!serial) {
+        rt_kprintf("[MODBUS] Error: Cannot find UART device '%s'\n", bus->uart_name);
+        return RT_NULL;
+    }
+
+    if (!modbus_bus_lock) {
+        return RT_NULL;
+    }
+
+    /* Share an existing master on the same UART, or start one */
+    rt_mutex_take(modbus_bus_lock, RT_WAITING_FOREVER);
+    for (slot = 0; slot < MODBUS_MAX_BUS; slot++) {
+        if (modbus_bus_table[slot] && modbus_bus_table[slot]->serial == serial) {
+            device = modbus_bus_share(modbus_bus_table[slot], bus);
+            break;
+        }
+    }
+    if (slot >= MODBUS_MAX_BUS) {
+        device = modbus_bus_create(bus, serial);
+    }
+    rt_mutex_release(modbus_bus_lock);
+
+    return device;
+}
+
+/**
+ * Deinitialize Modbus RTU device
+ * Drops one reference; the last one stops the bus and completes queued
+ * transactions with -RT_EINTR.
+ */
+rt_err_t modbus_rtu_deinit(modbus_rtu_device_t *device)
+{
+    rt_base_t level;
+    rt_uint8_t i;
+
+    if (!device) {
+        return -RT_ERROR;
+    }
+
+    /* Held until the bus has left the table, so nobody joins it on the way out */
+    rt_mutex_take(modbus_bus_lock, RT_WAITING_FOREVER);
+    level = rt_hw_interrupt_disable();
+    if (--device->refcount > 0) {
+        rt_hw_interrupt_enable(level);
+        rt_mutex_release(modbus_bus_lock);
+        return RT_EOK;
+    }
+    rt_hw_interrupt_enable(level);
+
+    /* Let the bus thread finish its current transaction and exit */
+    device->running = RT_FALSE;
+    rt_sem_release(device->queue_sem);
+    rt_sem_take(device->exit_sem, RT_WAITING_FOREVER);
+
+    rt_device_set_rx_indicate((rt_device_t)device->serial, RT_NULL);
+    if (device->de_pin >= 0) {
+        modbus_set_driver_enable(device, -1, 0);
+    }
+
+    level = rt_hw_interrupt_disable();
+    for (i = 0; i < MODBUS_MAX_BUS; i++) {
+        if (modbus_bus_table[i] == device) {
+            modbus_bus_table[i] = RT_NULL;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+    rt_mutex_release(modbus_bus_lock);
+
+    modbus_rtu_free(device);
+    return RT_EOK;
+}
+
+/**
+ * Build a request frame at run time, for addresses and ranges not known in advance
+ */
+void modbus_frame_build(modbus_frame_t *frame, rt_uint8_t slave_addr, rt_uint8_t function_code,
+                        rt_uint16_t start_addr, rt_uint16_t reg_count)
+{
+    rt_uint16_t crc;
+
+    frame->bytes[0] = slave_addr;
+    frame->bytes[1] = function_code;
+    frame->bytes[2] = (start_addr >> 8) & 0xFF;
+    frame->bytes[3] = start_addr & 0xFF;
+    frame->bytes[4] = (reg_count >> 8) & 0xFF;
+    frame->bytes[5] = reg_count & 0xFF;
+
+    crc = modbus_crc16(frame->bytes, 6);
+    frame->bytes[6] = (crc >> 8) & 0xFF;  /* High byte first */
+    frame->bytes[7] = crc & 0xFF;         /* Low byte second */
+}
+
+/**
+ * Append register values and the CRC to a request header of len bytes
+ * Returns the frame length.
+ */
+static rt_size_t modbus_frame_finish(rt_uint8_t *buf, rt_size_t len,
+                                     rt_uint16_t count, const rt_uint16_t *values)
+{
+    rt_uint16_t crc, i;
+
+    buf[len++] = (rt_uint8_t)(count * 2);
+    for (i = 0; i < count; i++) {
+        buf[len++] = (values[i] >> 8) & 0xFF;
+        buf[len++] = values[i] & 0xFF;
+    }
+
+    crc = modbus_crc16(buf, (rt_uint16_t)len);
+    buf[len++] = (crc >> 8) & 0xFF;       /* High byte first */
+    buf[len++] = crc & 0xFF;              /* Low byte second */
+    return len;
+}
+
+/**
+ * Build an FC16 write multiple registers request into buf
+ * buf holds MODBUS_MAX_BUFFER_SIZE bytes. Returns the frame length, or 0
+ * when the register count is outside 1..MODBUS_MAX_WRITE_REGS.
+ */
+rt_size_t modbus_frame_build_write(rt_uint8_t *buf, rt_uint8_t slave_addr, rt_uint16_t start_addr,
+                                   rt_uint16_t reg_count, const rt_uint16_t *values)
+{
+    if (!buf || !values || reg_count == 0 || reg_count > MODBUS_MAX_WRITE_REGS) {
+        return 0;
+    }
+
+    buf[0] = slave_addr;
+    buf[1] = MODBUS_FUNC_WRITE_MULTIPLE_REGS;
+    buf[2] = (start_addr >> 8) & 0xFF;
+    buf[3] = start_addr & 0xFF;
+    buf[4] = (reg_count >> 8) & 0xFF;
+    buf[5] = reg_count & 0xFF;
+
+    return modbus_frame_finish(buf, 6, reg_count, values);
+}
+
+/**
+ * Build an FC23 read/write multiple registers request into buf
+ * The slave performs the write before the read. buf holds
+ * MODBUS_MAX_BUFFER_SIZE bytes. Returns the frame length, or 0 when a
+ * count is out of range.
+ */
+rt_size_t modbus_frame_build_read_write(rt_uint8_t *buf, rt_uint8_t slave_addr,
+                                        rt_uint16_t read_addr, rt_uint16_t read_count,
+                                        rt_uint16_t write_addr, rt_uint16_t write_count,
+                                        const rt_uint16_t *values)
+{
+    if (!buf || !values || read_count == 0 || read_count > MODBUS_MAX_READ_REGS ||
+        write_count == 0 || write_count > MODBUS_MAX_RW_WRITE_REGS) {
+        return 0;
+    }
+
+    buf[0] = slave_addr;
+    buf[1] = MODBUS_FUNC_READ_WRITE_REGS;
+    buf[2] = (read_addr >> 8) & 0xFF;
+    buf[3] = read_addr & 0xFF;
+    buf[4] = (read_count >> 8) & 0xFF;
+    buf[5] = read_count & 0xFF;
+    buf[6] = (write_addr >> 8) & 0xFF;
+    buf[7] = write_addr & 0xFF;
+    buf[8] = (write_count >> 8) & 0xFF;
+    buf[9] = write_count & 0xFF;
+
+    return modbus_frame_finish(buf, 10, write_count, values);
+}
+
+/**
+ * Write a complete request and arm the parser for its reply
+ * reply_bytes is the byte count a read reply must carry, 0 for writes.
+ */
+static rt_err_t modbus_send_bytes(modbus_rtu_device_t *device, const rt_uint8_t *bytes,
+                                  rt_size_t length, rt_uint16_t reply_bytes)
+{
+    rt_size_t written;
+
+    /* Anything still in the RX ring belongs to an earlier exchange */
+    modbus_flush_rx(device);
+    modbus_parser_reset(&device->parser, bytes[0], bytes[1], reply_bytes);
+    device->rx_armed = RT_TRUE;
+    device->tx_done = RT_FALSE;
+    modbus_tap_bytes(device, MODBUS_TAP_TX, bytes, length);
+
+    /* Send frame */
+    written = rt_device_write((rt_device_t)device->serial, 0, bytes, length);
+    if (written != length) {
+        rt_kprintf("[MODBUS] Error: Only wrote %d bytes\n", written);
+        return -RT_ERROR;
+    }
+
+    return RT_EOK;
+}
+
+/**
+ * Write a fixed-size request frame and arm the parser for its reply
+ */
+static rt_err_t modbus_send_frame(modbus_rtu_device_t *device, const modbus_frame_t *frame)
+{
+    rt_uint8_t func = frame->bytes[1];
+    rt_uint16_t reg_count = (frame->bytes[4] << 8) | frame->bytes[5];
+
+    return modbus_send_bytes(device, frame->bytes, sizeof(frame->bytes),
+                             (func == MODBUS_FUNC_READ_INPUT_REGS ||
+                              func == MODBUS_FUNC_READ_HOLDING_REGS) ? reg_count * 2 : 0);
+}
+
+/**
+ * Length of the request frame a transaction puts on the line
+ */
+static rt_size_t modbus_request_length(const modbus_txn_t *txn)
+{
+    switch (txn->function_code) {
+    case MODBUS_FUNC_WRITE_MULTIPLE_REGS:
+        return 9 + txn->reg_count * 2;      /* addr, func, start, count, byte count, data, CRC */
+    case MODBUS_FUNC_READ_WRITE_REGS:
+        return 13 + txn->write_count * 2;   /* ... read start/count, write start/count ... */
+    default:
+        return 8;
+    }
+}
+
+/**
+ * Send Modbus request
+ */
+rt_err_t modbus_send_request(modbus_rtu_device_t *device, modbus_request_t *request)
+{
+    modbus_frame_t frame;
+
+    if (!device || !request) {
+        return -RT_ERROR;
+    }
+
+    modbus_frame_build(&frame, request->slave_addr, request->function_code,
+                       request->start_addr, request->reg_count);
+    return modbus_send_frame(device, &frame);
+}
+
+/**
+ * Total length of a response frame from its header
+ * Returns 0 while more header bytes are needed, -1 for an unknown function code.
+ */
+static int modbus_response_length(const rt_uint8_t *buf, rt_uint16_t len)
+{
+    rt_uint8_t func = buf[1];
+
+    if (func & 0x80) {
+        return 5;                       /* addr, func|0x80, exception code, CRC */
+    }
+
+    switch (func) {
+    case 0x01:
+    case 0x02:
+    case MODBUS_FUNC_READ_HOLDING_REGS:
+    case MODBUS_FUNC_READ_INPUT_REGS:
+    case MODBUS_FUNC_READ_WRITE_REGS:
+        if (len < 3) {
+            return 0;
+        }
+        return 3 + buf[2] + 2;          /* addr, func, byte count, data, CRC */
+
+    case 0x05:
+    case MODBUS_FUNC_WRITE_SINGLE_REG:
+    case 0x0F:
+    case MODBUS_FUNC_WRITE_MULTIPLE_REGS:
+        return 8;                       /* addr, func, address, value/quantity, CRC */
+
+    default:
+        return -1;
+    }
+}
+
+/**
+ * Discard leading bytes while hunting for the next frame start
+ */
+static void modbus_parser_drop(modbus_parser_t *parser, rt_uint16_t count)
+{
+    parser->len -= count;
+    rt_memmove(parser->buf, parser->buf + count, parser->len);
+    parser->dropped_bytes += count;
+}
+
+/**
+ * Re-examine the buffered bytes from the start
+ * Each rejected candidate costs one byte, so the scan always makes progress.
+ */
+static void modbus_parser_scan(modbus_parser_t *parser)
+{
+    rt_uint8_t *buf = parser->buf;
+    rt_uint16_t crc;
+    int length;
+
+    while (parser->len > 0) {
+        if (parser->match_addr && buf[0] != parser->match_addr) {
+            modbus_parser_drop(parser, 1);
+            continue;
+        }
+        if (parser->len < 2) {
+            break;
+        }
+        if (parser->match_func &&
+            buf[1] != parser->match_func && buf[1] != (parser->match_func | 0x80)) {
+            modbus_parser_drop(parser, 1);
+            continue;
+        }
+
+        length = modbus_response_length(buf, parser->len);
+        if (length < 0 || (length > MODBUS_MAX_BUFFER_SIZE) ||
+            (parser->match_bytes && !(buf[1] & 0x80) && parser->len >= 3 &&
+             (buf[1] == MODBUS_FUNC_READ_HOLDING_REGS || buf[1] == MODBUS_FUNC_READ_INPUT_REGS ||
+              buf[1] == MODBUS_FUNC_READ_WRITE_REGS) &&
+             buf[2] != parser->match_bytes)) {
+            modbus_parser_drop(parser, 1);
+            continue;
+        }
+        if (length == 0 || parser->len < length) {
+            break;
+        }
+
+        crc = modbus_crc16(buf, (rt_uint16_t)(length - 2));
+        if (crc == ((buf[length - 2] << 8) | buf[length - 1])) {
+            parser->length = (rt_uint16_t)length;
+            parser->state = MODBUS_PARSE_COMPLETE;
+            parser->frames++;
+            return;
+        }
+
+        parser->crc_errors++;
+        modbus_parser_drop(parser, 1);
+    }
+
+    parser->state = (parser->len >= MODBUS_MAX_BUFFER_SIZE) ? MODBUS_PARSE_OVERFLOW
+                                                           : MODBUS_PARSE_NEED_MORE;
+}
+
+/**
+ * Prepare the parser for the reply to a new request
+ * addr/func/byte_count narrow what counts as a frame start; pass 0 to accept any.
+ */
+void modbus_parser_reset(modbus_parser_t *parser, rt_uint8_t addr,
+                         rt_uint8_t func, rt_uint16_t byte_count)
+{
+    parser->len = 0;
+    parser->length = 0;
+    parser->match_addr = addr;
+    parser->match_func = func;
+    parser->match_bytes = byte_count;
+    parser->state = MODBUS_PARSE_NEED_MORE;
+}
+
+/**
+ * Feed received bytes in any chunking
+ * Consumes bytes only up to the end of a completed frame and returns how many
+ * were taken; check parser->state for MODBUS_PARSE_COMPLETE.
+ */
+rt_size_t modbus_parser_feed(modbus_parser_t *parser, const rt_uint8_t *data, rt_size_t length)
+{
+    rt_size_t used = 0;
+    rt_size_t want;
+    int frame_len;
+
+    if (parser->state == MODBUS_PARSE_COMPLETE) {
+        return 0;
+    }
+
+    while (used < length) {
+        /* Take just enough to learn the frame length, then up to its end */
+        frame_len = (parser->len >= 2) ? modbus_response_length(parser->buf, parser->len) : 0;
+        if (frame_len > parser->len) {
+            want = frame_len - parser->len;
+        } else {
+            want = (parser->len < 3) ? 3 - parser->len : 1;
+        }
+        if (want > length - used) {
+            want = length - used;
+        }
+        if (want > (rt_size_t)(MODBUS_MAX_BUFFER_SIZE - parser->len)) {
+            want = MODBUS_MAX_BUFFER_SIZE - parser->len;
+        }
+
+        rt_memcpy(parser->buf + parser->len, data + used, want);
+        parser->len += want;
+        used += want;
+
+        modbus_parser_scan(parser);
+        if (parser->state == MODBUS_PARSE_COMPLETE) {
+            break;
+        }
+        if (parser->state == MODBUS_PARSE_OVERFLOW) {
+            /* Keep hunting in the newest bytes only */
+            modbus_parser_drop(parser, parser->len);
+            parser->state = MODBUS_PARSE_NEED_MORE;
+        }
+    }
+
+    return used;
+}
+
+/**
+ * Receive Modbus response
+ * Waits up to wait_tick and feeds every chunk to the frame parser,
+ * returning as soon as a frame matching the last request is complete.
+ * Stale or corrupted bytes ahead of it are skipped, and a partial frame
+ * followed by T3.5 of silence is discarded. A reply that failed its CRC
+ * and was followed by T3.5 of silence ends the wait early with -RT_EIO.
+ * The frame is kept in device->parser.buf.
+ */
+rt_err_t modbus_receive_response(modbus_rtu_device_t *device, modbus_response_t *response)
+{
+    modbus_parser_t *parser;
+    rt_uint8_t chunk[32];
+    rt_ssize_t received;
+    rt_size_t used;
+    rt_tick_t deadline;
+    rt_int32_t remaining;
+    rt_uint32_t crc_errors;
+
+    if (!device || !response) {
+        return -RT_ERROR;
+    }
+
+    parser = &device->parser;
+    deadline = rt_tick_get() + device->wait_tick;
+    crc_errors = parser->crc_errors;
+
+    while (parser->state != MODBUS_PARSE_COMPLETE) {
+        received = rt_device_read((rt_device_t)device->serial, 0, chunk, sizeof(chunk));
+        if (received > 0) {
+            modbus_tap_bytes(device, MODBUS_TAP_RX, chunk, received);
+            used = 0;
+            while (used < (rt_size_t)received && parser->state != MODBUS_PARSE_COMPLETE) {
+                used += modbus_parser_feed(parser, chunk + used, received - used);
+            }
+            continue;
+        }
+
+        /* Nothing buffered: sleep until the RX callback fires or time runs out */
+        remaining = (rt_int32_t)(deadline - rt_tick_get());
+        if (remaining > 0 && parser->len > 0 && (rt_tick_t)remaining > device->t35_tick) {
+            /* A partial frame followed by T3.5 of silence can never complete */
+            if (rt_sem_take(device->rx_sem, device->t35_tick) != RT_EOK) {
+                modbus_parser_drop(parser, parser->len);
+            }
+            continue;
+        }
+        if (remaining > 0 && parser->len == 0 && parser->crc_errors != crc_errors &&
+            (rt_tick_t)remaining > device->t35_tick) {
+            /* The reply came in corrupted and the line went quiet: no point waiting it out */
+            if (rt_sem_take(device->rx_sem, device->t35_tick) != RT_EOK) {
+                LOG_D("Corrupted response: %d CRC errors", parser->crc_errors - crc_errors);
+                return -RT_EIO;
+            }
+            continue;
+        }
+        if (remaining <= 0 || rt_sem_take(device->rx_sem, remaining) != RT_EOK) {
+            if (parser->len == 0 && parser->dropped_bytes == 0) {
+                LOG_D("Timeout waiting for response");
+            } else {
+                LOG_D("Incomplete frame: %d bytes pending, %d dropped, %d CRC errors",
+                      parser->len, parser->dropped_bytes, parser->crc_errors);
+            }
+            return -RT_ETIMEOUT;
+        }
+    }
+
+    /* Parse response */
+    response->slave_addr = parser->buf[0];
+    response->function_code = parser->buf[1];
+    response->byte_count = parser->buf[2];
+    response->data = &parser->buf[3];
+    response->crc = (parser->buf[parser->length - 2] << 8) | parser->buf[parser->length - 1];
+
+    return RT_EOK;
+}
+
+/**
+ * TTL for a read, or 0 when no rule covers it
+ */
+static rt_tick_t modbus_cache_ttl(modbus_cache_t *cache, modbus_txn_t *txn)
+{
+    modbus_cache_rule_t *rule;
+    rt_uint8_t i;
+
+    if (txn->reg_count == 0 || txn->reg_count > MODBUS_CACHE_MAX_REGS) {
+        return 0;
+    }
+
+    for (i = 0; i < cache->rule_count; i++) {
+        rule = &cache->rules[i];
+        if (rule->function_code == txn->function_code &&
+            txn->start_addr >= rule->start_addr &&
+            txn->start_addr + txn->reg_count <= rule->start_addr + rule->reg_count) {
+            return rule->ttl_tick;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Answer a read from a fresh cache entry
+ * Returns RT_EOK on a hit with txn->values filled in.
+ */
+static rt_err_t modbus_cache_lookup(modbus_rtu_device_t *device, modbus_txn_t *txn)
+{
+    modbus_cache_t *cache = &device->cache;
+    modbus_cache_entry_t *entry;
+    rt_err_t result = -RT_ERROR;
+    rt_uint8_t i;
+
+    if (cache->rule_count == 0) {
+        return -RT_ERROR;
+    }
+
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    if (modbus_cache_ttl(cache, txn) == 0) {
+        rt_mutex_release(device->lock);
+        return -RT_ERROR;
+    }
+
+    for (i = 0; i < MODBUS_CACHE_ENTRIES; i++) {
+        entry = &cache->entries[i];
+        if (entry->valid &&
+            entry->slave_addr == txn->slave_addr &&
+            entry->function_code == txn->function_code &&
+            entry->start_addr == txn->start_addr &&
+            entry->reg_count == txn->reg_count) {
+            if (rt_tick_get() - entry->stored_tick < entry->ttl_tick) {
+                rt_memcpy(txn->values, entry->values, txn->reg_count * sizeof(rt_uint16_t));
+                result = RT_EOK;
+            } else {
+                entry->valid = RT_FALSE;
+            }
+            break;
+        }
+    }
+
+    if (result == RT_EOK) {
+        cache->hits++;
+    } else {
+        cache->misses++;
+    }
+    rt_mutex_release(device->lock);
+
+    return result;
+}
+
+/**
+ * Remember a successful read, replacing the same key or the oldest entry
+ */
+static void modbus_cache_store(modbus_rtu_device_t *device, modbus_txn_t *txn)
+{
+    modbus_cache_t *cache = &device->cache;
+    modbus_cache_entry_t *entry, *victim = RT_NULL;
+    rt_tick_t ttl, now;
+    rt_uint8_t i;
+
+    if (cache->rule_count == 0) {
+        return;
+    }
+
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    ttl = modbus_cache_ttl(cache, txn);
+    if (ttl == 0) {
+        rt_mutex_release(device->lock);
+        return;
+    }
+
+    now = rt_tick_get();
+    for (i = 0; i < MODBUS_CACHE_ENTRIES; i++) {
+        entry = &cache->entries[i];
+        if (entry->valid &&
+            entry->slave_addr == txn->slave_addr &&
+            entry->function_code == txn->function_code &&
+            entry->start_addr == txn->start_addr &&
+            entry->reg_count == txn->reg_count) {
+            victim = entry;
+            break;
+        }
+        if (!victim || !entry->valid ||
+            (victim->valid && now - entry->stored_tick > now - victim->stored_tick)) {
+            victim = entry;
+        }
+    }
+
+    victim->valid = RT_TRUE;
+    victim->slave_addr = txn->slave_addr;
+    victim->function_code = txn->function_code;
+    victim->start_addr = txn->start_addr;
+    victim->reg_count = txn->reg_count;
+    victim->stored_tick = now;
+    victim->ttl_tick = ttl;
+    rt_memcpy(victim->values, txn->values, txn->reg_count * sizeof(rt_uint16_t));
+    rt_mutex_release(device->lock);
+}
+
+/**
+ * Drop cached reads of one function that overlap a register range
+ * MODBUS_CACHE_ANY_FUNC matches every function. A broadcast reaches every
+ * slave, so it matches any entry; so does the any-slave address when one
+ * is set, in either direction.
+ * Call with device->lock held. Returns the number of entries dropped.
+ */
+static rt_uint8_t modbus_cache_drop(modbus_rtu_device_t *device, rt_uint8_t slave_addr,
+                                    rt_uint8_t function_code,
+                                    rt_uint16_t start_addr, rt_uint16_t reg_count)
+{
+    modbus_cache_entry_t *entry;
+    rt_uint8_t any = device->cache.any_addr;
+    rt_uint8_t i, dropped = 0;
+
+    for (i = 0; i < MODBUS_CACHE_ENTRIES; i++) {
+        entry = &device->cache.entries[i];
+        if (entry->valid &&
+            (function_code == MODBUS_CACHE_ANY_FUNC || entry->function_code == function_code) &&
+            (entry->slave_addr == slave_addr || slave_addr == MODBUS_BROADCAST_ADDRESS ||
+             (any != MODBUS_BROADCAST_ADDRESS && (entry->slave_addr == any || slave_addr == any))) &&
+            start_addr < entry->start_addr + entry->reg_count &&
+            entry->start_addr < start_addr + reg_count) {
+            entry->valid = RT_FALSE;
+            dropped++;
+        }
+    }
+
+    return dropped;
+}
+
+/**
+ * Drop cached reads of any function that overlap a write
+ * Input registers go too: a slave such as the S8 may expose a written
+ * setting through them as well.
+ */
+static void modbus_cache_invalidate(modbus_rtu_device_t *device, rt_uint8_t slave_addr,
+                                    rt_uint16_t start_addr, rt_uint16_t reg_count)
+{
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    device->cache.invalidations += modbus_cache_drop(device, slave_addr, MODBUS_CACHE_ANY_FUNC,
+                                                     start_addr, reg_count);
+    rt_mutex_release(device->lock);
+}
+
+/**
+ * Make the next read of a range go to the wire
+ * For callers that need a value newer than the TTL guarantees; the fresh
+ * reply is cached again as usual.
+ */
+void modbus_cache_expire(modbus_rtu_device_t *device, rt_uint8_t slave_addr,
+                         rt_uint8_t function_code, rt_uint16_t start_addr, rt_uint16_t reg_count)
+{
+    if (!device) {
+        return;
+    }
+
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    modbus_cache_drop(device, slave_addr, function_code, start_addr, reg_count);
+    rt_mutex_release(device->lock);
+}
+
+/**
+ * Cache reads of a register range for ttl_ms; 0 stops caching it
+ * Setting the same range again updates its TTL.
+ */
+rt_err_t modbus_cache_set_ttl(modbus_rtu_device_t *device, rt_uint8_t function_code,
+                              rt_uint16_t start_addr, rt_uint16_t reg_count, rt_uint32_t ttl_ms)
+{
+    modbus_cache_t *cache;
+    rt_err_t result = RT_EOK;
+    rt_uint8_t i;
+
+    if (!device || reg_count == 0) {
+        return -RT_ERROR;
+    }
+
+    cache = &device->cache;
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    for (i = 0; i < cache->rule_count; i++) {
+        if (cache->rules[i].function_code == function_code &&
+            cache->rules[i].start_addr == start_addr &&
+            cache->rules[i].reg_count == reg_count) {
+            break;
+        }
+    }
+
+    if (ttl_ms == 0) {
+        if (i < cache->rule_count) {
+            cache->rule_count--;
+            rt_memmove(&cache->rules[i], &cache->rules[i + 1],
+                       (cache->rule_count - i) * sizeof(modbus_cache_rule_t));
+        }
+        rt_memset(cache->entries, 0, sizeof(cache->entries));
+    } else if (i < cache->rule_count || cache->rule_count < MODBUS_CACHE_RULES) {
+        if (i == cache->rule_count) {
+            cache->rule_count++;
+        }
+        cache->rules[i].function_code = function_code;
+        cache->rules[i].start_addr = start_addr;
+        cache->rules[i].reg_count = reg_count;
+        cache->rules[i].ttl_tick = rt_tick_from_millisecond(ttl_ms);
+    } else {
+        result = -RT_EFULL;
+    }
+    rt_mutex_release(device->lock);
+
+    return result;
+}
+
+/**
+ * Forget every cached response and reset the counters
+ */
+void modbus_cache_clear(modbus_rtu_device_t *device)
+{
+    if (!device) {
+        return;
+    }
+
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    rt_memset(device->cache.entries, 0, sizeof(device->cache.entries));
+    device->cache.hits = 0;
+    device->cache.misses = 0;
+    device->cache.invalidations = 0;
+    rt_mutex_release(device->lock);
+}
+
+/**
+ * Name the address every slave answers (0xFE on an S8), 0 for none
+ * A write or expiry at it drops the entries of every slave, and one at any
+ * slave drops the entries read through it.
+ */
+void modbus_cache_set_any_address(modbus_rtu_device_t *device, rt_uint8_t slave_addr)
+{
+    if (!device) {
+        return;
+    }
+
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    device->cache.any_addr = slave_addr;
+    rt_mutex_release(device->lock);
+}
+
+/**
+ * Histogram bucket for a latency: 0 ms, then one bucket per power of two
+ */
+static rt_uint8_t modbus_hist_bucket(rt_uint32_t ms)
+{
+    rt_uint8_t bucket = 0;
+
+    while (ms && bucket < MODBUS_HIST_BUCKETS - 1) {
+        ms >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/**
+ * Count one latency sample
+ */
+void modbus_hist_add(modbus_hist_t *hist, rt_tick_t ticks)
+{
+    rt_uint32_t ms;
+
+    /* Phase edges are estimates and may cross by a tick */
+    if ((rt_int32_t)ticks < 0) {
+        ticks = 0;
+    }
+    ms = ticks * 1000 / RT_TICK_PER_SECOND;
+
+    hist->buckets[modbus_hist_bucket(ms)]++;
+    if (ms > hist->max_ms) {
+        hist->max_ms = ms;
+    }
+}
+
+/**
+ * Number of samples in a histogram
+ */
+rt_uint32_t modbus_hist_count(const modbus_hist_t *hist)
+{
+    rt_uint32_t count = 0;
+    rt_uint8_t i;
+
+    for (i = 0; i < MODBUS_HIST_BUCKETS; i++) {
+        count += hist->buckets[i];
+    }
+    return count;
+}
+
+/**
+ * Latency in ms that 'percent' of the samples stay within
+ * Resolved to the upper edge of its bucket, never above the recorded maximum.
+ */
+rt_uint32_t modbus_hist_percentile(const modbus_hist_t *hist, rt_uint8_t percent)
+{
+    rt_uint32_t count = modbus_hist_count(hist);
+    rt_uint32_t rank, seen = 0, bound;
+    rt_uint8_t i;
+
+    if (count == 0) {
+        return 0;
+    }
+
+    rank = (count * percent + 99) / 100;
+    for (i = 0; i < MODBUS_HIST_BUCKETS - 1; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            break;
+        }
+    }
+
+    bound = (i == MODBUS_HIST_BUCKETS - 1) ? hist->max_ms : (1UL << i);
+    return bound < hist->max_ms ? bound : hist->max_ms;
+}
+
+/**
+ * Add one histogram into another, e.g. to sum the slots of a bus
+ */
+void modbus_hist_merge(modbus_hist_t *into, const modbus_hist_t *hist)
+{
+    rt_uint8_t i;
+
+    for (i = 0; i < MODBUS_HIST_BUCKETS; i++) {
+        into->buckets[i] += hist->buckets[i];
+    }
+    if (hist->max_ms > into->max_ms) {
+        into->max_ms = hist->max_ms;
+    }
+}
+
+/**
+ * Slot for a (slave, function) pair, claiming a free one on first use
+ */
+static modbus_stats_slot_t *modbus_stats_slot(modbus_stats_t *stats, rt_uint8_t slave_addr,
+                                              rt_uint8_t function_code)
+{
+    modbus_stats_slot_t *slot;
+    rt_uint8_t i;
+
+    for (i = 0; i < MODBUS_STATS_SLOTS - 1; i++) {
+        slot = &stats->slots[i];
+        if (slot->function_code == 0) {
+            slot->slave_addr = slave_addr;
+            slot->function_code = function_code;
+            return slot;
+        }
+        if (slot->slave_addr == slave_addr && slot->function_code == function_code) {
+            return slot;
+        }
+    }
+
+    return &stats->slots[MODBUS_STATS_SLOTS - 1];
+}
+
+/**
+ * Account one attempt of a transaction, called only from the bus thread
+ * Queue wait and total latency are taken once, on the final attempt. A few
+ * increments under the queue lock, so it stays enabled in production.
+ */
+static void modbus_stats_record(modbus_rtu_device_t *device, modbus_txn_t *txn, rt_err_t result,
+                                rt_uint32_t crc_errors, rt_tick_t attempt_tick, rt_bool_t final)
+{
+    modbus_stats_t *stats = &device->stats;
+    modbus_stats_slot_t *slot;
+    rt_tick_t now = rt_tick_get();
+    rt_bool_t replied = (result == RT_EOK && txn->slave_addr != MODBUS_BROADCAST_ADDRESS) ||
+                        result == -RT_EINVAL || txn->exception != 0;
+    rt_uint32_t bytes = modbus_request_length(txn);
+
+    if (replied) {
+        bytes += device->parser.length;
+    }
+
+    /* A broadcast write is complete once its frame has left the UART */
+    if ((rt_int32_t)(txn->tx_tick - now) > 0) {
+        now = txn->tx_tick;
+    }
+
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+
+    slot = modbus_stats_slot(stats, txn->slave_addr, txn->function_code);
+    slot->transactions++;
+    slot->crc_errors += crc_errors;
+    if (txn->retries > 0) {
+        slot->retries++;
+    }
+    if (txn->exception != 0) {
+        slot->exceptions++;
+    } else if (result == -RT_ETIMEOUT) {
+        slot->timeouts++;
+    } else if (result == -RT_EINVAL) {
+        slot->invalid++;
+    } else if (result != RT_EOK && result != -RT_EIO) {
+        slot->errors++;
+    }
+
+    modbus_hist_add(&slot->hist[MODBUS_PHASE_TX], txn->tx_tick - attempt_tick);
+    if (replied) {
+        modbus_hist_add(&slot->hist[MODBUS_PHASE_TURNAROUND], txn->rx_tick - txn->tx_tick);
+        modbus_hist_add(&slot->hist[MODBUS_PHASE_RX], now - txn->rx_tick);
+    }
+    if (final) {
+        modbus_hist_add(&slot->hist[MODBUS_PHASE_WAIT], txn->start_tick - txn->queued_tick);
+        if (txn->priority < MODBUS_PRIO_COUNT) {
+            modbus_hist_add(&stats->class_wait[txn->priority], txn->start_tick - txn->queued_tick);
+        }
+        modbus_hist_add(&slot->hist[MODBUS_PHASE_TOTAL], now - txn->queued_tick);
+    }
+
+    stats->busy_tick += now - attempt_tick;
+    stats->wire_bits += bytes * MODBUS_CHAR_BITS;
+
+    rt_mutex_release(device->lock);
+}
+
+/**
+ * Copy the statistics of a bus and derive its utilisation
+ */
+void modbus_stats_get(modbus_rtu_device_t *device, modbus_stats_t *stats)
+{
+    rt_uint64_t capacity;
+
+    if (!device || !stats) {
+        return;
+    }
+
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    rt_memcpy(stats, &device->stats, sizeof(modbus_stats_t));
+    rt_mutex_release(device->lock);
+
+    stats->elapsed_tick = rt_tick_get() - stats->since;
+    stats->busy_permille = 0;
+    stats->wire_permille = 0;
+    if (stats->elapsed_tick > 0) {
+        stats->busy_permille = (rt_uint16_t)((rt_uint64_t)stats->busy_tick * 1000 / stats->elapsed_tick);
+        capacity = (rt_uint64_t)device->baud_rate * stats->elapsed_tick / RT_TICK_PER_SECOND;
+        if (capacity > 0) {
+            stats->wire_permille = (rt_uint16_t)(stats->wire_bits * 1000 / capacity);
+        }
+    }
+}
+
+/**
+ * Clear all counters and histograms of a bus
+ */
+void modbus_stats_reset(modbus_rtu_device_t *device)
+{
+    if (!device) {
+        return;
+    }
+
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    rt_memset(&device->stats, 0, sizeof(modbus_stats_t));
+    device->stats.since = rt_tick_get();
+    rt_mutex_release(device->lock);
+}
+
+/**
+ * Ticks a number of characters occupy on the wire
+ */
+static rt_tick_t modbus_wire_tick(modbus_rtu_device_t *device, rt_size_t bytes)
+{
+    return (bytes * MODBUS_CHAR_BITS * RT_TICK_PER_SECOND + device->baud_rate - 1) / device->baud_rate;
+}
+
+/**
+ * Length of the reply a transaction expects when the slave accepts it
+ */
+static rt_size_t modbus_reply_length(const modbus_txn_t *txn)
+{
+    switch (txn->function_code) {
+    case MODBUS_FUNC_WRITE_SINGLE_REG:
+    case MODBUS_FUNC_WRITE_MULTIPLE_REGS:
+        return 8;                           /* Echo of address and count or value */
+    default:
+        return 5 + txn->reg_count * 2;      /* addr, func, byte count, data, CRC */
+    }
+}
+
+/**
+ * Learned-timeout slot of a slave, created on first use
+ * Returns RT_NULL once every slot is taken; that slave keeps the bus timeout.
+ */
+static modbus_adapt_slot_t *modbus_adapt_slot(modbus_adapt_t *adapt, rt_uint8_t slave_addr,
+                                              rt_bool_t create)
+{
+    modbus_adapt_slot_t *slot;
+    rt_uint8_t i;
+
+    for (i = 0; i < MODBUS_ADAPT_SLOTS; i++) {
+        slot = &adapt->slots[i];
+        if (slot->slave_addr == slave_addr && (slot->samples || slot->timeouts)) {
+            return slot;
+        }
+    }
+    if (!create) {
+        return RT_NULL;
+    }
+    for (i = 0; i < MODBUS_ADAPT_SLOTS; i++) {
+        slot = &adapt->slots[i];
+        if (slot->samples == 0 && slot->timeouts == 0) {
+            rt_memset(slot, 0, sizeof(modbus_adapt_slot_t));
+            slot->slave_addr = slave_addr;
+            return slot;
+        }
+    }
+
+    return RT_NULL;
+}
+
+/**
+ * Response timeout for a request and reply of the given lengths, with the lock held
+ * The ceiling is max_tick or the configured bus timeout, whichever is longer.
+ */
+static rt_tick_t modbus_adapt_wait(modbus_rtu_device_t *device, const modbus_adapt_slot_t *slot,
+                                   rt_size_t request_len, rt_size_t reply_len)
+{
+    modbus_adapt_t *adapt = &device->adapt;
+    rt_tick_t wait, deviation, ceiling;
+
+    if (!adapt->enabled) {
+        return device->timeout_tick;
+    }
+
+    ceiling = adapt->max_tick > device->timeout_tick ? adapt->max_tick : device->timeout_tick;
+
+    /* Nothing learned yet: the configured timeout, doubled per miss */
+    if (!slot || slot->samples == 0) {
+        wait = device->timeout_tick;
+        if (slot) {
+            wait <<= slot->backoff;
+        }
+        return wait > ceiling ? ceiling : wait;
+    }
+
+    /* Four mean deviations, never less than two ticks for scheduling */
+    deviation = (slot->rttvar8 + 1) / 2;
+    if (deviation < 2) {
+        deviation = 2;
+    }
+    wait = modbus_wire_tick(device, request_len + reply_len) + (slot->srtt8 + 7) / 8 + deviation;
+    wait <<= slot->backoff;
+
+    if (wait < adapt->min_tick) {
+        wait = adapt->min_tick;
+    } else if (wait > ceiling) {
+        wait = ceiling;
+    }
+    return wait;
+}
+
+/**
+ * Feed one attempt's outcome into the slave's estimate, called only from the bus thread
+ * Turnaround is sampled from first attempts only (Karn's rule): after a
+ * re-send, a late reply to the earlier attempt would read as a fast one.
+ */
+static void modbus_adapt_record(modbus_rtu_device_t *device, modbus_txn_t *txn, rt_err_t result)
+{
+    modbus_adapt_slot_t *slot;
+    rt_int32_t error8;
+    rt_uint32_t sample8;
+
+    if (txn->slave_addr == MODBUS_BROADCAST_ADDRESS) {
+        return;
+    }
+
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+
+    slot = modbus_adapt_slot(&device->adapt, txn->slave_addr, RT_TRUE);
+    if (!slot) {
+        rt_mutex_release(device->lock);
+        return;
+    }
+
+    if (result == -RT_ETIMEOUT) {
+        slot->timeouts++;
+        if (slot->backoff < MODBUS_ADAPT_BACKOFF_MAX) {
+            slot->backoff++;
+        }
+    } else if ((result == RT_EOK || txn->exception != 0) && txn->retries == 0) {
+        sample8 = (txn->rx_tick - txn->tx_tick) * 8;
+        if ((rt_int32_t)(txn->rx_tick - txn->tx_tick) < 0) {
+            sample8 = 0;
+        }
+        if (slot->samples == 0) {
+            slot->srtt8 = sample8;
+            slot->rttvar8 = sample8 / 2;
+        } else {
+            /* Gains 1/8 for the mean and 1/4 for the deviation */
+            error8 = (rt_int32_t)sample8 - (rt_int32_t)slot->srtt8;
+            slot->srtt8 += error8 / 8;
+            if (error8 < 0) {
+                error8 = -error8;
+            }
+            slot->rttvar8 += (error8 - (rt_int32_t)slot->rttvar8) / 4;
+        }
+        slot->samples++;
+        slot->backoff = 0;
+    }
+
+    rt_mutex_release(device->lock);
+}
+
+/**
+ * Enable or disable learned timeouts of a bus and set their bounds
+ * A bound of 0 keeps the current one. Disabled, every request waits the
+ * bus timeout; what was learned is kept.
+ */
+void modbus_adapt_config(modbus_rtu_device_t *device, rt_bool_t enabled,
+                         rt_uint32_t min_ms, rt_uint32_t max_ms)
+{
+    if (!device) {
+        return;
+    }
+
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    device->adapt.enabled = enabled;
+    if (min_ms) {
+        device->adapt.min_tick = rt_tick_from_millisecond(min_ms);
+    }
+    if (max_ms) {
+        device->adapt.max_tick = rt_tick_from_millisecond(max_ms);
+    }
+    if (device->adapt.max_tick < device->adapt.min_tick) {
+        device->adapt.max_tick = device->adapt.min_tick;
+    }
+    rt_mutex_release(device->lock);
+}
+
+/**
+ * Copy the learned values for one slave and the timeout a one-register read would use
+ * Returns -RT_EEMPTY when nothing is known about the slave yet.
+ */
+rt_err_t modbus_adapt_get(modbus_rtu_device_t *device, rt_uint8_t slave_addr,
+                          modbus_adapt_slot_t *slot, rt_tick_t *wait_tick)
+{
+    modbus_adapt_slot_t *found;
+
+    if (!device) {
+        return -RT_ERROR;
+    }
+
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    found = modbus_adapt_slot(&device->adapt, slave_addr, RT_FALSE);
+    if (found && slot) {
+        *slot = *found;
+    }
+    if (wait_tick) {
+        *wait_tick = modbus_adapt_wait(device, found, 8, 7);
+    }
+    rt_mutex_release(device->lock);
+
+    return found ? RT_EOK : -RT_EEMPTY;
+}
+
+/**
+ * Forget every learned timeout of a bus
+ */
+void modbus_adapt_reset(modbus_rtu_device_t *device)
+{
+    if (!device) {
+        return;
+    }
+
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    rt_memset(device->adapt.slots, 0, sizeof(device->adapt.slots));
+    rt_mutex_release(device->lock);
+}
+
+/**
+ * Check that a reply without exception answers the request it was sent for
+ * Reads must carry the requested byte count; FC06 echoes the request and
+ * FC16 the written range.
+ */
+static rt_bool_t modbus_reply_matches(modbus_rtu_device_t *device, modbus_txn_t *txn)
+{
+    const rt_uint8_t *buf = device->parser.buf;
+
+    if (buf[0] != txn->slave_addr || buf[1] != txn->function_code) {
+        return RT_FALSE;
+    }
+
+    switch (txn->function_code) {
+    case MODBUS_FUNC_WRITE_SINGLE_REG:
+    case MODBUS_FUNC_WRITE_MULTIPLE_REGS:
+        return ((buf[2] << 8) | buf[3]) == txn->start_addr &&
+               ((buf[4] << 8) | buf[5]) == txn->reg_count;
+    default:
+        return buf[2] == txn->reg_count * 2;
+    }
+}
+
+/**
+ * Run one transaction on the wire, called only from the bus thread
+ */
+static rt_err_t modbus_execute(modbus_rtu_device_t *device, modbus_txn_t *txn)
+{
+    modbus_request_t request;
+    modbus_response_t response;
+    rt_err_t result;
+    rt_tick_t sent;
+    rt_size_t length = 8;
+    rt_uint16_t i;
+
+    request.slave_addr = txn->slave_addr;
+    request.function_code = txn->function_code;
+    request.start_addr = txn->start_addr;
+    request.reg_count = txn->reg_count;  /* Register value for FC06 */
+
+    /* A write makes any cached copy of the registers stale */
+    if (txn->function_code == MODBUS_FUNC_WRITE_SINGLE_REG) {
+        modbus_cache_invalidate(device, txn->slave_addr, txn->start_addr, 1);
+    } else if (txn->function_code == MODBUS_FUNC_WRITE_MULTIPLE_REGS) {
+        modbus_cache_invalidate(device, txn->slave_addr, txn->start_addr, txn->reg_count);
+    } else if (txn->function_code == MODBUS_FUNC_READ_WRITE_REGS) {
+        modbus_cache_invalidate(device, txn->slave_addr, txn->write_addr, txn->write_count);
+    }
+
+    /* Wait for this slave as learned from its earlier replies */
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    device->wait_tick = modbus_adapt_wait(device, modbus_adapt_slot(&device->adapt, txn->slave_addr, RT_FALSE),
+                                          modbus_request_length(txn), modbus_reply_length(txn));
+    rt_mutex_release(device->lock);
+
+    /* Send request, as prebuilt when the caller has one */
+    sent = rt_tick_get();
+    if (txn->frame) {
+        result = modbus_send_frame(device, txn->frame);
+    } else if (txn->function_code == MODBUS_FUNC_WRITE_MULTIPLE_REGS) {
+        length = modbus_frame_build_write(device->tx_buf, txn->slave_addr, txn->start_addr,
+                                          txn->reg_count, txn->write_values);
+        result = length ? modbus_send_bytes(device, device->tx_buf, length, 0) : -RT_ERROR;
+    } else if (txn->function_code == MODBUS_FUNC_READ_WRITE_REGS) {
+        length = modbus_frame_build_read_write(device->tx_buf, txn->slave_addr,
+                                               txn->start_addr, txn->reg_count,
+                                               txn->write_addr, txn->write_count, txn->write_values);
+        result = length ? modbus_send_bytes(device, device->tx_buf, length, txn->reg_count * 2) : -RT_ERROR;
+    } else {
+        result = modbus_send_request(device, &request);
+    }
+    if (result != RT_EOK) {
+        return result;
+    }
+
+    /* A non-blocking UART returns before the frame is out: never earlier than its wire time */
+    txn->tx_tick = sent + modbus_wire_tick(device, length);
+    if ((rt_int32_t)(rt_tick_get() - txn->tx_tick) > 0) {
+        txn->tx_tick = rt_tick_get();
+    }
+
+    if (txn->slave_addr == MODBUS_BROADCAST_ADDRESS) {
+        /* Nobody answers a broadcast */
+        return RT_EOK;
+    }
+
+    /* Receive response */
+    result = modbus_receive_response(device, &response);
+    if (device->tx_done) {
+        /* Driver enable released here: the real start of the turnaround */
+        txn->tx_tick = device->tx_done_tick;
+    }
+    if (result != RT_EOK) {
+        LOG_D("Failed to receive response: %d", result);
+        return result;
+    }
+    txn->rx_tick = device->first_rx_tick;
+
+    /* Exception reply: the code sits where a read reply has its byte count */
+    if (response.slave_addr == txn->slave_addr &&
+        response.function_code == (txn->function_code | 0x80)) {
+        txn->exception = response.byte_count;
+        LOG_D("Exception 0x%02X from slave 0x%02X, function 0x%02X",
+              txn->exception, txn->slave_addr, txn->function_code);
+        return (txn->exception == MODBUS_EX_SLAVE_BUSY || txn->exception == MODBUS_EX_ACKNOWLEDGE) ?
+               -RT_EBUSY : -RT_ERROR;
+    }
+
+    /* Verify response */
+    if (!modbus_reply_matches(device, txn)) {
+        LOG_D("Response validation failed: addr=0x%02X, func=0x%02X, %d bytes",
+              response.slave_addr, response.function_code, device->parser.length);
+        return -RT_EINVAL;
+    }
+
+    if (txn->function_code == MODBUS_FUNC_WRITE_SINGLE_REG ||
+        txn->function_code == MODBUS_FUNC_WRITE_MULTIPLE_REGS) {
+        return RT_EOK;
+    }
+
+    /* Extract values */
+    for (i = 0; i < txn->reg_count; i++) {
+        txn->values[i] = (response.data[i * 2] << 8) | response.data[i * 2 + 1];
+    }
+
+    if (txn->function_code != MODBUS_FUNC_READ_WRITE_REGS) {
+        modbus_cache_store(device, txn);
+    }
+    return RT_EOK;
+}
+
+/* Failures a retry policy treats separately */
+enum {
+    MODBUS_RETRY_CAUSE_TIMEOUT = 0,
+    MODBUS_RETRY_CAUSE_CRC,
+    MODBUS_RETRY_CAUSE_BUSY,
+    MODBUS_RETRY_CAUSE_COUNT
+};
+
+/**
+ * Ticks to wait before re-sending a failed attempt, or 0 when it is final
+ */
+static rt_tick_t modbus_retry_gap(modbus_rtu_device_t *device, const modbus_retry_t *policy,
+                                  modbus_txn_t *txn, rt_err_t result, rt_uint8_t *used)
+{
+    rt_uint8_t cause, limit;
+    rt_tick_t gap;
+
+    if (result == RT_EOK || !device->running || txn->retries >= policy->max_retries) {
+        return 0;
+    }
+
+    /* A few character times on top of the T3.5 the receive path already waited */
+    gap = (policy->gap_chars * MODBUS_CHAR_BITS * RT_TICK_PER_SECOND + device->baud_rate - 1) / device->baud_rate;
+    if (result == -RT_ETIMEOUT) {
+        cause = MODBUS_RETRY_CAUSE_TIMEOUT;
+        limit = policy->timeout_retries;
+    } else if (result == -RT_EIO) {
+        cause = MODBUS_RETRY_CAUSE_CRC;
+        limit = policy->crc_retries;
+    } else if (result == -RT_EBUSY) {
+        cause = MODBUS_RETRY_CAUSE_BUSY;
+        limit = policy->busy_retries;
+        gap = rt_tick_from_millisecond(policy->busy_ms);
+    } else {
+        return 0;
+    }
+
+    if (used[cause] >= limit) {
+        return 0;
+    }
+    used[cause]++;
+
+    return gap > 0 ? gap : 1;
+}
+
+/**
+ * Run a transaction on the wire under its retry policy and account every
+ * attempt, called only from the bus thread
+ */
+static rt_err_t modbus_run(modbus_rtu_device_t *device, modbus_txn_t *txn)
+{
+    modbus_retry_t policy;
+    rt_uint8_t used[MODBUS_RETRY_CAUSE_COUNT] = {0};
+    rt_uint32_t crc_errors;
+    rt_tick_t attempt_tick, gap;
+    rt_err_t result;
+
+    if (txn->retry) {
+        policy = *txn->retry;
+    } else {
+        rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+        policy = device->retry;
+        rt_mutex_release(device->lock);
+    }
+
+    txn->start_tick = rt_tick_get();
+    txn->retries = 0;
+    for (;;) {
+        crc_errors = device->parser.crc_errors;
+        attempt_tick = rt_tick_get();
+        txn->tx_tick = txn->rx_tick = attempt_tick;
+        txn->exception = 0;
+
+        result = modbus_execute(device, txn);
+        gap = modbus_retry_gap(device, &policy, txn, result, used);
+        modbus_stats_record(device, txn, result, device->parser.crc_errors - crc_errors,
+                            attempt_tick, gap == 0);
+        modbus_adapt_record(device, txn, result);
+        if (gap == 0) {
+            break;
+        }
+
+        txn->retries++;
+        rt_thread_delay(gap);
+    }
+
+    return result;
+}
+
+/**
+ * Finish a transaction: callback first, then wake any waiter
+ * The callback may hand the transaction back to its owner for reuse or
+ * freeing, so nothing here reads it once the callback has run.
+ */
+static void modbus_complete(modbus_txn_t *txn, rt_err_t result)
+{
+    rt_sem_t done = txn->done;
+
+    txn->result = result;
+    txn->done_tick = rt_tick_get();
+
+    if (txn->callback) {
+        txn->callback(txn);
+    }
+    if (done) {
+        rt_sem_release(done);
+    }
+}
+
+/**
+ * Next transaction to run, with the lock held and the queue not empty
+ * Highest class first after aging, oldest first among equals.
+ */
+static modbus_txn_t *modbus_queue_next(modbus_rtu_device_t *device)
+{
+    rt_tick_t now = rt_tick_get();
+    rt_tick_t aging = rt_tick_from_millisecond(MODBUS_PRIO_AGING_MS);
+    modbus_txn_t *txn, *best = RT_NULL;
+    rt_uint32_t rank, best_rank = 0;
+    rt_list_t *node;
+
+    rt_list_for_each(node, &device->queue) {
+        txn = rt_list_entry(node, modbus_txn_t, node);
+        rank = txn->priority + (aging ? (now - txn->queued_tick) / aging : 0);
+        if (rank > MODBUS_PRIO_URGENT) {
+            rank = MODBUS_PRIO_URGENT;
+        }
+        if (!best || rank > best_rank) {
+            best = txn;
+            best_rank = rank;
+        }
+    }
 
-    return RT_EOK;
+    return best;
 }
 
 /**
- * Calculate CRC-16 for Modbus (correct algorithm)
+ * Bus thread: the only place the serial port is touched
  */
-rt_uint16_t modbus_crc16(rt_uint8_t *data, rt_uint16_t length)
+static void modbus_bus_thread_entry(void *parameter)
 {
-    rt_uint16_t crc_value = 0xFFFF;
-    rt_uint8_t i, j;
+    modbus_rtu_device_t *device = (modbus_rtu_device_t *)parameter;
+    modbus_txn_t *txn;
+    rt_list_t drained;
 
-    for (i = 0; i < length; i++) {
-        crc_value ^= data[i];
-        for (j = 0; j < 8; j++) {
-            if (crc_value & 0x0001) {
-                crc_value = (crc_value >> 1) ^ 0xA001;
-            } else {
-                crc_value = (crc_value >> 1);
-            }
+    while (device->running) {
+        rt_sem_take(device->queue_sem, RT_WAITING_FOREVER);
+
+        rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+        if (rt_list_isempty(&device->queue)) {
+            rt_mutex_release(device->lock);
+            continue;
+        }
+        txn = modbus_queue_next(device);
+        rt_list_remove(&txn->node);
+        device->queue_len--;
+        rt_mutex_release(device->lock);
+        rt_sem_release(device->slot_sem);
+        if (txn->priority == MODBUS_PRIO_BACKGROUND) {
+            rt_sem_release(device->background_sem);
         }
+
+        modbus_complete(txn, modbus_run(device, txn));
     }
-    
-    /* Swap high and low bytes */
-    crc_value = ((crc_value >> 8) + (crc_value << 8));
-    
-    return crc_value;
+
+    /* Fail whatever is still queued so no waiter hangs */
+    rt_list_init(&drained);
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    while (!rt_list_isempty(&device->queue)) {
+        txn = rt_list_first_entry(&device->queue, modbus_txn_t, node);
+        rt_list_remove(&txn->node);
+        rt_list_insert_before(&drained, &txn->node);
+        device->queue_len--;
+    }
+    rt_mutex_release(device->lock);
+
+    /* Unlocked: a callback may submit to or cancel on this bus */
+    while (!rt_list_isempty(&drained)) {
+        txn = rt_list_first_entry(&drained, modbus_txn_t, node);
+        rt_list_remove(&txn->node);
+        modbus_complete(txn, -RT_EINTR);
+    }
+
+    rt_sem_release(device->exit_sem);
 }
 
 /**
- * Test CRC calculation with known example from manual (simplified)
+ * Class of a transaction submitted with MODBUS_PRIO_AUTO
  */
-static void test_crc_example(void)
+static rt_uint8_t modbus_auto_priority(void)
 {
-    /* CRC test removed to reduce output */
+#if defined(RT_USING_FINSH) && defined(FINSH_THREAD_NAME)
+    rt_thread_t self = rt_thread_self();
+
+    if (self && rt_strncmp(self->parent.name, FINSH_THREAD_NAME, RT_NAME_MAX) == 0) {
+        return MODBUS_PRIO_INTERACTIVE;
+    }
+#endif
+    return MODBUS_PRIO_BACKGROUND;
 }
 
 /**
- * Initialize Modbus RTU device
+ * Append a transaction once a queue slot frees up within timeout
+ * Background transactions leave MODBUS_PRIO_RESERVED slots to the others,
+ * so a queue full of polls never holds up a shell command or a calibration.
  */
-modbus_rtu_device_t* modbus_rtu_init(const char *uart_name)
+static rt_err_t modbus_enqueue(modbus_rtu_device_t *device, modbus_txn_t *txn, rt_int32_t timeout)
 {
-    modbus_rtu_device_t *device;
-    struct rt_serial_device *serial;
-
-    if (!uart_name) {
-        rt_kprintf("[MODBUS] Error: uart_name is NULL\n");
-        return RT_NULL;
+    if (!device || !txn || !device->running) {
+        return -RT_ERROR;
     }
 
-    device = (modbus_rtu_device_t*)rt_malloc(sizeof(modbus_rtu_device_t));
-    if (!device) {
-        rt_kprintf("[MODBUS] Error: Failed to allocate memory\n");
-        return RT_NULL;
+    if (txn->priority == MODBUS_PRIO_AUTO) {
+        txn->priority = modbus_auto_priority();
+    } else if (txn->priority >= MODBUS_PRIO_COUNT) {
+        txn->priority = MODBUS_PRIO_URGENT;
     }
 
-    rt_memset(device, 0, sizeof(modbus_rtu_device_t));
-
-    /* Find serial device */
-    serial = (struct rt_serial_device *)rt_device_find(uart_name);
-    if (!serial) {
-        rt_kprintf("[MODBUS] Error: Cannot find UART device '%s'\n", uart_name);
-        rt_free(device);
-        return RT_NULL;
+    if (txn->priority == MODBUS_PRIO_BACKGROUND &&
+        rt_sem_take(device->background_sem, timeout) != RT_EOK) {
+        return -RT_EFULL;
     }
-
-    /* Configure UART2 specifically for S8 sensor */
-    if (rt_strcmp(uart_name, "uart2") == 0) {
-        rt_err_t config_result = configure_uart2_for_s8();
-        if (config_result != RT_EOK) {
-            rt_kprintf("[MODBUS] Warning: UART2 configuration failed, using defaults (error: %d)\n", config_result);
+    if (rt_sem_take(device->slot_sem, timeout) != RT_EOK) {
+        if (txn->priority == MODBUS_PRIO_BACKGROUND) {
+            rt_sem_release(device->background_sem);
         }
+        return -RT_EFULL;
     }
 
-    /* Open serial device */
-    if (rt_device_open((rt_device_t)serial, RT_DEVICE_OFLAG_RDWR | RT_DEVICE_FLAG_INT_RX) != RT_EOK) {
-        rt_kprintf("[MODBUS] Error: Failed to open UART\n");
-        rt_free(device);
-        return RT_NULL;
-    }
+    txn->result = -RT_EBUSY;
+    txn->queued_tick = rt_tick_get();
+    rt_list_init(&txn->node);
 
-    device->serial = serial;
-    device->timeout_tick = rt_tick_from_millisecond(180);  /* S8 sensor timeout: 180ms (per Modbus specification) */
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    rt_list_insert_before(&device->queue, &txn->node);
+    device->queue_len++;
+    rt_mutex_release(device->lock);
 
-    /* Create mutex for thread safety */
-    device->lock = rt_mutex_create("mb_lock", RT_IPC_FLAG_FIFO);
-    if (!device->lock) {
-        rt_kprintf("[MODBUS] Error: Failed to create mutex\n");
-        rt_device_close((rt_device_t)serial);
-        rt_free(device);
-        return RT_NULL;
-    }
+    rt_sem_release(device->queue_sem);
+    return RT_EOK;
+}
 
-    return device;
+/**
+ * Queue a transaction without waiting for it
+ * The transaction must stay valid until it completes. Its callback runs in
+ * the bus thread and may queue further work or free the transaction; the
+ * bus does not touch it afterwards, except to release txn->done if that was
+ * set when it completed. Returns -RT_EFULL when the queue is at depth.
+ */
+rt_err_t modbus_submit(modbus_rtu_device_t *device, modbus_txn_t *txn)
+{
+    return modbus_enqueue(device, txn, RT_WAITING_NO);
 }
 
 /**
- * Deinitialize Modbus RTU device
+ * Set the retry policy for transactions that do not bring their own
+ * RT_NULL restores the MODBUS_RETRY_* defaults.
  */
-rt_err_t modbus_rtu_deinit(modbus_rtu_device_t *device)
+void modbus_set_retry(modbus_rtu_device_t *device, const modbus_retry_t *policy)
 {
+    modbus_retry_t defaults;
+
     if (!device) {
-        return -RT_ERROR;
+        return;
     }
 
-    if (device->serial) {
-        rt_device_close((rt_device_t)device->serial);
+    if (!policy) {
+        defaults.max_retries = MODBUS_RETRY_MAX;
+        defaults.timeout_retries = MODBUS_RETRY_TIMEOUTS;
+        defaults.crc_retries = MODBUS_RETRY_CRC;
+        defaults.busy_retries = MODBUS_RETRY_BUSY;
+        defaults.gap_chars = MODBUS_RETRY_GAP_CHARS;
+        defaults.busy_ms = MODBUS_RETRY_BUSY_MS;
+        policy = &defaults;
     }
 
     if (device->lock) {
-        rt_mutex_delete(device->lock);
+        rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    }
+    device->retry = *policy;
+    if (device->lock) {
+        rt_mutex_release(device->lock);
     }
-
-    rt_free(device);
-    return RT_EOK;
 }
 
 /**
- * Send Modbus request
+ * Queue a transaction and block until it completes
+ * Waits for queue space instead of failing, and runs inline when called
+ * from the bus thread itself (e.g. inside a completion callback). Reads
+ * with a fresh cache entry return at once without touching the bus.
+ * Failed attempts are re-sent under the retry policy; txn->retries counts
+ * them. The final result is RT_EOK, -RT_ETIMEOUT (no reply), -RT_EIO
+ * (corrupted reply), -RT_EINVAL (unexpected reply), -RT_EBUSY (slave still
+ * busy) or -RT_ERROR (other exception in txn->exception, or a local failure).
  */
-rt_err_t modbus_send_request(modbus_rtu_device_t *device, modbus_request_t *request)
+rt_err_t modbus_transact(modbus_rtu_device_t *device, modbus_txn_t *txn)
 {
-    rt_uint8_t frame[8];
-    rt_uint16_t crc;
-    rt_size_t written;
+    struct rt_semaphore done;
+    rt_err_t result;
 
-    if (!device || !request) {
+    if (!device || !txn) {
         return -RT_ERROR;
     }
 
-    /* Build Modbus RTU frame */
-    frame[0] = request->slave_addr;
-    frame[1] = request->function_code;
-    frame[2] = (request->start_addr >> 8) & 0xFF;
-    frame[3] = request->start_addr & 0xFF;
-    frame[4] = (request->reg_count >> 8) & 0xFF;
-    frame[5] = request->reg_count & 0xFF;
+    txn->cached = (txn->function_code == MODBUS_FUNC_READ_INPUT_REGS ||
+                   txn->function_code == MODBUS_FUNC_READ_HOLDING_REGS) &&
+                  modbus_cache_lookup(device, txn) == RT_EOK;
+    if (txn->cached) {
+        txn->queued_tick = txn->start_tick = txn->done_tick = rt_tick_get();
+        txn->result = RT_EOK;
+        return RT_EOK;
+    }
 
-    /* Calculate CRC */
-    crc = modbus_crc16(frame, 6);
-    frame[6] = (crc >> 8) & 0xFF;  /* High byte first */
-    frame[7] = crc & 0xFF;         /* Low byte second */
+    if (rt_thread_self() == device->bus_thread) {
+        txn->queued_tick = rt_tick_get();
+        txn->result = modbus_run(device, txn);
+        txn->done_tick = rt_tick_get();
+        return txn->result;
+    }
 
-    /* Debug output removed */
+    rt_sem_init(&done, "mb_done", 0, RT_IPC_FLAG_FIFO);
+    txn->done = &done;
 
-    /* Send frame */
-    written = rt_device_write((rt_device_t)device->serial, 0, frame, 8);
-    if (written != 8) {
-        rt_kprintf("[MODBUS] Error: Only wrote %d bytes\n", written);
-        return -RT_ERROR;
+    result = modbus_enqueue(device, txn, RT_WAITING_FOREVER);
+    if (result == RT_EOK) {
+        rt_sem_take(&done, RT_WAITING_FOREVER);
+        result = txn->result;
     }
 
-    return RT_EOK;
+    txn->done = RT_NULL;
+    rt_sem_detach(&done);
+    return result;
 }
 
 /**
- * Receive Modbus response
+ * Read input registers
  */
-rt_err_t modbus_receive_response(modbus_rtu_device_t *device, modbus_response_t *response)
+rt_err_t modbus_read_input_registers(modbus_rtu_device_t *device,
+                                   rt_uint8_t slave_addr,
+                                   rt_uint16_t start_addr,
+                                   rt_uint16_t reg_count,
+                                   rt_uint16_t *values)
 {
-    rt_uint8_t buffer[MODBUS_MAX_BUFFER_SIZE];
-    rt_size_t received;
-    rt_uint32_t start_tick, current_tick;
-    rt_uint16_t crc, received_crc;
+    modbus_txn_t txn;
 
-    if (!device || !response) {
+    if (!device || !values || reg_count == 0 || reg_count > MODBUS_MAX_READ_REGS) {
         return -RT_ERROR;
     }
 
-    start_tick = rt_tick_get();
-
-    /* Wait for response */
-    while (1) {
-        received = rt_device_read((rt_device_t)device->serial, 0, buffer, sizeof(buffer));
-        if (received > 0) {
-            break;
-        }
+    rt_memset(&txn, 0, sizeof(txn));
+    txn.slave_addr = slave_addr;
+    txn.function_code = MODBUS_FUNC_READ_INPUT_REGS;
+    txn.start_addr = start_addr;
+    txn.reg_count = reg_count;
+    txn.values = values;
 
-        current_tick = rt_tick_get();
-        if ((current_tick - start_tick) > device->timeout_tick) {
-            rt_kprintf("[MODBUS] Timeout waiting for response\n");
-            return -RT_ETIMEOUT;
-        }
+    return modbus_transact(device, &txn);
+}
 
-        rt_thread_mdelay(10);
-    }
+/**
+ * Read holding registers (legacy function)
+ */
+rt_err_t modbus_read_holding_registers(modbus_rtu_device_t *device,
+                                       rt_uint8_t slave_addr,
+                                       rt_uint16_t start_addr,
+                                       rt_uint16_t reg_count,
+                                       rt_uint16_t *values)
+{
+    modbus_txn_t txn;
 
-    if (received < 5) { /* Minimum response size */
-        rt_kprintf("[MODBUS] Error: Received only %d bytes\n", received);
+    if (!device || !values || reg_count == 0 || reg_count > MODBUS_MAX_READ_REGS) {
         return -RT_ERROR;
     }
 
-    /* Debug output removed */
-
-    /* Parse response */
-    response->slave_addr = buffer[0];
-    response->function_code = buffer[1];
-    response->byte_count = buffer[2];
-    response->data = &buffer[3];
-
-    /* Verify CRC */
-    crc = modbus_crc16(buffer, received - 2);
-    received_crc = (buffer[received - 2] << 8) | (buffer[received - 1]);  /* High byte first, Low byte second */
+    rt_memset(&txn, 0, sizeof(txn));
+    txn.slave_addr = slave_addr;
+    txn.function_code = MODBUS_FUNC_READ_HOLDING_REGS;
+    txn.start_addr = start_addr;
+    txn.reg_count = reg_count;
+    txn.values = values;
 
-    if (crc != received_crc) {
-        rt_kprintf("[MODBUS] CRC error: calculated %04X, received %04X\n", crc, received_crc);
-        return -RT_ERROR;
-    }
+    return modbus_transact(device, &txn);
+}
 
-    return RT_EOK;
+/**
+ * Prepare a read transaction that sends a prebuilt request frame
+ */
+void modbus_txn_from_frame(modbus_txn_t *txn, const modbus_frame_t *frame, rt_uint16_t *values)
+{
+    rt_memset(txn, 0, sizeof(modbus_txn_t));
+    txn->slave_addr = frame->bytes[0];
+    txn->function_code = frame->bytes[1];
+    txn->start_addr = (frame->bytes[2] << 8) | frame->bytes[3];
+    txn->reg_count = (frame->bytes[4] << 8) | frame->bytes[5];
+    txn->values = values;
+    txn->frame = frame;
 }
 
 /**
- * Read input registers
+ * Read registers with a prebuilt request frame
+ * Takes the same path as the field-based reads, cache included, but the
+ * frame goes to the line as is.
  */
-rt_err_t modbus_read_input_registers(modbus_rtu_device_t *device,
-                                   rt_uint8_t slave_addr,
-                                   rt_uint16_t start_addr,
-                                   rt_uint16_t reg_count,
-                                   rt_uint16_t *values)
+rt_err_t modbus_read_frame(modbus_rtu_device_t *device, const modbus_frame_t *frame,
+                           rt_uint16_t *values)
 {
-    modbus_request_t request;
-    modbus_response_t response;
-    rt_err_t result;
-    rt_uint16_t i;
+    modbus_txn_t txn;
 
-    if (!device || !values || reg_count == 0) {
+    if (!device || !frame || !values) {
         return -RT_ERROR;
     }
 
-    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    modbus_txn_from_frame(&txn, frame, values);
+    if ((txn.function_code != MODBUS_FUNC_READ_INPUT_REGS &&
+         txn.function_code != MODBUS_FUNC_READ_HOLDING_REGS) || txn.reg_count == 0) {
+        return -RT_ERROR;
+    }
 
-    /* Build request for input registers */
-    request.slave_addr = slave_addr;
-    request.function_code = MODBUS_FUNC_READ_INPUT_REGS;
-    request.start_addr = start_addr;
-    request.reg_count = reg_count;
+    return modbus_transact(device, &txn);
+}
 
-    /* Debug output removed */
+/**
+ * Write single register
+ * Completes once the slave has echoed the request, or at once for the
+ * broadcast address.
+ */
+rt_err_t modbus_write_single_register(modbus_rtu_device_t *device,
+                                    rt_uint8_t slave_addr,
+                                    rt_uint16_t reg_addr,
+                                    rt_uint16_t value)
+{
+    modbus_txn_t txn;
 
-    /* Send request */
-    result = modbus_send_request(device, &request);
-    if (result != RT_EOK) {
-        rt_mutex_release(device->lock);
-        return result;
+    if (!device) {
+        return -RT_ERROR;
     }
 
-    /* Wait a bit for response */
-    rt_thread_mdelay(100);  /* S8 needs more time */
+    rt_memset(&txn, 0, sizeof(txn));
+    txn.slave_addr = slave_addr;
+    txn.function_code = MODBUS_FUNC_WRITE_SINGLE_REG;
+    txn.start_addr = reg_addr;
+    txn.reg_count = value;
 
-    /* Receive response */
-    result = modbus_receive_response(device, &response);
-    if (result != RT_EOK) {
-        rt_mutex_release(device->lock);
-        rt_kprintf("[MODBUS] Failed to receive response: %d\n", result);
-        return result;
-    }
+    return modbus_transact(device, &txn);
+}
 
-    /* Verify response */
-    if (response.slave_addr != slave_addr ||
-        response.function_code != MODBUS_FUNC_READ_INPUT_REGS ||
-        response.byte_count != (reg_count * 2)) {
-        rt_kprintf("[MODBUS] Response validation failed: addr=0x%02X, func=0x%02X, bytes=%d (expected %d)\n",
-                   response.slave_addr, response.function_code, response.byte_count, reg_count * 2);
-        rt_mutex_release(device->lock);
+/**
+ * Write multiple registers (FC16)
+ * One round trip for a block of consecutive registers; completes once the
+ * slave has confirmed the written range.
+ */
+rt_err_t modbus_write_multiple_registers(modbus_rtu_device_t *device,
+                                         rt_uint8_t slave_addr,
+                                         rt_uint16_t start_addr,
+                                         rt_uint16_t reg_count,
+                                         const rt_uint16_t *values)
+{
+    modbus_txn_t txn;
+
+    if (!device || !values || reg_count == 0 || reg_count > MODBUS_MAX_WRITE_REGS) {
         return -RT_ERROR;
     }
 
-    /* Extract values */
-    for (i = 0; i < reg_count; i++) {
-        values[i] = (response.data[i * 2] << 8) | response.data[i * 2 + 1];
-        /* Debug output removed */
-    }
+    rt_memset(&txn, 0, sizeof(txn));
+    txn.slave_addr = slave_addr;
+    txn.function_code = MODBUS_FUNC_WRITE_MULTIPLE_REGS;
+    txn.start_addr = start_addr;
+    txn.reg_count = reg_count;
+    txn.write_values = values;
 
-    rt_mutex_release(device->lock);
-    return RT_EOK;
+    return modbus_transact(device, &txn);
 }
 
 /**
- * Read holding registers (legacy function)
+ * Write then read registers in one transaction (FC23)
+ * The slave applies the write before the read, so a command and its
+ * result can be exchanged in one round trip.
  */
-rt_err_t modbus_read_holding_registers(modbus_rtu_device_t *device,
-                                       rt_uint8_t slave_addr,
-                                       rt_uint16_t start_addr,
-                                       rt_uint16_t reg_count,
-                                       rt_uint16_t *values)
+rt_err_t modbus_read_write_registers(modbus_rtu_device_t *device,
+                                     rt_uint8_t slave_addr,
+                                     rt_uint16_t read_addr,
+                                     rt_uint16_t read_count,
+                                     rt_uint16_t *read_values,
+                                     rt_uint16_t write_addr,
+                                     rt_uint16_t write_count,
+                                     const rt_uint16_t *write_values)
 {
-    modbus_request_t request;
-    modbus_response_t response;
-    rt_err_t result;
-    rt_uint16_t i;
+    modbus_txn_t txn;
 
-    if (!device || !values || reg_count == 0) {
+    if (!device || !read_values || !write_values ||
+        read_count == 0 || read_count > MODBUS_MAX_READ_REGS ||
+        write_count == 0 || write_count > MODBUS_MAX_RW_WRITE_REGS ||
+        slave_addr == MODBUS_BROADCAST_ADDRESS) {
         return -RT_ERROR;
     }
 
-    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    rt_memset(&txn, 0, sizeof(txn));
+    txn.slave_addr = slave_addr;
+    txn.function_code = MODBUS_FUNC_READ_WRITE_REGS;
+    txn.start_addr = read_addr;
+    txn.reg_count = read_count;
+    txn.values = read_values;
+    txn.write_addr = write_addr;
+    txn.write_count = write_count;
+    txn.write_values = write_values;
+
+    return modbus_transact(device, &txn);
+}
 
-    /* Build request */
-    request.slave_addr = slave_addr;
-    request.function_code = MODBUS_FUNC_READ_HOLDING_REGS;
-    request.start_addr = start_addr;
-    request.reg_count = reg_count;
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+#include <stdlib.h>
 
-    /* Debug output removed */
+/**
+ * Show or clear the read cache of every active bus
+ * Usage: mb_cache [clear]
+ */
+static void mb_cache(int argc, char *argv[])
+{
+    modbus_rtu_device_t *device;
+    modbus_cache_rule_t rules[MODBUS_CACHE_RULES];
+    rt_uint32_t hits, misses, invalidations, lookups;
+    rt_uint8_t slot, rule_count, i;
 
-    /* Send request */
-    result = modbus_send_request(device, &request);
-    if (result != RT_EOK) {
-        rt_mutex_release(device->lock);
-        return result;
+    if (!modbus_bus_lock) {
+        return;
     }
 
-    /* Wait a bit for response */
-    rt_thread_mdelay(50);
+    /* No bus leaves the table while it is shown; counters are copied under its lock */
+    rt_mutex_take(modbus_bus_lock, RT_WAITING_FOREVER);
+    for (slot = 0; slot < MODBUS_MAX_BUS; slot++) {
+        device = modbus_bus_table[slot];
+        if (!device) {
+            continue;
+        }
 
-    /* Receive response */
-    result = modbus_receive_response(device, &response);
-    if (result != RT_EOK) {
+        if (argc > 1 && rt_strcmp(argv[1], "clear") == 0) {
+            modbus_cache_clear(device);
+            rt_kprintf("[MODBUS] %s: cache cleared\n", device->serial->parent.parent.name);
+            continue;
+        }
+
+        rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+        hits = device->cache.hits;
+        misses = device->cache.misses;
+        invalidations = device->cache.invalidations;
+        rule_count = device->cache.rule_count;
+        rt_memcpy(rules, device->cache.rules, sizeof(rules));
         rt_mutex_release(device->lock);
-        rt_kprintf("[MODBUS] Failed to receive response: %d\n", result);
-        return result;
+
+        lookups = hits + misses;
+        rt_kprintf("[MODBUS] %s: %d hits, %d misses (%d%% avoided), %d invalidated\n",
+                   device->serial->parent.parent.name, hits, misses,
+                   lookups ? hits * 100 / lookups : 0, invalidations);
+        for (i = 0; i < rule_count; i++) {
+            rt_kprintf("  FC%02X 0x%04X+%d  TTL %d ms\n",
+                       rules[i].function_code, rules[i].start_addr, rules[i].reg_count,
+                       rules[i].ttl_tick * 1000 / RT_TICK_PER_SECOND);
+        }
     }
+    rt_mutex_release(modbus_bus_lock);
+}
+MSH_CMD_EXPORT(mb_cache, Show or clear the Modbus read cache);
 
-    /* Verify response */
-    if (response.slave_addr != slave_addr ||
-        response.function_code != MODBUS_FUNC_READ_HOLDING_REGS ||
-        response.byte_count != (reg_count * 2)) {
-        rt_kprintf("[MODBUS] Response validation failed: addr=0x%02X, func=0x%02X, bytes=%d (expected %d)\n",
-                   response.slave_addr, response.function_code, response.byte_count, reg_count * 2);
-        rt_mutex_release(device->lock);
-        return -RT_ERROR;
+/**
+ * Show or reset latency histograms and bus utilisation of every active bus
+ * Usage: modbus_stats [reset]
+ */
+static void modbus_stats(int argc, char *argv[])
+{
+    static const char *phase_names[MODBUS_PHASE_COUNT] = {
+        "wait", "tx", "turnaround", "rx", "total"
+    };
+    static const char *class_names[MODBUS_PRIO_COUNT] = {
+        "auto", "background", "interactive", "urgent"
+    };
+    modbus_rtu_device_t *device;
+    modbus_stats_t *stats;
+    modbus_stats_slot_t *slot;
+    modbus_hist_t bus;
+    rt_uint32_t transactions, timeouts, crc_errors;
+    rt_uint8_t busno, phase, i;
+
+    if (!modbus_bus_lock) {
+        return;
     }
 
-    /* Extract values */
-    for (i = 0; i < reg_count; i++) {
-        values[i] = (response.data[i * 2] << 8) | response.data[i * 2 + 1];
-        /* Debug output removed */
+    stats = (modbus_stats_t *)rt_malloc(sizeof(modbus_stats_t));
+    if (!stats) {
+        rt_kprintf("[MODBUS] Error: Failed to allocate memory\n");
+        return;
     }
 
-    rt_mutex_release(device->lock);
-    return RT_EOK;
+    /* No bus leaves the table while it is shown; modbus_stats_get() copies under its lock */
+    rt_mutex_take(modbus_bus_lock, RT_WAITING_FOREVER);
+    for (busno = 0; busno < MODBUS_MAX_BUS; busno++) {
+        device = modbus_bus_table[busno];
+        if (!device) {
+            continue;
+        }
+
+        if (argc > 1 && rt_strcmp(argv[1], "reset") == 0) {
+            modbus_stats_reset(device);
+            rt_kprintf("[MODBUS] %s: statistics reset\n", device->serial->parent.parent.name);
+            continue;
+        }
+
+        modbus_stats_get(device, stats);
+        transactions = timeouts = crc_errors = 0;
+        for (i = 0; i < MODBUS_STATS_SLOTS; i++) {
+            transactions += stats->slots[i].transactions;
+            timeouts += stats->slots[i].timeouts;
+            crc_errors += stats->slots[i].crc_errors;
+        }
+
+        rt_kprintf("[MODBUS] %s: %d transactions in %d s, bus busy %d.%d%%, line %d.%d%%, "
+                   "%d timeouts, %d CRC errors\n",
+                   device->serial->parent.parent.name, transactions,
+                   stats->elapsed_tick / RT_TICK_PER_SECOND,
+                   stats->busy_permille / 10, stats->busy_permille % 10,
+                   stats->wire_permille / 10, stats->wire_permille % 10,
+                   timeouts, crc_errors);
+        if (transactions == 0) {
+            continue;
+        }
+
+        rt_kprintf("  Phase (ms)     p50    p90    p99    max\n");
+        for (phase = 0; phase < MODBUS_PHASE_COUNT; phase++) {
+            rt_memset(&bus, 0, sizeof(bus));
+            for (i = 0; i < MODBUS_STATS_SLOTS; i++) {
+                modbus_hist_merge(&bus, &stats->slots[i].hist[phase]);
+            }
+            rt_kprintf("  %-11s %6d %6d %6d %6d\n", phase_names[phase],
+                       modbus_hist_percentile(&bus, 50), modbus_hist_percentile(&bus, 90),
+                       modbus_hist_percentile(&bus, 99), bus.max_ms);
+        }
+
+        rt_kprintf("  Queue wait (ms) p50    p99    max\n");
+        for (i = MODBUS_PRIO_BACKGROUND; i < MODBUS_PRIO_COUNT; i++) {
+            if (modbus_hist_count(&stats->class_wait[i]) == 0) {
+                continue;
+            }
+            rt_kprintf("  %-12s %6d %6d %6d\n", class_names[i],
+                       modbus_hist_percentile(&stats->class_wait[i], 50),
+                       modbus_hist_percentile(&stats->class_wait[i], 99), stats->class_wait[i].max_ms);
+        }
+
+        rt_kprintf("  Slave  FC    Txns   Tmo   CRC   Inv   Exc  Retry   Err  Turn p50/p99  Total p50/p99\n");
+        for (i = 0; i < MODBUS_STATS_SLOTS; i++) {
+            slot = &stats->slots[i];
+            if (slot->transactions == 0) {
+                continue;
+            }
+            if (slot->function_code == 0) {
+                rt_kprintf("  other    ");
+            } else {
+                rt_kprintf("  0x%02X   %02X", slot->slave_addr, slot->function_code);
+            }
+            rt_kprintf(" %7d %5d %5d %5d %5d %6d %5d %8d/%-4d %9d/%d\n",
+                       slot->transactions, slot->timeouts, slot->crc_errors, slot->invalid,
+                       slot->exceptions, slot->retries, slot->errors,
+                       modbus_hist_percentile(&slot->hist[MODBUS_PHASE_TURNAROUND], 50),
+                       modbus_hist_percentile(&slot->hist[MODBUS_PHASE_TURNAROUND], 99),
+                       modbus_hist_percentile(&slot->hist[MODBUS_PHASE_TOTAL], 50),
+                       modbus_hist_percentile(&slot->hist[MODBUS_PHASE_TOTAL], 99));
+        }
+    }
+    rt_mutex_release(modbus_bus_lock);
+
+    rt_free(stats);
 }
+MSH_CMD_EXPORT(modbus_stats, Show or reset Modbus latency and bus utilisation);
+
+/* Ticks scaled by 8 as tenths of a millisecond */
+#define MB_TIMEOUT_TENTHS(x8)   ((rt_uint32_t)((rt_uint64_t)(x8) * 10000 / (8 * RT_TICK_PER_SECOND)))
 
 /**
- * Write single register
+ * Show the response timeouts learned on every active bus, or change them
+ * Usage: mb_timeout [on [min_ms max_ms] | off | reset]
  */
-rt_err_t modbus_write_single_register(modbus_rtu_device_t *device,
-                                    rt_uint8_t slave_addr,
-                                    rt_uint16_t reg_addr,
-                                    rt_uint16_t value)
+static void mb_timeout(int argc, char *argv[])
 {
-    rt_uint8_t frame[8];
-    rt_uint16_t crc;
-    rt_size_t written;
+    modbus_rtu_device_t *device;
+    modbus_adapt_slot_t slots[MODBUS_ADAPT_SLOTS], slot;
+    rt_tick_t wait, min_tick, max_tick, timeout_tick;
+    rt_bool_t enabled;
+    rt_uint8_t busno, i;
 
-    if (!device) {
-        return -RT_ERROR;
+    if (!modbus_bus_lock) {
+        return;
     }
 
-    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
-
-    /* Build Modbus RTU frame for write single register */
-    frame[0] = slave_addr;
-    frame[1] = MODBUS_FUNC_WRITE_SINGLE_REG;
-    frame[2] = (reg_addr >> 8) & 0xFF;
-    frame[3] = reg_addr & 0xFF;
-    frame[4] = (value >> 8) & 0xFF;
-    frame[5] = value & 0xFF;
+    /* No bus leaves the table while it is shown; settings are copied under its lock */
+    rt_mutex_take(modbus_bus_lock, RT_WAITING_FOREVER);
+    for (busno = 0; busno < MODBUS_MAX_BUS; busno++) {
+        device = modbus_bus_table[busno];
+        if (!device) {
+            continue;
+        }
 
-    /* Calculate CRC */
-    crc = modbus_crc16(frame, 6);
-    frame[6] = (crc >> 8) & 0xFF;  /* High byte first */
-    frame[7] = crc & 0xFF;         /* Low byte second */
+        if (argc > 1 && rt_strcmp(argv[1], "reset") == 0) {
+            modbus_adapt_reset(device);
+            rt_kprintf("[MODBUS] %s: learned timeouts cleared\n", device->serial->parent.parent.name);
+            continue;
+        }
+        if (argc > 1 && (rt_strcmp(argv[1], "on") == 0 || rt_strcmp(argv[1], "off") == 0)) {
+            modbus_adapt_config(device, rt_strcmp(argv[1], "on") == 0,
+                                (argc > 3) ? atoi(argv[2]) : 0, (argc > 3) ? atoi(argv[3]) : 0);
+        }
 
-    /* Send frame */
-    written = rt_device_write((rt_device_t)device->serial, 0, frame, 8);
-    if (written != 8) {
+        rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+        enabled = device->adapt.enabled;
+        min_tick = device->adapt.min_tick;
+        max_tick = device->adapt.max_tick;
+        timeout_tick = device->timeout_tick;
+        rt_memcpy(slots, device->adapt.slots, sizeof(slots));
         rt_mutex_release(device->lock);
-        return -RT_ERROR;
-    }
 
-    rt_mutex_release(device->lock);
-    return RT_EOK;
+        rt_kprintf("[MODBUS] %s: learned timeouts %s, bounds %d-%d ms, bus timeout %d ms\n",
+                   device->serial->parent.parent.name, enabled ? "on" : "off",
+                   min_tick * 1000 / RT_TICK_PER_SECOND, max_tick * 1000 / RT_TICK_PER_SECOND,
+                   timeout_tick * 1000 / RT_TICK_PER_SECOND);
+        rt_kprintf("  Slave  Samples  Turn ms  Dev ms  Backoff  Timeouts  Wait ms\n");
+        for (i = 0; i < MODBUS_ADAPT_SLOTS; i++) {
+            if ((slots[i].samples == 0 && slots[i].timeouts == 0) ||
+                modbus_adapt_get(device, slots[i].slave_addr, &slot, &wait) != RT_EOK) {
+                continue;
+            }
+            rt_kprintf("  0x%02X  %8d %5d.%d %5d.%d %8d %9d %8d\n", slot.slave_addr, slot.samples,
+                       MB_TIMEOUT_TENTHS(slot.srtt8) / 10, MB_TIMEOUT_TENTHS(slot.srtt8) % 10,
+                       MB_TIMEOUT_TENTHS(slot.rttvar8) / 10, MB_TIMEOUT_TENTHS(slot.rttvar8) % 10,
+                       slot.backoff, slot.timeouts, wait * 1000 / RT_TICK_PER_SECOND);
+        }
+    }
+    rt_mutex_release(modbus_bus_lock);
 }
+MSH_CMD_EXPORT(mb_timeout, Show or configure learned Modbus response timeouts);
+#endif
@@ -6,6 +6,21 @@
  * Change Logs:
  * Date           Author       Notes
  * 2025-11-21     Developer    Modbus RTU protocol for S8 CO2 sensor
+ * 2026-10-16     Developer    Transaction queue, bus table and per-bus configuration
+ * 2026-10-16     Developer    Read-response cache with per-range TTL
+ * 2026-10-16     Developer    Latency histograms and utilisation counters
+ * 2026-10-16     Developer    Compile-time request frames
+ * 2026-10-16     Developer    Retry policy, exception codes, FC16 and FC23
+ * 2026-10-16     Developer    Response timeouts learned per slave
+ * 2026-10-16     Developer    Priority classes with aging for queued transactions
+ * 2026-10-16     Developer    RS-485 driver enable run by the UART
+ * 2026-10-16     Developer    Byte tap for traffic capture
+ * 2026-10-16     Developer    Any-slave cache address set by the caller
+ * 2026-10-16     Developer    Driver enable pin set per bus in the bus table
+ * 2026-10-16     Developer    Learned timeout ceiling no lower than the bus timeout
+ * 2026-10-16     Developer    Cache match for reads of every function
+ * 2026-10-16     Developer    C linkage when included from C++
+ * 2026-10-16     Developer    Transactions answered from the cache marked as such
  */
 
 #ifndef MODBUS_RTU_H__
@@ -14,14 +29,93 @@
 #include <rtthread.h>
 #include <rtdevice.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /* Modbus function codes */
 #define MODBUS_FUNC_READ_HOLDING_REGS    0x03
 #define MODBUS_FUNC_READ_INPUT_REGS     0x04
 #define MODBUS_FUNC_WRITE_SINGLE_REG     0x06
+#define MODBUS_FUNC_WRITE_MULTIPLE_REGS  0x10
+#define MODBUS_FUNC_READ_WRITE_REGS      0x17
+
+/* Exception codes, sent back with the function code | 0x80 */
+#define MODBUS_EX_ILLEGAL_FUNCTION       0x01
+#define MODBUS_EX_ILLEGAL_ADDRESS        0x02
+#define MODBUS_EX_ILLEGAL_VALUE          0x03
+#define MODBUS_EX_SLAVE_FAILURE          0x04
+#define MODBUS_EX_ACKNOWLEDGE            0x05    /* Accepted, still processing */
+#define MODBUS_EX_SLAVE_BUSY             0x06
+#define MODBUS_EX_GATEWAY_PATH           0x0A    /* Gateway overloaded, bus queue full */
+#define MODBUS_EX_GATEWAY_TARGET         0x0B    /* Target slave did not answer */
 
 /* Modbus constants */
 #define MODBUS_MAX_BUFFER_SIZE           256
 #define MODBUS_TIMEOUT_MS               1000
+#define MODBUS_RESPONSE_TIMEOUT_MS       180     /* S8 sensor timeout: 180ms (per Modbus specification) */
+#define MODBUS_CHAR_BITS                 11      /* Line bits per character: 8N1 plus the idle bit */
+#define MODBUS_MAX_BUS                   4       /* Serial ports with an active Modbus master */
+#define MODBUS_DE_NONE                   (-1)    /* Bus without a UART-driven driver enable */
+#define MODBUS_TXN_QUEUE_DEPTH           8       /* Pending transactions per bus */
+#define MODBUS_PRIO_RESERVED             2       /* Of which background transactions cannot take */
+#define MODBUS_BUS_THREAD_PRIORITY       12      /* Above the shell and all pollers */
+#define MODBUS_CACHE_ENTRIES             8       /* Cached read responses per bus */
+#define MODBUS_CACHE_MAX_REGS            8       /* Longest read that is cached */
+#define MODBUS_CACHE_RULES               4       /* TTL ranges per bus */
+#define MODBUS_CACHE_ANY_FUNC            0x00    /* Matches cached reads of every function */
+#define MODBUS_STATS_SLOTS               8       /* (slave, function) pairs tracked per bus */
+#define MODBUS_HIST_BUCKETS              12      /* Log2 ms buckets: 0, 1, 2-3, ... 1024+ */
+#define MODBUS_ADAPT_SLOTS               16      /* Slaves with a learned response timeout per bus */
+#define MODBUS_ADAPT_BACKOFF_MAX         3       /* Timeout doublings after consecutive misses */
+#define MODBUS_BROADCAST_ADDRESS         0x00    /* Writes only, no slave replies */
+#define MODBUS_MAX_READ_REGS             125     /* Per FC03/FC04/FC23 read */
+#define MODBUS_MAX_WRITE_REGS            123     /* Per FC16 write */
+#define MODBUS_MAX_RW_WRITE_REGS         121     /* Per FC23 write */
+
+/* Default retry policy of a bus, see modbus_retry_t */
+#ifndef MODBUS_RETRY_MAX
+#define MODBUS_RETRY_MAX                 2
+#endif
+#define MODBUS_RETRY_TIMEOUTS            1
+#define MODBUS_RETRY_CRC                 2
+#define MODBUS_RETRY_BUSY                2
+#define MODBUS_RETRY_GAP_CHARS           4       /* Line idle before a fast retry */
+#define MODBUS_RETRY_BUSY_MS             50      /* Back-off after a slave-busy exception */
+
+/* Queue wait that lifts a transaction by one priority class */
+#ifndef MODBUS_PRIO_AGING_MS
+#define MODBUS_PRIO_AGING_MS             250
+#endif
+
+/* Bounds of the learned response timeout, see modbus_adapt_t */
+#ifndef MODBUS_ADAPT_MIN_MS
+#define MODBUS_ADAPT_MIN_MS              20
+#endif
+#ifndef MODBUS_ADAPT_MAX_MS
+#define MODBUS_ADAPT_MAX_MS              400
+#endif
+
+/* CRC-16 engine: 1 = 256-entry table, 4 or 8 = slice-by-4/slice-by-8 */
+#ifndef MODBUS_CRC_SLICE_BY
+#define MODBUS_CRC_SLICE_BY              1
+#endif
+#define MODBUS_CRC16_INIT_VALUE          0xFFFF
+
+/*
+ * CRC-16 as an integer constant expression, for request frames built at
+ * compile time. One byte step is the table step of modbus_crc16_update()
+ * with the table entry spelled out as the XOR of its eight single-bit
+ * columns, so each step only names the previous CRC value.
+ */
+#define MODBUS_CRC16_CONST_COLUMN(x, bit, column)   ((((x) >> (bit)) & 1) * (column))
+#define MODBUS_CRC16_CONST_TABLE(x) \
+    (MODBUS_CRC16_CONST_COLUMN(x, 0, 0xC0C1) ^ MODBUS_CRC16_CONST_COLUMN(x, 1, 0xC181) ^ \
+     MODBUS_CRC16_CONST_COLUMN(x, 2, 0xC301) ^ MODBUS_CRC16_CONST_COLUMN(x, 3, 0xC601) ^ \
+     MODBUS_CRC16_CONST_COLUMN(x, 4, 0xCC01) ^ MODBUS_CRC16_CONST_COLUMN(x, 5, 0xD801) ^ \
+     MODBUS_CRC16_CONST_COLUMN(x, 6, 0xF001) ^ MODBUS_CRC16_CONST_COLUMN(x, 7, 0xA001))
+#define MODBUS_CRC16_CONST_STEP(crc, byte) \
+    (((crc) >> 8) ^ MODBUS_CRC16_CONST_TABLE(((crc) ^ (byte)) & 0xFF))
 
 /* S8 Sensor specific constants */
 #define S8_MODBUS_ADDRESS               0xFE    /* Broadcast address */
@@ -45,20 +139,291 @@ typedef struct {
     rt_uint16_t crc;
 } modbus_response_t;
 
+/* Incremental response parser */
+typedef enum {
+    MODBUS_PARSE_NEED_MORE = 0,      /* Frame not complete yet */
+    MODBUS_PARSE_COMPLETE,           /* A CRC-valid frame is in buf[0..length) */
+    MODBUS_PARSE_OVERFLOW            /* Buffer full without a valid frame */
+} modbus_parse_state_t;
+
+typedef struct {
+    rt_uint8_t buf[MODBUS_MAX_BUFFER_SIZE];
+    rt_uint16_t len;                 /* Bytes buffered */
+    rt_uint16_t length;              /* Length of the completed frame */
+    rt_uint8_t match_addr;           /* Expected slave address, 0 = any */
+    rt_uint8_t match_func;           /* Expected function code, 0 = any */
+    rt_uint16_t match_bytes;         /* Expected byte count for read replies, 0 = any */
+    modbus_parse_state_t state;
+
+    /* Statistics */
+    rt_uint32_t frames;              /* Valid frames extracted */
+    rt_uint32_t crc_errors;          /* Candidate frames rejected by CRC */
+    rt_uint32_t dropped_bytes;       /* Bytes discarded while resynchronising */
+} modbus_parser_t;
+
+/* Request frame with its CRC, ready to be written to the line */
+typedef struct {
+    rt_uint8_t bytes[8];                 /* Address, function, start, count, CRC low, CRC high */
+} modbus_frame_t;
+
+/*
+ * Read request frames with the CRC computed by the compiler.
+ * MODBUS_FRAME_CRC() chains the CRC through enum constants name##_crc0..5
+ * so the expression stays linear in size; MODBUS_FRAME_BYTES() is the
+ * matching initializer. MODBUS_FRAME_DEFINE() does both for one frame in
+ * flash. Usable at file or function scope, from C or C++.
+ */
+#define MODBUS_FRAME_CRC(name, slave, func, addr, count) \
+    enum { \
+        name##_crc0 = MODBUS_CRC16_CONST_STEP(MODBUS_CRC16_INIT_VALUE, (slave)), \
+        name##_crc1 = MODBUS_CRC16_CONST_STEP(name##_crc0, (func)), \
+        name##_crc2 = MODBUS_CRC16_CONST_STEP(name##_crc1, ((addr) >> 8) & 0xFF), \
+        name##_crc3 = MODBUS_CRC16_CONST_STEP(name##_crc2, (addr) & 0xFF), \
+        name##_crc4 = MODBUS_CRC16_CONST_STEP(name##_crc3, ((count) >> 8) & 0xFF), \
+        name##_crc5 = MODBUS_CRC16_CONST_STEP(name##_crc4, (count) & 0xFF) \
+    }
+#define MODBUS_FRAME_BYTES(name, slave, func, addr, count) \
+    { { (slave), (func), ((addr) >> 8) & 0xFF, (addr) & 0xFF, \
+        ((count) >> 8) & 0xFF, (count) & 0xFF, name##_crc5 & 0xFF, (name##_crc5 >> 8) & 0xFF } }
+#define MODBUS_FRAME_DEFINE(name, slave, func, addr, count) \
+    MODBUS_FRAME_CRC(name, slave, func, addr, count); \
+    static const modbus_frame_t name = MODBUS_FRAME_BYTES(name, slave, func, addr, count)
+
+/* One bus in the board's bus table */
+typedef struct {
+    const char *uart_name;
+    rt_uint32_t baud_rate;               /* 8N1 at this rate, 0 keeps the port's settings */
+    rt_uint32_t timeout_ms;              /* 0 uses MODBUS_RESPONSE_TIMEOUT_MS */
+    rt_base_t de_pin;                    /* RS-485 driver enable wired to this UART, or MODBUS_DE_NONE */
+    rt_uint8_t de_tx_level;              /* de_pin level while a request is on the wire */
+} modbus_bus_config_t;
+
+/*
+ * Retry policy: which failures are re-sent, how often, and after what gap.
+ * A corrupted reply is re-sent soonest since the slave did answer; no reply
+ * costs a full timeout per attempt, so it gets fewer tries; a busy slave
+ * is given time to finish first. Other exceptions and malformed replies
+ * are final.
+ */
+typedef struct {
+    rt_uint8_t max_retries;              /* Re-sends per request, all causes together */
+    rt_uint8_t timeout_retries;          /* Of which after no reply */
+    rt_uint8_t crc_retries;              /* Of which after a corrupted reply */
+    rt_uint8_t busy_retries;             /* Of which after a busy or acknowledge exception */
+    rt_uint16_t gap_chars;               /* Fast retry gap, in character times */
+    rt_uint16_t busy_ms;                 /* Retry gap for a busy slave */
+} modbus_retry_t;
+
+/*
+ * Queue priority of a transaction. The bus thread takes the highest class
+ * first, oldest first within a class. A queued transaction rises one class
+ * per MODBUS_PRIO_AGING_MS of waiting, so background polls still get the
+ * bus under sustained interactive load.
+ */
+typedef enum {
+    MODBUS_PRIO_AUTO = 0,                /* Interactive from the shell thread, background otherwise */
+    MODBUS_PRIO_BACKGROUND,              /* Periodic polling and logging */
+    MODBUS_PRIO_INTERACTIVE,             /* Shell commands */
+    MODBUS_PRIO_URGENT,                  /* Calibration and alarm configuration */
+    MODBUS_PRIO_COUNT
+} modbus_priority_t;
+
+/* Queued transaction */
+typedef struct modbus_txn modbus_txn_t;
+typedef void (*modbus_txn_callback_t)(modbus_txn_t *txn);
+
+struct modbus_txn {
+    rt_list_t node;                      /* Bus queue link */
+    rt_uint8_t slave_addr;
+    rt_uint8_t function_code;
+    rt_uint16_t start_addr;
+    rt_uint16_t reg_count;               /* Registers to read or write (FC16), value for FC06 */
+    rt_uint16_t *values;                 /* Read results, reg_count entries */
+    const rt_uint16_t *write_values;     /* FC16: reg_count entries, FC23: write_count entries */
+    rt_uint16_t write_addr;              /* FC23 only, written before the read */
+    rt_uint16_t write_count;
+    const modbus_frame_t *frame;         /* Prebuilt request matching the fields above, or RT_NULL */
+    rt_err_t result;                     /* -RT_EBUSY until completed, see modbus_transact() */
+    const modbus_retry_t *retry;         /* Optional, RT_NULL uses the bus policy */
+    rt_uint8_t priority;                 /* modbus_priority_t, AUTO is resolved on submission */
+    rt_uint8_t retries;                  /* Re-sends it took */
+    rt_uint8_t exception;                /* Exception code of the last reply, 0 = none */
+    rt_bool_t cached;                    /* modbus_transact() answered it from the cache */
+    modbus_txn_callback_t callback;      /* Optional, runs in the bus thread */
+    void *user_data;
+    rt_sem_t done;                       /* Optional, released on completion */
+    rt_tick_t queued_tick;               /* Submitted */
+    rt_tick_t start_tick;                /* Picked up by the bus thread */
+    rt_tick_t tx_tick;                   /* Request handed to the UART */
+    rt_tick_t rx_tick;                   /* First reply byte arrived */
+    rt_tick_t done_tick;                 /* Completed */
+};
+
+/* Register range whose reads may be served from the cache */
+typedef struct {
+    rt_uint8_t function_code;
+    rt_uint16_t start_addr;
+    rt_uint16_t reg_count;
+    rt_tick_t ttl_tick;
+} modbus_cache_rule_t;
+
+/* One cached read, keyed by (slave, function, address, count) */
+typedef struct {
+    rt_bool_t valid;
+    rt_uint8_t slave_addr;
+    rt_uint8_t function_code;
+    rt_uint16_t start_addr;
+    rt_uint16_t reg_count;
+    rt_tick_t stored_tick;
+    rt_tick_t ttl_tick;
+    rt_uint16_t values[MODBUS_CACHE_MAX_REGS];
+} modbus_cache_entry_t;
+
+/* Read-response cache, empty and inactive until a TTL rule is set */
+typedef struct {
+    modbus_cache_rule_t rules[MODBUS_CACHE_RULES];
+    rt_uint8_t rule_count;
+    rt_uint8_t any_addr;                 /* Address every slave answers, 0 for none */
+    modbus_cache_entry_t entries[MODBUS_CACHE_ENTRIES];
+    rt_uint32_t hits;                    /* Reads answered without the bus */
+    rt_uint32_t misses;                  /* Cacheable reads that went to the bus */
+    rt_uint32_t invalidations;           /* Entries dropped by writes */
+} modbus_cache_t;
+
+/* Transaction phases, each with its own latency histogram */
+typedef enum {
+    MODBUS_PHASE_WAIT = 0,               /* Queued -> picked up */
+    MODBUS_PHASE_TX,                     /* Picked up -> request written */
+    MODBUS_PHASE_TURNAROUND,             /* Request written -> first reply byte */
+    MODBUS_PHASE_RX,                     /* First reply byte -> frame complete */
+    MODBUS_PHASE_TOTAL,                  /* Queued -> complete */
+    MODBUS_PHASE_COUNT
+} modbus_phase_t;
+
+/* Log-scale latency histogram, bucket i > 0 counts [2^(i-1), 2^i) ms */
+typedef struct {
+    rt_uint32_t buckets[MODBUS_HIST_BUCKETS];
+    rt_uint32_t max_ms;
+} modbus_hist_t;
+
+/* Counters and latencies of one (slave, function) pair */
+typedef struct {
+    rt_uint8_t slave_addr;
+    rt_uint8_t function_code;            /* 0 = unused, or the overflow slot */
+    rt_uint32_t transactions;            /* Executed on the wire */
+    rt_uint32_t timeouts;
+    rt_uint32_t crc_errors;              /* Candidate frames rejected while waiting */
+    rt_uint32_t invalid;                 /* Frames that failed response validation */
+    rt_uint32_t exceptions;              /* Exception replies */
+    rt_uint32_t retries;                 /* Re-sends under the retry policy */
+    rt_uint32_t errors;                  /* Any other failure */
+    modbus_hist_t hist[MODBUS_PHASE_COUNT];
+} modbus_stats_slot_t;
+
+/* Bus instrumentation, always on; written by the bus thread only */
+typedef struct {
+    rt_tick_t since;                     /* Last reset */
+    rt_tick_t busy_tick;                 /* Bus thread occupied by transactions */
+    rt_uint64_t wire_bits;               /* Request and reply frames on the line */
+    modbus_stats_slot_t slots[MODBUS_STATS_SLOTS];  /* Last one collects any overflow */
+    modbus_hist_t class_wait[MODBUS_PRIO_COUNT];    /* Queued -> picked up, per priority */
+
+    /* Filled in by modbus_stats_get() */
+    rt_tick_t elapsed_tick;
+    rt_uint16_t busy_permille;           /* Share of time the bus thread was busy */
+    rt_uint16_t wire_permille;           /* Share of time the line carried a frame */
+} modbus_stats_t;
+
+/* Learned response time of one slave, in ticks scaled by 8 */
+typedef struct {
+    rt_uint8_t slave_addr;
+    rt_uint8_t backoff;                  /* Timeout doublings since the last valid sample */
+    rt_uint32_t samples;                 /* 0 = nothing learned yet, slot unused if no address */
+    rt_uint32_t timeouts;
+    rt_uint32_t srtt8;                   /* Smoothed turnaround, request sent -> first reply byte */
+    rt_uint32_t rttvar8;                 /* Smoothed mean deviation of the turnaround */
+} modbus_adapt_slot_t;
+
+/*
+ * Response timeouts learned per slave. Each reply to a first attempt
+ * feeds a smoothed turnaround and its mean deviation (the TCP
+ * retransmission timer estimator); replies to re-sends are not sampled
+ * since they may answer the earlier attempt. The wait for a reply is the
+ * request and reply wire time plus turnaround plus four deviations,
+ * doubled for each consecutive miss and held within [min_tick, max_tick].
+ * A slave with no samples yet waits the bus timeout, also doubled per miss.
+ * A bus timeout above max_tick raises the ceiling to it: adaptation only
+ * shortens waits it has samples for.
+ */
+typedef struct {
+    rt_bool_t enabled;                   /* RT_FALSE = always the bus timeout */
+    rt_tick_t min_tick;
+    rt_tick_t max_tick;
+    modbus_adapt_slot_t slots[MODBUS_ADAPT_SLOTS];
+} modbus_adapt_t;
+
+/* Direction of the bytes handed to a bus tap */
+#define MODBUS_TAP_TX                    0
+#define MODBUS_TAP_RX                    1
+
+/*
+ * Sees every byte the master writes to or reads from its UART, including
+ * line noise flushed between exchanges. Called from the bus thread with
+ * the bus lock held, so it must not block or start transactions.
+ */
+typedef void (*modbus_tap_t)(void *context, rt_uint8_t direction, const rt_uint8_t *bytes, rt_size_t length);
+
 /* Modbus RTU device structure */
 typedef struct {
     struct rt_serial_device *serial;
-    rt_uint8_t rx_buffer[MODBUS_MAX_BUFFER_SIZE];
-    rt_uint16_t rx_index;
+    rt_uint16_t refcount;                /* Users sharing this bus */
+    modbus_parser_t parser;              /* Reassembles the current response */
+    rt_uint8_t tx_buf[MODBUS_MAX_BUFFER_SIZE];  /* Variable-length request, bus thread only */
     rt_uint32_t timeout_tick;
-    rt_mutex_t lock;
+    rt_tick_t wait_tick;                 /* Response timeout of the request in flight */
+    rt_mutex_t lock;                     /* Protects the transaction queue */
+    rt_sem_t rx_sem;                     /* Released by the serial RX callback */
+    rt_uint32_t baud_rate;               /* Line speed used for frame timing */
+    rt_tick_t t35_tick;                  /* Inter-frame silence (3.5 characters) */
+    volatile rt_tick_t last_rx_tick;     /* Tick of the most recent RX indication */
+    volatile rt_tick_t first_rx_tick;    /* First RX indication since the last request */
+    volatile rt_bool_t rx_armed;         /* first_rx_tick still to be taken */
+    rt_base_t de_pin;                    /* RS-485 driver enable run by the UART, -1 = none */
+    volatile rt_bool_t tx_done;          /* Transmit-complete seen for the current request */
+    volatile rt_tick_t tx_done_tick;     /* Tick of that transmit-complete event */
+
+    /* Transaction engine */
+    rt_list_t queue;                     /* Pending modbus_txn_t, in submission order */
+    rt_uint16_t queue_len;
+    rt_sem_t queue_sem;                  /* Counts queued transactions */
+    rt_sem_t slot_sem;                   /* Counts free queue slots */
+    rt_sem_t background_sem;             /* Counts free slots open to background transactions */
+    rt_sem_t exit_sem;                   /* Released when the bus thread exits */
+    rt_thread_t bus_thread;
+    volatile rt_bool_t running;
+
+    modbus_retry_t retry;                /* Default policy, protected by lock */
+    modbus_cache_t cache;                /* Protected by lock */
+    modbus_stats_t stats;                /* Protected by lock */
+    modbus_adapt_t adapt;                /* Protected by lock */
+    modbus_tap_t tap;                    /* Protected by lock */
+    void *tap_context;
 } modbus_rtu_device_t;
 
 /* Function declarations */
 modbus_rtu_device_t* modbus_rtu_init(const char *uart_name);
+modbus_rtu_device_t* modbus_rtu_init_config(const modbus_bus_config_t *bus);
 rt_err_t modbus_rtu_deinit(modbus_rtu_device_t *device);
 
+rt_err_t modbus_configure_uart(struct rt_serial_device *serial, rt_uint32_t baud_rate);
+rt_err_t modbus_set_driver_enable(modbus_rtu_device_t *device, rt_base_t pin, rt_uint8_t tx_level);
+rt_tick_t modbus_t35_tick(rt_uint32_t baud_rate);
+
 rt_uint16_t modbus_crc16(rt_uint8_t *data, rt_uint16_t length);
+rt_uint16_t modbus_crc16_init(void);
+rt_uint16_t modbus_crc16_update(rt_uint16_t crc, const rt_uint8_t *data, rt_size_t length);
+rt_uint16_t modbus_crc16_final(rt_uint16_t crc);
+
 rt_err_t modbus_read_holding_registers(modbus_rtu_device_t *device,
                                        rt_uint8_t slave_addr,
                                        rt_uint16_t start_addr,
@@ -71,14 +436,74 @@ rt_err_t modbus_read_input_registers(modbus_rtu_device_t *device,
                                    rt_uint16_t reg_count,
                                    rt_uint16_t *values);
 
+rt_err_t modbus_read_frame(modbus_rtu_device_t *device, const modbus_frame_t *frame,
+                           rt_uint16_t *values);
+void modbus_txn_from_frame(modbus_txn_t *txn, const modbus_frame_t *frame, rt_uint16_t *values);
+void modbus_frame_build(modbus_frame_t *frame, rt_uint8_t slave_addr, rt_uint8_t function_code,
+                        rt_uint16_t start_addr, rt_uint16_t reg_count);
+rt_size_t modbus_frame_build_write(rt_uint8_t *buf, rt_uint8_t slave_addr, rt_uint16_t start_addr,
+                                   rt_uint16_t reg_count, const rt_uint16_t *values);
+rt_size_t modbus_frame_build_read_write(rt_uint8_t *buf, rt_uint8_t slave_addr,
+                                        rt_uint16_t read_addr, rt_uint16_t read_count,
+                                        rt_uint16_t write_addr, rt_uint16_t write_count,
+                                        const rt_uint16_t *values);
+
 rt_err_t modbus_write_single_register(modbus_rtu_device_t *device,
                                     rt_uint8_t slave_addr,
                                     rt_uint16_t reg_addr,
                                     rt_uint16_t value);
 
+rt_err_t modbus_write_multiple_registers(modbus_rtu_device_t *device,
+                                         rt_uint8_t slave_addr,
+                                         rt_uint16_t start_addr,
+                                         rt_uint16_t reg_count,
+                                         const rt_uint16_t *values);
+
+rt_err_t modbus_read_write_registers(modbus_rtu_device_t *device,
+                                     rt_uint8_t slave_addr,
+                                     rt_uint16_t read_addr,
+                                     rt_uint16_t read_count,
+                                     rt_uint16_t *read_values,
+                                     rt_uint16_t write_addr,
+                                     rt_uint16_t write_count,
+                                     const rt_uint16_t *write_values);
+
+void modbus_parser_reset(modbus_parser_t *parser, rt_uint8_t addr,
+                         rt_uint8_t func, rt_uint16_t byte_count);
+rt_size_t modbus_parser_feed(modbus_parser_t *parser, const rt_uint8_t *data, rt_size_t length);
+
+rt_err_t modbus_submit(modbus_rtu_device_t *device, modbus_txn_t *txn);
+void modbus_set_retry(modbus_rtu_device_t *device, const modbus_retry_t *policy);
+rt_err_t modbus_transact(modbus_rtu_device_t *device, modbus_txn_t *txn);
+
+rt_err_t modbus_cache_set_ttl(modbus_rtu_device_t *device, rt_uint8_t function_code,
+                              rt_uint16_t start_addr, rt_uint16_t reg_count, rt_uint32_t ttl_ms);
+void modbus_cache_expire(modbus_rtu_device_t *device, rt_uint8_t slave_addr,
+                         rt_uint8_t function_code, rt_uint16_t start_addr, rt_uint16_t reg_count);
+void modbus_cache_clear(modbus_rtu_device_t *device);
+void modbus_cache_set_any_address(modbus_rtu_device_t *device, rt_uint8_t slave_addr);
+
+void modbus_stats_get(modbus_rtu_device_t *device, modbus_stats_t *stats);
+void modbus_stats_reset(modbus_rtu_device_t *device);
+void modbus_hist_add(modbus_hist_t *hist, rt_tick_t ticks);
+rt_uint32_t modbus_hist_count(const modbus_hist_t *hist);
+rt_uint32_t modbus_hist_percentile(const modbus_hist_t *hist, rt_uint8_t percent);
+void modbus_hist_merge(modbus_hist_t *into, const modbus_hist_t *hist);
+
+void modbus_adapt_config(modbus_rtu_device_t *device, rt_bool_t enabled,
+                         rt_uint32_t min_ms, rt_uint32_t max_ms);
+rt_err_t modbus_adapt_get(modbus_rtu_device_t *device, rt_uint8_t slave_addr,
+                          modbus_adapt_slot_t *slot, rt_tick_t *wait_tick);
+void modbus_adapt_reset(modbus_rtu_device_t *device);
+void modbus_set_tap(modbus_rtu_device_t *device, modbus_tap_t tap, void *context);
+
 rt_err_t modbus_send_request(modbus_rtu_device_t *device,
                             modbus_request_t *request);
 rt_err_t modbus_receive_response(modbus_rtu_device_t *device,
                                  modbus_response_t *response);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* MODBUS_RTU_H__ */
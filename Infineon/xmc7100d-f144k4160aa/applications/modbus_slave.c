@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Modbus RTU slave endpoint serving a register snapshot
+ */
+
+#include "modbus_slave.h"
+
+/* Endpoints with an active RX callback, looked up from the serial ISR */
+static modbus_slave_t *modbus_slave_table[MODBUS_SLAVE_MAX];
+
+/**
+ * Serial RX indication, called from the UART ISR for every received chunk
+ */
+static rt_err_t modbus_slave_rx_indicate(rt_device_t dev, rt_size_t size)
+{
+    rt_uint8_t i;
+
+    RT_UNUSED(size);
+
+    for (i = 0; i < MODBUS_SLAVE_MAX; i++) {
+        modbus_slave_t *slave = modbus_slave_table[i];
+        if (slave && (rt_device_t)slave->serial == dev) {
+            rt_sem_release(slave->rx_sem);
+            break;
+        }
+    }
+
+    return RT_EOK;
+}
+
+/**
+ * Turn the reply being built into an exception reply, returns its length
+ */
+static rt_size_t modbus_slave_exception(modbus_slave_t *slave, rt_uint8_t code)
+{
+    slave->tx_buf[1] |= 0x80;
+    slave->tx_buf[2] = code;
+    slave->exceptions++;
+    return 3;
+}
+
+/**
+ * Answer the frame in rx_buf, if it is a valid request for this address
+ */
+static void modbus_slave_handle(modbus_slave_t *slave)
+{
+    const rt_uint8_t *req = slave->rx_buf;
+    rt_uint8_t *out = slave->tx_buf;
+    rt_uint16_t len = slave->rx_len;
+    rt_uint16_t start, count, crc, i;
+    rt_size_t n;
+
+    if (len < 4 || modbus_crc16(slave->rx_buf, len - 2) != ((req[len - 2] << 8) | req[len - 1])) {
+        slave->crc_errors++;
+        return;
+    }
+
+    /* Other slaves on the segment, and broadcasts: nothing to write, nothing to answer */
+    if (req[0] != slave->slave_addr) {
+        if (req[0] != MODBUS_BROADCAST_ADDRESS) {
+            slave->other_slaves++;
+        }
+        return;
+    }
+    slave->requests++;
+
+    out[0] = req[0];
+    out[1] = req[1];
+    switch (req[1]) {
+    case MODBUS_FUNC_READ_HOLDING_REGS:
+    case MODBUS_FUNC_READ_INPUT_REGS:
+        start = (req[2] << 8) | req[3];
+        count = (req[4] << 8) | req[5];
+        if (len != 8 || count == 0 || count > MODBUS_MAX_READ_REGS) {
+            n = modbus_slave_exception(slave, MODBUS_EX_ILLEGAL_VALUE);
+            break;
+        }
+        if (start >= MODBUS_SLAVE_REGS || count > MODBUS_SLAVE_REGS - start) {
+            n = modbus_slave_exception(slave, MODBUS_EX_ILLEGAL_ADDRESS);
+            break;
+        }
+
+        /* One publish is either entirely before or entirely after this copy */
+        out[2] = (rt_uint8_t)(count * 2);
+        rt_enter_critical();
+        for (i = 0; i < count; i++) {
+            out[3 + i * 2] = slave->regs[start + i] >> 8;
+            out[4 + i * 2] = slave->regs[start + i] & 0xFF;
+        }
+        rt_exit_critical();
+        n = 3 + count * 2;
+        break;
+
+    default:
+        n = modbus_slave_exception(slave, MODBUS_EX_ILLEGAL_FUNCTION);
+        break;
+    }
+
+    crc = modbus_crc16(out, (rt_uint16_t)n);
+    out[n++] = (crc >> 8) & 0xFF;       /* High byte first */
+    out[n++] = crc & 0xFF;
+
+    rt_device_write((rt_device_t)slave->serial, 0, out, n);
+}
+
+/**
+ * Slave thread: collect a frame until T3.5 of silence, then answer it
+ */
+static void modbus_slave_thread_entry(void *parameter)
+{
+    modbus_slave_t *slave = (modbus_slave_t *)parameter;
+    rt_ssize_t received;
+    rt_tick_t frame_tick = 0, response;
+
+    while (slave->running) {
+        if (slave->rx_len >= sizeof(slave->rx_buf)) {
+            /* Longer than any frame: line noise */
+            slave->crc_errors++;
+            slave->rx_len = 0;
+        }
+
+        received = rt_device_read((rt_device_t)slave->serial, 0, slave->rx_buf + slave->rx_len,
+                                  sizeof(slave->rx_buf) - slave->rx_len);
+        if (received > 0) {
+            slave->rx_len += received;
+            frame_tick = rt_tick_get();
+            continue;
+        }
+
+        if (slave->rx_len == 0) {
+            rt_sem_take(slave->rx_sem, RT_WAITING_FOREVER);
+            continue;
+        }
+
+        if (rt_sem_take(slave->rx_sem, slave->t35_tick) != RT_EOK) {
+            modbus_slave_handle(slave);
+            slave->rx_len = 0;
+
+            response = rt_tick_get() - frame_tick;
+            if (response > slave->max_response_tick) {
+                slave->max_response_tick = response;
+            }
+        }
+    }
+
+    rt_sem_release(slave->exit_sem);
+}
+
+/**
+ * Release whatever modbus_slave_start() managed to create
+ */
+static void modbus_slave_free(modbus_slave_t *slave)
+{
+    if (slave->serial) {
+        rt_device_close((rt_device_t)slave->serial);
+    }
+    if (slave->exit_sem) {
+        rt_sem_delete(slave->exit_sem);
+    }
+    if (slave->rx_sem) {
+        rt_sem_delete(slave->rx_sem);
+    }
+
+    rt_free(slave);
+}
+
+/**
+ * Start a slave endpoint on a UART that has no Modbus master
+ * The register image starts out all zero.
+ */
+modbus_slave_t *modbus_slave_start(const modbus_bus_config_t *bus, rt_uint8_t slave_addr)
+{
+    modbus_slave_t *slave;
+    struct rt_serial_device *serial;
+    char thread_name[RT_NAME_MAX];
+    rt_base_t level;
+    rt_uint8_t slot;
+
+    if (!bus || !bus->uart_name || slave_addr < 1 || slave_addr > 247) {
+        rt_kprintf("[MB_SLAVE] Error: Invalid UART or slave address\n");
+        return RT_NULL;
+    }
+
+    serial = (struct rt_serial_device *)rt_device_find(bus->uart_name);
+    if (!serial) {
+        rt_kprintf("[MB_SLAVE] Error: Cannot find UART device '%s'\n", bus->uart_name);
+        return RT_NULL;
+    }
+    if (serial->parent.rx_indicate) {
+        rt_kprintf("[MB_SLAVE] Error: %s is already in use\n", bus->uart_name);
+        return RT_NULL;
+    }
+
+    slave = (modbus_slave_t *)rt_malloc(sizeof(modbus_slave_t));
+    if (!slave) {
+        rt_kprintf("[MB_SLAVE] Error: Failed to allocate memory\n");
+        return RT_NULL;
+    }
+    rt_memset(slave, 0, sizeof(modbus_slave_t));
+    slave->slave_addr = slave_addr;
+
+    if (bus->baud_rate != 0 && modbus_configure_uart(serial, bus->baud_rate) != RT_EOK) {
+        rt_kprintf("[MB_SLAVE] Warning: %s configuration failed, using defaults\n", bus->uart_name);
+    }
+
+    slave->rx_sem = rt_sem_create("mbs_rx", 0, RT_IPC_FLAG_FIFO);
+    slave->exit_sem = rt_sem_create("mbs_exit", 0, RT_IPC_FLAG_FIFO);
+    if (!slave->rx_sem || !slave->exit_sem) {
+        rt_kprintf("[MB_SLAVE] Error: Failed to create IPC objects\n");
+        modbus_slave_free(slave);
+        return RT_NULL;
+    }
+
+    if (rt_device_open((rt_device_t)serial, RT_DEVICE_OFLAG_RDWR | RT_DEVICE_FLAG_INT_RX) != RT_EOK) {
+        rt_kprintf("[MB_SLAVE] Error: Failed to open %s\n", bus->uart_name);
+        modbus_slave_free(slave);
+        return RT_NULL;
+    }
+    slave->serial = serial;
+    slave->t35_tick = modbus_t35_tick(serial->config.baud_rate ? serial->config.baud_rate : 9600);
+
+    /* Claim a slot so the RX callback can find this endpoint */
+    level = rt_hw_interrupt_disable();
+    for (slot = 0; slot < MODBUS_SLAVE_MAX; slot++) {
+        if (modbus_slave_table[slot] == RT_NULL) {
+            modbus_slave_table[slot] = slave;
+            break;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+    if (slot >= MODBUS_SLAVE_MAX) {
+        rt_kprintf("[MB_SLAVE] Error: All %d endpoint slots in use\n", MODBUS_SLAVE_MAX);
+        modbus_slave_free(slave);
+        return RT_NULL;
+    }
+    rt_device_set_rx_indicate((rt_device_t)serial, modbus_slave_rx_indicate);
+
+    rt_snprintf(thread_name, sizeof(thread_name), "mbs_%s", bus->uart_name);
+    slave->running = RT_TRUE;
+    slave->thread = rt_thread_create(thread_name, modbus_slave_thread_entry, slave,
+                                     1024, MODBUS_SLAVE_THREAD_PRIORITY, 10);
+    if (!slave->thread) {
+        rt_kprintf("[MB_SLAVE] Error: Failed to create thread\n");
+        slave->running = RT_FALSE;
+        rt_device_set_rx_indicate((rt_device_t)serial, RT_NULL);
+        modbus_slave_table[slot] = RT_NULL;
+        modbus_slave_free(slave);
+        return RT_NULL;
+    }
+    rt_thread_startup(slave->thread);
+
+    return slave;
+}
+
+/**
+ * Stop a slave endpoint and give its UART back
+ */
+void modbus_slave_stop(modbus_slave_t *slave)
+{
+    rt_base_t level;
+    rt_uint8_t i;
+
+    if (!slave) {
+        return;
+    }
+
+    slave->running = RT_FALSE;
+    rt_sem_release(slave->rx_sem);
+    rt_sem_take(slave->exit_sem, RT_WAITING_FOREVER);
+
+    rt_device_set_rx_indicate((rt_device_t)slave->serial, RT_NULL);
+
+    level = rt_hw_interrupt_disable();
+    for (i = 0; i < MODBUS_SLAVE_MAX; i++) {
+        if (modbus_slave_table[i] == slave) {
+            modbus_slave_table[i] = RT_NULL;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+
+    modbus_slave_free(slave);
+}
+
+/**
+ * Replace a block of the register image
+ * Polls see either all of it or none of it.
+ */
+rt_err_t modbus_slave_publish(modbus_slave_t *slave, rt_uint16_t start_addr,
+                              rt_uint16_t reg_count, const rt_uint16_t *values)
+{
+    if (!slave || !values || start_addr >= MODBUS_SLAVE_REGS ||
+        reg_count > MODBUS_SLAVE_REGS - start_addr) {
+        return -RT_ERROR;
+    }
+
+    rt_enter_critical();
+    rt_memcpy(&slave->regs[start_addr], values, reg_count * sizeof(rt_uint16_t));
+    slave->publishes++;
+    rt_exit_critical();
+
+    return RT_EOK;
+}
+
+/**
+ * Print endpoint statistics and the current register image
+ */
+void modbus_slave_dump(modbus_slave_t *slave)
+{
+    rt_uint16_t regs[MODBUS_SLAVE_REGS];
+    rt_uint8_t i;
+
+    if (!slave) {
+        return;
+    }
+
+    rt_enter_critical();
+    rt_memcpy(regs, slave->regs, sizeof(regs));
+    rt_exit_critical();
+
+    rt_kprintf("Slave 0x%02X on %s, T3.5 %d ms\n", slave->slave_addr,
+               slave->serial->parent.parent.name, slave->t35_tick * 1000 / RT_TICK_PER_SECOND);
+    rt_kprintf("  Requests %d, exceptions %d, CRC errors %d, other slaves %d, publishes %d\n",
+               slave->requests, slave->exceptions, slave->crc_errors,
+               slave->other_slaves, slave->publishes);
+    rt_kprintf("  Worst response %d ms after the request\n",
+               slave->max_response_tick * 1000 / RT_TICK_PER_SECOND);
+    for (i = 0; i < MODBUS_SLAVE_REGS; i++) {
+        if (i % 8 == 0) {
+            rt_kprintf("  %02d:", i);
+        }
+        rt_kprintf(" %5d", regs[i]);
+        if (i % 8 == 7) {
+            rt_kprintf("\n");
+        }
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Modbus RTU slave endpoint serving a register snapshot
+ * 2026-10-16     Developer    C linkage when included from C++
+ */
+
+#ifndef MODBUS_SLAVE_H__
+#define MODBUS_SLAVE_H__
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "modbus_rtu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MODBUS_SLAVE_REGS               32      /* Registers served, from address 0 */
+#define MODBUS_SLAVE_MAX                2       /* Serial ports with a slave endpoint */
+#define MODBUS_SLAVE_THREAD_PRIORITY    11      /* Above the bus masters and the TF logger */
+
+/*
+ * Modbus RTU slave on its own UART, answering FC03 and FC04 alike from a
+ * register image. Producers publish into the image; a poll copies the
+ * requested range in one short critical section, so it always sees one
+ * complete update and never waits on a sensor bus or the file system.
+ * Frames end at T3.5 of line silence, which also keeps the reply clear of
+ * the request as the RTU timing rules require.
+ */
+typedef struct {
+    struct rt_serial_device *serial;
+    rt_uint8_t slave_addr;
+    rt_tick_t t35_tick;
+    rt_sem_t rx_sem;                     /* Released by the RX indication */
+    rt_sem_t exit_sem;
+    rt_thread_t thread;
+    volatile rt_bool_t running;
+
+    rt_uint16_t regs[MODBUS_SLAVE_REGS]; /* Changed only inside modbus_slave_publish() */
+
+    /* Request being received, reply being sent; slave thread only */
+    rt_uint8_t rx_buf[MODBUS_MAX_BUFFER_SIZE];
+    rt_uint16_t rx_len;
+    rt_uint8_t tx_buf[MODBUS_MAX_BUFFER_SIZE];
+
+    /* Statistics */
+    rt_uint32_t requests;                /* Valid frames for this address */
+    rt_uint32_t exceptions;              /* Answered with an exception */
+    rt_uint32_t crc_errors;              /* Frames dropped for a bad CRC */
+    rt_uint32_t other_slaves;            /* Valid frames for someone else */
+    rt_uint32_t publishes;
+    rt_tick_t max_response_tick;         /* Worst end of request -> reply written */
+} modbus_slave_t;
+
+modbus_slave_t *modbus_slave_start(const modbus_bus_config_t *bus, rt_uint8_t slave_addr);
+void modbus_slave_stop(modbus_slave_t *slave);
+rt_err_t modbus_slave_publish(modbus_slave_t *slave, rt_uint16_t start_addr,
+                              rt_uint16_t reg_count, const rt_uint16_t *values);
+void modbus_slave_dump(modbus_slave_t *slave);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MODBUS_SLAVE_H__ */
@@ -0,0 +1,578 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Acquisition service per sensor with sample fan-out, its reads driven by the bus scheduler
+ * 2026-10-16     Developer    Latest reading read through the sensor snapshot
+ * 2026-10-16     Developer    Read requested without waiting, for the calibrator
+ */
+
+#include "s8_acquire.h"
+#include "s8_poller.h"
+
+/**
+ * Sampling period for the current subscribers, call with acquire->lock held
+ */
+static void s8_acquire_replan(s8_acquire_t *acquire)
+{
+    rt_tick_t period = 0;
+    rt_bool_t tracking;
+    rt_uint8_t i;
+
+    for (i = 0; i < S8_ACQUIRE_MAX_SUBSCRIBERS; i++) {
+        if (acquire->subscribers[i].used && !acquire->subscribers[i].closing &&
+            !acquire->subscribers[i].oneshot &&
+            (period == 0 || acquire->subscribers[i].interval_tick < period)) {
+            period = acquire->subscribers[i].interval_tick;
+        }
+    }
+
+    tracking = period > 0 && period <= rt_tick_from_millisecond(S8_MEASUREMENT_PERIOD_MS);
+    if (tracking && !acquire->tracking) {
+        s8_cadence_init(&acquire->cadence, S8_MEASUREMENT_PERIOD_MS);
+    }
+    if ((period > 0 && acquire->period == 0) ||
+        (!tracking && period < acquire->period)) {
+        /* First subscriber, or a faster one: sample now */
+        acquire->next_due = rt_tick_get();
+    }
+
+    acquire->period = period;
+    acquire->tracking = tracking;
+}
+
+/**
+ * Pick the subscribers one sample is due to, call with acquire->lock held
+ * A subscriber is due half a sample spacing early, so its long-run rate
+ * matches its interval even when that is not a multiple of the spacing.
+ * A one-off reader gets the first sample from a read after its request.
+ */
+static rt_uint32_t s8_acquire_fan_out(s8_acquire_t *acquire, const s8_sample_t *sample, rt_tick_t now)
+{
+    rt_tick_t spacing = acquire->tracking ? acquire->cadence.period : acquire->period;
+    s8_subscriber_t *subscriber;
+    rt_uint32_t due = 0;
+    rt_uint8_t i;
+
+    for (i = 0; i < S8_ACQUIRE_MAX_SUBSCRIBERS; i++) {
+        subscriber = &acquire->subscribers[i];
+        if (!subscriber->used || subscriber->closing) {
+            continue;
+        }
+        if (subscriber->oneshot) {
+            if (!subscriber->started && (rt_int32_t)(sample->read - subscriber->after) > 0) {
+                subscriber->started = RT_TRUE;
+                due |= 1UL << i;
+            }
+            continue;
+        }
+        if (subscriber->started && (rt_int32_t)(now + spacing / 2 - subscriber->next_due) < 0) {
+            continue;
+        }
+
+        if (!subscriber->started ||
+            (rt_int32_t)(now - subscriber->next_due) >= (rt_int32_t)subscriber->interval_tick) {
+            /* First sample, or a whole interval behind: resync */
+            subscriber->next_due = now + subscriber->interval_tick;
+            subscriber->started = RT_TRUE;
+        } else {
+            subscriber->next_due += subscriber->interval_tick;
+        }
+        due |= 1UL << i;
+    }
+
+    return due;
+}
+
+/**
+ * Hand a sample to the subscribers picked for it
+ * Call with acquire->deliver held and acquire->lock released: a callback may
+ * subscribe or unsubscribe, and ending a subscription waits for this.
+ */
+static void s8_acquire_hand_out(s8_acquire_t *acquire, const s8_sample_t *sample, rt_uint32_t due)
+{
+    s8_subscriber_t *subscriber;
+    rt_uint8_t i;
+
+    for (i = 0; i < S8_ACQUIRE_MAX_SUBSCRIBERS; i++) {
+        subscriber = &acquire->subscribers[i];
+        if (!(due & (1UL << i)) || !subscriber->used || subscriber->closing) {
+            continue;
+        }
+
+        if (subscriber->callback) {
+            subscriber->callback(subscriber->context, sample);
+        } else if (rt_mq_send(subscriber->queue, sample, sizeof(s8_sample_t)) != RT_EOK) {
+            subscriber->overflows++;
+            continue;
+        }
+        subscriber->delivered++;
+    }
+}
+
+/**
+ * Wake the bus scheduler: the service's demand changed
+ */
+static void s8_acquire_wake(s8_acquire_t *acquire)
+{
+    s8_poller_wake(acquire->sensor->poller);
+}
+
+/**
+ * When the service next wants the bus, for its bus scheduler
+ * Returns RT_FALSE while nobody needs samples. urgent is set when a one-off
+ * reader waits, due is then now.
+ */
+rt_bool_t s8_acquire_due(s8_acquire_t *acquire, rt_tick_t *due, rt_bool_t *urgent)
+{
+    rt_bool_t wanted;
+
+    rt_mutex_take(acquire->lock, RT_WAITING_FOREVER);
+    wanted = acquire->period > 0 || acquire->urgent;
+    *urgent = acquire->urgent;
+    *due = acquire->urgent ? rt_tick_get() : acquire->next_due;
+    rt_mutex_release(acquire->lock);
+
+    return wanted;
+}
+
+/**
+ * Read the sensor once and fan the sample out
+ * Called by the bus scheduler only, when s8_acquire_due() says so: the
+ * service is the sensor's one reader and the scheduler its one caller.
+ */
+void s8_acquire_run(s8_acquire_t *acquire)
+{
+    s8_sensor_device_t *sensor = acquire->sensor;
+    rt_bool_t deliver, tracking, urgent;
+    rt_tick_t start, end;
+    rt_uint32_t fresh, due = 0;
+    s8_sample_t sample;
+    s8_status_t status;
+
+    rt_mutex_take(acquire->lock, RT_WAITING_FOREVER);
+    tracking = acquire->tracking;
+    urgent = acquire->urgent;
+    acquire->urgent = RT_FALSE;
+    sample.read = ++acquire->reads;
+    rt_mutex_release(acquire->lock);
+
+    /* Subscribers can come and go during the transaction */
+    start = rt_tick_get();
+    status = (tracking || urgent) ? s8_refresh_co2_data(sensor) : s8_read_co2_data(sensor);
+    end = rt_tick_get();
+    s8_sensor_snapshot(sensor, &sample.data);
+
+    rt_mutex_take(acquire->deliver, RT_WAITING_FOREVER);
+    rt_mutex_take(acquire->lock, RT_WAITING_FOREVER);
+    deliver = RT_TRUE;
+    if (status != S8_STATUS_OK) {
+        /* An offline sensor is held back by the scheduler */
+        acquire->failures++;
+        acquire->next_due = end + rt_tick_from_millisecond(S8_CADENCE_RETRY_MS);
+    } else if (acquire->tracking) {
+        fresh = acquire->cadence.fresh;
+        s8_cadence_observe(&acquire->cadence, start, end, sample.data.co2_ppm, sample.data.meter_status);
+        acquire->next_due = s8_cadence_next(&acquire->cadence, end);
+
+        /* A repeat is only news when the value held still for a whole period */
+        deliver = urgent || acquire->cadence.fresh != fresh || acquire->samples == 0 ||
+                  end - acquire->last_sample >= acquire->cadence.period;
+    } else if (urgent && (rt_int32_t)(acquire->next_due - end) > 0) {
+        /* An extra read: the schedule stands */
+    } else if ((rt_int32_t)(end - acquire->next_due) >= (rt_int32_t)acquire->period) {
+        acquire->next_due = end + acquire->period;
+    } else {
+        acquire->next_due += acquire->period;
+    }
+
+    if (deliver) {
+        sample.status = status;
+        sample.sequence = ++acquire->samples;
+        sample.start = start;
+        sample.end = end;
+        acquire->last_sample = end;
+        due = s8_acquire_fan_out(acquire, &sample, end);
+    }
+    rt_mutex_release(acquire->lock);
+
+    s8_acquire_hand_out(acquire, &sample, due);
+    rt_mutex_release(acquire->deliver);
+}
+
+/**
+ * Free a service
+ */
+static void s8_acquire_free(s8_acquire_t *acquire)
+{
+    rt_uint8_t i;
+
+    for (i = 0; i < S8_ACQUIRE_MAX_SUBSCRIBERS; i++) {
+        if (acquire->subscribers[i].queue) {
+            rt_mq_delete(acquire->subscribers[i].queue);
+        }
+    }
+    if (acquire->lock) {
+        rt_mutex_delete(acquire->lock);
+    }
+    if (acquire->deliver) {
+        rt_mutex_delete(acquire->deliver);
+    }
+    rt_free(acquire);
+}
+
+/**
+ * Set up the acquisition service of a sensor
+ * Called once, while the sensor is set up and before anyone can use it.
+ * It reads nothing until the sensor has joined its bus scheduler.
+ */
+s8_acquire_t *s8_acquire_create(s8_sensor_device_t *sensor)
+{
+    s8_acquire_t *acquire;
+
+    if (!sensor) {
+        return RT_NULL;
+    }
+
+    acquire = (s8_acquire_t *)rt_malloc(sizeof(s8_acquire_t));
+    if (!acquire) {
+        return RT_NULL;
+    }
+    rt_memset(acquire, 0, sizeof(s8_acquire_t));
+    acquire->sensor = sensor;
+    acquire->lock = rt_mutex_create("s8_acq", RT_IPC_FLAG_FIFO);
+    acquire->deliver = rt_mutex_create("s8_acqd", RT_IPC_FLAG_FIFO);
+    if (!acquire->lock || !acquire->deliver) {
+        s8_acquire_free(acquire);
+        return RT_NULL;
+    }
+
+    return acquire;
+}
+
+/**
+ * The acquisition service of a sensor
+ * Every consumer of the sensor should subscribe here rather than read it.
+ */
+s8_acquire_t *s8_acquire_get(s8_sensor_device_t *sensor)
+{
+    return sensor ? sensor->acquire : RT_NULL;
+}
+
+/**
+ * Drop a sensor's service and its subscriptions
+ * The sensor must have left its bus scheduler, and consumers blocked in
+ * s8_acquire_receive() must be stopped first.
+ */
+void s8_acquire_destroy(s8_acquire_t *acquire)
+{
+    if (!acquire) {
+        return;
+    }
+
+    if (acquire->sensor->acquire == acquire) {
+        acquire->sensor->acquire = RT_NULL;
+    }
+    s8_acquire_free(acquire);
+}
+
+/**
+ * Take a free slot for a subscriber
+ * A one-off reader is not part of the plan: it asks for a read at once, and
+ * only reads started from here on count for it.
+ */
+static s8_subscriber_t *s8_acquire_add(s8_acquire_t *acquire, rt_uint32_t interval_ms,
+                                       s8_sample_callback_t callback, void *context, rt_mq_t queue,
+                                       rt_bool_t oneshot)
+{
+    s8_subscriber_t *subscriber = RT_NULL;
+    rt_uint8_t i;
+
+    rt_mutex_take(acquire->lock, RT_WAITING_FOREVER);
+    for (i = 0; i < S8_ACQUIRE_MAX_SUBSCRIBERS; i++) {
+        if (!acquire->subscribers[i].used) {
+            subscriber = &acquire->subscribers[i];
+            break;
+        }
+    }
+    if (subscriber) {
+        rt_memset(subscriber, 0, sizeof(s8_subscriber_t));
+        subscriber->acquire = acquire;
+        subscriber->used = RT_TRUE;
+        subscriber->interval_tick = rt_tick_from_millisecond(interval_ms ? interval_ms : 1);
+        subscriber->callback = callback;
+        subscriber->context = context;
+        subscriber->queue = queue;
+        if (oneshot) {
+            subscriber->oneshot = RT_TRUE;
+            subscriber->after = acquire->reads;
+            acquire->urgent = RT_TRUE;
+        }
+        s8_acquire_replan(acquire);
+    }
+    rt_mutex_release(acquire->lock);
+
+    if (subscriber) {
+        s8_acquire_wake(acquire);
+    }
+    return subscriber;
+}
+
+/**
+ * Call back with a sample about every interval_ms
+ * The callback runs in the bus scheduler's thread, outside the service's lock.
+ */
+s8_subscriber_t *s8_acquire_subscribe(s8_acquire_t *acquire, rt_uint32_t interval_ms,
+                                      s8_sample_callback_t callback, void *context)
+{
+    if (!acquire || !callback) {
+        return RT_NULL;
+    }
+
+    return s8_acquire_add(acquire, interval_ms, callback, context, RT_NULL, RT_FALSE);
+}
+
+/**
+ * Subscribe with a queue of its own
+ */
+static s8_subscriber_t *s8_acquire_add_queue(s8_acquire_t *acquire, rt_uint32_t interval_ms, rt_bool_t oneshot)
+{
+    s8_subscriber_t *subscriber;
+    rt_mq_t queue;
+
+    queue = rt_mq_create("s8_acqq", sizeof(s8_sample_t), S8_ACQUIRE_QUEUE_DEPTH, RT_IPC_FLAG_FIFO);
+    if (!queue) {
+        return RT_NULL;
+    }
+
+    subscriber = s8_acquire_add(acquire, interval_ms, RT_NULL, RT_NULL, queue, oneshot);
+    if (!subscriber) {
+        rt_mq_delete(queue);
+    }
+    return subscriber;
+}
+
+/**
+ * Queue a sample about every interval_ms for s8_acquire_receive()
+ * A consumer S8_ACQUIRE_QUEUE_DEPTH samples behind loses the newest ones.
+ */
+s8_subscriber_t *s8_acquire_subscribe_queue(s8_acquire_t *acquire, rt_uint32_t interval_ms)
+{
+    if (!acquire) {
+        return RT_NULL;
+    }
+
+    return s8_acquire_add_queue(acquire, interval_ms, RT_FALSE);
+}
+
+/**
+ * Wake a receiver blocked on a closing queue
+ * Urgent, so it goes ahead of samples; a full queue wakes it anyway. Call
+ * with acquire->lock held, so the last receiver cannot free the queue meanwhile.
+ */
+static void s8_acquire_wake_receiver(rt_mq_t queue)
+{
+    s8_sample_t wake;
+
+    rt_memset(&wake, 0, sizeof(wake));
+    wake.status = S8_STATUS_NOT_INITIALIZED;
+    rt_mq_urgent(queue, &wake, sizeof(wake));
+}
+
+/**
+ * End a subscription
+ * May be called from any thread: a queue still being waited on is closed,
+ * its receivers are woken, and the last of them to leave frees it.
+ */
+rt_err_t s8_acquire_unsubscribe(s8_acquire_t *acquire, s8_subscriber_t *subscriber)
+{
+    rt_mq_t queue = RT_NULL;
+    rt_bool_t waited_on;
+
+    if (!acquire || !subscriber) {
+        return -RT_EINVAL;
+    }
+
+    /* No sample is on its way to it once deliver is ours */
+    rt_mutex_take(acquire->deliver, RT_WAITING_FOREVER);
+    rt_mutex_take(acquire->lock, RT_WAITING_FOREVER);
+    if (!subscriber->used || subscriber->closing) {
+        rt_mutex_release(acquire->lock);
+        rt_mutex_release(acquire->deliver);
+        return -RT_EINVAL;
+    }
+    waited_on = subscriber->receivers > 0;
+    if (waited_on) {
+        subscriber->closing = RT_TRUE;
+        s8_acquire_wake_receiver(subscriber->queue);
+    } else {
+        queue = subscriber->queue;
+        subscriber->queue = RT_NULL;
+        subscriber->used = RT_FALSE;
+    }
+    s8_acquire_replan(acquire);
+    rt_mutex_release(acquire->lock);
+    rt_mutex_release(acquire->deliver);
+
+    if (queue) {
+        rt_mq_delete(queue);
+    }
+    return RT_EOK;
+}
+
+/**
+ * Wait up to timeout ticks for the next sample of a queued subscription
+ * Returns -RT_ERROR once the subscription has been closed.
+ */
+rt_err_t s8_acquire_receive(s8_subscriber_t *subscriber, s8_sample_t *sample, rt_int32_t timeout)
+{
+    s8_acquire_t *acquire;
+    rt_bool_t closing, last;
+    rt_mq_t queue;
+    rt_err_t result = RT_EOK;
+
+    if (!subscriber || !sample || !subscriber->acquire) {
+        return -RT_EINVAL;
+    }
+    acquire = subscriber->acquire;
+
+    rt_mutex_take(acquire->lock, RT_WAITING_FOREVER);
+    queue = subscriber->queue;
+    if (!subscriber->used || subscriber->closing || !queue) {
+        rt_mutex_release(acquire->lock);
+        return -RT_EINVAL;
+    }
+    subscriber->receivers++;
+    rt_mutex_release(acquire->lock);
+
+    if (rt_mq_recv(queue, sample, sizeof(s8_sample_t), timeout) < 0) {
+        result = -RT_ETIMEOUT;
+    }
+
+    /* Closed meanwhile: the fan-out no longer touches the queue or the slot */
+    rt_mutex_take(acquire->deliver, RT_WAITING_FOREVER);
+    rt_mutex_take(acquire->lock, RT_WAITING_FOREVER);
+    subscriber->receivers--;
+    closing = subscriber->closing;
+    last = closing && subscriber->receivers == 0;
+    if (last) {
+        subscriber->queue = RT_NULL;
+        subscriber->closing = RT_FALSE;
+        subscriber->used = RT_FALSE;
+    } else if (closing) {
+        s8_acquire_wake_receiver(queue);
+    }
+    rt_mutex_release(acquire->lock);
+    rt_mutex_release(acquire->deliver);
+
+    if (last) {
+        rt_mq_delete(queue);
+    }
+    return closing ? -RT_ERROR : result;
+}
+
+/**
+ * Have the service read the sensor now and wait up to timeout ticks for it
+ * For a reader that needs just one sample, or one fresher than the cycle
+ * gives. The sample comes from a read started after the call, never from
+ * one already under way. Returns the sample's status, or S8_STATUS_TIMEOUT
+ * when none came.
+ */
+s8_status_t s8_acquire_sample(s8_acquire_t *acquire, s8_sample_t *sample, rt_int32_t timeout)
+{
+    s8_subscriber_t *subscriber;
+    rt_err_t result;
+
+    if (!acquire || !sample) {
+        return S8_STATUS_NOT_INITIALIZED;
+    }
+
+    subscriber = s8_acquire_add_queue(acquire, S8_MEASUREMENT_PERIOD_MS, RT_TRUE);
+    if (!subscriber) {
+        return S8_STATUS_ERROR;
+    }
+    result = s8_acquire_receive(subscriber, sample, timeout);
+    s8_acquire_unsubscribe(acquire, subscriber);
+
+    return result == RT_EOK ? sample->status : S8_STATUS_TIMEOUT;
+}
+
+/**
+ * Have the service read the sensor at once, without waiting for it
+ * The reading lands in the sensor's snapshot; for the calibrator, which
+ * runs in the bus scheduler's thread and so cannot wait on the read.
+ */
+void s8_acquire_request(s8_acquire_t *acquire)
+{
+    if (!acquire) {
+        return;
+    }
+
+    rt_mutex_take(acquire->lock, RT_WAITING_FOREVER);
+    acquire->urgent = RT_TRUE;
+    rt_mutex_release(acquire->lock);
+    s8_acquire_wake(acquire);
+}
+
+/**
+ * Print the sampling plan and every subscriber
+ */
+void s8_acquire_dump(s8_acquire_t *acquire)
+{
+    s8_subscriber_t *subscriber;
+    rt_uint8_t i;
+
+    if (!acquire) {
+        return;
+    }
+
+    rt_mutex_take(acquire->lock, RT_WAITING_FOREVER);
+    if (acquire->period == 0) {
+        rt_kprintf("Acquisition: idle\n");
+    } else if (acquire->tracking) {
+        rt_kprintf("Acquisition: following the sensor, period %d ms\n",
+                   acquire->cadence.period * 1000 / RT_TICK_PER_SECOND);
+    } else {
+        rt_kprintf("Acquisition: every %d ms\n", acquire->period * 1000 / RT_TICK_PER_SECOND);
+    }
+    rt_kprintf("  %d reads, %d samples, %d failed\n", acquire->reads, acquire->samples, acquire->failures);
+
+    rt_kprintf("Sub  Interval  Kind      Delivered  Lost\n");
+    for (i = 0; i < S8_ACQUIRE_MAX_SUBSCRIBERS; i++) {
+        subscriber = &acquire->subscribers[i];
+        if (!subscriber->used) {
+            continue;
+        }
+        rt_kprintf("%3d  %5d ms  %-8s  %9d  %4d\n", i,
+                   subscriber->interval_tick * 1000 / RT_TICK_PER_SECOND,
+                   subscriber->callback ? "callback" : "queue",
+                   subscriber->delivered, subscriber->overflows);
+    }
+    rt_mutex_release(acquire->lock);
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+/* Main S8 sensor from main.c */
+extern s8_sensor_device_t *g_main_s8_device;
+
+/**
+ * Show the main sensor's acquisition service
+ */
+static void s8_acq(int argc, char *argv[])
+{
+    RT_UNUSED(argc);
+    RT_UNUSED(argv);
+
+    if (!g_main_s8_device || !g_main_s8_device->acquire) {
+        rt_kprintf("[S8] No acquisition service running\n");
+        return;
+    }
+    s8_acquire_dump(g_main_s8_device->acquire);
+}
+MSH_CMD_EXPORT(s8_acq, Show the S8 acquisition service and its subscribers);
+#endif
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Acquisition service per sensor with sample fan-out, its reads driven by the bus scheduler
+ * 2026-10-16     Developer    C linkage when included from C++
+ * 2026-10-16     Developer    Read requested without waiting, for the calibrator
+ */
+
+#ifndef S8_ACQUIRE_H__
+#define S8_ACQUIRE_H__
+
+#include <rtthread.h>
+#include "s8_sensor.h"
+#include "s8_cadence.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define S8_ACQUIRE_MAX_SUBSCRIBERS  8
+#define S8_ACQUIRE_QUEUE_DEPTH      4       /* Samples a queued consumer may fall behind by */
+#define S8_ACQUIRE_SAMPLE_WAIT_MS   (2 * S8_MEASUREMENT_PERIOD_MS)  /* Longest a one-off sample takes */
+
+/* One acquisition as handed to subscribers */
+typedef struct {
+    s8_status_t status;             /* Outcome of the read */
+    s8_sensor_data_t data;          /* The sensor's data after the read; last good values on failure */
+    rt_uint32_t sequence;           /* Acquisition number, gaps show decimation */
+    rt_uint32_t read;               /* Bus read it came from, numbered as the reads start */
+    rt_tick_t start;                /* The read's transaction started... */
+    rt_tick_t end;                  /* ...and ended here */
+} s8_sample_t;
+
+/* Runs in the bus scheduler's thread, service unlocked: must not block on the bus or the card */
+typedef void (*s8_sample_callback_t)(void *context, const s8_sample_t *sample);
+
+struct s8_acquire;
+
+/* One consumer of the samples */
+typedef struct s8_subscriber {
+    struct s8_acquire *acquire;     /* Its service */
+    rt_bool_t used;
+    rt_bool_t oneshot;              /* One-off reader: only the first read after... */
+    rt_uint32_t after;              /* ...this one, see s8_acquire_sample() */
+    rt_tick_t interval_tick;        /* At most one sample per interval on average */
+    rt_tick_t next_due;             /* Next sample is delivered from about here */
+    rt_bool_t started;              /* First sample delivered */
+    s8_sample_callback_t callback;  /* Either a callback... */
+    void *context;
+    rt_mq_t queue;                  /* ...or a queue of s8_sample_t */
+    volatile rt_bool_t closing;     /* Unsubscribed, the queue waits for its receivers to leave */
+    volatile rt_uint8_t receivers;  /* Threads in s8_acquire_receive() */
+
+    /* Statistics */
+    rt_uint32_t delivered;
+    rt_uint32_t overflows;          /* Samples lost to a full queue */
+} s8_subscriber_t;
+
+/*
+ * The one reader of a sensor. It samples at the fastest rate any subscriber
+ * asks for and fans every sample out, so bus traffic does not grow with the
+ * number of consumers. Intervals up to S8_MEASUREMENT_PERIOD_MS follow the
+ * sensor's own measurement cycle: one read per update, and only new
+ * measurements are delivered. Each subscriber decimates to its own interval.
+ * The service has no thread: the scheduler of the sensor's bus, see
+ * s8_poller.h, asks it when it is due and runs its reads in turn with
+ * those of the other sensors on the bus.
+ */
+typedef struct s8_acquire {
+    s8_sensor_device_t *sensor;
+    s8_subscriber_t subscribers[S8_ACQUIRE_MAX_SUBSCRIBERS];
+    rt_mutex_t lock;                /* Protects subscribers and the plan */
+    rt_mutex_t deliver;             /* Held while samples are handed out, taken before lock */
+
+    rt_tick_t period;               /* Fastest subscriber interval, 0 = no subscribers */
+    rt_bool_t tracking;             /* period is within the sensor's own cycle */
+    rt_tick_t next_due;
+    rt_bool_t urgent;               /* A one-off reader waits: read at once, deliver what comes */
+    rt_tick_t last_sample;          /* End of the read last delivered */
+    s8_cadence_t cadence;
+
+    /* Statistics */
+    rt_uint32_t reads;              /* Bus reads started */
+    rt_uint32_t samples;            /* Samples fanned out */
+    rt_uint32_t failures;
+} s8_acquire_t;
+
+s8_acquire_t *s8_acquire_create(s8_sensor_device_t *sensor);
+s8_acquire_t *s8_acquire_get(s8_sensor_device_t *sensor);
+void s8_acquire_destroy(s8_acquire_t *acquire);
+
+s8_subscriber_t *s8_acquire_subscribe(s8_acquire_t *acquire, rt_uint32_t interval_ms,
+                                      s8_sample_callback_t callback, void *context);
+s8_subscriber_t *s8_acquire_subscribe_queue(s8_acquire_t *acquire, rt_uint32_t interval_ms);
+rt_err_t s8_acquire_unsubscribe(s8_acquire_t *acquire, s8_subscriber_t *subscriber);
+rt_err_t s8_acquire_receive(s8_subscriber_t *subscriber, s8_sample_t *sample, rt_int32_t timeout);
+s8_status_t s8_acquire_sample(s8_acquire_t *acquire, s8_sample_t *sample, rt_int32_t timeout);
+void s8_acquire_request(s8_acquire_t *acquire);
+void s8_acquire_dump(s8_acquire_t *acquire);
+
+/* For the bus scheduler */
+rt_bool_t s8_acquire_due(s8_acquire_t *acquire, rt_tick_t *due, rt_bool_t *urgent);
+void s8_acquire_run(s8_acquire_t *acquire);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* S8_ACQUIRE_H__ */
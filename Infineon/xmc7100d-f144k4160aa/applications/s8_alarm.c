@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Interrupt-driven S8 alarm input, lock-free ring keeping the newest changes
+ */
+
+#include "s8_alarm.h"
+#include "drv_gpio.h"
+
+/* Orders the event copy against head, both on the producer and consumer side */
+#ifndef S8_ALARM_BARRIER
+#define S8_ALARM_BARRIER()  __DMB()
+#endif
+
+/* The board has one alarm line, and its port one GPIO interrupt slot */
+static s8_alarm_t *g_s8_alarm = RT_NULL;
+
+/**
+ * Queue a change for the consumer, overwriting the oldest when full
+ * Timer callback context, the ring's only producer: it reads tail but never
+ * writes it. The semaphore counts queued events, so an overwrite leaves it
+ * as it is.
+ */
+static void s8_alarm_push(s8_alarm_t *alarm, rt_uint8_t state, rt_tick_t tick)
+{
+    s8_alarm_event_t *event;
+    rt_bool_t full;
+
+    alarm->changes++;
+    full = alarm->head - alarm->tail >= S8_ALARM_QUEUE_DEPTH;
+    if (full) {
+        alarm->overflows++;
+    }
+
+    event = &alarm->events[alarm->head & (S8_ALARM_QUEUE_DEPTH - 1)];
+    event->state = state;
+    event->tick = tick;
+    event->sequence = alarm->changes;
+    S8_ALARM_BARRIER();
+    alarm->head++;
+    if (!full) {
+        rt_sem_release(&alarm->ready);
+    }
+}
+
+/**
+ * Debounce timer: the line has been quiet for S8_ALARM_DEBOUNCE_MS
+ */
+static void s8_alarm_settled(void *parameter)
+{
+    s8_alarm_t *alarm = (s8_alarm_t *)parameter;
+    rt_uint8_t level;
+    rt_tick_t tick;
+    rt_base_t irq;
+
+    /* An edge between the read and the reset would otherwise be lost */
+    irq = rt_hw_interrupt_disable();
+    level = rt_pin_read(alarm->pin) ? 1 : 0;
+    tick = alarm->edge_tick;
+    alarm->settling = RT_FALSE;
+    rt_hw_interrupt_enable(irq);
+
+    if (level == alarm->state) {
+        alarm->glitches++;
+        return;
+    }
+    alarm->state = level;
+    s8_alarm_push(alarm, level, tick);
+}
+
+/**
+ * GPIO interrupt on either edge of the alarm line
+ */
+static void s8_alarm_edge(void *args)
+{
+    s8_alarm_t *alarm = (s8_alarm_t *)args;
+
+    alarm->edges++;
+    if (!alarm->settling) {
+        alarm->settling = RT_TRUE;
+        alarm->edge_tick = rt_tick_get();
+    }
+
+    /* Restarted by every bounce: the level must hold for the whole debounce time */
+    rt_timer_start(&alarm->debounce);
+}
+
+/**
+ * Set up the alarm input once, before any sensor or consumer runs
+ */
+static int s8_alarm_init(void)
+{
+    s8_alarm_t *alarm;
+    rt_tick_t debounce;
+
+    alarm = (s8_alarm_t *)rt_malloc(sizeof(s8_alarm_t));
+    if (!alarm) {
+        rt_kprintf("[S8_ALARM] Out of memory\n");
+        return -RT_ENOMEM;
+    }
+    rt_memset(alarm, 0, sizeof(s8_alarm_t));
+    alarm->pin = S8_ALARM_PIN;
+
+    /* A one-tick timer may fire at once on the next tick: two is the shortest real wait */
+    debounce = rt_tick_from_millisecond(S8_ALARM_DEBOUNCE_MS);
+    rt_sem_init(&alarm->ready, "s8_alrm", 0, RT_IPC_FLAG_FIFO);
+    rt_timer_init(&alarm->debounce, "s8_alrm", s8_alarm_settled, alarm,
+                  debounce > 2 ? debounce : 2, RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_HARD_TIMER);
+
+    rt_pin_mode(alarm->pin, PIN_MODE_INPUT);
+    alarm->state = rt_pin_read(alarm->pin) ? 1 : 0;
+    if (rt_pin_attach_irq(alarm->pin, PIN_IRQ_MODE_RISING_FALLING, s8_alarm_edge, alarm) != RT_EOK ||
+        rt_pin_irq_enable(alarm->pin, PIN_IRQ_ENABLE) != RT_EOK) {
+        /* Still usable: s8_alarm_state() falls back to reading the pin */
+        rt_kprintf("[S8_ALARM] No edge interrupt on the alarm pin, sampling it instead\n");
+        rt_pin_detach_irq(alarm->pin);
+        alarm->pin = -1;
+    }
+
+    g_s8_alarm = alarm;
+    return RT_EOK;
+}
+INIT_DEVICE_EXPORT(s8_alarm_init);
+
+/**
+ * The alarm input, RT_NULL if it could not be set up
+ * S8_ALARM_PIN is one line on the board, driven by the one sensor wired to
+ * it, see S8_ALARM_UART and S8_ALARM_SLAVE.
+ */
+s8_alarm_t *s8_alarm_get(void)
+{
+    return g_s8_alarm;
+}
+
+/**
+ * Debounced alarm level, 1 = alarm
+ */
+rt_uint8_t s8_alarm_state(s8_alarm_t *alarm)
+{
+    if (!alarm) {
+        return 0;
+    }
+    if (alarm->pin < 0) {
+        return rt_pin_read(S8_ALARM_PIN) ? 1 : 0;
+    }
+
+    return alarm->state;
+}
+
+/**
+ * Wait for the next alarm change
+ * One consumer: the queue has a single reader, the only writer of tail. A
+ * ring that filled skips to the oldest event still held; a copy the timer
+ * callback overwrote meanwhile shows as head running more than the depth
+ * ahead of it, and is taken again.
+ */
+rt_err_t s8_alarm_wait(s8_alarm_t *alarm, s8_alarm_event_t *event, rt_int32_t timeout)
+{
+    rt_err_t result;
+    rt_uint32_t head;
+
+    if (!alarm || !event) {
+        return -RT_EINVAL;
+    }
+
+    result = rt_sem_take(&alarm->ready, timeout);
+    if (result != RT_EOK) {
+        return result;
+    }
+
+    for (;;) {
+        head = alarm->head;
+        S8_ALARM_BARRIER();
+        if (head - alarm->tail > S8_ALARM_QUEUE_DEPTH) {
+            alarm->tail = head - S8_ALARM_QUEUE_DEPTH;
+        }
+        *event = alarm->events[alarm->tail & (S8_ALARM_QUEUE_DEPTH - 1)];
+        S8_ALARM_BARRIER();
+        if (alarm->head - alarm->tail <= S8_ALARM_QUEUE_DEPTH) {
+            break;
+        }
+    }
+    alarm->tail++;
+
+    return RT_EOK;
+}
+
+/**
+ * Print the alarm input's state and counters
+ */
+void s8_alarm_dump(s8_alarm_t *alarm)
+{
+    rt_uint32_t queued;
+
+    if (!alarm) {
+        return;
+    }
+
+    /* Until the consumer next reads, tail may still point at overwritten events */
+    queued = alarm->head - alarm->tail;
+    if (queued > S8_ALARM_QUEUE_DEPTH) {
+        queued = S8_ALARM_QUEUE_DEPTH;
+    }
+
+    rt_kprintf("Alarm: %s (%s)\n", s8_alarm_state(alarm) ? "ACTIVE" : "normal",
+               alarm->pin < 0 ? "sampled" : "edge interrupt");
+    rt_kprintf("  %d edges, %d changes, %d glitches, %d overwritten, %d queued\n",
+               alarm->edges, alarm->changes, alarm->glitches, alarm->overflows,
+               queued);
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+#include <stdlib.h>
+
+/**
+ * Show the alarm input, or print its changes as they come
+ * Usage: s8_alarm [watch_seconds]
+ */
+static void s8_alarm(int argc, char *argv[])
+{
+    s8_alarm_t *alarm;
+    s8_alarm_event_t event;
+    rt_tick_t until;
+    rt_int32_t wait;
+
+    alarm = s8_alarm_get();
+    if (!alarm) {
+        rt_kprintf("[S8_ALARM] Alarm input not set up\n");
+        return;
+    }
+    s8_alarm_dump(alarm);
+    if (argc < 2) {
+        return;
+    }
+
+    until = rt_tick_get() + rt_tick_from_millisecond(atoi(argv[1]) * 1000);
+    while ((wait = (rt_int32_t)(until - rt_tick_get())) > 0) {
+        if (s8_alarm_wait(alarm, &event, wait) != RT_EOK) {
+            continue;
+        }
+        rt_kprintf("[S8_ALARM] #%d %s at tick %d, seen %d ms later\n", event.sequence,
+                   event.state ? "ACTIVE" : "cleared", event.tick,
+                   (rt_tick_get() - event.tick) * 1000 / RT_TICK_PER_SECOND);
+    }
+}
+MSH_CMD_EXPORT(s8_alarm, Show the S8 alarm input or watch its changes);
+#endif
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Interrupt-driven S8 alarm input, lock-free ring keeping the newest changes
+ * 2026-10-16     Developer    C linkage when included from C++
+ */
+
+#ifndef S8_ALARM_H__
+#define S8_ALARM_H__
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "s8_sensor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The level must hold this long after the last edge to count, at least two ticks */
+#ifndef S8_ALARM_DEBOUNCE_MS
+#define S8_ALARM_DEBOUNCE_MS    1
+#endif
+
+/* Events the consumer may fall behind by; a power of two */
+#ifndef S8_ALARM_QUEUE_DEPTH
+#define S8_ALARM_QUEUE_DEPTH    16
+#endif
+#if (S8_ALARM_QUEUE_DEPTH & (S8_ALARM_QUEUE_DEPTH - 1)) != 0
+#error "S8_ALARM_QUEUE_DEPTH must be a power of two"
+#endif
+
+/* One debounced change of the alarm output */
+typedef struct {
+    rt_uint8_t state;               /* Level after the change, 1 = alarm */
+    rt_tick_t tick;                 /* First edge of the change */
+    rt_uint32_t sequence;           /* Change number, gaps show events overwritten in a full queue */
+} s8_alarm_event_t;
+
+/*
+ * The S8 alarm output on S8_ALARM_PIN, watched by a GPIO edge interrupt.
+ * Every edge restarts a hard timer; when the level has held for
+ * S8_ALARM_DEBOUNCE_MS the timer callback records the change. Events go
+ * into a single-producer, single-consumer ring; when it is full the timer
+ * callback overwrites the oldest change, as the newest matter most, and the
+ * consumer skips past what was overwritten.
+ */
+typedef struct s8_alarm {
+    rt_base_t pin;
+    volatile rt_uint8_t state;      /* Debounced level */
+    volatile rt_bool_t settling;    /* Edges seen, debounce timer running */
+    volatile rt_tick_t edge_tick;   /* First edge since the level last settled */
+    struct rt_timer debounce;
+    struct rt_semaphore ready;      /* Counts queued events */
+
+    s8_alarm_event_t events[S8_ALARM_QUEUE_DEPTH];
+    volatile rt_uint32_t head;      /* Next slot to fill */
+    volatile rt_uint32_t tail;      /* Next event to read, written by the consumer only */
+
+    /* Statistics */
+    rt_uint32_t edges;              /* Interrupts taken */
+    rt_uint32_t changes;            /* Debounced changes, the last sequence number */
+    rt_uint32_t glitches;           /* Edge bursts that settled back to the old level */
+    rt_uint32_t overflows;          /* Oldest changes overwritten in a full queue */
+} s8_alarm_t;
+
+s8_alarm_t *s8_alarm_get(void);
+rt_uint8_t s8_alarm_state(s8_alarm_t *alarm);
+rt_err_t s8_alarm_wait(s8_alarm_t *alarm, s8_alarm_event_t *event, rt_int32_t timeout);
+void s8_alarm_dump(s8_alarm_t *alarm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* S8_ALARM_H__ */
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Table-driven S8 sensor buses
+ * 2026-10-16     Developer    Board buses follow the sensors' measurement cycle
+ * 2026-10-16     Developer    R/T driver enable only on the UART2 bus
+ * 2026-10-16     Developer    Sensors shared with their other users, sampled by their services
+ * 2026-10-16     Developer    Slaves scheduled on the bus's own scheduler
+ */
+
+#include "s8_bus.h"
+
+/*
+ * Sensor buses on this board. Each entry gets its own Modbus worker, so
+ * buses run in parallel and share no locks. Add a row per UART enabled in
+ * board/Kconfig; uart4 is the console. S8_POLL_TRACK reads each sensor once
+ * per measurement, just after it is taken. A sensor main.c or the shell
+ * already set up, such as the one at 0xFE on uart2, is shared, not set up
+ * twice. Only UART2 has the S8 connector's R/T line; other buses need an
+ * auto-direction transceiver or their own pin here.
+ */
+static const s8_bus_config_t s8_bus_table[] =
+{
+#ifdef BSP_USING_UART2
+    { { "uart2", 9600, MODBUS_RESPONSE_TIMEOUT_MS, S8_UART_RXT_PIN, S8_UART_RXT_TX_LEVEL }, S8_POLL_TRACK, 1, { S8_MODBUS_ADDRESS } },
+#endif
+#ifdef BSP_USING_UART3
+    { { "uart3", 9600, MODBUS_RESPONSE_TIMEOUT_MS, MODBUS_DE_NONE, 0 }, S8_POLL_TRACK, 1, { S8_MODBUS_ADDRESS } },
+#endif
+#ifdef BSP_USING_UART5
+    { { "uart5", 9600, MODBUS_RESPONSE_TIMEOUT_MS, MODBUS_DE_NONE, 0 }, S8_POLL_TRACK, 1, { S8_MODBUS_ADDRESS } },
+#endif
+    { { RT_NULL, 0, 0, MODBUS_DE_NONE, 0 }, 0, 0, { 0 } }   /* Keeps the table non-empty */
+};
+
+#define S8_BUS_COUNT    (sizeof(s8_bus_table) / sizeof(s8_bus_table[0]) - 1)
+
+static s8_bus_t s8_buses[sizeof(s8_bus_table) / sizeof(s8_bus_table[0])];
+
+/**
+ * Bring up one bus: sensors for every slave, then put them on the schedule
+ * The sensors share the scheduler of their bus, which runs their reads.
+ */
+rt_err_t s8_bus_start(s8_bus_t *bus, const s8_bus_config_t *config)
+{
+    rt_err_t result;
+    rt_uint8_t i;
+
+    if (!bus || !config || !config->bus.uart_name) {
+        return -RT_ERROR;
+    }
+
+    if (bus->poller) {
+        return -RT_EBUSY;
+    }
+
+    rt_memset(bus, 0, sizeof(s8_bus_t));
+    bus->config = config;
+
+    for (i = 0; i < config->slave_count && i < S8_POLLER_MAX_SLAVES; i++) {
+        bus->sensors[i] = s8_sensor_init_bus(&config->bus, config->slaves[i]);
+        if (!bus->sensors[i]) {
+            rt_kprintf("[S8] Bus %s: slave 0x%02X init failed\n",
+                       config->bus.uart_name, config->slaves[i]);
+            s8_bus_stop(bus);
+            return -RT_ERROR;
+        }
+        bus->sensor_count++;
+        bus->poller = s8_poller_get(bus->sensors[i]);
+        s8_poller_add(bus->poller, bus->sensors[i], config->interval_ms);
+    }
+
+    /* The shell may have started the schedule already */
+    result = s8_poller_start(bus->poller);
+    return result == -RT_EBUSY ? RT_EOK : result;
+}
+
+/**
+ * Take a bus's slaves off the schedule and release its references to them
+ */
+void s8_bus_stop(s8_bus_t *bus)
+{
+    rt_uint8_t i;
+
+    if (!bus || !bus->sensor_count) {
+        return;
+    }
+
+    for (i = 0; i < bus->sensor_count; i++) {
+        s8_poller_remove(bus->poller, bus->sensors[i]);
+        s8_sensor_deinit(bus->sensors[i]);
+        bus->sensors[i] = RT_NULL;
+    }
+    bus->sensor_count = 0;
+    bus->poller = RT_NULL;
+}
+
+/**
+ * Start every bus in the board table
+ */
+rt_err_t s8_buses_start(void)
+{
+    rt_err_t result = RT_EOK;
+    rt_size_t i;
+
+    for (i = 0; i < S8_BUS_COUNT; i++) {
+        if (s8_bus_start(&s8_buses[i], &s8_bus_table[i]) != RT_EOK) {
+            result = -RT_ERROR;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Stop every bus in the board table
+ */
+void s8_buses_stop(void)
+{
+    rt_size_t i;
+
+    for (i = 0; i < S8_BUS_COUNT; i++) {
+        s8_bus_stop(&s8_buses[i]);
+    }
+}
+
+/**
+ * Print each running bus
+ */
+void s8_buses_dump(void)
+{
+    rt_size_t i;
+
+    for (i = 0; i < S8_BUS_COUNT; i++) {
+        rt_kprintf("Bus %s @ %d baud: %s\n",
+                   s8_bus_table[i].bus.uart_name,
+                   s8_bus_table[i].bus.baud_rate,
+                   s8_buses[i].poller ? "running" : "stopped");
+        if (s8_buses[i].poller) {
+            s8_poller_dump(s8_buses[i].poller);
+        }
+    }
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+/**
+ * Start, stop or list the buses from the board table
+ * Usage: s8_bus start | stop | list
+ */
+static void s8_bus(int argc, char *argv[])
+{
+    if (argc < 2 || rt_strcmp(argv[1], "list") == 0) {
+        s8_buses_dump();
+    } else if (rt_strcmp(argv[1], "start") == 0) {
+        rt_kprintf("[S8] Starting %d bus(es): %s\n", S8_BUS_COUNT,
+                   s8_buses_start() == RT_EOK ? "ok" : "some failed");
+    } else if (rt_strcmp(argv[1], "stop") == 0) {
+        s8_buses_stop();
+        rt_kprintf("[S8] Buses stopped\n");
+    } else {
+        rt_kprintf("Usage: s8_bus start | stop | list\n");
+    }
+}
+MSH_CMD_EXPORT(s8_bus, Start stop or list the S8 sensor buses);
+#endif
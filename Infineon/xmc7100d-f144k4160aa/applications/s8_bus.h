@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Table-driven S8 sensor buses
+ * 2026-10-16     Developer    Poller without a thread of its own
+ * 2026-10-16     Developer    C linkage when included from C++
+ * 2026-10-16     Developer    Poller is the bus's own scheduler
+ */
+
+#ifndef S8_BUS_H__
+#define S8_BUS_H__
+
+#include <rtthread.h>
+#include "modbus_rtu.h"
+#include "s8_poller.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* One RS-485 segment and the sensors wired to it */
+typedef struct {
+    modbus_bus_config_t bus;
+    rt_uint32_t interval_ms;                    /* Poll period for every slave, or S8_POLL_TRACK */
+    rt_uint8_t slave_count;
+    rt_uint8_t slaves[S8_POLLER_MAX_SLAVES];
+} s8_bus_config_t;
+
+/* A running bus: its sensors and the scheduler they share */
+typedef struct {
+    const s8_bus_config_t *config;
+    s8_poller_t *poller;                        /* The bus's scheduler, RT_NULL while stopped */
+    s8_sensor_device_t *sensors[S8_POLLER_MAX_SLAVES];
+    rt_uint8_t sensor_count;
+} s8_bus_t;
+
+rt_err_t s8_bus_start(s8_bus_t *bus, const s8_bus_config_t *config);
+void s8_bus_stop(s8_bus_t *bus);
+
+/* Board bus table */
+rt_err_t s8_buses_start(void);
+void s8_buses_stop(void);
+void s8_buses_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* S8_BUS_H__ */
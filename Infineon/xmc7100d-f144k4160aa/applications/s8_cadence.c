@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    S8 measurement cadence tracking
+ */
+
+#include "s8_cadence.h"
+
+/**
+ * Narrow the update bracket with a window (a, b] known to contain an update
+ */
+static void s8_cadence_bracket(s8_cadence_t *cadence, rt_tick_t a, rt_tick_t b)
+{
+    rt_tick_t lo = a, hi = b, plo, phi, slack, centre, measured;
+    rt_int32_t k;
+
+    if (!cadence->locked) {
+        cadence->lo = a;
+        cadence->hi = b;
+        cadence->locked = RT_TRUE;
+        cadence->anchor = a + (b - a) / 2;
+        return;
+    }
+
+    /* Project the last bracket forward, widened for clock drift */
+    k = ((rt_int32_t)(b - cadence->hi) + (rt_int32_t)cadence->period / 2) / (rt_int32_t)cadence->period;
+    if (k < 1) {
+        k = 1;
+    }
+    slack = k * (cadence->period / 2048 + 1);
+    plo = cadence->lo + k * cadence->period - slack;
+    phi = cadence->hi + k * cadence->period + slack;
+    if ((rt_int32_t)(plo - lo) > 0) {
+        lo = plo;
+    }
+    if ((rt_int32_t)(phi - hi) < 0) {
+        hi = phi;
+    }
+    if ((rt_int32_t)(hi - lo) <= 0) {
+        /* The update moved outside the prediction: start over from this window */
+        cadence->resyncs++;
+        lo = a;
+        hi = b;
+    }
+    cadence->lo = lo;
+    cadence->hi = hi;
+
+    /*
+     * Period from how far the bracket centre moved since the anchor. The
+     * anchor survives resyncs, so the estimate keeps improving as updates
+     * accumulate; it is re-anchored only to keep the arithmetic in range.
+     */
+    centre = lo + (hi - lo) / 2;
+    cadence->anchor_updates = (centre - cadence->anchor + cadence->period / 2) / cadence->period;
+    if (cadence->anchor_updates >= S8_CADENCE_LEARN_UPDATES) {
+        measured = (centre - cadence->anchor) / cadence->anchor_updates;
+        if (measured < cadence->nominal - cadence->nominal / 16) {
+            measured = cadence->nominal - cadence->nominal / 16;
+        } else if (measured > cadence->nominal + cadence->nominal / 16) {
+            measured = cadence->nominal + cadence->nominal / 16;
+        }
+        cadence->period = measured;
+    }
+    if (cadence->anchor_updates >= S8_CADENCE_ANCHOR_UPDATES) {
+        cadence->anchor = centre;
+    }
+}
+
+/**
+ * Start tracking a sensor that updates about every period_ms
+ */
+void s8_cadence_init(s8_cadence_t *cadence, rt_uint32_t period_ms)
+{
+    rt_memset(cadence, 0, sizeof(s8_cadence_t));
+    cadence->nominal = rt_tick_from_millisecond(period_ms);
+    cadence->period = cadence->nominal;
+}
+
+/**
+ * Feed one successful read that started at 'start' and completed at 'end'
+ */
+void s8_cadence_observe(s8_cadence_t *cadence, rt_tick_t start, rt_tick_t end,
+                        rt_uint16_t co2, rt_uint16_t status)
+{
+    rt_tick_t age, width;
+
+    cadence->reads++;
+
+    if (!cadence->have_last) {
+        cadence->have_last = RT_TRUE;
+    } else if (co2 != cadence->last_co2 || status != cadence->last_status) {
+        cadence->fresh++;
+        width = cadence->hi - cadence->lo;
+        s8_cadence_bracket(cadence, cadence->last_start, end);
+        if (cadence->probing) {
+            /* Update came before the probe: the projected lower bound is
+             * unproven when the sensor runs fast, so let the bracket slide */
+            cadence->lo -= width / 2;
+        }
+
+        /* The new value cannot predate the update's lower bound */
+        age = end - cadence->lo;
+        cadence->age_sum += age;
+        cadence->age_count++;
+        if (age > cadence->age_max) {
+            cadence->age_max = age;
+        }
+        cadence->probed = RT_FALSE;
+        cadence->retries = 0;
+    } else {
+        cadence->duplicates++;
+        if (cadence->locked && cadence->probing &&
+            (rt_int32_t)(start - (cadence->lo + cadence->period)) > 0 &&
+            (rt_int32_t)(start - (cadence->hi + cadence->period)) < 0) {
+            /* Probe came before the update: it lies in the later half */
+            cadence->lo = start - cadence->period;
+        } else if (cadence->locked &&
+                   (rt_int32_t)(start - (cadence->hi + cadence->period)) > 0) {
+            cadence->retries++;
+        }
+    }
+    cadence->probing = RT_FALSE;
+
+    cadence->last_start = start;
+    cadence->last_co2 = co2;
+    cadence->last_status = status;
+}
+
+/**
+ * Tick the next read should start, given the read that just finished at 'now'
+ */
+rt_tick_t s8_cadence_next(s8_cadence_t *cadence, rt_tick_t now)
+{
+    rt_tick_t ulo, uhi, probe;
+
+    if (!cadence->locked) {
+        /* Scan until the first update is seen */
+        return now + rt_tick_from_millisecond(S8_CADENCE_RETRY_MS);
+    }
+
+    if (cadence->retries > 0) {
+        if (cadence->retries <= S8_CADENCE_MAX_RETRIES) {
+            return now + rt_tick_from_millisecond(S8_CADENCE_RETRY_MS);
+        }
+        /* Value held still across an update; carry the bracket forward */
+        cadence->lo += cadence->period;
+        cadence->hi += cadence->period;
+        cadence->retries = 0;
+        cadence->probed = RT_FALSE;
+    }
+
+    ulo = cadence->lo + cadence->period;
+    uhi = cadence->hi + cadence->period;
+
+    if (!cadence->probed && uhi - ulo > rt_tick_from_millisecond(S8_CADENCE_TARGET_MS)) {
+        probe = ulo + (uhi - ulo) / 2;
+        if ((rt_int32_t)(probe - now) > 0) {
+            cadence->probing = RT_TRUE;
+            cadence->probed = RT_TRUE;
+            cadence->probes++;
+            return probe;
+        }
+    }
+
+    return uhi + rt_tick_from_millisecond(S8_CADENCE_GUARD_MS);
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    S8 measurement cadence tracking
+ * 2026-10-16     Developer    C linkage when included from C++
+ */
+
+#ifndef S8_CADENCE_H__
+#define S8_CADENCE_H__
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define S8_CADENCE_GUARD_MS         5       /* Read this long after the latest possible update */
+#define S8_CADENCE_RETRY_MS         50      /* Re-read interval while a new value is overdue */
+#define S8_CADENCE_MAX_RETRIES      2       /* Then assume the value simply did not change */
+#define S8_CADENCE_TARGET_MS        100     /* Probe when the update is bracketed less tightly */
+#define S8_CADENCE_LEARN_UPDATES    8       /* Updates observed before the period is corrected */
+#define S8_CADENCE_ANCHOR_UPDATES   256     /* Updates a period measurement spans at most */
+
+/*
+ * Follows the sensor's internal measurement cycle from the outside.
+ *
+ * A read that returns a new CO2 value or meter status proves an update
+ * happened between the previous read and this one. That window, projected
+ * forward by the learned period and intersected with the earlier ones,
+ * brackets the update phase; an occasional probe inside a wide bracket
+ * halves it. Reads are then scheduled just after the latest tick the next
+ * update can occur, giving one fresh sample per update with minimum age.
+ */
+typedef struct {
+    rt_tick_t nominal;              /* Configured period, bounds the learned one */
+    rt_tick_t period;               /* Learned update period */
+    rt_tick_t lo, hi;               /* Last update happened in (lo, hi] */
+    rt_bool_t locked;               /* lo/hi hold a real bracket */
+    rt_bool_t probing;              /* Next read is a probe inside the bracket */
+    rt_bool_t probed;               /* Already probed for the upcoming update */
+    rt_uint8_t retries;             /* Overdue reads without a new value */
+    rt_tick_t anchor;               /* Bracket centre the period is measured from */
+    rt_uint32_t anchor_updates;     /* Updates between the anchor and the last bracket */
+
+    /* Previous successful read */
+    rt_bool_t have_last;
+    rt_tick_t last_start;
+    rt_uint16_t last_co2;
+    rt_uint16_t last_status;
+
+    /* Statistics */
+    rt_uint32_t reads;
+    rt_uint32_t fresh;              /* Reads that returned a new measurement */
+    rt_uint32_t duplicates;         /* Reads that returned the previous one again */
+    rt_uint32_t probes;
+    rt_uint32_t resyncs;            /* Update seen outside the predicted bracket */
+    rt_uint32_t age_sum;            /* Age upper bounds of new measurements, ticks */
+    rt_uint32_t age_count;
+    rt_tick_t age_max;
+} s8_cadence_t;
+
+void s8_cadence_init(s8_cadence_t *cadence, rt_uint32_t period_ms);
+void s8_cadence_observe(s8_cadence_t *cadence, rt_tick_t start, rt_tick_t end,
+                        rt_uint16_t co2, rt_uint16_t status);
+rt_tick_t s8_cadence_next(s8_cadence_t *cadence, rt_tick_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* S8_CADENCE_H__ */
@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Calibration tracked through the meter status and stepped by the bus scheduler
+ * 2026-10-16     Developer    Reads of its own made by the acquisition service
+ */
+
+#include "s8_calib.h"
+#include "s8_acquire.h"
+#include "s8_poller.h"
+
+static const char *const s8_cal_kind_names[S8_CAL_KIND_COUNT] =
+{
+    "zero", "background", "single point"
+};
+
+/**
+ * Issue the calibration command; its echo is all there is to check
+ */
+static s8_status_t s8_cal_command(s8_cal_t *cal)
+{
+    switch (cal->kind) {
+    case S8_CAL_ZERO:
+        return s8_zero_calibration(cal->sensor);
+    case S8_CAL_BACKGROUND:
+        return s8_background_calibration(cal->sensor);
+    default:
+        return s8_single_point_calibration(cal->sensor, cal->value);
+    }
+}
+
+/**
+ * Meter status as of after cal->since
+ * A reading someone else published after since and no older than the poll
+ * interval is used as is; otherwise the acquisition service, the sensor's
+ * only reader, is asked for one. The scheduler makes that read before the
+ * next step, which looks again. Returns RT_FALSE while the answer is to come.
+ */
+static rt_bool_t s8_cal_meter_status(s8_cal_t *cal, rt_uint16_t *meter_status)
+{
+    s8_sensor_data_t data;
+    rt_bool_t asked = cal->asking;
+
+    cal->asking = RT_FALSE;
+    s8_sensor_snapshot(cal->sensor, &data);
+    if (data.data_valid && (rt_int32_t)(data.timestamp - cal->since) > 0 &&
+        rt_tick_get() - data.timestamp <= cal->poll_interval) {
+        cal->polls++;
+        cal->last_status = S8_STATUS_OK;
+        *meter_status = data.meter_status;
+        return RT_TRUE;
+    }
+    if (asked) {
+        /* The read was made and failed */
+        cal->polls++;
+        cal->last_status = cal->sensor->health.last_error;
+        return RT_TRUE;
+    }
+
+    cal->own_reads++;
+    cal->asking = RT_TRUE;
+    s8_acquire_request(s8_acquire_get(cal->sensor));
+    return RT_FALSE;
+}
+
+/**
+ * Next poll interval while the calibration runs
+ * Backs off to S8_CAL_POLL_MAX_MS, and drops back to S8_CAL_POLL_MIN_MS
+ * around the run time learned from the last calibration of this kind.
+ */
+static void s8_cal_backoff(s8_cal_t *cal, rt_tick_t elapsed)
+{
+    rt_tick_t min = rt_tick_from_millisecond(S8_CAL_POLL_MIN_MS);
+    rt_tick_t max = rt_tick_from_millisecond(S8_CAL_POLL_MAX_MS);
+    rt_tick_t expected = cal->expected[cal->kind];
+
+    cal->poll_interval *= 2;
+    if (cal->poll_interval > max) {
+        cal->poll_interval = max;
+    }
+    if (expected > 0 && elapsed + cal->poll_interval >= expected && elapsed < expected * 2) {
+        cal->poll_interval = min;
+    }
+}
+
+/**
+ * End the calibration and tell the waiters
+ */
+static void s8_cal_finish(s8_cal_t *cal, s8_cal_state_t outcome)
+{
+    cal->end_tick = rt_tick_get();
+    cal->state = outcome;
+    rt_kprintf("[S8_CAL] %s calibration %s after %d ms\n", s8_cal_kind_names[cal->kind],
+               s8_cal_state_name(outcome),
+               (cal->end_tick - cal->start_tick) * 1000 / RT_TICK_PER_SECOND);
+    rt_event_send(&cal->event, S8_CAL_EVENT_FINISHED);
+}
+
+/**
+ * When the calibration in progress next needs a step, for the bus scheduler
+ * Returns RT_FALSE while none runs, or while the read it asked for is yet
+ * to be made.
+ */
+rt_bool_t s8_cal_due(s8_cal_t *cal, rt_tick_t *due)
+{
+    rt_bool_t urgent;
+    rt_tick_t when;
+
+    if (!s8_cal_busy(cal)) {
+        return RT_FALSE;
+    }
+    if (cal->asking && s8_acquire_due(s8_acquire_get(cal->sensor), &when, &urgent) && urgent) {
+        return RT_FALSE;
+    }
+
+    *due = cal->abort ? rt_tick_get() : cal->next_step;
+    return RT_TRUE;
+}
+
+/**
+ * Take a calibration one step from command to outcome
+ * Called by the bus scheduler only, when s8_cal_due() says so. The command
+ * is written a few times over until the sensor echoes it; then each step
+ * looks at the meter status until the calibration ongoing bit clears.
+ */
+void s8_cal_step(s8_cal_t *cal)
+{
+    rt_uint16_t meter_status;
+    rt_tick_t now;
+
+    if (cal->state == S8_CAL_STATE_COMMAND) {
+        if (cal->abort) {
+            s8_cal_finish(cal, S8_CAL_STATE_ABORTED);
+            return;
+        }
+        cal->write_attempts++;
+        cal->last_status = s8_cal_command(cal);
+        if (cal->last_status == S8_STATUS_OK) {
+            cal->state = S8_CAL_STATE_STARTING;
+            cal->poll_interval = rt_tick_from_millisecond(S8_CAL_POLL_MIN_MS);
+            cal->since = rt_tick_get();
+            cal->next_step = cal->since;
+        } else if (cal->write_attempts >= S8_CAL_WRITE_ATTEMPTS) {
+            rt_kprintf("[S8_CAL] Command not accepted: %d\n", cal->last_status);
+            s8_cal_finish(cal, S8_CAL_STATE_FAILED);
+        }
+        return;
+    }
+
+    if (cal->abort) {
+        s8_cancel_calibration(cal->sensor);
+        s8_cal_finish(cal, S8_CAL_STATE_ABORTED);
+        return;
+    }
+    now = rt_tick_get();
+    /* The command went through: it may have run between two polls */
+    if (cal->state == S8_CAL_STATE_STARTING &&
+        now - cal->start_tick >= rt_tick_from_millisecond(S8_CAL_START_TIMEOUT_MS)) {
+        rt_kprintf("[S8_CAL] Sensor never reported the calibration\n");
+        s8_cal_finish(cal, S8_CAL_STATE_UNCONFIRMED);
+        return;
+    }
+    if (now - cal->start_tick >= rt_tick_from_millisecond(S8_CAL_TIMEOUT_MS)) {
+        s8_cancel_calibration(cal->sensor);
+        s8_cal_finish(cal, S8_CAL_STATE_TIMEOUT);
+        return;
+    }
+
+    if (!s8_cal_meter_status(cal, &meter_status)) {
+        return;
+    }
+    if (cal->last_status == S8_STATUS_OK) {
+        cal->since = rt_tick_get();
+        if (meter_status & S8_METER_STATUS_CAL_ONGOING) {
+            cal->ongoing = cal->since;
+            if (cal->state == S8_CAL_STATE_STARTING) {
+                cal->state = S8_CAL_STATE_RUNNING;
+                cal->running_tick = cal->since;
+            }
+        } else if (cal->state == S8_CAL_STATE_RUNNING) {
+            /* It ended after the bit was last seen: poll fast from there next time */
+            cal->expected[cal->kind] = cal->ongoing - cal->start_tick;
+            s8_cal_finish(cal, S8_CAL_STATE_DONE);
+            return;
+        }
+    }
+    if (cal->state == S8_CAL_STATE_RUNNING) {
+        s8_cal_backoff(cal, rt_tick_get() - cal->start_tick);
+    }
+    cal->next_step = rt_tick_get() + cal->poll_interval;
+}
+
+/**
+ * Free a calibrator
+ */
+static void s8_cal_free(s8_cal_t *cal)
+{
+    rt_event_detach(&cal->event);
+    rt_free(cal);
+}
+
+/**
+ * Set up the calibration state machine of a sensor
+ * Called once, while the sensor is set up and before anyone can use it.
+ * Its steps are run by the scheduler of the sensor's bus.
+ */
+s8_cal_t *s8_cal_create(s8_sensor_device_t *sensor)
+{
+    s8_cal_t *cal;
+
+    if (!sensor) {
+        return RT_NULL;
+    }
+
+    cal = (s8_cal_t *)rt_malloc(sizeof(s8_cal_t));
+    if (!cal) {
+        return RT_NULL;
+    }
+    rt_memset(cal, 0, sizeof(s8_cal_t));
+    cal->sensor = sensor;
+    rt_event_init(&cal->event, "s8_cal", RT_IPC_FLAG_FIFO);
+
+    return cal;
+}
+
+/**
+ * The calibration state machine of a sensor
+ */
+s8_cal_t *s8_cal_get(s8_sensor_device_t *sensor)
+{
+    return sensor ? sensor->cal : RT_NULL;
+}
+
+/**
+ * Drop a calibrator, aborting a calibration in progress
+ * The sensor must have left its bus scheduler, so the abort goes to the
+ * sensor from here. Callers blocked in s8_cal_wait() must be gone first.
+ */
+void s8_cal_destroy(s8_cal_t *cal)
+{
+    if (!cal) {
+        return;
+    }
+
+    if (s8_cal_busy(cal)) {
+        if (cal->state != S8_CAL_STATE_COMMAND) {
+            s8_cancel_calibration(cal->sensor);
+        }
+        s8_cal_finish(cal, S8_CAL_STATE_ABORTED);
+    }
+
+    if (cal->sensor->cal == cal) {
+        cal->sensor->cal = RT_NULL;
+    }
+    s8_cal_free(cal);
+}
+
+/**
+ * Start a calibration and return at once
+ * value is the single point target in ppm, unused otherwise. Completion
+ * is signalled with S8_CAL_EVENT_FINISHED; see s8_cal_wait().
+ */
+rt_err_t s8_cal_start(s8_cal_t *cal, s8_cal_kind_t kind, rt_uint16_t value)
+{
+    if (!cal || kind >= S8_CAL_KIND_COUNT) {
+        return -RT_EINVAL;
+    }
+    if (s8_cal_busy(cal)) {
+        return -RT_EBUSY;
+    }
+
+    rt_event_recv(&cal->event, S8_CAL_EVENT_FINISHED,
+                  RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR, 0, RT_NULL);
+    cal->kind = kind;
+    cal->value = value;
+    cal->abort = RT_FALSE;
+    cal->write_attempts = 0;
+    cal->polls = 0;
+    cal->own_reads = 0;
+    cal->start_tick = rt_tick_get();
+    cal->running_tick = 0;
+    cal->end_tick = 0;
+    cal->asking = RT_FALSE;
+    cal->next_step = cal->start_tick;
+    cal->state = S8_CAL_STATE_COMMAND;
+    s8_poller_wake(cal->sensor->poller);
+
+    rt_kprintf("[S8_CAL] %s calibration started\n", s8_cal_kind_names[kind]);
+    return RT_EOK;
+}
+
+/**
+ * Abort the calibration in progress
+ * Zero and background calibrations are cancelled on the sensor too.
+ */
+rt_err_t s8_cal_abort(s8_cal_t *cal)
+{
+    if (!cal) {
+        return -RT_EINVAL;
+    }
+    if (!s8_cal_busy(cal)) {
+        return -RT_ERROR;
+    }
+
+    cal->abort = RT_TRUE;
+    s8_poller_wake(cal->sensor->poller);
+    return RT_EOK;
+}
+
+/**
+ * Wait for the calibration in progress to finish
+ * Returns the state at the end of the wait: an outcome, or a busy state
+ * if the timeout expired first.
+ */
+s8_cal_state_t s8_cal_wait(s8_cal_t *cal, rt_int32_t timeout)
+{
+    if (!cal) {
+        return S8_CAL_STATE_IDLE;
+    }
+
+    if (s8_cal_busy(cal)) {
+        rt_event_recv(&cal->event, S8_CAL_EVENT_FINISHED, RT_EVENT_FLAG_OR, timeout, RT_NULL);
+    }
+    return cal->state;
+}
+
+/**
+ * Whether a calibration is in progress
+ */
+rt_bool_t s8_cal_busy(s8_cal_t *cal)
+{
+    return cal && (cal->state == S8_CAL_STATE_COMMAND ||
+                   cal->state == S8_CAL_STATE_STARTING ||
+                   cal->state == S8_CAL_STATE_RUNNING);
+}
+
+/**
+ * Printable calibration state
+ */
+const char *s8_cal_state_name(s8_cal_state_t state)
+{
+    switch (state) {
+    case S8_CAL_STATE_IDLE:        return "idle";
+    case S8_CAL_STATE_COMMAND:     return "commanding";
+    case S8_CAL_STATE_STARTING:    return "starting";
+    case S8_CAL_STATE_RUNNING:     return "running";
+    case S8_CAL_STATE_DONE:        return "done";
+    case S8_CAL_STATE_UNCONFIRMED: return "unconfirmed";
+    case S8_CAL_STATE_FAILED:      return "failed";
+    case S8_CAL_STATE_TIMEOUT:     return "timed out";
+    case S8_CAL_STATE_ABORTED:     return "aborted";
+    default:                       return "?";
+    }
+}
+
+/**
+ * Print the current or last calibration
+ */
+void s8_cal_dump(s8_cal_t *cal)
+{
+    rt_tick_t end;
+
+    if (!cal) {
+        return;
+    }
+    if (cal->state == S8_CAL_STATE_IDLE) {
+        rt_kprintf("Calibration: none since init\n");
+        return;
+    }
+
+    end = s8_cal_busy(cal) ? rt_tick_get() : cal->end_tick;
+    rt_kprintf("Calibration: %s, %s for %d ms\n", s8_cal_kind_names[cal->kind],
+               s8_cal_state_name(cal->state), (end - cal->start_tick) * 1000 / RT_TICK_PER_SECOND);
+    rt_kprintf("  %d command writes, %d status polls (%d own reads), poll interval %d ms\n",
+               cal->write_attempts, cal->polls, cal->own_reads,
+               cal->poll_interval * 1000 / RT_TICK_PER_SECOND);
+    if (cal->running_tick) {
+        rt_kprintf("  sensor reported it after %d ms\n",
+                   (cal->running_tick - cal->start_tick) * 1000 / RT_TICK_PER_SECOND);
+    }
+}
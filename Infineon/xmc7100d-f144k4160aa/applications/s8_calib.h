@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Calibration tracked through the meter status and stepped by the bus scheduler
+ * 2026-10-16     Developer    Reads of its own made by the acquisition service
+ * 2026-10-16     Developer    C linkage when included from C++
+ */
+
+#ifndef S8_CALIB_H__
+#define S8_CALIB_H__
+
+#include <rtthread.h>
+#include "s8_sensor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define S8_CAL_WRITE_ATTEMPTS       3       /* Command writes before giving up */
+
+/* Meter status polling: starts fast, backs off while the calibration runs */
+#ifndef S8_CAL_POLL_MIN_MS
+#define S8_CAL_POLL_MIN_MS          200
+#endif
+#ifndef S8_CAL_POLL_MAX_MS
+#define S8_CAL_POLL_MAX_MS          S8_MEASUREMENT_PERIOD_MS
+#endif
+
+/* The sensor must report the calibration within this long of the command */
+#ifndef S8_CAL_START_TIMEOUT_MS
+#define S8_CAL_START_TIMEOUT_MS     (3 * S8_MEASUREMENT_PERIOD_MS)
+#endif
+
+/* Longest calibration before it is given up on */
+#ifndef S8_CAL_TIMEOUT_MS
+#define S8_CAL_TIMEOUT_MS           (5 * 60 * 1000)
+#endif
+
+/* Set in the event when a calibration ends, whatever the outcome */
+#define S8_CAL_EVENT_FINISHED       (1 << 0)
+
+typedef enum {
+    S8_CAL_ZERO = 0,
+    S8_CAL_BACKGROUND,
+    S8_CAL_SINGLE_POINT,
+    S8_CAL_KIND_COUNT
+} s8_cal_kind_t;
+
+typedef enum {
+    S8_CAL_STATE_IDLE = 0,          /* Nothing requested yet */
+    S8_CAL_STATE_COMMAND,           /* Writing the command */
+    S8_CAL_STATE_STARTING,          /* Waiting for the calibration ongoing bit */
+    S8_CAL_STATE_RUNNING,           /* Bit set */
+    S8_CAL_STATE_DONE,              /* Bit cleared: readings can be trusted again */
+    S8_CAL_STATE_UNCONFIRMED,       /* Command accepted, bit never seen by the start timeout */
+    S8_CAL_STATE_FAILED,            /* Command not accepted */
+    S8_CAL_STATE_TIMEOUT,           /* Still running after S8_CAL_TIMEOUT_MS */
+    S8_CAL_STATE_ABORTED
+} s8_cal_state_t;
+
+/*
+ * Calibration of one sensor, stepped by the scheduler of its bus so the
+ * caller never waits on it and no thread is kept per sensor; a step makes
+ * one bus transaction at most. The command goes out at urgent priority and
+ * must be echoed; then the calibration ongoing bit of the meter status is
+ * followed until it clears. The acquisition service keeps sampling
+ * throughout: a reading it published recently enough stands in for a poll,
+ * so the bus only sees extra reads when nobody else is sampling. Those are
+ * made by the service too, which stays the only reader of the sensor.
+ */
+typedef struct s8_cal {
+    s8_sensor_device_t *sensor;
+    struct rt_event event;          /* S8_CAL_EVENT_FINISHED */
+
+    /* Current or last calibration */
+    volatile s8_cal_state_t state;
+    volatile rt_bool_t abort;
+    s8_cal_kind_t kind;
+    rt_uint16_t value;              /* Single point target, ppm */
+    s8_status_t last_status;        /* Last bus outcome */
+    rt_tick_t start_tick;           /* Command issued */
+    rt_tick_t running_tick;         /* Ongoing bit first seen */
+    rt_tick_t end_tick;
+    rt_tick_t poll_interval;
+    rt_tick_t next_step;            /* The scheduler steps it from here */
+    rt_tick_t since;                /* Meter status must be newer than this */
+    rt_tick_t ongoing;              /* Ongoing bit last seen */
+    rt_bool_t asking;               /* Waiting for a read it asked the service for */
+
+    /* Learned run time of each kind, 0 = none yet; polling speeds up near it */
+    rt_tick_t expected[S8_CAL_KIND_COUNT];
+
+    /* Statistics */
+    rt_uint8_t write_attempts;
+    rt_uint32_t polls;              /* Meter status looked at */
+    rt_uint32_t own_reads;          /* Polls that asked the service for a read */
+} s8_cal_t;
+
+s8_cal_t *s8_cal_create(s8_sensor_device_t *sensor);
+s8_cal_t *s8_cal_get(s8_sensor_device_t *sensor);
+void s8_cal_destroy(s8_cal_t *cal);
+
+rt_err_t s8_cal_start(s8_cal_t *cal, s8_cal_kind_t kind, rt_uint16_t value);
+rt_err_t s8_cal_abort(s8_cal_t *cal);
+s8_cal_state_t s8_cal_wait(s8_cal_t *cal, rt_int32_t timeout);
+rt_bool_t s8_cal_busy(s8_cal_t *cal);
+const char *s8_cal_state_name(s8_cal_state_t state);
+void s8_cal_dump(s8_cal_t *cal);
+
+/* For the bus scheduler */
+rt_bool_t s8_cal_due(s8_cal_t *cal, rt_tick_t *due);
+void s8_cal_step(s8_cal_t *cal);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* S8_CALIB_H__ */
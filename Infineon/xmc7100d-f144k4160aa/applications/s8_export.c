@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    S8 readings served to a PLC over a Modbus slave endpoint
+ * 2026-10-16     Developer    Latest reading read through the sensor snapshot
+ */
+
+#include "s8_export.h"
+
+/**
+ * Fold the sensor's latest reading into the statistics and publish the register image
+ * Uses only the cached reading: a PLC poll never waits on the sensor bus.
+ */
+void s8_export_refresh(s8_export_t *exporter)
+{
+    s8_sensor_device_t *sensor;
+    s8_sensor_data_t data;
+    rt_uint16_t regs[S8_EXPORT_REG_COUNT];
+    rt_uint32_t age;
+
+    if (!exporter) {
+        return;
+    }
+    sensor = exporter->sensor;
+
+    if (exporter->reset_pending) {
+        exporter->reset_pending = RT_FALSE;
+        exporter->samples = 0;
+        exporter->co2_sum = 0;
+        exporter->last_timestamp = 0;
+    }
+
+    s8_sensor_snapshot(sensor, &data);
+    if (data.data_valid && (exporter->samples == 0 || data.timestamp != exporter->last_timestamp)) {
+        if (exporter->samples == 0 || data.co2_ppm < exporter->co2_min) {
+            exporter->co2_min = data.co2_ppm;
+        }
+        if (exporter->samples == 0 || data.co2_ppm > exporter->co2_max) {
+            exporter->co2_max = data.co2_ppm;
+        }
+        exporter->co2_sum += data.co2_ppm;
+        exporter->samples++;
+        exporter->last_timestamp = data.timestamp;
+    }
+
+    rt_memset(regs, 0, sizeof(regs));
+    if (exporter->samples > 0) {
+        regs[S8_EXPORT_CO2] = data.co2_ppm;
+        regs[S8_EXPORT_CO2_MIN] = exporter->co2_min;
+        regs[S8_EXPORT_CO2_MAX] = exporter->co2_max;
+        regs[S8_EXPORT_CO2_AVG] = (rt_uint16_t)(exporter->co2_sum / exporter->samples);
+    }
+    regs[S8_EXPORT_ALARM] = data.alarm_state;
+    regs[S8_EXPORT_METER_STATUS] = data.meter_status;
+    regs[S8_EXPORT_ALARM_STATUS] = data.alarm_status;
+    regs[S8_EXPORT_SAMPLES_HI] = (rt_uint16_t)(exporter->samples >> 16);
+    regs[S8_EXPORT_SAMPLES_LO] = (rt_uint16_t)(exporter->samples & 0xFFFF);
+
+    if (data.data_valid) {
+        age = (rt_tick_get() - data.timestamp) / RT_TICK_PER_SECOND;
+        regs[S8_EXPORT_AGE] = (age > 0xFFFE) ? 0xFFFE : (rt_uint16_t)age;
+    } else {
+        regs[S8_EXPORT_AGE] = 0xFFFF;
+    }
+    regs[S8_EXPORT_HEALTH] = (rt_uint16_t)sensor->health.state;
+    regs[S8_EXPORT_FAILURES] = sensor->health.consecutive_failures;
+    regs[S8_EXPORT_VALID] = data.data_valid ? 1 : 0;
+
+    modbus_slave_publish(exporter->slave, 0, S8_EXPORT_REG_COUNT, regs);
+}
+
+/**
+ * Soft timer: periodic refresh
+ */
+static void s8_export_timeout(void *parameter)
+{
+    s8_export_refresh((s8_export_t *)parameter);
+}
+
+/**
+ * Serve a sensor's readings as Modbus slave 'slave_addr' on the given UART
+ */
+s8_export_t *s8_export_start(s8_sensor_device_t *sensor, const modbus_bus_config_t *bus,
+                             rt_uint8_t slave_addr)
+{
+    s8_export_t *exporter;
+
+    if (!sensor || !bus) {
+        return RT_NULL;
+    }
+
+    exporter = (s8_export_t *)rt_malloc(sizeof(s8_export_t));
+    if (!exporter) {
+        rt_kprintf("[S8] Error: Failed to allocate export\n");
+        return RT_NULL;
+    }
+    rt_memset(exporter, 0, sizeof(s8_export_t));
+    exporter->sensor = sensor;
+
+    exporter->slave = modbus_slave_start(bus, slave_addr);
+    if (!exporter->slave) {
+        rt_free(exporter);
+        return RT_NULL;
+    }
+
+    exporter->timer = rt_timer_create("s8_exp", s8_export_timeout, exporter,
+                                      rt_tick_from_millisecond(S8_EXPORT_REFRESH_MS),
+                                      RT_TIMER_FLAG_PERIODIC | RT_TIMER_FLAG_SOFT_TIMER);
+    if (!exporter->timer) {
+        rt_kprintf("[S8] Error: Failed to create export timer\n");
+        modbus_slave_stop(exporter->slave);
+        rt_free(exporter);
+        return RT_NULL;
+    }
+
+    /* Valid registers from the first poll on, not one period later */
+    s8_export_refresh(exporter);
+    rt_timer_start(exporter->timer);
+
+    return exporter;
+}
+
+/**
+ * Stop serving and release the UART
+ */
+void s8_export_stop(s8_export_t *exporter)
+{
+    if (!exporter) {
+        return;
+    }
+
+    rt_timer_stop(exporter->timer);
+    rt_timer_delete(exporter->timer);
+    modbus_slave_stop(exporter->slave);
+    rt_free(exporter);
+}
+
+/**
+ * Restart min/max/avg and the sample count at the next refresh
+ */
+void s8_export_reset(s8_export_t *exporter)
+{
+    if (exporter) {
+        exporter->reset_pending = RT_TRUE;
+    }
+}
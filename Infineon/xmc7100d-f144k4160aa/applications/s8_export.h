@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    S8 readings served to a PLC over a Modbus slave endpoint
+ * 2026-10-16     Developer    C linkage when included from C++
+ */
+
+#ifndef S8_EXPORT_H__
+#define S8_EXPORT_H__
+
+#include <rtthread.h>
+#include "modbus_slave.h"
+#include "s8_sensor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* How often the register image follows the sensor's cached reading */
+#ifndef S8_EXPORT_REFRESH_MS
+#define S8_EXPORT_REFRESH_MS    1000
+#endif
+
+/* Default slave address of the export endpoint */
+#ifndef S8_EXPORT_SLAVE_ADDR
+#define S8_EXPORT_SLAVE_ADDR    1
+#endif
+
+/*
+ * Register map, served identically as holding (FC03) and input (FC04)
+ * registers from address 0. Statistics cover the samples seen since start
+ * or the last s8_export_reset().
+ */
+typedef enum {
+    S8_EXPORT_CO2 = 0,          /* Latest CO2, ppm */
+    S8_EXPORT_CO2_MIN,          /* Lowest CO2, ppm */
+    S8_EXPORT_CO2_MAX,          /* Highest CO2, ppm */
+    S8_EXPORT_CO2_AVG,          /* Mean CO2, ppm */
+    S8_EXPORT_ALARM,            /* 1 while the S8 alarm output is active, 0xFF if not wired */
+    S8_EXPORT_METER_STATUS,     /* IR1 as last read */
+    S8_EXPORT_ALARM_STATUS,     /* IR2 as last read */
+    S8_EXPORT_SAMPLES_HI,       /* Sample count, high word */
+    S8_EXPORT_SAMPLES_LO,       /* Sample count, low word */
+    S8_EXPORT_AGE,              /* Seconds since the latest sample, 0xFFFF if none */
+    S8_EXPORT_HEALTH,           /* s8_health_state_t */
+    S8_EXPORT_FAILURES,         /* Consecutive failed polls */
+    S8_EXPORT_VALID,            /* 1 once a reading has been taken */
+    S8_EXPORT_REG_COUNT
+} s8_export_reg_t;
+
+typedef struct {
+    s8_sensor_device_t *sensor;          /* Read from its cached data only */
+    modbus_slave_t *slave;
+    rt_timer_t timer;
+
+    /* Statistics, refresh context only */
+    rt_uint32_t last_timestamp;          /* Sample already counted */
+    rt_uint32_t samples;
+    rt_uint16_t co2_min;
+    rt_uint16_t co2_max;
+    rt_uint64_t co2_sum;
+    volatile rt_bool_t reset_pending;
+} s8_export_t;
+
+s8_export_t *s8_export_start(s8_sensor_device_t *sensor, const modbus_bus_config_t *bus,
+                             rt_uint8_t slave_addr);
+void s8_export_stop(s8_export_t *exporter);
+void s8_export_refresh(s8_export_t *exporter);
+void s8_export_reset(s8_export_t *exporter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* S8_EXPORT_H__ */
@@ -6,17 +6,98 @@
  * Change Logs:
  * Date           Author       Notes
  * 2025-11-21     Developer    MSH commands for S8 CO2 sensor
+ * 2026-10-16     Developer    Report transactions saved by batched reads
+ * 2026-10-16     Developer    Address sensors by slave ID, multi-drop polling
+ * 2026-10-16     Developer    Cadence-tracking mode for s8_poll
+ * 2026-10-16     Developer    Report retries and exception codes
+ * 2026-10-16     Developer    s8_export: serve readings as a Modbus slave
+ * 2026-10-16     Developer    Latest reading read through the sensor snapshot
+ * 2026-10-16     Developer    s8_calibrate runs the calibration state machine
+ * 2026-10-16     Developer    s8_info answers from the kept identity under the sensor lock, refresh re-reads it
+ * 2026-10-16     Developer    Export bus without a driver enable pin
+ * 2026-10-16     Developer    Calibrator comes with the sensor
+ * 2026-10-16     Developer    s8_read and s8_status sampled through the acquisition service
+ * 2026-10-16     Developer    s8_poll works on the schedule of the sensors' bus
  */
 
 #include <rtthread.h>
 #include <rtdevice.h>
 #include "s8_sensor.h"
 #include "modbus_rtu.h"
+#include "s8_poller.h"
+#include "s8_export.h"
+#include "s8_calib.h"
+#include "s8_acquire.h"
+#include <stdlib.h>
+
+/* UART the RS-485 segment is wired to */
+#define S8_MSH_UART     "uart2"
 
 /* Global sensor instance - shared with main.c */
 extern s8_sensor_device_t *g_main_s8_device;
 static s8_sensor_device_t *g_s8_sensor = RT_NULL;
 
+/* Sensors addressed by slave ID, sharing the bus with g_s8_sensor */
+static s8_sensor_device_t *s8_msh_slaves[S8_POLLER_MAX_SLAVES];
+
+/* Modbus slave endpoint serving the default sensor's readings */
+static s8_export_t *s8_msh_export = RT_NULL;
+
+/**
+ * Resolve the optional [slave] argument at argv[index] to a sensor
+ * Without it the default sensor is used; unknown slaves are created on demand.
+ */
+static s8_sensor_device_t *s8_msh_sensor(int argc, char *argv[], int index)
+{
+    unsigned long addr;
+    int i, free_slot = -1;
+
+    /* Auto-detect sensor if not initialized */
+    if (g_s8_sensor == RT_NULL && g_main_s8_device != RT_NULL) {
+        g_s8_sensor = g_main_s8_device;
+        rt_kprintf("[S8] Auto-detected initialized sensor\n");
+    }
+
+    if (argc <= index) {
+        if (g_s8_sensor == RT_NULL) {
+            rt_kprintf("[S8] Error: Sensor not initialized. Use 's8_init' first\n");
+        }
+        return g_s8_sensor;
+    }
+
+    addr = strtoul(argv[index], RT_NULL, 0);
+    if ((addr < 1 || addr > 247) && addr != S8_MODBUS_ADDRESS) {
+        rt_kprintf("[S8] Error: Invalid slave ID '%s' (1-247 or 0xFE)\n", argv[index]);
+        return RT_NULL;
+    }
+
+    if (g_s8_sensor != RT_NULL && g_s8_sensor->slave_addr == addr) {
+        return g_s8_sensor;
+    }
+
+    for (i = 0; i < S8_POLLER_MAX_SLAVES; i++) {
+        if (s8_msh_slaves[i] == RT_NULL) {
+            if (free_slot < 0) {
+                free_slot = i;
+            }
+        } else if (s8_msh_slaves[i]->slave_addr == addr) {
+            return s8_msh_slaves[i];
+        }
+    }
+
+    if (free_slot < 0) {
+        rt_kprintf("[S8] Error: Already tracking %d slaves\n", S8_POLLER_MAX_SLAVES);
+        return RT_NULL;
+    }
+
+    s8_msh_slaves[free_slot] = s8_sensor_init_slave(S8_MSH_UART, (rt_uint8_t)addr);
+    if (s8_msh_slaves[free_slot] == RT_NULL) {
+        rt_kprintf("[S8] Error: Failed to initialize slave 0x%02X\n", (unsigned int)addr);
+    }
+
+    return s8_msh_slaves[free_slot];
+}
+
 /**
  * Show help information
  */
@@ -24,20 +105,28 @@ static void s8_help(void)
 {
     rt_kprintf("S8 CO2 Sensor Commands:\n");
     rt_kprintf("  s8_init               - Initialize S8 sensor\n");
-    rt_kprintf("  s8_read               - Read CO2 concentration\n");
-    rt_kprintf("  s8_status             - Read sensor status\n");
+    rt_kprintf("  s8_read [slave]       - Read CO2 concentration\n");
+    rt_kprintf("  s8_status [slave]     - Read sensor status\n");
     rt_kprintf("  s8_monitor [interval]  - Start continuous monitoring\n");
     rt_kprintf("  s8_stop               - Stop continuous monitoring\n");
-    rt_kprintf("  s8_calibrate          - Start zero calibration\n");
+    rt_kprintf("  s8_calibrate [kind]   - Calibrate: zero/background/point <ppm>, or status/abort\n");
     rt_kprintf("  s8_reset              - Reset sensor\n");
-    rt_kprintf("  s8_info               - Show sensor information\n");
+    rt_kprintf("  s8_info [slave] [refresh] - Show sensor information\n");
+    rt_kprintf("  s8_poll <cmd> ...     - Multi-drop polling (add/remove/start/stop/list)\n");
+    rt_kprintf("  s8_export <cmd> ...   - Serve readings to a PLC (start/stop/show/reset)\n");
     rt_kprintf("  s8_help               - Show this help\n");
     rt_kprintf("\nExamples:\n");
     rt_kprintf("  s8_init              # Initialize sensor\n");
     rt_kprintf("  s8_read              # Read CO2 value\n");
+    rt_kprintf("  s8_read 3            # Read CO2 from slave 3\n");
+    rt_kprintf("  s8_poll add 3 2000   # Poll slave 3 every 2 seconds\n");
+    rt_kprintf("  s8_poll add 4 track  # Poll slave 4 just after each measurement\n");
+    rt_kprintf("  s8_export start uart4 1 19200  # PLC polls slave 1 on uart4\n");
     rt_kprintf("  s8_monitor 3000      # Start monitoring every 3 seconds\n");
     rt_kprintf("  s8_stop              # Stop monitoring\n");
-    rt_kprintf("  s8_calibrate         # Start calibration\n");
+    rt_kprintf("  s8_calibrate         # Start zero calibration\n");
+    rt_kprintf("  s8_calibrate point 420 wait  # Single point, wait for the result\n");
+    rt_kprintf("  s8_info 3 refresh    # Read slave 3's identity again\n");
 }
 
 /**
@@ -69,63 +158,60 @@ static void s8_init(int argc, char *argv[])
 
 /**
  * Read CO2 concentration
+ * Usage: s8_read [slave]
  */
 static void s8_read(int argc, char *argv[])
 {
-    rt_uint16_t co2_ppm;
+    s8_sample_t sample;
     s8_status_t result;
+    s8_sensor_device_t *sensor;
 
-    RT_UNUSED(argc);
-    RT_UNUSED(argv);
-
-    /* Auto-detect sensor if not initialized */
-    if (g_s8_sensor == RT_NULL && g_main_s8_device != RT_NULL) {
-        g_s8_sensor = g_main_s8_device;
-        rt_kprintf("[S8] Auto-detected initialized sensor\n");
-    }
-
-    if (g_s8_sensor == RT_NULL) {
-        rt_kprintf("[S8] Error: Sensor not initialized. Use 's8_init' first\n");
+    sensor = s8_msh_sensor(argc, argv, 1);
+    if (sensor == RT_NULL) {
         return;
     }
 
-    result = s8_read_co2_data(g_s8_sensor);
+    result = s8_acquire_sample(s8_acquire_get(sensor), &sample,
+                               rt_tick_from_millisecond(S8_ACQUIRE_SAMPLE_WAIT_MS));
     if (result == S8_STATUS_OK) {
-        co2_ppm = g_s8_sensor->data.co2_ppm;
-        rt_kprintf("[S8] CO2 Concentration: %d ppm\n", co2_ppm);
+        rt_kprintf("[S8] CO2 Concentration: %d ppm\n", sample.data.co2_ppm);
+        rt_kprintf("[S8] Batched read saved %d transactions (%d since init)\n",
+                   sensor->plan_saved, sensor->plan_saved_total);
+    } else if (result == S8_STATUS_EXCEPTION) {
+        rt_kprintf("[S8] Failed to read CO2: exception 0x%02X\n", sensor->health.last_exception);
     } else {
         rt_kprintf("[S8] Failed to read CO2: %d\n", result);
     }
+    if (sensor->last_retries > 0) {
+        rt_kprintf("[S8] Read needed %d retries (%d since init)\n",
+                   sensor->last_retries, sensor->health.retries);
+    }
 }
 
 /**
  * Read sensor status
+ * Usage: s8_status [slave]
  */
 static void s8_status(int argc, char *argv[])
 {
     rt_uint16_t status;
+    s8_sample_t sample;
     s8_status_t result;
+    s8_sensor_device_t *sensor;
 
-    RT_UNUSED(argc);
-    RT_UNUSED(argv);
-
-    /* Auto-detect sensor if not initialized */
-    if (g_s8_sensor == RT_NULL && g_main_s8_device != RT_NULL) {
-        g_s8_sensor = g_main_s8_device;
-        rt_kprintf("[S8] Auto-detected initialized sensor\n");
-    }
-
-    if (g_s8_sensor == RT_NULL) {
-        rt_kprintf("[S8] Error: Sensor not initialized. Use 's8_init' first\n");
+    sensor = s8_msh_sensor(argc, argv, 1);
+    if (sensor == RT_NULL) {
         return;
     }
 
-    result = s8_read_status(g_s8_sensor, &status);
+    result = s8_acquire_sample(s8_acquire_get(sensor), &sample,
+                               rt_tick_from_millisecond(S8_ACQUIRE_SAMPLE_WAIT_MS));
     if (result == S8_STATUS_OK) {
+        status = sample.data.meter_status;
         rt_kprintf("[S8] Status Register: 0x%04X\n", status);
         
         /* Decode status bits */
-        if (status & 0x0001) {
+        if (status & S8_METER_STATUS_CAL_ONGOING) {
             rt_kprintf("  - Calibration ongoing\n");
         }
         if (status & 0x0002) {
@@ -158,14 +244,16 @@ static void s8_status(int argc, char *argv[])
 }
 
 /**
- * Start zero calibration
+ * Start a calibration, follow it or abort it
+ * Usage: s8_calibrate [zero|background|point <ppm>] [wait] | status | abort
  */
 static void s8_calibrate(int argc, char *argv[])
 {
-    s8_status_t result;
-
-    RT_UNUSED(argc);
-    RT_UNUSED(argv);
+    s8_cal_kind_t kind = S8_CAL_ZERO;
+    rt_uint16_t ppm = 0;
+    rt_bool_t wait;
+    s8_cal_t *cal;
+    rt_err_t result;
 
     /* Auto-detect sensor if not initialized */
     if (g_s8_sensor == RT_NULL && g_main_s8_device != RT_NULL) {
@@ -178,15 +266,53 @@ static void s8_calibrate(int argc, char *argv[])
         return;
     }
 
-    rt_kprintf("[S8] Starting zero calibration (this may take several minutes)...\n");
-    
-    result = s8_zero_calibration(g_s8_sensor);
-    if (result == S8_STATUS_OK) {
-        rt_kprintf("[S8] Zero calibration started successfully\n");
-        rt_kprintf("[S8] Please wait for calibration to complete...\n");
-    } else {
+    cal = s8_cal_get(g_s8_sensor);
+    if (cal == RT_NULL) {
+        rt_kprintf("[S8] Error: Sensor has no calibrator\n");
+        return;
+    }
+
+    if (argc > 1 && rt_strcmp(argv[1], "status") == 0) {
+        s8_cal_dump(cal);
+        return;
+    }
+    if (argc > 1 && rt_strcmp(argv[1], "abort") == 0) {
+        if (s8_cal_abort(cal) != RT_EOK) {
+            rt_kprintf("[S8] No calibration in progress\n");
+            return;
+        }
+        rt_kprintf("[S8] Calibration %s\n", s8_cal_state_name(s8_cal_wait(cal, RT_WAITING_FOREVER)));
+        return;
+    }
+
+    if (argc > 1 && rt_strcmp(argv[1], "background") == 0) {
+        kind = S8_CAL_BACKGROUND;
+    } else if (argc > 2 && rt_strcmp(argv[1], "point") == 0) {
+        kind = S8_CAL_SINGLE_POINT;
+        ppm = atoi(argv[2]);
+    } else if (argc > 1 && rt_strcmp(argv[1], "zero") != 0 && rt_strcmp(argv[1], "wait") != 0) {
+        rt_kprintf("Usage: s8_calibrate [zero|background|point <ppm>] [wait] | status | abort\n");
+        return;
+    }
+    wait = rt_strcmp(argv[argc - 1], "wait") == 0;
+
+    result = s8_cal_start(cal, kind, ppm);
+    if (result == -RT_EBUSY) {
+        rt_kprintf("[S8] A calibration is already in progress\n");
+        s8_cal_dump(cal);
+        return;
+    }
+    if (result != RT_EOK) {
         rt_kprintf("[S8] Failed to start calibration: %d\n", result);
+        return;
+    }
+
+    if (!wait) {
+        rt_kprintf("[S8] Running in the background; 's8_calibrate status' shows progress\n");
+        return;
     }
+    rt_kprintf("[S8] Calibration %s\n", s8_cal_state_name(s8_cal_wait(cal, RT_WAITING_FOREVER)));
+    s8_cal_dump(cal);
 }
 
 /**
@@ -298,38 +424,155 @@ static void s8_stop(int argc, char *argv[])
 
 /**
  * Show sensor information
+ * Usage: s8_info [slave] [refresh]
  */
 static void s8_info(int argc, char *argv[])
 {
     s8_sensor_info_t info;
     s8_status_t result;
-
-    RT_UNUSED(argc);
-    RT_UNUSED(argv);
-
-    /* Auto-detect sensor if not initialized */
-    if (g_s8_sensor == RT_NULL && g_main_s8_device != RT_NULL) {
-        g_s8_sensor = g_main_s8_device;
-        rt_kprintf("[S8] Auto-detected initialized sensor\n");
+    s8_sensor_device_t *sensor;
+    rt_bool_t refresh = RT_FALSE;
+    rt_tick_t age;
+    rt_uint32_t reads;
+
+    if (argc > 1 && rt_strcmp(argv[argc - 1], "refresh") == 0) {
+        refresh = RT_TRUE;
+        argc--;
     }
 
-    if (g_s8_sensor == RT_NULL) {
-        rt_kprintf("[S8] Error: Sensor not initialized. Use 's8_init' first\n");
+    sensor = s8_msh_sensor(argc, argv, 1);
+    if (sensor == RT_NULL) {
         return;
     }
 
-    result = s8_read_sensor_info(g_s8_sensor, &info);
+    if (refresh) {
+        result = s8_refresh_sensor_info(sensor, &info);
+    } else {
+        result = s8_read_sensor_info(sensor, &info);
+    }
     if (result == S8_STATUS_OK) {
         rt_kprintf("[S8] Sensor Information:\n");
         rt_kprintf("  Type: 0x%04X\n", info.sensor_type);
         rt_kprintf("  Firmware Version: %d.%d\n", 
                    (info.firmware_version >> 8) & 0xFF, 
                    info.firmware_version & 0xFF);
+        rt_mutex_take(sensor->lock, RT_WAITING_FOREVER);
+        age = rt_tick_get() - sensor->info_tick;
+        reads = sensor->info_reads;
+        rt_mutex_release(sensor->lock);
+        rt_kprintf("  Read from the sensor %d ms ago (%d reads since init)\n",
+                   age * 1000 / RT_TICK_PER_SECOND, reads);
     } else {
         rt_kprintf("[S8] Failed to read sensor info: %d\n", result);
     }
 }
 
+/**
+ * Multi-drop polling of several sensors on the bus
+ * The schedule is the one of the bus the shell's sensors share.
+ * Usage: s8_poll add <slave> [interval_ms|track] | remove <slave> | start | stop | list
+ */
+static void s8_poll(int argc, char *argv[])
+{
+    s8_sensor_device_t *sensor;
+    s8_poller_t *poller;
+    rt_uint32_t interval_ms = 5000;
+    rt_err_t result;
+
+    if (argc < 2) {
+        rt_kprintf("Usage: s8_poll add <slave> [interval_ms|track] | remove <slave> | start | stop | list\n");
+        return;
+    }
+
+    sensor = s8_msh_sensor(argc, argv, 2);
+    poller = s8_poller_get(sensor);
+    if (poller == RT_NULL) {
+        return;
+    }
+
+    if (rt_strcmp(argv[1], "add") == 0 && argc >= 3) {
+        if (argc > 3) {
+            interval_ms = (rt_strcmp(argv[3], "track") == 0) ? S8_POLL_TRACK : atoi(argv[3]);
+        }
+        result = s8_poller_add(poller, sensor, interval_ms);
+        if (result == RT_EOK && interval_ms == S8_POLL_TRACK) {
+            rt_kprintf("[S8] Polling slave 0x%02X after each measurement\n", sensor->slave_addr);
+        } else if (result == RT_EOK) {
+            rt_kprintf("[S8] Polling slave 0x%02X every %d ms\n", sensor->slave_addr, interval_ms);
+        } else {
+            rt_kprintf("[S8] Failed to add slave: %d\n", result);
+        }
+    } else if (rt_strcmp(argv[1], "remove") == 0 && argc >= 3) {
+        result = s8_poller_remove(poller, sensor);
+        rt_kprintf("[S8] Slave 0x%02X %s\n", sensor->slave_addr,
+                   result == RT_EOK ? "removed" : "was not scheduled");
+    } else if (rt_strcmp(argv[1], "start") == 0) {
+        result = s8_poller_start(poller);
+        if (result == RT_EOK) {
+            rt_kprintf("[S8] Polling started\n");
+        } else if (result == -RT_EBUSY) {
+            rt_kprintf("[S8] Polling already running\n");
+        } else {
+            rt_kprintf("[S8] Failed to start polling: %d\n", result);
+        }
+    } else if (rt_strcmp(argv[1], "stop") == 0) {
+        s8_poller_stop(poller);
+        rt_kprintf("[S8] Polling stopped\n");
+    } else if (rt_strcmp(argv[1], "list") == 0) {
+        s8_poller_dump(poller);
+    } else {
+        rt_kprintf("Usage: s8_poll add <slave> [interval_ms|track] | remove <slave> | start | stop | list\n");
+    }
+}
+
+/**
+ * Serve the default sensor's readings as a Modbus RTU slave
+ * Usage: s8_export start <uart> [slave] [baud] | stop | show | reset
+ */
+static void s8_export(int argc, char *argv[])
+{
+    modbus_bus_config_t bus = {RT_NULL, 0, 0, MODBUS_DE_NONE, 0};
+    s8_sensor_device_t *sensor;
+    rt_uint8_t slave_addr = S8_EXPORT_SLAVE_ADDR;
+
+    if (argc >= 3 && rt_strcmp(argv[1], "start") == 0) {
+        if (s8_msh_export != RT_NULL) {
+            rt_kprintf("[S8] Export already running, use 's8_export stop' first\n");
+            return;
+        }
+        sensor = s8_msh_sensor(argc, argv, argc);
+        if (sensor == RT_NULL) {
+            return;
+        }
+        bus.uart_name = argv[2];
+        if (argc > 3) {
+            slave_addr = (rt_uint8_t)strtoul(argv[3], RT_NULL, 0);
+        }
+        if (argc > 4) {
+            bus.baud_rate = strtoul(argv[4], RT_NULL, 0);
+        }
+        s8_msh_export = s8_export_start(sensor, &bus, slave_addr);
+        if (s8_msh_export != RT_NULL) {
+            rt_kprintf("[S8] Serving slave 0x%02X readings as slave %d on %s, registers 0-%d\n",
+                       sensor->slave_addr, slave_addr, argv[2], S8_EXPORT_REG_COUNT - 1);
+        }
+    } else if (argc >= 2 && rt_strcmp(argv[1], "stop") == 0) {
+        s8_export_stop(s8_msh_export);
+        s8_msh_export = RT_NULL;
+        rt_kprintf("[S8] Export stopped\n");
+    } else if (argc >= 2 && rt_strcmp(argv[1], "show") == 0) {
+        if (s8_msh_export == RT_NULL) {
+            rt_kprintf("[S8] Export not running\n");
+            return;
+        }
+        modbus_slave_dump(s8_msh_export->slave);
+    } else if (argc >= 2 && rt_strcmp(argv[1], "reset") == 0) {
+        s8_export_reset(s8_msh_export);
+    } else {
+        rt_kprintf("Usage: s8_export start <uart> [slave] [baud] | stop | show | reset\n");
+    }
+}
+
 /**
  * Initialize S8 MSH commands
  */
@@ -353,9 +596,11 @@ MSH_CMD_EXPORT(s8_read, Read CO2 concentration);
 MSH_CMD_EXPORT(s8_status, Read sensor status);
 MSH_CMD_EXPORT(s8_monitor, Start continuous monitoring);
 MSH_CMD_EXPORT(s8_stop, Stop continuous monitoring);
-MSH_CMD_EXPORT(s8_calibrate, Start zero calibration);
+MSH_CMD_EXPORT(s8_calibrate, Calibrate the sensor and follow it to completion);
 MSH_CMD_EXPORT(s8_reset, Reset sensor);
 MSH_CMD_EXPORT(s8_info, Show sensor information);
+MSH_CMD_EXPORT(s8_poll, Poll several sensors on one RS-485 bus);
+MSH_CMD_EXPORT(s8_export, Serve readings to a PLC as a Modbus slave);
 MSH_CMD_EXPORT(s8_help, Show S8 sensor command help);
 
 /* Auto-initialization - use lower priority to run after main() */
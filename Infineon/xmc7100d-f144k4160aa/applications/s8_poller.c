@@ -0,0 +1,574 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Multi-drop S8 polling scheduler
+ * 2026-10-16     Developer    Cadence-tracking poll mode
+ * 2026-10-16     Developer    Latest reading read through the sensor snapshot
+ * 2026-10-16     Developer    One scheduler per bus runs the acquisition services' reads
+ * 2026-10-16     Developer    Calibrations stepped by the scheduler
+ */
+
+#include "s8_poller.h"
+#include "s8_calib.h"
+
+/* Schedulers of the buses that have sensors, one per Modbus device */
+static s8_poller_t *s8_pollers = RT_NULL;
+
+/* Serialises finding or creating a scheduler against its last sensor leaving */
+static rt_mutex_t s8_poller_list_lock;
+
+/**
+ * Create the scheduler list lock before any thread can set up a sensor
+ */
+static int s8_poller_list_init(void)
+{
+    s8_poller_list_lock = rt_mutex_create("s8_plist", RT_IPC_FLAG_PRIO);
+    if (!s8_poller_list_lock) {
+        rt_kprintf("[S8] Error: Failed to create the scheduler list lock\n");
+        return -RT_ENOMEM;
+    }
+
+    return RT_EOK;
+}
+INIT_COMPONENT_EXPORT(s8_poller_list_init);
+
+/**
+ * Whether an entry's samples are paced by the sensor rather than its interval
+ */
+static rt_bool_t s8_poller_tracked(s8_poll_entry_t *entry)
+{
+    return entry->interval_tick <= rt_tick_from_millisecond(S8_MEASUREMENT_PERIOD_MS);
+}
+
+/**
+ * One sample for a scheduled slave, from its acquisition service
+ * Runs in the scheduler thread, which holds poller->lock meanwhile.
+ */
+static void s8_poller_sample(void *context, const s8_sample_t *sample)
+{
+    s8_poll_entry_t *entry = (s8_poll_entry_t *)context;
+    rt_tick_t lateness = 0;
+
+    if ((rt_int32_t)(sample->start - entry->next_due) > 0) {
+        lateness = sample->start - entry->next_due;
+    }
+
+    entry->polls++;
+    if (sample->status == S8_STATUS_OK) {
+        entry->samples++;
+        s8_cadence_observe(&entry->cadence, sample->start, sample->end,
+                           sample->data.co2_ppm, sample->data.meter_status);
+    }
+
+    if (lateness > entry->max_lateness) {
+        entry->max_lateness = lateness;
+    }
+    if (s8_poller_tracked(entry)) {
+        entry->next_due = (sample->status == S8_STATUS_OK) ?
+                          s8_cadence_next(&entry->cadence, sample->end) :
+                          sample->end + rt_tick_from_millisecond(S8_CADENCE_RETRY_MS);
+    } else if (lateness >= entry->interval_tick) {
+        /* Fell a whole period behind: count it and resync */
+        entry->late++;
+        entry->next_due = sample->start + entry->interval_tick;
+    } else {
+        entry->next_due += entry->interval_tick;
+    }
+}
+
+/**
+ * Subscribe an entry to its sensor's acquisition service
+ * Call with poller->lock held.
+ */
+static rt_err_t s8_poller_subscribe(s8_poll_entry_t *entry)
+{
+    rt_uint32_t interval_ms = S8_MEASUREMENT_PERIOD_MS;
+
+    if (entry->interval_tick != S8_POLL_TRACK) {
+        interval_ms = entry->interval_tick * 1000 / RT_TICK_PER_SECOND;
+    }
+
+    entry->next_due = rt_tick_get();
+    entry->subscriber = s8_acquire_subscribe(s8_acquire_get(entry->sensor), interval_ms,
+                                             s8_poller_sample, entry);
+    return entry->subscriber ? RT_EOK : -RT_EFULL;
+}
+
+/**
+ * End an entry's subscription, call with poller->lock held
+ * Samples are handed out with the lock held, so none is on its way.
+ */
+static void s8_poller_unsubscribe(s8_poll_entry_t *entry)
+{
+    if (entry->subscriber) {
+        s8_acquire_unsubscribe(s8_acquire_get(entry->sensor), entry->subscriber);
+        entry->subscriber = RT_NULL;
+    }
+}
+
+/**
+ * Find a sensor's entry, call with poller->lock held
+ */
+static s8_poll_entry_t *s8_poller_find(s8_poller_t *poller, s8_sensor_device_t *sensor)
+{
+    rt_uint8_t i;
+
+    for (i = 0; i < S8_POLLER_MAX_SLAVES; i++) {
+        if (poller->entries[i].sensor == sensor) {
+            return &poller->entries[i];
+        }
+    }
+
+    return RT_NULL;
+}
+
+/**
+ * Pick the service due soonest, scanning round-robin so ties rotate
+ * Call with poller->lock held. Returns -1 when no service wants the bus;
+ * calibrate is set when the work due is a calibration step.
+ */
+static int s8_poller_pick(s8_poller_t *poller, rt_tick_t *due, rt_bool_t *calibrate)
+{
+    s8_poll_entry_t *entry;
+    rt_bool_t urgent;
+    rt_tick_t when;
+    int best = -1;
+    rt_uint8_t n, i;
+
+    for (n = 0; n < S8_POLLER_MAX_SLAVES; n++) {
+        i = (poller->next_rr + n) % S8_POLLER_MAX_SLAVES;
+        entry = &poller->entries[i];
+        if (!entry->sensor) {
+            continue;
+        }
+        if (s8_acquire_due(s8_acquire_get(entry->sensor), &when, &urgent)) {
+            if (entry->held && !urgent && (rt_int32_t)(entry->held_until - when) > 0) {
+                when = entry->held_until;
+            }
+            if (best < 0 || (rt_int32_t)(when - *due) < 0) {
+                best = i;
+                *due = when;
+                *calibrate = RT_FALSE;
+            }
+        }
+        /* A calibration step goes after a read due at the same time */
+        if (s8_cal_due(s8_cal_get(entry->sensor), &when) &&
+            (best < 0 || (rt_int32_t)(when - *due) < 0)) {
+            best = i;
+            *due = when;
+            *calibrate = RT_TRUE;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * Scheduler thread: the only reader of the sensors on its bus
+ */
+static void s8_poller_thread_entry(void *parameter)
+{
+    s8_poller_t *poller = (s8_poller_t *)parameter;
+    s8_poll_entry_t *entry;
+    rt_tick_t due, start, end;
+    rt_bool_t calibrate;
+    rt_int32_t wait;
+    int index;
+
+    while (poller->running) {
+        rt_mutex_take(poller->lock, RT_WAITING_FOREVER);
+        index = s8_poller_pick(poller, &due, &calibrate);
+        if (index < 0) {
+            rt_mutex_release(poller->lock);
+            rt_sem_take(poller->wake, RT_TICK_PER_SECOND);
+            continue;
+        }
+
+        wait = (rt_int32_t)(due - rt_tick_get());
+        if (wait > 0) {
+            /* Bus idle until the next service is due, unless demand changes */
+            rt_mutex_release(poller->lock);
+            rt_sem_take(poller->wake, wait);
+            continue;
+        }
+
+        /* Hold the lock across the work so the sensor cannot leave meanwhile */
+        entry = &poller->entries[index];
+        poller->next_rr = (index + 1) % S8_POLLER_MAX_SLAVES;
+        start = rt_tick_get();
+        if (calibrate) {
+            s8_cal_step(s8_cal_get(entry->sensor));
+            poller->busy_ticks += rt_tick_get() - start;
+            rt_mutex_release(poller->lock);
+            continue;
+        }
+        s8_acquire_run(s8_acquire_get(entry->sensor));
+        end = rt_tick_get();
+        poller->reads++;
+        poller->busy_ticks += end - start;
+
+        entry->held = entry->sensor->health.state == S8_HEALTH_OFFLINE;
+        if (entry->held) {
+            entry->held_until = end + rt_tick_from_millisecond(S8_MEASUREMENT_PERIOD_MS) *
+                                S8_POLLER_OFFLINE_BACKOFF;
+        }
+        rt_mutex_release(poller->lock);
+    }
+
+    rt_sem_release(poller->exit_sem);
+}
+
+/**
+ * Stop a scheduler's thread and free it
+ */
+static void s8_poller_destroy(s8_poller_t *poller)
+{
+    if (poller->running) {
+        poller->running = RT_FALSE;
+        rt_sem_release(poller->wake);
+        rt_sem_take(poller->exit_sem, RT_WAITING_FOREVER);
+    }
+
+    if (poller->exit_sem) {
+        rt_sem_delete(poller->exit_sem);
+    }
+    if (poller->wake) {
+        rt_sem_delete(poller->wake);
+    }
+    if (poller->lock) {
+        rt_mutex_delete(poller->lock);
+    }
+    rt_free(poller);
+}
+
+/**
+ * Start the scheduler of a bus, with no sensors yet
+ */
+static s8_poller_t *s8_poller_create(modbus_rtu_device_t *modbus)
+{
+    s8_poller_t *poller;
+
+    poller = (s8_poller_t *)rt_malloc(sizeof(s8_poller_t));
+    if (!poller) {
+        return RT_NULL;
+    }
+
+    rt_memset(poller, 0, sizeof(s8_poller_t));
+    poller->modbus = modbus;
+    rt_snprintf(poller->name, sizeof(poller->name), "s8p_%s", modbus->serial->parent.parent.name);
+    poller->lock = rt_mutex_create("s8_poll", RT_IPC_FLAG_FIFO);
+    poller->wake = rt_sem_create("s8_wake", 0, RT_IPC_FLAG_FIFO);
+    poller->exit_sem = rt_sem_create("s8_pexit", 0, RT_IPC_FLAG_FIFO);
+    poller->thread = rt_thread_create(poller->name,
+                                      s8_poller_thread_entry,
+                                      poller,
+                                      1536,
+                                      S8_POLLER_THREAD_PRIORITY,
+                                      10);
+    if (!poller->lock || !poller->wake || !poller->exit_sem || !poller->thread) {
+        if (poller->thread) {
+            rt_thread_delete(poller->thread);
+        }
+        s8_poller_destroy(poller);
+        return RT_NULL;
+    }
+
+    poller->running = RT_TRUE;
+    rt_thread_startup(poller->thread);
+    return poller;
+}
+
+/**
+ * Put a sensor under the scheduler of its bus, starting it for the first
+ * Called once while the sensor is set up, after its acquisition service.
+ */
+rt_err_t s8_poller_join(s8_sensor_device_t *sensor)
+{
+    s8_poll_entry_t *entry;
+    s8_poller_t *poller;
+    rt_err_t result = RT_EOK;
+
+    if (!sensor || !sensor->modbus || !s8_acquire_get(sensor) || !s8_poller_list_lock) {
+        return -RT_ERROR;
+    }
+
+    rt_mutex_take(s8_poller_list_lock, RT_WAITING_FOREVER);
+    for (poller = s8_pollers; poller; poller = poller->next) {
+        if (poller->modbus == sensor->modbus) {
+            break;
+        }
+    }
+    if (!poller) {
+        poller = s8_poller_create(sensor->modbus);
+        if (!poller) {
+            rt_mutex_release(s8_poller_list_lock);
+            return -RT_ENOMEM;
+        }
+        poller->next = s8_pollers;
+        s8_pollers = poller;
+    }
+
+    rt_mutex_take(poller->lock, RT_WAITING_FOREVER);
+    entry = s8_poller_find(poller, RT_NULL);
+    if (entry) {
+        rt_memset(entry, 0, sizeof(s8_poll_entry_t));
+        entry->sensor = sensor;
+        sensor->poller = poller;
+        poller->count++;
+    } else {
+        result = -RT_EFULL;
+    }
+    rt_mutex_release(poller->lock);
+    rt_mutex_release(s8_poller_list_lock);
+
+    return result;
+}
+
+/**
+ * Take a sensor off its bus scheduler, stopping it after the last
+ * A read of the sensor in progress completes first.
+ */
+void s8_poller_leave(s8_sensor_device_t *sensor)
+{
+    s8_poll_entry_t *entry;
+    s8_poller_t *poller, **link;
+    rt_bool_t empty;
+
+    if (!sensor || !sensor->poller) {
+        return;
+    }
+
+    rt_mutex_take(s8_poller_list_lock, RT_WAITING_FOREVER);
+    poller = sensor->poller;
+    rt_mutex_take(poller->lock, RT_WAITING_FOREVER);
+    entry = s8_poller_find(poller, sensor);
+    if (entry) {
+        s8_poller_unsubscribe(entry);
+        rt_memset(entry, 0, sizeof(s8_poll_entry_t));
+        poller->count--;
+    }
+    sensor->poller = RT_NULL;
+    empty = poller->count == 0;
+    rt_mutex_release(poller->lock);
+
+    if (empty) {
+        for (link = &s8_pollers; *link; link = &(*link)->next) {
+            if (*link == poller) {
+                *link = poller->next;
+                break;
+            }
+        }
+        s8_poller_destroy(poller);
+    }
+    rt_mutex_release(s8_poller_list_lock);
+}
+
+/**
+ * The scheduler of a sensor's bus
+ */
+s8_poller_t *s8_poller_get(s8_sensor_device_t *sensor)
+{
+    return sensor ? sensor->poller : RT_NULL;
+}
+
+/**
+ * Have the scheduler look at its services again
+ * Called by a service whose demand went up; any thread.
+ */
+void s8_poller_wake(s8_poller_t *poller)
+{
+    if (poller) {
+        rt_sem_release(poller->wake);
+    }
+}
+
+/**
+ * Schedule a sensor on the bus every interval_ms, or change its interval
+ * S8_POLL_TRACK follows the sensor's measurement cycle instead. New slaves
+ * are due immediately.
+ */
+rt_err_t s8_poller_add(s8_poller_t *poller, s8_sensor_device_t *sensor, rt_uint32_t interval_ms)
+{
+    s8_poll_entry_t *entry;
+    rt_err_t result = RT_EOK;
+
+    if (!poller || !sensor || sensor->poller != poller) {
+        return -RT_ERROR;
+    }
+
+    rt_mutex_take(poller->lock, RT_WAITING_FOREVER);
+    entry = s8_poller_find(poller, sensor);
+    if (!entry) {
+        rt_mutex_release(poller->lock);
+        return -RT_ERROR;
+    }
+    if (!entry->scheduled) {
+        entry->scheduled = RT_TRUE;
+        entry->polls = 0;
+        entry->samples = 0;
+        entry->late = 0;
+        entry->max_lateness = 0;
+        s8_cadence_init(&entry->cadence, S8_MEASUREMENT_PERIOD_MS);
+    }
+
+    s8_poller_unsubscribe(entry);
+    entry->interval_tick = rt_tick_from_millisecond(interval_ms);
+    if (poller->started) {
+        result = s8_poller_subscribe(entry);
+    }
+    rt_mutex_release(poller->lock);
+
+    return result;
+}
+
+/**
+ * Take a sensor off the schedule; its service still serves its other subscribers
+ */
+rt_err_t s8_poller_remove(s8_poller_t *poller, s8_sensor_device_t *sensor)
+{
+    s8_poll_entry_t *entry;
+    rt_err_t result = -RT_EEMPTY;
+
+    if (!poller || !sensor) {
+        return -RT_ERROR;
+    }
+
+    rt_mutex_take(poller->lock, RT_WAITING_FOREVER);
+    entry = s8_poller_find(poller, sensor);
+    if (entry && entry->scheduled) {
+        s8_poller_unsubscribe(entry);
+        entry->scheduled = RT_FALSE;
+        result = RT_EOK;
+    }
+    rt_mutex_release(poller->lock);
+
+    return result;
+}
+
+/**
+ * Subscribe every scheduled slave to its acquisition service
+ */
+rt_err_t s8_poller_start(s8_poller_t *poller)
+{
+    s8_poll_entry_t *entry;
+    rt_err_t result = RT_EOK;
+    rt_uint8_t i;
+
+    if (!poller) {
+        return -RT_ERROR;
+    }
+
+    rt_mutex_take(poller->lock, RT_WAITING_FOREVER);
+    if (poller->started) {
+        rt_mutex_release(poller->lock);
+        return -RT_EBUSY;
+    }
+
+    poller->start_tick = rt_tick_get();
+    poller->busy_ticks = 0;
+    poller->reads = 0;
+    poller->started = RT_TRUE;
+    for (i = 0; i < S8_POLLER_MAX_SLAVES && result == RT_EOK; i++) {
+        entry = &poller->entries[i];
+        if (entry->sensor && entry->scheduled) {
+            entry->polls = 0;
+            entry->samples = 0;
+            result = s8_poller_subscribe(entry);
+        }
+    }
+    rt_mutex_release(poller->lock);
+
+    if (result != RT_EOK) {
+        s8_poller_stop(poller);
+    }
+    return result;
+}
+
+/**
+ * End every subscription of the schedule
+ * The services keep serving their other subscribers.
+ */
+rt_err_t s8_poller_stop(s8_poller_t *poller)
+{
+    rt_uint8_t i;
+
+    if (!poller) {
+        return -RT_ERROR;
+    }
+
+    rt_mutex_take(poller->lock, RT_WAITING_FOREVER);
+    poller->started = RT_FALSE;
+    for (i = 0; i < S8_POLLER_MAX_SLAVES; i++) {
+        if (poller->entries[i].sensor) {
+            s8_poller_unsubscribe(&poller->entries[i]);
+        }
+    }
+    rt_mutex_release(poller->lock);
+
+    return RT_EOK;
+}
+
+/**
+ * Print the schedule, per-slave health and bus throughput
+ * Dup% counts samples that returned the same measurement as the one before;
+ * AvgAge is the mean upper bound on how old a new measurement was when read.
+ * Busy counts every read the scheduler made, for any subscriber.
+ */
+void s8_poller_dump(s8_poller_t *poller)
+{
+    rt_uint32_t samples = 0;
+    s8_poll_entry_t *entry;
+    s8_cadence_t *cadence;
+    s8_sensor_data_t data;
+    char interval[12];
+    rt_tick_t elapsed;
+    rt_uint8_t i;
+
+    if (!poller) {
+        return;
+    }
+
+    rt_mutex_take(poller->lock, RT_WAITING_FOREVER);
+    rt_kprintf("Slave  Interval  Samples  Late  MaxLate  Dup%%  AvgAge  Health    Fails  CO2\n");
+    for (i = 0; i < S8_POLLER_MAX_SLAVES; i++) {
+        entry = &poller->entries[i];
+        if (!entry->sensor || !entry->scheduled) {
+            continue;
+        }
+        cadence = &entry->cadence;
+        s8_sensor_snapshot(entry->sensor, &data);
+        if (entry->interval_tick == S8_POLL_TRACK) {
+            rt_snprintf(interval, sizeof(interval), "track");
+        } else {
+            rt_snprintf(interval, sizeof(interval), "%d ms",
+                        entry->interval_tick * 1000 / RT_TICK_PER_SECOND);
+        }
+        rt_kprintf("0x%02X   %8s  %7d  %4d  %4d ms  %3d%%  %3d ms  %-8s  %5d  %d\n",
+                   entry->sensor->slave_addr,
+                   interval,
+                   entry->samples,
+                   entry->late,
+                   entry->max_lateness * 1000 / RT_TICK_PER_SECOND,
+                   cadence->reads ? cadence->duplicates * 100 / cadence->reads : 0,
+                   cadence->age_count ? cadence->age_sum / cadence->age_count * 1000 / RT_TICK_PER_SECOND : 0,
+                   s8_health_name(entry->sensor->health.state),
+                   entry->sensor->health.fail_count,
+                   data.co2_ppm);
+        samples += entry->samples;
+    }
+
+    elapsed = rt_tick_get() - poller->start_tick;
+    if (poller->started && elapsed > 0) {
+        rt_kprintf("Bus: %d samples/s, %d%% busy (%d reads of %d sensors in %d ms)\n",
+                   samples * RT_TICK_PER_SECOND / elapsed,
+                   poller->busy_ticks * 100 / elapsed,
+                   poller->reads,
+                   poller->count,
+                   elapsed * 1000 / RT_TICK_PER_SECOND);
+    }
+    rt_mutex_release(poller->lock);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Multi-drop S8 polling scheduler
+ * 2026-10-16     Developer    Cadence-tracking poll mode
+ * 2026-10-16     Developer    C linkage when included from C++
+ * 2026-10-16     Developer    One scheduler per bus runs the acquisition services' reads
+ * 2026-10-16     Developer    Calibrations stepped by the scheduler
+ */
+
+#ifndef S8_POLLER_H__
+#define S8_POLLER_H__
+
+#include <rtthread.h>
+#include "s8_sensor.h"
+#include "s8_cadence.h"
+#include "s8_acquire.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define S8_POLLER_MAX_SLAVES        16      /* Sensors per RS-485 segment */
+#define S8_POLLER_OFFLINE_BACKOFF   4       /* Offline slaves read once per this many measurement periods */
+#define S8_POLLER_THREAD_PRIORITY   18      /* Below the bus thread and the shell */
+
+/* Interval that follows the sensor's own measurement cycle instead of a timer */
+#define S8_POLL_TRACK               0
+
+/* One slave on the bus */
+typedef struct {
+    s8_sensor_device_t *sensor;     /* RT_NULL while the slot is free */
+    rt_bool_t held;                 /* Offline: not read again before held_until... */
+    rt_tick_t held_until;           /* ...unless a one-off reader waits on it */
+
+    /* Its schedule, from s8_poller_add() */
+    rt_bool_t scheduled;
+    s8_subscriber_t *subscriber;    /* Its subscription while the poller runs */
+    rt_tick_t interval_tick;        /* Target poll period, 0 = S8_POLL_TRACK */
+    rt_tick_t next_due;             /* Tick the next sample is expected */
+    rt_uint32_t polls;              /* Samples received, failed reads included */
+    rt_uint32_t samples;            /* Successful polls */
+    rt_uint32_t late;               /* Samples that came a whole interval behind */
+    rt_tick_t max_lateness;         /* Worst read start past next_due */
+    s8_cadence_t cadence;           /* Update phase and sample freshness, kept in both modes */
+} s8_poll_entry_t;
+
+/*
+ * Earliest-due-first scheduler for the sensors on one bus, and the only
+ * thread that reads them. Every sensor joins the scheduler of its bus when
+ * it is set up; the scheduler asks each sensor's acquisition service when
+ * it is next due and runs that service's read, and steps a calibration in
+ * progress the same way, so neither needs a thread of its own. Services
+ * due together are served round-robin, offline slaves are held back, and
+ * the bus goes idle only when no service is due.
+ *
+ * On top, the sensors put on the schedule with s8_poller_add() are sampled
+ * at their interval while the poller runs: each is then a subscriber of its
+ * own service, and the poller keeps the per-slave statistics. Intervals up
+ * to S8_MEASUREMENT_PERIOD_MS, and S8_POLL_TRACK, follow the sensor's
+ * measurement cycle.
+ */
+typedef struct s8_poller {
+    char name[RT_NAME_MAX];         /* Thread name, after the bus's UART */
+    modbus_rtu_device_t *modbus;    /* The bus */
+    s8_poll_entry_t entries[S8_POLLER_MAX_SLAVES];
+    rt_uint8_t count;               /* Sensors on the bus */
+    rt_uint8_t next_rr;             /* Tie-break start for the next pick */
+    rt_mutex_t lock;                /* Protects entries, held across each read */
+    rt_sem_t wake;                  /* A service's demand changed */
+    rt_sem_t exit_sem;
+    rt_thread_t thread;
+    volatile rt_bool_t running;     /* Scheduler thread */
+    rt_bool_t started;              /* Schedule subscribed, see s8_poller_start() */
+    struct s8_poller *next;         /* Scheduler of another bus */
+
+    /* Statistics since start */
+    rt_tick_t start_tick;
+    rt_tick_t busy_ticks;           /* Time the reads spent on the bus */
+    rt_uint32_t reads;
+} s8_poller_t;
+
+/* Bus membership, from sensor setup and teardown */
+rt_err_t s8_poller_join(s8_sensor_device_t *sensor);
+void s8_poller_leave(s8_sensor_device_t *sensor);
+s8_poller_t *s8_poller_get(s8_sensor_device_t *sensor);
+void s8_poller_wake(s8_poller_t *poller);
+
+/* Schedule */
+rt_err_t s8_poller_add(s8_poller_t *poller, s8_sensor_device_t *sensor, rt_uint32_t interval_ms);
+rt_err_t s8_poller_remove(s8_poller_t *poller, s8_sensor_device_t *sensor);
+rt_err_t s8_poller_start(s8_poller_t *poller);
+rt_err_t s8_poller_stop(s8_poller_t *poller);
+void s8_poller_dump(s8_poller_t *poller);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* S8_POLLER_H__ */
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    S8 register map and fixed query frames
+ * 2026-10-16     Developer    Query extents checked against the batch planner at init
+ */
+
+#include "s8_regmap.h"
+#include "modbus_plan.h"
+
+/* CRC of every fixed query, evaluated by the compiler */
+#define S8_QUERY_CRC(name, first, count) \
+    MODBUS_FRAME_CRC(s8_query_##name, S8_MODBUS_ADDRESS, S8_REG_FUNC_##first, S8_REG_##first, count);
+S8_QUERY_MAP(S8_QUERY_CRC)
+#undef S8_QUERY_CRC
+
+/* Request frames in flash, written to the line as they are */
+#define S8_QUERY_FRAME(name, first, count) \
+    MODBUS_FRAME_BYTES(s8_query_##name, S8_MODBUS_ADDRESS, S8_REG_FUNC_##first, S8_REG_##first, count),
+const modbus_frame_t s8_query_frames[S8_QUERY_COUNT] = {
+    S8_QUERY_MAP(S8_QUERY_FRAME)
+};
+#undef S8_QUERY_FRAME
+
+rt_uint8_t s8_query_saved[S8_QUERY_COUNT];
+
+/**
+ * Compare a query's extent with the plan for the registers it is read for
+ * Records the transactions the plan saves when they agree.
+ */
+static rt_err_t s8_query_check(modbus_plan_t *plan, s8_query_t query, const char *name,
+                               rt_uint16_t first, rt_uint16_t count)
+{
+    if (modbus_plan_build(plan) != RT_EOK || plan->span_count != 1 ||
+        plan->spans[0].start != first || plan->spans[0].count != count) {
+        rt_kprintf("[S8] Error: query %s reads %d registers from 0x%04X, the planner %d spans from 0x%04X\n",
+                   name, count, first, plan->span_count, plan->spans[0].start);
+        return -RT_ERROR;
+    }
+
+    s8_query_saved[query] = plan->saved;
+    return RT_EOK;
+}
+
+/**
+ * Plan every fixed query from its wanted registers under S8_PLAN_MAX_GAP
+ * A query map the planner would not produce fails the assertion; in a build
+ * without RT_DEBUG the query still runs but reports no saving.
+ */
+static int s8_regmap_plan(void)
+{
+    modbus_plan_t plan;
+    rt_uint16_t value;
+    rt_err_t result = RT_EOK;
+
+#define S8_PLAN_WANT(reg)   modbus_plan_add(&plan, S8_REG_##reg, &value);
+#define S8_QUERY_PLAN(name, first, count) \
+    modbus_plan_init(&plan, S8_PLAN_MAX_GAP); \
+    S8_QUERY_WANTS_##name(S8_PLAN_WANT) \
+    if (s8_query_check(&plan, S8_QUERY_##name, #name, S8_REG_##first, count) != RT_EOK) { \
+        result = -RT_ERROR; \
+    }
+    S8_QUERY_MAP(S8_QUERY_PLAN)
+#undef S8_QUERY_PLAN
+#undef S8_PLAN_WANT
+
+    RT_ASSERT(result == RT_EOK);
+    return result;
+}
+INIT_COMPONENT_EXPORT(s8_regmap_plan);
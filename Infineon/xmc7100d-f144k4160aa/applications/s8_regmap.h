@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    S8 register map and fixed query frames
+ * 2026-10-16     Developer    Query extents checked against the batch planner at init
+ */
+
+#ifndef S8_REGMAP_H__
+#define S8_REGMAP_H__
+
+#include <rtthread.h>
+#include "modbus_rtu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * S8 registers: X(name, function code, address)
+ * Input registers IRn sit at address n - 1.
+ */
+#define S8_REGISTER_MAP(X) \
+    X(METER_STATUS,      MODBUS_FUNC_READ_INPUT_REGS,   0x0000)   /* Meter status (IR1) */ \
+    X(ALARM_STATUS,      MODBUS_FUNC_READ_INPUT_REGS,   0x0001)   /* Alarm status (IR2) */ \
+    X(OUTPUT_STATUS,     MODBUS_FUNC_READ_INPUT_REGS,   0x0002)   /* Output status (IR3) */ \
+    X(CO2_CONCENTRATION, MODBUS_FUNC_READ_INPUT_REGS,   0x0003)   /* CO2 concentration (IR4) */ \
+    X(SENSOR_TYPE_HIGH,  MODBUS_FUNC_READ_INPUT_REGS,   0x0019)   /* Sensor type ID high (IR26) */ \
+    X(SENSOR_TYPE_LOW,   MODBUS_FUNC_READ_INPUT_REGS,   0x001A)   /* Sensor type ID low (IR27) */ \
+    X(MEMORY_MAP,        MODBUS_FUNC_READ_INPUT_REGS,   0x001B)   /* Memory map version (IR28) */ \
+    X(FIRMWARE_VERSION,  MODBUS_FUNC_READ_INPUT_REGS,   0x001C)   /* Firmware version (IR29) */ \
+    X(SINGLE_POINT_CAL,  MODBUS_FUNC_READ_HOLDING_REGS, 0x0010)   /* Single point calibration */ \
+    X(BACKGROUND_CAL,    MODBUS_FUNC_READ_HOLDING_REGS, 0x0011)   /* Background calibration */ \
+    X(ZERO_CAL,          MODBUS_FUNC_READ_HOLDING_REGS, 0x0012)   /* Zero calibration */ \
+    X(AUTO_CAL,          MODBUS_FUNC_READ_HOLDING_REGS, 0x0013)   /* Auto calibration */ \
+    X(ALARM_THRESHOLD,   MODBUS_FUNC_READ_HOLDING_REGS, 0x0014)   /* Alarm threshold */
+
+/*
+ * Fixed reads: X(name, first register, register count)
+ * Each becomes a request frame for the 0xFE address with its CRC computed
+ * at compile time. S8_QUERY_WANTS_<name> lists the registers it is read
+ * for; at init the batch planner merges them and must arrive at the same
+ * extent, and what it saves is what the query reports.
+ */
+#define S8_QUERY_MAP(X) \
+    X(CYCLE, METER_STATUS,     4) \
+    X(INFO,  SENSOR_TYPE_HIGH, 4)
+
+#define S8_QUERY_WANTS_CYCLE(X) \
+    X(METER_STATUS) X(ALARM_STATUS) X(CO2_CONCENTRATION)
+#define S8_QUERY_WANTS_INFO(X) \
+    X(SENSOR_TYPE_HIGH) X(SENSOR_TYPE_LOW) X(FIRMWARE_VERSION)
+
+/* Unwanted registers the planner may read to join two wanted ones */
+#ifndef S8_PLAN_MAX_GAP
+#define S8_PLAN_MAX_GAP     2
+#endif
+
+/*
+ * S8_REG_<name>: register address, S8_REG_FUNC_<name>: function code that reads it
+ * S8_QUERY_FIRST_<name>, S8_QUERY_REGS_<name>: compile-time query extent
+ */
+#define S8_REGMAP_ADDR(name, func, addr) \
+    S8_REG_##name = (addr), S8_REG_FUNC_##name = (func),
+#define S8_QUERY_EXTENT(name, first, count) \
+    S8_QUERY_FIRST_##name = S8_REG_##first, S8_QUERY_REGS_##name = (count),
+enum {
+    S8_REGISTER_MAP(S8_REGMAP_ADDR)
+    S8_QUERY_MAP(S8_QUERY_EXTENT)
+    S8_REGMAP_END
+};
+#undef S8_REGMAP_ADDR
+#undef S8_QUERY_EXTENT
+
+/* S8_QUERY_<name>: index into the query tables */
+#define S8_QUERY_ID(name, first, count)     S8_QUERY_##name,
+typedef enum {
+    S8_QUERY_MAP(S8_QUERY_ID)
+    S8_QUERY_COUNT
+} s8_query_t;
+#undef S8_QUERY_ID
+
+extern const modbus_frame_t s8_query_frames[S8_QUERY_COUNT];     /* For S8_MODBUS_ADDRESS */
+extern rt_uint8_t s8_query_saved[S8_QUERY_COUNT];               /* Set at init by the planner */
+
+/*
+ * Value of register S8_REG_<reg> in the reply to S8_QUERY_<query>. The
+ * offset is a constant, and a register outside the query fails to compile.
+ */
+#define S8_QUERY_VALUE(values, query, reg) \
+    ((values)[S8_REG_##reg - S8_QUERY_FIRST_##query + \
+              0 * sizeof(char[(S8_REG_##reg >= S8_QUERY_FIRST_##query && \
+                               S8_REG_##reg < S8_QUERY_FIRST_##query + S8_QUERY_REGS_##query) ? 1 : -1])])
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* S8_REGMAP_H__ */
@@ -6,71 +6,207 @@
  * Change Logs:
  * Date           Author       Notes
  * 2025-11-21     Developer    S8 CO2 sensor driver
+ * 2026-10-16     Developer    Batched IR1-IR4 cycle read and info read, saving reported from the planner
+ * 2026-10-16     Developer    Per-slave instances for multi-drop buses, health and retry counts under the sensor lock
+ * 2026-10-16     Developer    Sensors on table-driven buses
+ * 2026-10-16     Developer    Cache TTLs for measurement and info registers
+ * 2026-10-16     Developer    Uncached measurement read for cadence tracking
+ * 2026-10-16     Developer    Fixed reads from the register map with prebuilt frames
+ * 2026-10-16     Developer    Exception status and retry counts from the Modbus layer
+ * 2026-10-16     Developer    Register writes confirmed by the sensor's echo
+ * 2026-10-16     Developer    Calibration and alarm writes queued as urgent
+ * 2026-10-16     Developer    R/T pin configured with the UART2 bus and switched by the UART around each request
+ * 2026-10-16     Developer    One shared instance per sensor, on its bus's scheduler from attach
+ * 2026-10-16     Developer    Latest reading published under a sequence count with the scheduler locked
+ * 2026-10-16     Developer    Alarm state from the board's alarm input, reported for the sensor wired to it only
+ * 2026-10-16     Developer    Verified holding register writes, calibrator created at attach and dropped on detach
+ * 2026-10-16     Developer    Sensor identity kept under the sensor lock until re-init, refresh or a long silence
  */
 
 #include "s8_sensor.h"
+#include "s8_acquire.h"
+#include "s8_poller.h"
+#include "s8_alarm.h"
+#include "s8_calib.h"
+#include "board.h"
 #include "drv_gpio.h"
 
+/* Orders the data copy against its sequence count, for compiler and core */
+#ifndef S8_DATA_BARRIER
+#define S8_DATA_BARRIER()   __DMB()
+#endif
+
 /* Global sensor device for MSH commands */
 static s8_sensor_device_t *g_s8_device = RT_NULL;
 
-/* Monitor thread function */
-static void s8_monitor_thread_entry(void *parameter)
+/* Sensor instances, one per bus and slave address */
+static s8_sensor_device_t *s8_sensor_table[S8_SENSOR_MAX];
+
+/* Serialises finding or creating a sensor against the last reference going */
+static rt_mutex_t s8_sensor_lock;
+
+static s8_sensor_device_t* s8_sensor_attach(modbus_rtu_device_t *modbus, rt_uint8_t slave_addr);
+
+/* Monitor output, called by the acquisition service */
+static void s8_monitor_sample(void *context, const s8_sample_t *sample)
 {
-    s8_sensor_device_t *device = (s8_sensor_device_t *)parameter;
-    s8_status_t result;
-    
-    
-    while (device->running) {
-        result = s8_read_co2_data(device);
-        
-        if (result == S8_STATUS_OK) {
-            rt_kprintf("[S8] CO2: %d ppm\n", device->data.co2_ppm);
-        } else {
-            rt_kprintf("[S8] Read error: %d\n", result);
-        }
-        
-        /* Use time-slicing approach for better MSH responsiveness */
-        for (int i = 0; i < (device->read_interval_ms / 50) && device->running; i++) {
-            rt_thread_mdelay(50);   /* 50ms short delay */
-            rt_thread_yield();       /* Yield CPU to allow MSH thread to run */
-        }
+    RT_UNUSED(context);
+
+    if (sample->status == S8_STATUS_OK) {
+        rt_kprintf("[S8] CO2: %d ppm\n", sample->data.co2_ppm);
+    } else {
+        rt_kprintf("[S8] Read error: %d\n", sample->status);
     }
-    
 }
 
 /**
  * Initialize S8 sensor device
+ * Uses the 0xFE "any sensor" address, for a sensor alone on its bus.
  */
 s8_sensor_device_t* s8_sensor_init(const char *uart_name)
 {
-    s8_sensor_device_t *device;
+    return s8_sensor_init_slave(uart_name, S8_MODBUS_ADDRESS);
+}
+
+/**
+ * Initialize S8 sensor device at a specific slave address
+ * Sensors on the same UART share one Modbus device and bus thread. UART2
+ * is the S8 connector: 9600-8N1 with its R/T line as driver enable.
+ */
+s8_sensor_device_t* s8_sensor_init_slave(const char *uart_name, rt_uint8_t slave_addr)
+{
+    modbus_bus_config_t bus = {RT_NULL, 0, 0, MODBUS_DE_NONE, 0};
 
     if (!uart_name) {
         return RT_NULL;
     }
 
+    bus.uart_name = uart_name;
+    if (rt_strcmp(uart_name, "uart2") == 0) {
+        bus.baud_rate = 9600;
+        bus.de_pin = S8_UART_RXT_PIN;
+        bus.de_tx_level = S8_UART_RXT_TX_LEVEL;
+    }
+
+    return s8_sensor_init_bus(&bus, slave_addr);
+}
+
+/**
+ * Create the sensor table lock before any thread can set up a sensor
+ */
+static int s8_sensor_lock_init(void)
+{
+    s8_sensor_lock = rt_mutex_create("s8_tab", RT_IPC_FLAG_PRIO);
+    if (!s8_sensor_lock) {
+        rt_kprintf("[S8] Error: Failed to create the sensor table lock\n");
+        return -RT_ENOMEM;
+    }
+
+    return RT_EOK;
+}
+INIT_COMPONENT_EXPORT(s8_sensor_lock_init);
+
+/**
+ * Initialize S8 sensor device on a bus from the bus table
+ * A sensor already set up on the same bus and address is shared, not
+ * duplicated: its acquisition service stays the only reader of it. Each
+ * init is matched by one s8_sensor_deinit().
+ */
+s8_sensor_device_t* s8_sensor_init_bus(const modbus_bus_config_t *bus, rt_uint8_t slave_addr)
+{
+    s8_sensor_device_t *device = RT_NULL;
+    modbus_rtu_device_t *modbus;
+    int slot, free_slot = -1;
+
+    if (!bus || !s8_sensor_lock) {
+        return RT_NULL;
+    }
+
+    modbus = modbus_rtu_init_config(bus);
+    if (!modbus) {
+        return RT_NULL;
+    }
+
+    rt_mutex_take(s8_sensor_lock, RT_WAITING_FOREVER);
+    for (slot = 0; slot < S8_SENSOR_MAX; slot++) {
+        if (s8_sensor_table[slot] && s8_sensor_table[slot]->modbus == modbus &&
+            s8_sensor_table[slot]->slave_addr == slave_addr) {
+            device = s8_sensor_table[slot];
+            break;
+        }
+        if (free_slot < 0 && !s8_sensor_table[slot]) {
+            free_slot = slot;
+        }
+    }
+
+    if (device) {
+        /* The instance holds its own bus reference */
+        device->refcount++;
+        modbus_rtu_deinit(modbus);
+
+        /* A re-init may follow a sensor swap: no identity from before it is trusted */
+        s8_invalidate_sensor_info(device);
+    } else if (free_slot < 0) {
+        rt_kprintf("[S8] Error: No room for slave 0x%02X, %d sensors set up\n", slave_addr, S8_SENSOR_MAX);
+        modbus_rtu_deinit(modbus);
+    } else {
+        device = s8_sensor_attach(modbus, slave_addr);
+        s8_sensor_table[free_slot] = device;
+    }
+    rt_mutex_release(s8_sensor_lock);
+
+    return device;
+}
+
+/**
+ * Wrap a Modbus bus reference in a sensor instance
+ * Takes over the reference, and drops it on failure.
+ */
+static s8_sensor_device_t* s8_sensor_attach(modbus_rtu_device_t *modbus, rt_uint8_t slave_addr)
+{
+    s8_sensor_device_t *device;
+
+    if (!modbus) {
+        return RT_NULL;
+    }
+
     device = (s8_sensor_device_t*)rt_malloc(sizeof(s8_sensor_device_t));
     if (!device) {
+        modbus_rtu_deinit(modbus);
         return RT_NULL;
     }
 
     rt_memset(device, 0, sizeof(s8_sensor_device_t));
-
-    /* Initialize Modbus RTU device */
-    device->modbus = modbus_rtu_init(uart_name);
-    if (!device->modbus) {
+    device->slave_addr = slave_addr;
+    device->refcount = 1;
+    device->modbus = modbus;
+    device->alarm_wired = slave_addr == S8_ALARM_SLAVE &&
+                          rt_strncmp(modbus->serial->parent.parent.name, S8_ALARM_UART, RT_NAME_MAX) == 0;
+    device->lock = rt_mutex_create("s8_dev", RT_IPC_FLAG_PRIO);
+    if (!device->lock) {
         rt_free(device);
+        modbus_rtu_deinit(modbus);
         return RT_NULL;
     }
 
-    /* Initialize GPIO pins */
-    rt_pin_mode(S8_ALARM_PIN, PIN_MODE_INPUT);
-    rt_pin_mode(S8_UART_RXT_PIN, PIN_MODE_OUTPUT);
+    /* Readers polling faster than the sensor refreshes share one bus read */
+    modbus_cache_set_any_address(modbus, S8_MODBUS_ADDRESS);
+    if (S8_MEASUREMENT_TTL_MS > 0) {
+        modbus_cache_set_ttl(modbus, S8_REG_FUNC_METER_STATUS,
+                             S8_QUERY_FIRST_CYCLE, S8_QUERY_REGS_CYCLE, S8_MEASUREMENT_TTL_MS);
+    }
+    if (S8_INFO_TTL_MS > 0) {
+        modbus_cache_set_ttl(modbus, S8_REG_FUNC_SENSOR_TYPE_HIGH,
+                             S8_QUERY_FIRST_INFO, S8_QUERY_REGS_INFO, S8_INFO_TTL_MS);
+    }
+
+    /* A re-init may follow a sensor swap: no identity from before it is trusted */
+    s8_invalidate_sensor_info(device);
+
+    /* Initialize GPIO pins; the alarm line is watched by the board's alarm input */
     rt_pin_mode(S8_BCAL_PIN, PIN_MODE_OUTPUT);
 
     /* Set initial GPIO states */
-    rt_pin_write(S8_UART_RXT_PIN, PIN_HIGH);  /* Enable receive mode */
     rt_pin_write(S8_BCAL_PIN, PIN_LOW);       /* Normal operation */
 
     /* Initialize data structure */
@@ -82,62 +218,274 @@ s8_sensor_device_t* s8_sensor_init(const char *uart_name)
     device->running = RT_FALSE;
     device->read_interval_ms = 5000;  /* Default 5 seconds */
 
+    /* Its one reader, on its bus's scheduler, and its calibrator exist before anyone can reach the sensor */
+    device->acquire = s8_acquire_create(device);
+    device->cal = s8_cal_create(device);
+    if (!device->acquire || !device->cal || s8_poller_join(device) != RT_EOK) {
+        rt_kprintf("[S8] Slave 0x%02X: no room for its services\n", slave_addr);
+        s8_sensor_deinit(device);
+        return RT_NULL;
+    }
+
     return device;
 }
 
 /**
  * Deinitialize S8 sensor device
+ * Drops one reference; the last one takes it off its bus scheduler and frees it.
  */
 rt_err_t s8_sensor_deinit(s8_sensor_device_t *device)
 {
+    int slot;
+
     if (!device) {
         return -RT_ERROR;
     }
 
-    /* Stop monitoring if running */
+    /* Held until the sensor has left the table, so nobody shares it on the way out */
+    rt_mutex_take(s8_sensor_lock, RT_WAITING_FOREVER);
+    if (--device->refcount > 0) {
+        rt_mutex_release(s8_sensor_lock);
+        return RT_EOK;
+    }
+    for (slot = 0; slot < S8_SENSOR_MAX; slot++) {
+        if (s8_sensor_table[slot] == device) {
+            s8_sensor_table[slot] = RT_NULL;
+        }
+    }
+    rt_mutex_release(s8_sensor_lock);
+
+    /* Stop monitoring, the reads and calibration steps, then drop the services */
     s8_stop_monitoring(device);
+    s8_poller_leave(device);
+    s8_cal_destroy(device->cal);
+    s8_acquire_destroy(device->acquire);
 
     /* Deinitialize Modbus device */
     if (device->modbus) {
         modbus_rtu_deinit(device->modbus);
     }
 
+    rt_mutex_delete(device->lock);
     rt_free(device);
     return RT_EOK;
 }
 
+/**
+ * Record the outcome of a cycle read
+ * The acquisition service, the calibrator and the shell all read the
+ * sensor, so the counters and state change under device->lock.
+ */
+static void s8_health_update(s8_sensor_device_t *device, s8_status_t status)
+{
+    s8_health_t *health = &device->health;
+    rt_tick_t heard;
+    rt_bool_t known;
+
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    health->last_error = status;
+    if (status == S8_STATUS_OK) {
+        health->ok_count++;
+        health->consecutive_failures = 0;
+        health->last_ok_tick = rt_tick_get();
+        health->state = S8_HEALTH_ONLINE;
+        rt_mutex_release(device->lock);
+        return;
+    }
+
+    health->fail_count++;
+    health->consecutive_failures++;
+    if (health->consecutive_failures >= S8_OFFLINE_FAILURES) {
+        health->state = S8_HEALTH_OFFLINE;
+    } else if (health->state != S8_HEALTH_OFFLINE) {
+        health->state = S8_HEALTH_DEGRADED;
+    }
+    heard = health->last_ok_tick;
+    if ((rt_int32_t)(device->info_tick - heard) > 0) {
+        heard = device->info_tick;
+    }
+    known = device->info_valid;
+    rt_mutex_release(device->lock);
+
+    /* Silent long enough to have been power cycled or swapped */
+    if (known && rt_tick_get() - heard >= rt_tick_from_millisecond(S8_IDENTITY_LOSS_MS)) {
+        rt_kprintf("[S8] Slave 0x%02X silent for %d ms, identity will be read again\n",
+                   device->slave_addr, (rt_tick_get() - heard) * 1000 / RT_TICK_PER_SECOND);
+        s8_invalidate_sensor_info(device);
+    }
+}
+
+/**
+ * Request frame of a fixed query for this sensor's address
+ * 0xFE frames come straight from flash; other addresses get theirs built once.
+ */
+static const modbus_frame_t *s8_query_frame(s8_sensor_device_t *device, s8_query_t query)
+{
+    const modbus_frame_t *base = &s8_query_frames[query];
+    modbus_frame_t *frame = &device->frames[query];
+
+    if (device->slave_addr == S8_MODBUS_ADDRESS) {
+        return base;
+    }
+
+    if (frame->bytes[0] != device->slave_addr) {
+        modbus_frame_build(frame, device->slave_addr, base->bytes[1],
+                           (base->bytes[2] << 8) | base->bytes[3],
+                           (base->bytes[4] << 8) | base->bytes[5]);
+    }
+    return frame;
+}
+
+/**
+ * Final outcome of a transaction as an S8 status
+ * Also accounts for the re-sends it needed.
+ */
+static s8_status_t s8_txn_status(s8_sensor_device_t *device, modbus_txn_t *txn, rt_err_t result)
+{
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    device->last_retries = txn->retries;
+    device->health.retries += txn->retries;
+    if (result != RT_EOK && txn->exception != 0) {
+        device->health.last_exception = txn->exception;
+    }
+    rt_mutex_release(device->lock);
+
+    if (result == RT_EOK) {
+        return S8_STATUS_OK;
+    }
+    if (txn->exception != 0) {
+        return S8_STATUS_EXCEPTION;
+    }
+    if (result == -RT_ETIMEOUT) {
+        return S8_STATUS_TIMEOUT;
+    }
+    if (result == -RT_EIO || result == -RT_EINVAL) {
+        return S8_STATUS_INVALID_DATA;
+    }
+    return S8_STATUS_ERROR;
+}
+
+/**
+ * Run a fixed query under the bus retry policy
+ * Accounts for the re-sends it needed and the transactions it saves.
+ */
+static s8_status_t s8_query(s8_sensor_device_t *device, s8_query_t query, rt_uint16_t *values)
+{
+    modbus_txn_t txn;
+    s8_status_t status;
+
+    modbus_txn_from_frame(&txn, s8_query_frame(device, query), values);
+    status = s8_txn_status(device, &txn, modbus_transact(device->modbus, &txn));
+    if (status == S8_STATUS_OK) {
+        /* A reply from the cache put nothing on the bus, so batching saved nothing */
+        device->plan_saved = txn.cached ? 0 : s8_query_saved[query];
+        device->plan_saved_total += device->plan_saved;
+    }
+
+    return status;
+}
+
+/**
+ * Whether a holding register keeps the value written to it
+ * The calibration registers are commands: the sensor acts on them and may
+ * clear them, so only the echo and the meter status say they were taken.
+ */
+static rt_bool_t s8_reg_keeps_value(rt_uint16_t reg_addr)
+{
+    return reg_addr != S8_REG_ZERO_CAL && reg_addr != S8_REG_BACKGROUND_CAL &&
+           reg_addr != S8_REG_SINGLE_POINT_CAL;
+}
+
+/**
+ * Write one holding register, reading settings back
+ * Calibration and alarm settings go ahead of any queued polling. The
+ * echo only shows the request arrived; for a setting, the read-back shows
+ * the sensor kept the value. A mismatch is S8_STATUS_INVALID_DATA.
+ */
+static s8_status_t s8_write(s8_sensor_device_t *device, rt_uint16_t reg_addr, rt_uint16_t value)
+{
+    modbus_txn_t txn;
+    rt_uint16_t stored;
+    s8_status_t status;
+
+    rt_memset(&txn, 0, sizeof(txn));
+    txn.slave_addr = device->slave_addr;
+    txn.function_code = MODBUS_FUNC_WRITE_SINGLE_REG;
+    txn.start_addr = reg_addr;
+    txn.reg_count = value;
+    txn.priority = MODBUS_PRIO_URGENT;
+
+    status = s8_txn_status(device, &txn, modbus_transact(device->modbus, &txn));
+    if (status != S8_STATUS_OK || !s8_reg_keeps_value(reg_addr)) {
+        return status;
+    }
+
+    rt_memset(&txn, 0, sizeof(txn));
+    txn.slave_addr = device->slave_addr;
+    txn.function_code = MODBUS_FUNC_READ_HOLDING_REGS;
+    txn.start_addr = reg_addr;
+    txn.reg_count = 1;
+    txn.values = &stored;
+    txn.priority = MODBUS_PRIO_URGENT;
+
+    status = s8_txn_status(device, &txn, modbus_transact(device->modbus, &txn));
+    if (status == S8_STATUS_OK && stored != value) {
+        rt_kprintf("[S8] Register 0x%04X reads back 0x%04X, wrote 0x%04X\n", reg_addr, stored, value);
+        return S8_STATUS_INVALID_DATA;
+    }
+    return status;
+}
+
 /**
  * Read CO2 data from S8 sensor
+ * Meter status, alarm status and CO2 come from one IR1-IR4 read. The
+ * status is the final outcome after Modbus retries; device->last_retries
+ * says how many re-sends it took.
  */
 s8_status_t s8_read_co2_data(s8_sensor_device_t *device)
 {
-    rt_uint16_t co2_value;
-    rt_err_t result;
+    rt_uint16_t values[S8_QUERY_REGS_CYCLE];
+    s8_sensor_data_t data;
+    s8_status_t status;
 
     if (!device || !device->modbus) {
         return S8_STATUS_NOT_INITIALIZED;
     }
 
-    /* Read CO2 concentration from input register 0x0003 using broadcast address 0xFE */
-    result = modbus_read_input_registers(device->modbus,
-                                          0xFE,     /* Broadcast address */
-                                          S8_REG_CO2_CONCENTRATION,
-                                          1,         /* Read 1 register */
-                                          &co2_value);
-
-    if (result != RT_EOK) {
-        return (result == -RT_ETIMEOUT) ? S8_STATUS_TIMEOUT : S8_STATUS_ERROR;
+    /* Read input registers from this sensor's slave address */
+    status = s8_query(device, S8_QUERY_CYCLE, values);
+    s8_health_update(device, status);
+    if (status != S8_STATUS_OK) {
+        return status;
     }
 
     /* Update sensor data */
-    device->data.co2_ppm = co2_value;
-    device->data.alarm_state = s8_get_alarm_state(device);
-    device->data.timestamp = rt_tick_get();
-    device->data.data_valid = RT_TRUE;
+    data.co2_ppm = S8_QUERY_VALUE(values, CYCLE, CO2_CONCENTRATION);
+    data.meter_status = S8_QUERY_VALUE(values, CYCLE, METER_STATUS);
+    data.alarm_status = S8_QUERY_VALUE(values, CYCLE, ALARM_STATUS);
+    data.alarm_state = s8_get_alarm_state(device);
+    data.timestamp = rt_tick_get();
+    data.data_valid = RT_TRUE;
+    s8_sensor_publish(device, &data);
 
     return S8_STATUS_OK;
 }
 
+/**
+ * Read CO2 data from the sensor itself, never from the Modbus cache
+ * For callers that time their reads against the measurement cycle.
+ */
+s8_status_t s8_refresh_co2_data(s8_sensor_device_t *device)
+{
+    if (!device || !device->modbus) {
+        return S8_STATUS_NOT_INITIALIZED;
+    }
+
+    modbus_cache_expire(device->modbus, device->slave_addr, S8_REG_FUNC_METER_STATUS,
+                        S8_QUERY_FIRST_CYCLE, S8_QUERY_REGS_CYCLE);
+    return s8_read_co2_data(device);
+}
+
 /**
  * Read all sensor data (CO2 only)
  */
@@ -156,89 +504,114 @@ s8_status_t s8_read_all_data(s8_sensor_device_t *device, s8_sensor_data_t *data)
     }
 
     /* Copy to output */
-    *data = device->data;
+    s8_sensor_snapshot(device, data);
 
-    rt_kprintf("[S8] All data - CO2: %d ppm\n", device->data.co2_ppm);
+    rt_kprintf("[S8] All data - CO2: %d ppm\n", data->co2_ppm);
 
     return S8_STATUS_OK;
 }
 
 /**
  * Read sensor information
+ * Answered from the device once read: IR26, IR27 and IR29 are fetched as
+ * one batched read the first time, and again only after the identity was
+ * invalidated (re-init, S8_IDENTITY_LOSS_MS of silence, or a refresh).
+ * The kept identity changes under device->lock.
  */
 s8_status_t s8_read_sensor_info(s8_sensor_device_t *device, s8_sensor_info_t *info)
 {
+    rt_uint16_t values[S8_QUERY_REGS_INFO];
     rt_uint16_t type_high, type_low, firmware;
-    rt_err_t result;
+    s8_status_t status;
 
     if (!device || !device->modbus || !info) {
         return S8_STATUS_NOT_INITIALIZED;
     }
 
-    /* Read sensor type ID high (IR26) */
-    result = modbus_read_input_registers(device->modbus,
-                                          0xFE,
-                                          S8_REG_SENSOR_TYPE_HIGH,
-                                          1,
-                                          &type_high);
-    if (result != RT_EOK) {
-        return (result == -RT_ETIMEOUT) ? S8_STATUS_TIMEOUT : S8_STATUS_ERROR;
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    if (device->info_valid) {
+        *info = device->info;
+        rt_mutex_release(device->lock);
+        return S8_STATUS_OK;
     }
+    rt_mutex_release(device->lock);
 
-    /* Read sensor type ID low (IR27) */
-    result = modbus_read_input_registers(device->modbus,
-                                          0xFE,
-                                          S8_REG_SENSOR_TYPE_LOW,
-                                          1,
-                                          &type_low);
-    if (result != RT_EOK) {
-        return (result == -RT_ETIMEOUT) ? S8_STATUS_TIMEOUT : S8_STATUS_ERROR;
+    status = s8_query(device, S8_QUERY_INFO, values);
+    if (status != S8_STATUS_OK) {
+        return status;
     }
 
-    /* Read firmware version (IR29) */
-    result = modbus_read_input_registers(device->modbus,
-                                          0xFE,
-                                          S8_REG_FIRMWARE_VERSION,
-                                          1,
-                                          &firmware);
-    if (result != RT_EOK) {
-        return (result == -RT_ETIMEOUT) ? S8_STATUS_TIMEOUT : S8_STATUS_ERROR;
-    }
+    type_high = S8_QUERY_VALUE(values, INFO, SENSOR_TYPE_HIGH);
+    type_low = S8_QUERY_VALUE(values, INFO, SENSOR_TYPE_LOW);
+    firmware = S8_QUERY_VALUE(values, INFO, FIRMWARE_VERSION);
 
     /* Combine sensor type (high << 16 | low) but we only use high for now */
     info->sensor_type = type_high;
     info->firmware_version = firmware;
 
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    device->info = *info;
+    device->info_tick = rt_tick_get();
+    device->info_valid = RT_TRUE;
+    device->info_reads++;
+    rt_mutex_release(device->lock);
+
     rt_kprintf("[S8] Sensor info - Type: 0x%04X%04X, Firmware: %d\n", 
                type_high, type_low, firmware);
 
     return S8_STATUS_OK;
 }
 
+/**
+ * Read sensor information from the sensor, replacing the kept identity
+ */
+s8_status_t s8_refresh_sensor_info(s8_sensor_device_t *device, s8_sensor_info_t *info)
+{
+    if (!device || !device->modbus || !info) {
+        return S8_STATUS_NOT_INITIALIZED;
+    }
+
+    s8_invalidate_sensor_info(device);
+    return s8_read_sensor_info(device, info);
+}
+
+/**
+ * Forget the kept identity; the next query reads it from the sensor
+ * The bus cache entry goes too, so that read is not answered from it.
+ */
+void s8_invalidate_sensor_info(s8_sensor_device_t *device)
+{
+    if (!device || !device->modbus) {
+        return;
+    }
+
+    rt_mutex_take(device->lock, RT_WAITING_FOREVER);
+    device->info_valid = RT_FALSE;
+    rt_mutex_release(device->lock);
+    modbus_cache_expire(device->modbus, device->slave_addr, S8_REG_FUNC_SENSOR_TYPE_HIGH,
+                        S8_QUERY_FIRST_INFO, S8_QUERY_REGS_INFO);
+}
+
 /**
  * Read sensor status
+ * Shares the cycle read, so CO2 and alarm status are refreshed too.
  */
 s8_status_t s8_read_status(s8_sensor_device_t *device, rt_uint16_t *status)
 {
-    rt_uint16_t status_value;
-    rt_err_t result;
+    s8_sensor_data_t data;
+    s8_status_t result;
 
     if (!device || !device->modbus || !status) {
         return S8_STATUS_NOT_INITIALIZED;
     }
 
-    /* Read status from Input Register IR1 (0x0000) using function 0x04 */
-    result = modbus_read_input_registers(device->modbus,
-                                          0xFE,     /* Broadcast address */
-                                          0x0000,   /* MeterStatus register IR1 */
-                                          1,         /* Read 1 register */
-                                          &status_value);
-
-    if (result != RT_EOK) {
-        return (result == -RT_ETIMEOUT) ? S8_STATUS_TIMEOUT : S8_STATUS_ERROR;
+    result = s8_read_co2_data(device);
+    if (result != S8_STATUS_OK) {
+        return result;
     }
 
-    *status = status_value;
+    s8_sensor_snapshot(device, &data);
+    *status = data.meter_status;
     return S8_STATUS_OK;
 }
 
@@ -277,20 +650,16 @@ s8_status_t s8_read_firmware_version(s8_sensor_device_t *device, rt_uint16_t *fi
  */
 s8_status_t s8_single_point_calibration(s8_sensor_device_t *device, rt_uint16_t ppm_value)
 {
-    rt_err_t result;
+    s8_status_t status;
 
     if (!device || !device->modbus) {
         return S8_STATUS_NOT_INITIALIZED;
     }
 
     /* Write calibration value to holding register */
-    result = modbus_write_single_register(device->modbus,
-                                           0xFE,
-                                           S8_REG_SINGLE_POINT_CAL,
-                                           ppm_value);
-
-    if (result != RT_EOK) {
-        return (result == -RT_ETIMEOUT) ? S8_STATUS_TIMEOUT : S8_STATUS_ERROR;
+    status = s8_write(device, S8_REG_SINGLE_POINT_CAL, ppm_value);
+    if (status != S8_STATUS_OK) {
+        return status;
     }
 
     rt_kprintf("[S8] Single point calibration set to %d ppm\n", ppm_value);
@@ -302,20 +671,16 @@ s8_status_t s8_single_point_calibration(s8_sensor_device_t *device, rt_uint16_t
  */
 s8_status_t s8_background_calibration(s8_sensor_device_t *device)
 {
-    rt_err_t result;
+    s8_status_t status;
 
     if (!device || !device->modbus) {
         return S8_STATUS_NOT_INITIALIZED;
     }
 
     /* Start background calibration */
-    result = modbus_write_single_register(device->modbus,
-                                           0xFE,
-                                           S8_REG_BACKGROUND_CAL,
-                                           S8_CAL_COMMAND_START);
-
-    if (result != RT_EOK) {
-        return (result == -RT_ETIMEOUT) ? S8_STATUS_TIMEOUT : S8_STATUS_ERROR;
+    status = s8_write(device, S8_REG_BACKGROUND_CAL, S8_CAL_COMMAND_START);
+    if (status != S8_STATUS_OK) {
+        return status;
     }
 
     rt_kprintf("[S8] Background calibration started\n");
@@ -327,45 +692,61 @@ s8_status_t s8_background_calibration(s8_sensor_device_t *device)
  */
 s8_status_t s8_zero_calibration(s8_sensor_device_t *device)
 {
-    rt_err_t result;
+    s8_status_t status;
 
     if (!device || !device->modbus) {
         return S8_STATUS_NOT_INITIALIZED;
     }
 
     /* Start zero calibration */
-    result = modbus_write_single_register(device->modbus,
-                                           0xFE,
-                                           S8_REG_ZERO_CAL,
-                                           S8_CAL_COMMAND_START);
-
-    if (result != RT_EOK) {
-        return (result == -RT_ETIMEOUT) ? S8_STATUS_TIMEOUT : S8_STATUS_ERROR;
+    status = s8_write(device, S8_REG_ZERO_CAL, S8_CAL_COMMAND_START);
+    if (status != S8_STATUS_OK) {
+        return status;
     }
 
     rt_kprintf("[S8] Zero calibration started\n");
     return S8_STATUS_OK;
 }
 
+/**
+ * Cancel a zero or background calibration
+ * Single point calibration has no stop command.
+ */
+s8_status_t s8_cancel_calibration(s8_sensor_device_t *device)
+{
+    s8_status_t status;
+
+    if (!device || !device->modbus) {
+        return S8_STATUS_NOT_INITIALIZED;
+    }
+
+    status = s8_write(device, S8_REG_ZERO_CAL, S8_CAL_COMMAND_STOP);
+    if (status == S8_STATUS_OK) {
+        status = s8_write(device, S8_REG_BACKGROUND_CAL, S8_CAL_COMMAND_STOP);
+    }
+    if (status != S8_STATUS_OK) {
+        return status;
+    }
+
+    rt_kprintf("[S8] Calibration cancelled\n");
+    return S8_STATUS_OK;
+}
+
 /**
  * Set auto calibration
  */
 s8_status_t s8_set_auto_calibration(s8_sensor_device_t *device, rt_bool_t enable)
 {
-    rt_err_t result;
+    s8_status_t status;
 
     if (!device || !device->modbus) {
         return S8_STATUS_NOT_INITIALIZED;
     }
 
     /* Enable or disable auto calibration */
-    result = modbus_write_single_register(device->modbus,
-                                           0xFE,
-                                           S8_REG_AUTO_CAL,
-                                           enable ? S8_CAL_COMMAND_START : S8_CAL_COMMAND_STOP);
-
-    if (result != RT_EOK) {
-        return (result == -RT_ETIMEOUT) ? S8_STATUS_TIMEOUT : S8_STATUS_ERROR;
+    status = s8_write(device, S8_REG_AUTO_CAL, enable ? S8_CAL_COMMAND_START : S8_CAL_COMMAND_STOP);
+    if (status != S8_STATUS_OK) {
+        return status;
     }
 
     rt_kprintf("[S8] Auto calibration %s\n", enable ? "enabled" : "disabled");
@@ -377,20 +758,16 @@ s8_status_t s8_set_auto_calibration(s8_sensor_device_t *device, rt_bool_t enable
  */
 s8_status_t s8_set_alarm_threshold(s8_sensor_device_t *device, rt_uint16_t threshold_ppm)
 {
-    rt_err_t result;
+    s8_status_t status;
 
     if (!device || !device->modbus) {
         return S8_STATUS_NOT_INITIALIZED;
     }
 
     /* Set alarm threshold */
-    result = modbus_write_single_register(device->modbus,
-                                           0xFE,
-                                           S8_REG_ALARM_THRESHOLD,
-                                           threshold_ppm);
-
-    if (result != RT_EOK) {
-        return (result == -RT_ETIMEOUT) ? S8_STATUS_TIMEOUT : S8_STATUS_ERROR;
+    status = s8_write(device, S8_REG_ALARM_THRESHOLD, threshold_ppm);
+    if (status != S8_STATUS_OK) {
+        return status;
     }
 
     rt_kprintf("[S8] Alarm threshold set to %d ppm\n", threshold_ppm);
@@ -399,6 +776,7 @@ s8_status_t s8_set_alarm_threshold(s8_sensor_device_t *device, rt_uint16_t thres
 
 /**
  * Get sensor data
+ * The latest reading, without touching the bus.
  */
 s8_status_t s8_get_sensor_data(s8_sensor_device_t *device, s8_sensor_data_t *data)
 {
@@ -406,16 +784,51 @@ s8_status_t s8_get_sensor_data(s8_sensor_device_t *device, s8_sensor_data_t *dat
         return S8_STATUS_ERROR;
     }
 
-    if (!device->data.data_valid) {
+    s8_sensor_snapshot(device, data);
+    if (!data->data_valid) {
         return S8_STATUS_INVALID_DATA;
     }
 
-    *data = device->data;
     return S8_STATUS_OK;
 }
 
 /**
- * Start monitoring thread
+ * Publish a reading as the sensor's latest data
+ * The sequence count is odd while the copy is in progress. The scheduler
+ * is locked across it, so no reader can preempt a writer and spin on an
+ * odd count, and writers never interleave. Thread context.
+ */
+void s8_sensor_publish(s8_sensor_device_t *device, const s8_sensor_data_t *data)
+{
+    rt_enter_critical();
+    device->data_seq++;
+    S8_DATA_BARRIER();
+    device->data = *data;
+    S8_DATA_BARRIER();
+    device->data_seq++;
+    rt_exit_critical();
+}
+
+/**
+ * Consistent copy of the latest reading
+ * Lock-free: never blocks the writer and never takes the bus lock. The copy
+ * is retried if a write completed while it was taken. Thread context: an
+ * interrupt could land inside a write and spin on it.
+ */
+void s8_sensor_snapshot(const s8_sensor_device_t *device, s8_sensor_data_t *data)
+{
+    rt_uint32_t seq;
+
+    do {
+        seq = device->data_seq;
+        S8_DATA_BARRIER();
+        *data = device->data;
+        S8_DATA_BARRIER();
+    } while ((seq & 1) || seq != device->data_seq);
+}
+
+/**
+ * Start monitoring: print a sample about every interval_ms
  */
 rt_err_t s8_start_monitoring(s8_sensor_device_t *device, rt_uint32_t interval_ms)
 {
@@ -427,30 +840,20 @@ rt_err_t s8_start_monitoring(s8_sensor_device_t *device, rt_uint32_t interval_ms
         return -RT_EBUSY;
     }
 
-    device->read_interval_ms = interval_ms;
-    device->running = RT_TRUE;
-
-    /* Create monitor thread with lower priority and time-slicing */
-    device->monitor_thread = rt_thread_create("s8_monitor",
-                                            s8_monitor_thread_entry,
-                                            device,
-                                            1024,
-                                            30,    /* Lower priority than MSH (which is typically 20) */
-                                            10);   /* Time slice for responsive scheduling */
-
-    if (!device->monitor_thread) {
-        device->running = RT_FALSE;
+    device->monitor = s8_acquire_subscribe(s8_acquire_get(device), interval_ms, s8_monitor_sample, device);
+    if (!device->monitor) {
         return -RT_ERROR;
     }
+    device->read_interval_ms = interval_ms;
+    device->running = RT_TRUE;
 
-    rt_thread_startup(device->monitor_thread);
     rt_kprintf("[S8] Monitoring started, interval: %d ms\n", interval_ms);
 
     return RT_EOK;
 }
 
 /**
- * Stop monitoring thread
+ * Stop monitoring
  */
 rt_err_t s8_stop_monitoring(s8_sensor_device_t *device)
 {
@@ -463,11 +866,8 @@ rt_err_t s8_stop_monitoring(s8_sensor_device_t *device)
     }
 
     device->running = RT_FALSE;
-
-    if (device->monitor_thread) {
-        rt_thread_delete(device->monitor_thread);
-        device->monitor_thread = RT_NULL;
-    }
+    s8_acquire_unsubscribe(device->acquire, device->monitor);
+    device->monitor = RT_NULL;
 
     rt_kprintf("[S8] Monitoring stopped\n");
     return RT_EOK;
@@ -493,14 +893,28 @@ rt_err_t s8_trigger_calibration(s8_sensor_device_t *device)
 
 /**
  * Get alarm state
+ * The debounced level kept by the alarm interrupt, current to about a
+ * millisecond. The pin is one line on the board: only the sensor at
+ * S8_ALARM_SLAVE on S8_ALARM_UART drives it, the others get
+ * S8_ALARM_UNAVAILABLE.
  */
 rt_uint8_t s8_get_alarm_state(s8_sensor_device_t *device)
 {
+    s8_alarm_t *alarm;
+
     if (!device) {
         return 0;
     }
+    if (!device->alarm_wired) {
+        return S8_ALARM_UNAVAILABLE;
+    }
+
+    alarm = s8_alarm_get();
+    if (!alarm) {
+        return rt_pin_read(S8_ALARM_PIN) ? 1 : 0;
+    }
 
-    return rt_pin_read(S8_ALARM_PIN) ? 1 : 0;
+    return s8_alarm_state(alarm);
 }
 
 /**
@@ -508,11 +922,14 @@ rt_uint8_t s8_get_alarm_state(s8_sensor_device_t *device)
  */
 rt_bool_t s8_is_data_valid(s8_sensor_device_t *device)
 {
+    s8_sensor_data_t data;
+
     if (!device) {
         return RT_FALSE;
     }
 
-    return device->data.data_valid;
+    s8_sensor_snapshot(device, &data);
+    return data.data_valid;
 }
 
 /**
@@ -520,11 +937,35 @@ rt_bool_t s8_is_data_valid(s8_sensor_device_t *device)
  */
 rt_uint32_t s8_get_data_age(s8_sensor_device_t *device)
 {
-    if (!device || !device->data.data_valid) {
+    s8_sensor_data_t data;
+
+    if (!device) {
+        return 0xFFFFFFFF;
+    }
+
+    s8_sensor_snapshot(device, &data);
+    if (!data.data_valid) {
         return 0xFFFFFFFF;
     }
 
-    return rt_tick_get() - device->data.timestamp;
+    return rt_tick_get() - data.timestamp;
+}
+
+/**
+ * Printable health state
+ */
+const char *s8_health_name(s8_health_state_t state)
+{
+    switch (state) {
+    case S8_HEALTH_ONLINE:
+        return "online";
+    case S8_HEALTH_DEGRADED:
+        return "degraded";
+    case S8_HEALTH_OFFLINE:
+        return "offline";
+    default:
+        return "unknown";
+    }
 }
 
 /**
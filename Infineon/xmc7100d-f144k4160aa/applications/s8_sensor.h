@@ -6,6 +6,19 @@
  * Change Logs:
  * Date           Author       Notes
  * 2025-11-21     Developer    S8 CO2 sensor driver
+ * 2026-10-16     Developer    Batched IR1-IR4 cycle read and info read
+ * 2026-10-16     Developer    Per-slave instances for multi-drop buses, health updated under the sensor lock
+ * 2026-10-16     Developer    Sensors on table-driven buses
+ * 2026-10-16     Developer    Cache TTLs for measurement and info registers
+ * 2026-10-16     Developer    Uncached measurement read for cadence tracking
+ * 2026-10-16     Developer    Fixed reads from the register map with prebuilt frames, C linkage when included from C++
+ * 2026-10-16     Developer    Exception status and retry counts from the Modbus layer
+ * 2026-10-16     Developer    R/T pin driven by the UART as RS-485 driver enable
+ * 2026-10-16     Developer    One shared instance per sensor, sampled by the acquisition service on its bus's scheduler
+ * 2026-10-16     Developer    Latest reading published under a sequence count by a writer that locks the scheduler
+ * 2026-10-16     Developer    Verified holding register writes and calibration state machine
+ * 2026-10-16     Developer    Sensor identity kept under the sensor lock until re-init, refresh or a long silence
+ * 2026-10-16     Developer    Alarm pin reported for the sensor wired to it only
  */
 
 #ifndef S8_SENSOR_H__
@@ -14,30 +27,101 @@
 #include <rtthread.h>
 #include <rtdevice.h>
 #include "modbus_rtu.h"
+#include "s8_regmap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 /* GPIO pin definitions for S8 sensor */
 #define S8_ALARM_PIN        GET_PIN(19, 3)    /* P19_3 (IO2) - Alarm output */
 #define S8_UART_RXT_PIN     GET_PIN(20, 1)    /* P20_1 (IO5) - UART R/T control */
 #define S8_BCAL_PIN         GET_PIN(20, 2)    /* P20_2 (IO6) - Calibration input */
 
-/* S8 Modbus register addresses */
-#define S8_REG_CO2_CONCENTRATION    0x0003  /* CO2 concentration (input register) */
-#define S8_REG_METER_STATUS        0x0000  /* Meter status (input register IR1) */
-#define S8_REG_ALARM_STATUS        0x0001  /* Alarm status (input register IR2) */
-#define S8_REG_OUTPUT_STATUS       0x0002  /* Output status (input register IR3) */
-#define S8_REG_SENSOR_TYPE_HIGH    0x0019  /* Sensor type ID high (input register IR26) */
-#define S8_REG_SENSOR_TYPE_LOW     0x001A  /* Sensor type ID low (input register IR27) */
-#define S8_REG_FIRMWARE_VERSION   0x001C  /* Firmware version (input register IR29) */
-#define S8_REG_SINGLE_POINT_CAL  0x0010  /* Single point calibration (holding register) */
-#define S8_REG_BACKGROUND_CAL    0x0011  /* Background calibration (holding register) */
-#define S8_REG_ZERO_CAL         0x0012  /* Zero calibration (holding register) */
-#define S8_REG_AUTO_CAL         0x0013  /* Auto calibration (holding register) */
-#define S8_REG_ALARM_THRESHOLD   0x0014  /* Alarm threshold (holding register) */
+/* The alarm pin is one line, wired to the sensor on the S8 connector */
+#ifndef S8_ALARM_UART
+#define S8_ALARM_UART       "uart2"
+#endif
+#ifndef S8_ALARM_SLAVE
+#define S8_ALARM_SLAVE      S8_MODBUS_ADDRESS
+#endif
+#define S8_ALARM_UNAVAILABLE    0xFF          /* Alarm state of a sensor not wired to the pin */
+
+/* R/T level while the request is on the wire; the opposite level receives */
+#ifndef S8_UART_RXT_TX_LEVEL
+#define S8_UART_RXT_TX_LEVEL    PIN_LOW
+#endif
+
+/* S8 Modbus register addresses (S8_REG_*) come from the register map */
 
 /* S8 calibration commands */
 #define S8_CAL_COMMAND_START      0x0001
 #define S8_CAL_COMMAND_STOP       0x0000
 
+/* Meter status (IR1) bits */
+#define S8_METER_STATUS_CAL_ONGOING     0x0001
+
+/* Internal measurement period of the S8 (datasheet: 2 s) */
+#ifndef S8_MEASUREMENT_PERIOD_MS
+#define S8_MEASUREMENT_PERIOD_MS  2000
+#endif
+
+/* How long a cycle read (IR1-IR4) may be answered from the Modbus cache.
+ * Shorter than S8_MEASUREMENT_PERIOD_MS; 0 disables caching. */
+#ifndef S8_MEASUREMENT_TTL_MS
+#define S8_MEASUREMENT_TTL_MS     1000
+#endif
+
+/* Sensor type and firmware (IR26-IR29) do not change at run time */
+#ifndef S8_INFO_TTL_MS
+#define S8_INFO_TTL_MS            60000
+#endif
+
+/* The identity is kept in the device after the first read. A sensor silent
+ * this long may have been power cycled or swapped, so it is read again. */
+#ifndef S8_IDENTITY_LOSS_MS
+#define S8_IDENTITY_LOSS_MS       10000
+#endif
+
+/* Sensor instances on all buses; an instance is shared by all its users */
+#ifndef S8_SENSOR_MAX
+#define S8_SENSOR_MAX             16
+#endif
+
+/* Consecutive failures before a slave is considered offline */
+#ifndef S8_OFFLINE_FAILURES
+#define S8_OFFLINE_FAILURES       3
+#endif
+
+/* S8 sensor status codes */
+typedef enum {
+    S8_STATUS_OK = 0,
+    S8_STATUS_ERROR = -1,
+    S8_STATUS_TIMEOUT = -2,
+    S8_STATUS_INVALID_DATA = -3,
+    S8_STATUS_NOT_INITIALIZED = -4,
+    S8_STATUS_EXCEPTION = -5        /* Slave answered with a Modbus exception */
+} s8_status_t;
+
+/* S8 slave health */
+typedef enum {
+    S8_HEALTH_UNKNOWN = 0,       /* Never polled */
+    S8_HEALTH_ONLINE,            /* Last read succeeded */
+    S8_HEALTH_DEGRADED,          /* Recent failures, still answering sometimes */
+    S8_HEALTH_OFFLINE            /* S8_OFFLINE_FAILURES in a row */
+} s8_health_state_t;
+
+typedef struct {
+    s8_health_state_t state;
+    rt_uint32_t ok_count;
+    rt_uint32_t fail_count;
+    rt_uint16_t consecutive_failures;
+    rt_tick_t last_ok_tick;
+    s8_status_t last_error;
+    rt_uint8_t last_exception;   /* Exception code behind the last S8_STATUS_EXCEPTION */
+    rt_uint32_t retries;         /* Re-sends the Modbus layer needed, all queries */
+} s8_health_t;
+
 /* S8 sensor info structure */
 typedef struct {
     rt_uint16_t sensor_type;      /* Sensor type identifier */
@@ -47,44 +131,66 @@ typedef struct {
 /* S8 sensor data structure */
 typedef struct {
     rt_uint16_t co2_ppm;        /* CO2 concentration in ppm */
-    rt_uint8_t  alarm_state;     /* Alarm state (0=normal, 1=alarm) */
+    rt_uint8_t  alarm_state;     /* Alarm state (0=normal, 1=alarm, S8_ALARM_UNAVAILABLE) */
+    rt_uint16_t meter_status;    /* IR1 meter status */
+    rt_uint16_t alarm_status;    /* IR2 alarm status */
     rt_uint32_t timestamp;       /* Last update timestamp */
     rt_bool_t   data_valid;      /* Data validity flag */
 } s8_sensor_data_t;
 
+struct s8_acquire;
+struct s8_subscriber;
+struct s8_cal;
+struct s8_poller;
+
 /* S8 sensor device structure */
 typedef struct {
-    modbus_rtu_device_t *modbus;     /* Modbus RTU device */
-    s8_sensor_data_t data;           /* Sensor data */
-    rt_thread_t monitor_thread;      /* Monitor thread */
+    modbus_rtu_device_t *modbus;     /* Modbus RTU device, shared by slaves on one bus */
+    rt_uint8_t slave_addr;           /* Modbus address, 0xFE when alone on the bus */
+    rt_uint16_t refcount;            /* Users sharing this instance */
+    rt_bool_t alarm_wired;           /* Its alarm output is S8_ALARM_PIN */
+    rt_mutex_t lock;                 /* Protects health and the retry counts */
+    s8_health_t health;              /* Poll outcome history */
+    s8_sensor_data_t data;           /* Latest reading, read it with s8_sensor_snapshot() */
+    volatile rt_uint32_t data_seq;   /* Odd while data is being written */
+    struct s8_acquire *acquire;      /* The sensor's only reader, see s8_acquire.h */
+    struct s8_poller *poller;        /* Scheduler of its bus, runs the reads, see s8_poller.h */
+    struct s8_subscriber *monitor;   /* s8_start_monitoring() subscription */
+    struct s8_cal *cal;              /* Calibration state machine, see s8_calib.h */
+    s8_sensor_info_t info;           /* Identity, while info_valid; info_* change under lock */
+    rt_bool_t info_valid;
+    rt_tick_t info_tick;             /* Identity last read from the sensor */
+    rt_uint32_t info_reads;          /* Identity reads that went to the bus */
     rt_uint32_t read_interval_ms;   /* Read interval in milliseconds */
-    rt_bool_t running;               /* Thread running flag */
+    rt_bool_t running;               /* Monitoring flag */
+    modbus_frame_t frames[S8_QUERY_COUNT];  /* Query frames for slave_addr, built on first use */
+    rt_uint8_t last_retries;         /* Re-sends the last query needed */
+    rt_uint8_t plan_saved;           /* Transactions saved by the last batched read */
+    rt_uint32_t plan_saved_total;    /* Transactions saved since init */
 } s8_sensor_device_t;
 
-/* S8 sensor status codes */
-typedef enum {
-    S8_STATUS_OK = 0,
-    S8_STATUS_ERROR = -1,
-    S8_STATUS_TIMEOUT = -2,
-    S8_STATUS_INVALID_DATA = -3,
-    S8_STATUS_NOT_INITIALIZED = -4
-} s8_status_t;
-
 /* Function declarations */
 
 /* Device management */
 s8_sensor_device_t* s8_sensor_init(const char *uart_name);
+s8_sensor_device_t* s8_sensor_init_slave(const char *uart_name, rt_uint8_t slave_addr);
+s8_sensor_device_t* s8_sensor_init_bus(const modbus_bus_config_t *bus, rt_uint8_t slave_addr);
 rt_err_t s8_sensor_deinit(s8_sensor_device_t *device);
 
 /* Data reading */
 s8_status_t s8_read_co2_data(s8_sensor_device_t *device);
+s8_status_t s8_refresh_co2_data(s8_sensor_device_t *device);
 s8_status_t s8_read_all_data(s8_sensor_device_t *device, s8_sensor_data_t *data);
 s8_status_t s8_get_sensor_data(s8_sensor_device_t *device, s8_sensor_data_t *data);
+void s8_sensor_publish(s8_sensor_device_t *device, const s8_sensor_data_t *data);
+void s8_sensor_snapshot(const s8_sensor_device_t *device, s8_sensor_data_t *data);
 
 /* Sensor information */
 s8_status_t s8_read_sensor_info(s8_sensor_device_t *device, s8_sensor_info_t *info);
 s8_status_t s8_read_sensor_type(s8_sensor_device_t *device, rt_uint16_t *sensor_type);
 s8_status_t s8_read_firmware_version(s8_sensor_device_t *device, rt_uint16_t *firmware_version);
+s8_status_t s8_refresh_sensor_info(s8_sensor_device_t *device, s8_sensor_info_t *info);
+void s8_invalidate_sensor_info(s8_sensor_device_t *device);
 s8_status_t s8_read_status(s8_sensor_device_t *device, rt_uint16_t *status);
 
 /* Calibration functions */
@@ -92,6 +198,7 @@ rt_err_t s8_trigger_calibration(s8_sensor_device_t *device);
 s8_status_t s8_single_point_calibration(s8_sensor_device_t *device, rt_uint16_t ppm_value);
 s8_status_t s8_background_calibration(s8_sensor_device_t *device);
 s8_status_t s8_zero_calibration(s8_sensor_device_t *device);
+s8_status_t s8_cancel_calibration(s8_sensor_device_t *device);
 s8_status_t s8_set_auto_calibration(s8_sensor_device_t *device, rt_bool_t enable);
 
 /* Control functions */
@@ -105,6 +212,7 @@ rt_err_t s8_stop_monitoring(s8_sensor_device_t *device);
 /* Utility functions */
 rt_bool_t s8_is_data_valid(s8_sensor_device_t *device);
 rt_uint32_t s8_get_data_age(s8_sensor_device_t *device);
+const char *s8_health_name(s8_health_state_t state);
 
 /* Data conversion helpers */
 float s8_co2_to_ppm(rt_uint16_t raw_value);
@@ -126,4 +234,8 @@ void s8_msh_start_monitor(int argc, char **argv);
 void s8_msh_stop_monitor(int argc, char **argv);
 #endif
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* S8_SENSOR_H__ */
@@ -6,6 +6,8 @@
  * Change Logs:
  * Date           Author       Notes
  * 2025-11-27     Developer    TF Card driver - Stage 1: Communication
+ * 2026-10-16     Developer    Logger samples from the acquisition service
+ * 2026-10-16     Developer    Logger thread joined on stop instead of deleted
  */
 
 #include <rtthread.h>
@@ -20,6 +22,7 @@
 #include <errno.h>
 #include "tf_card.h"
 #include "s8_sensor.h"
+#include "s8_acquire.h"
 #include "nvs_state.h"
 
 #define DBG_TAG "tf_card"
@@ -983,6 +986,9 @@ tf_status_t tf_monitor_init(tf_monitor_state_t *monitor_state)
     monitor_state->session_file_fd = -1;  /* No open file */
     monitor_state->interval_sec = 5;      /* Default 5 seconds */
     monitor_state->power_outage_detected = RT_FALSE;  /* Default: no outage */
+    monitor_state->exit_sem = rt_sem_create("tf_mexit", 0, RT_IPC_FLAG_FIFO);
+    if (monitor_state->exit_sem == RT_NULL)
+        return TF_STATUS_ERROR;
 
     /* Get current RTC time */
     rtc_dev = rt_device_find("rtc");
@@ -1012,12 +1018,31 @@ tf_status_t tf_monitor_init(tf_monitor_state_t *monitor_state)
 }
 
 /**
- * @brief Thread entry for persistent TF monitoring
+ * @brief Drop the logger's subscription, once, from the thread or from stop
  */
-static void tf_persistent_monitor_thread_entry(void *parameter)
+static void tf_monitor_unsubscribe(tf_monitor_state_t *state)
+{
+    struct s8_subscriber *subscriber;
+
+    rt_enter_critical();
+    subscriber = state->subscriber;
+    state->subscriber = RT_NULL;
+    rt_exit_critical();
+
+    if (subscriber != RT_NULL && g_main_s8_device != RT_NULL)
+    {
+        /* Wakes the thread out of s8_acquire_receive() */
+        s8_acquire_unsubscribe(g_main_s8_device->acquire, subscriber);
+    }
+}
+
+/**
+ * @brief Persistent TF monitoring, until running is cleared
+ */
+static void tf_persistent_monitor_run(tf_monitor_state_t *state)
 {
-    tf_monitor_state_t *state = (tf_monitor_state_t *)parameter;
     tf_co2_record_t record;
+    s8_sample_t sample;
     char line[128];
     int written;
     static rt_device_t rtc_dev = RT_NULL;
@@ -1103,10 +1128,22 @@ static void tf_persistent_monitor_thread_entry(void *parameter)
 
     while (state->running)
     {
-        if (g_main_s8_device != RT_NULL)
+        /* Samples come from the sensor's acquisition service at the log interval */
+        if (state->subscriber == RT_NULL && g_main_s8_device != RT_NULL)
         {
-            /* Read sensor */
-            if (s8_read_co2_data(g_main_s8_device) == S8_STATUS_OK)
+            state->subscriber = s8_acquire_subscribe_queue(s8_acquire_get(g_main_s8_device),
+                                                           state->interval_sec * 1000);
+        }
+
+        if (state->subscriber != RT_NULL)
+        {
+            /* Wake now and then to notice a stop request */
+            if (s8_acquire_receive(state->subscriber, &sample, rt_tick_from_millisecond(500)) != RT_EOK)
+            {
+                continue;
+            }
+
+            if (sample.status == S8_STATUS_OK)
             {
                 /* Get current RTC time or use backup if RTC is reset */
                 time_t current_rtc_time;
@@ -1122,7 +1159,7 @@ static void tf_persistent_monitor_thread_entry(void *parameter)
                     /* Build record */
                     record.rtc_timestamp = current_rtc_time;
                     record.elapsed_seconds = state->sample_count * state->interval_sec;
-                    record.co2_ppm = g_main_s8_device->data.co2_ppm;
+                    record.co2_ppm = sample.data.co2_ppm;
 
                     /* Write to session file (kept open) */
                     if (state->session_file_fd >= 0)
@@ -1169,11 +1206,12 @@ static void tf_persistent_monitor_thread_entry(void *parameter)
         else
         {
             LOG_W("S8 sensor not available");
+            rt_thread_mdelay(state->interval_sec * 1000);
         }
-
-        rt_thread_mdelay(state->interval_sec * 1000);
     }
 
+    tf_monitor_unsubscribe(state);
+
     /* Clean shutdown */
     rt_kprintf("TF monitor stopped (total: %lu samples)\n", state->sample_count);
     rt_kprintf("Session file: %s\n", state->session_file);
@@ -1198,6 +1236,17 @@ static void tf_persistent_monitor_thread_entry(void *parameter)
     LOG_I("TF monitor shutdown complete");
 }
 
+/**
+ * @brief Thread entry for persistent TF monitoring
+ */
+static void tf_persistent_monitor_thread_entry(void *parameter)
+{
+    tf_monitor_state_t *state = (tf_monitor_state_t *)parameter;
+
+    tf_persistent_monitor_run(state);
+    rt_sem_release(state->exit_sem);
+}
+
 /**
  * @brief Start TF monitoring with persistent state
  */
@@ -1221,6 +1270,13 @@ tf_status_t tf_monitor_start(tf_monitor_state_t *monitor_state, rt_uint32_t inte
         return TF_STATUS_NOT_MOUNTED;
     }
 
+    /* A thread that ended on its own, after an emergency shutdown or a failed start */
+    if (monitor_state->monitor_thread != RT_NULL)
+    {
+        rt_sem_take(monitor_state->exit_sem, RT_WAITING_FOREVER);
+        monitor_state->monitor_thread = RT_NULL;
+    }
+
     /* Get current time for session start */
     time(&session_start);
 
@@ -1288,10 +1344,11 @@ tf_status_t tf_monitor_stop(tf_monitor_state_t *monitor_state)
 
     LOG_I("Stopping TF monitor...");
 
-    /* Wait for thread to finish */
+    /* Closing the subscription wakes the thread; wait for it to finish */
+    tf_monitor_unsubscribe(monitor_state);
     if (monitor_state->monitor_thread != RT_NULL)
     {
-        rt_thread_delete(monitor_state->monitor_thread);
+        rt_sem_take(monitor_state->exit_sem, RT_WAITING_FOREVER);
         monitor_state->monitor_thread = RT_NULL;
     }
 
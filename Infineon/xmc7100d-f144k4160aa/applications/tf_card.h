@@ -6,6 +6,8 @@
  * Change Logs:
  * Date           Author       Notes
  * 2025-11-27     Developer    TF Card driver header
+ * 2026-10-16     Developer    Logger samples from the acquisition service
+ * 2026-10-16     Developer    Logger thread joined on stop instead of deleted
  */
 
 #ifndef __TF_CARD_H__
@@ -93,6 +95,7 @@ typedef struct {
     rt_uint32_t interval_sec;             /* Monitoring interval in seconds */
     char session_file[64];                /* Current session filename */
     rt_thread_t monitor_thread;           /* Monitor thread handle */
+    rt_sem_t exit_sem;                    /* Released by the monitor thread as it ends */
     rt_uint32_t sample_count;             /* Total samples logged */
     time_t session_start_time;            /* Session start timestamp */
     int session_file_fd;                  /* Open file descriptor (-1 if closed) */
@@ -100,6 +103,7 @@ typedef struct {
     rt_bool_t power_outage_detected;      /* Power outage detection flag */
     rt_uint32_t session_duration_sec;     /* Total session duration in seconds */
     time_t rtc_backup_time;               /* Backup time when RTC might be reset */
+    struct s8_subscriber *subscriber;     /* Sample queue from the S8 acquisition service */
 } tf_monitor_state_t;
 
 /*
@@ -6,6 +6,9 @@
  * Change Logs:
  * Date           Author       Notes
  * 2025-11-27     Developer    TF Card MSH commands
+ * 2026-10-16     Developer    Real-time stream from the acquisition service
+ * 2026-10-16     Developer    Latest reading read through the sensor snapshot
+ * 2026-10-16     Developer    Single log sampled through the acquisition service
  */
 
 #include <rtthread.h>
@@ -19,6 +22,7 @@
 #include <sys/time.h>
 #include "tf_card.h"
 #include "s8_sensor.h"
+#include "s8_acquire.h"
 
 #define DBG_TAG "tf_msh"
 #define DBG_LVL DBG_INFO
@@ -129,6 +133,7 @@ MSH_CMD_EXPORT_ALIAS(cmd_tf_test, tf_test, Test TF card read write);
 static int cmd_tf_log(int argc, char **argv)
 {
     tf_co2_record_t record;
+    s8_sample_t sample;
     tf_status_t status;
     time_t current_rtc;
 
@@ -144,8 +149,9 @@ static int cmd_tf_log(int argc, char **argv)
         return -1;
     }
 
-    /* Read current CO2 data */
-    s8_status_t s8_status = s8_read_co2_data(g_main_s8_device);
+    /* Current CO2 data, from the sensor's only reader */
+    s8_status_t s8_status = s8_acquire_sample(s8_acquire_get(g_main_s8_device), &sample,
+                                              rt_tick_from_millisecond(S8_ACQUIRE_SAMPLE_WAIT_MS));
     if (s8_status != S8_STATUS_OK)
     {
         rt_kprintf("Failed to read S8 sensor: %d\n", s8_status);
@@ -158,7 +164,7 @@ static int cmd_tf_log(int argc, char **argv)
     /* Build record with new format */
     record.rtc_timestamp = current_rtc;
     record.elapsed_seconds = 0;  /* For single log, elapsed is 0 */
-    record.co2_ppm = g_main_s8_device->data.co2_ppm;
+    record.co2_ppm = sample.data.co2_ppm;
 
     /* Write to TF card */
     status = tf_data_write_record(&record);
@@ -431,6 +437,8 @@ static void tf_realtime_thread_entry(void *parameter)
 {
     tf_co2_record_t record;
     time_t current_rtc;
+    s8_subscriber_t *subscriber = RT_NULL;
+    s8_sample_t sample;
     static rt_device_t rtc_dev = RT_NULL;
 
     /* Find RTC device */
@@ -454,24 +462,39 @@ static void tf_realtime_thread_entry(void *parameter)
 
     while (tf_realtime_running)
     {
-        if (g_main_s8_device != RT_NULL)
+        if (subscriber == RT_NULL)
         {
-            if (s8_read_co2_data(g_main_s8_device) == S8_STATUS_OK)
+            /* Every sensor update (2 s), shared with the other consumers */
+            if (g_main_s8_device != RT_NULL)
             {
-                /* Get current RTC time */
-                if (rt_device_control(rtc_dev, RT_DEVICE_CTRL_RTC_GET_TIME, &current_rtc) == RT_EOK)
-                {
-                    /* Build record with new format */
-                    record.rtc_timestamp = current_rtc;
-                    record.elapsed_seconds = 0;  /* Not applicable for realtime */
-                    record.co2_ppm = g_main_s8_device->data.co2_ppm;
-
-                    tf_serial_send_record(&record, tf_realtime_serial);
-                }
+                subscriber = s8_acquire_subscribe_queue(s8_acquire_get(g_main_s8_device), S8_MEASUREMENT_PERIOD_MS);
+            }
+            if (subscriber == RT_NULL)
+            {
+                rt_thread_mdelay(2000);
+                continue;
+            }
+        }
+
+        if (s8_acquire_receive(subscriber, &sample, rt_tick_from_millisecond(500)) == RT_EOK &&
+            sample.status == S8_STATUS_OK)
+        {
+            /* Get current RTC time */
+            if (rt_device_control(rtc_dev, RT_DEVICE_CTRL_RTC_GET_TIME, &current_rtc) == RT_EOK)
+            {
+                /* Build record with new format */
+                record.rtc_timestamp = current_rtc;
+                record.elapsed_seconds = 0;  /* Not applicable for realtime */
+                record.co2_ppm = sample.data.co2_ppm;
+
+                tf_serial_send_record(&record, tf_realtime_serial);
             }
         }
+    }
 
-        rt_thread_mdelay(2000);  /* Every 2 seconds (sensor update rate) */
+    if (subscriber != RT_NULL)
+    {
+        s8_acquire_unsubscribe(g_main_s8_device->acquire, subscriber);
     }
 
     rt_kprintf("Real-time streaming stopped\n");
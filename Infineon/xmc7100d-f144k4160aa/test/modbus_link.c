@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Null-modem pair of virtual serial ports
+ */
+
+#include "modbus_link.h"
+
+/* 8N1 plus the idle bit the Modbus timing rules assume */
+#define LINK_BITS_PER_CHAR  11
+
+/**
+ * Hard timer: move written bytes to the peer at line rate, like its UART ISR
+ */
+static void link_timer_entry(void *parameter)
+{
+    modbus_link_end_t *end = (modbus_link_end_t *)parameter;
+    rt_device_t peer = &end->peer->serial.parent;
+    rt_size_t delivered = 0;
+    rt_uint8_t byte;
+
+    end->bit_credit += end->serial.config.baud_rate;
+    while (end->bit_credit >= LINK_BITS_PER_CHAR * RT_TICK_PER_SECOND &&
+           rt_ringbuffer_get(&end->tx_rb, &byte, 1) == 1) {
+        rt_ringbuffer_put(&end->peer->rx_rb, &byte, 1);
+        end->bit_credit -= LINK_BITS_PER_CHAR * RT_TICK_PER_SECOND;
+        delivered++;
+    }
+
+    if (delivered > 0 && peer->rx_indicate) {
+        peer->rx_indicate(peer, rt_ringbuffer_data_len(&end->peer->rx_rb));
+    }
+
+    if (rt_ringbuffer_data_len(&end->tx_rb) > 0) {
+        rt_timer_start(&end->timer);
+    } else {
+        end->sending = RT_FALSE;
+    }
+}
+
+static rt_err_t link_open(rt_device_t dev, rt_uint16_t oflag)
+{
+    RT_UNUSED(dev);
+    RT_UNUSED(oflag);
+    return RT_EOK;
+}
+
+static rt_err_t link_close(rt_device_t dev)
+{
+    RT_UNUSED(dev);
+    return RT_EOK;
+}
+
+static rt_ssize_t link_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+    modbus_link_end_t *end = (modbus_link_end_t *)dev;
+    rt_base_t level;
+    rt_size_t n;
+
+    RT_UNUSED(pos);
+
+    level = rt_hw_interrupt_disable();
+    n = rt_ringbuffer_get(&end->rx_rb, buffer, size);
+    rt_hw_interrupt_enable(level);
+
+    return n;
+}
+
+static rt_ssize_t link_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+    modbus_link_end_t *end = (modbus_link_end_t *)dev;
+    rt_base_t level;
+    rt_size_t n;
+
+    RT_UNUSED(pos);
+
+    level = rt_hw_interrupt_disable();
+    n = rt_ringbuffer_put(&end->tx_rb, buffer, size);
+    if (!end->sending && n > 0) {
+        /* Line was idle: the first character starts now */
+        end->sending = RT_TRUE;
+        end->bit_credit = 0;
+        rt_timer_start(&end->timer);
+    }
+    rt_hw_interrupt_enable(level);
+
+    return n;
+}
+
+static rt_err_t link_control(rt_device_t dev, int cmd, void *args)
+{
+    modbus_link_end_t *end = (modbus_link_end_t *)dev;
+
+    if (cmd == RT_DEVICE_CTRL_CONFIG && args) {
+        end->serial.config = *(struct serial_configure *)args;
+    }
+
+    return RT_EOK;
+}
+
+#ifdef RT_USING_DEVICE_OPS
+static const struct rt_device_ops link_ops =
+{
+    RT_NULL,
+    link_open,
+    link_close,
+    link_read,
+    link_write,
+    link_control
+};
+#endif
+
+/**
+ * Set up one end and register it as serial device 'name'
+ */
+static rt_err_t link_end_init(modbus_link_end_t *end, modbus_link_end_t *peer,
+                              const char *name, rt_uint32_t baud_rate)
+{
+    struct serial_configure config = RT_SERIAL_CONFIG_DEFAULT;
+    rt_device_t dev = &end->serial.parent;
+
+    config.baud_rate = baud_rate;
+    end->serial.config = config;
+    end->peer = peer;
+
+    rt_ringbuffer_init(&end->tx_rb, end->tx_pool, sizeof(end->tx_pool));
+    rt_ringbuffer_init(&end->rx_rb, end->rx_pool, sizeof(end->rx_pool));
+    rt_timer_init(&end->timer, name, link_timer_entry, end, 1,
+                  RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_HARD_TIMER);
+
+    dev->type = RT_Device_Class_Char;
+#ifdef RT_USING_DEVICE_OPS
+    dev->ops = &link_ops;
+#else
+    dev->open = link_open;
+    dev->close = link_close;
+    dev->read = link_read;
+    dev->write = link_write;
+    dev->control = link_control;
+#endif
+
+    if (rt_device_register(dev, name, RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_INT_RX) != RT_EOK) {
+        rt_timer_detach(&end->timer);
+        return -RT_ERROR;
+    }
+
+    return RT_EOK;
+}
+
+/**
+ * Create two connected serial devices 'name_a' and 'name_b'
+ */
+modbus_link_t *modbus_link_create(const char *name_a, const char *name_b, rt_uint32_t baud_rate)
+{
+    modbus_link_t *link;
+
+    link = (modbus_link_t *)rt_malloc(sizeof(modbus_link_t));
+    if (!link) {
+        return RT_NULL;
+    }
+    rt_memset(link, 0, sizeof(modbus_link_t));
+
+    if (link_end_init(&link->end[0], &link->end[1], name_a, baud_rate) != RT_EOK) {
+        rt_free(link);
+        return RT_NULL;
+    }
+    if (link_end_init(&link->end[1], &link->end[0], name_b, baud_rate) != RT_EOK) {
+        rt_timer_detach(&link->end[0].timer);
+        rt_device_unregister(&link->end[0].serial.parent);
+        rt_free(link);
+        return RT_NULL;
+    }
+
+    return link;
+}
+
+/**
+ * Unregister both ends and free the link
+ */
+void modbus_link_destroy(modbus_link_t *link)
+{
+    rt_uint8_t i;
+
+    if (!link) {
+        return;
+    }
+
+    for (i = 0; i < 2; i++) {
+        rt_timer_stop(&link->end[i].timer);
+        rt_timer_detach(&link->end[i].timer);
+        rt_device_unregister(&link->end[i].serial.parent);
+    }
+    rt_free(link);
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Null-modem pair of virtual serial ports
+ */
+
+#ifndef MODBUS_LINK_H__
+#define MODBUS_LINK_H__
+
+#include <rtthread.h>
+#include <rtdevice.h>
+
+#define MODBUS_LINK_POOL_SIZE       512
+
+/*
+ * Two virtual serial ports wired back to back. Bytes written to one end
+ * arrive at the other from a hard timer at the configured baud rate, with
+ * an RX indication per tick like the UART ISR gives, so a master and a
+ * slave endpoint can run against each other with real line timing.
+ */
+typedef struct modbus_link_end {
+    struct rt_serial_device serial;          /* Must be first: opened as a serial device */
+    struct modbus_link_end *peer;
+    struct rt_ringbuffer tx_rb;              /* Written, not yet on the wire */
+    rt_uint8_t tx_pool[MODBUS_LINK_POOL_SIZE];
+    struct rt_ringbuffer rx_rb;              /* Arrived, not yet read */
+    rt_uint8_t rx_pool[MODBUS_LINK_POOL_SIZE];
+    rt_uint32_t bit_credit;                  /* Line bits elapsed, scaled by RT_TICK_PER_SECOND */
+    rt_bool_t sending;
+    struct rt_timer timer;
+} modbus_link_end_t;
+
+typedef struct {
+    modbus_link_end_t end[2];
+} modbus_link_t;
+
+modbus_link_t *modbus_link_create(const char *name_a, const char *name_b, rt_uint32_t baud_rate);
+void modbus_link_destroy(modbus_link_t *link);
+
+#endif /* MODBUS_LINK_H__ */
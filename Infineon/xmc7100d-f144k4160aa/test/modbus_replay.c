@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Serial device replaying a Modbus bus capture
+ */
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "modbus_replay.h"
+#include "drv_uart.h"
+
+/**
+ * Local ticks until a recorded offset is due, at the replay speed
+ */
+static rt_tick_t replay_ticks(modbus_replay_t *replay, rt_uint32_t recorded)
+{
+    rt_uint64_t ticks = (rt_uint64_t)recorded * RT_TICK_PER_SECOND * 100 /
+                        ((rt_uint64_t)replay->header->tick_per_second * replay->speed_percent);
+
+    return (rt_tick_t)ticks;
+}
+
+/**
+ * Arm the timer for the next RX record, if the one at pos is one
+ * delta is added to the offset from the request, as records chain their deltas.
+ */
+static void replay_schedule(modbus_replay_t *replay)
+{
+    modbus_capture_record_t record;
+    rt_size_t pos = replay->pos;
+    rt_tick_t delay, elapsed;
+
+    replay->rx_pending = RT_FALSE;
+    if (modbus_capture_next(replay->data, replay->length, &pos, &record) != RT_EOK ||
+        record.direction != MODBUS_TAP_RX) {
+        return;
+    }
+
+    replay->rx_offset += record.delta_tick;
+    replay->rx_pending = RT_TRUE;
+    elapsed = rt_tick_get() - replay->rx_base;
+    delay = replay_ticks(replay, replay->rx_offset);
+    delay = delay > elapsed ? delay - elapsed : 1;
+    rt_timer_control(&replay->timer, RT_TIMER_CTRL_SET_TIME, &delay);
+    rt_timer_start(&replay->timer);
+}
+
+/**
+ * Hard timer: one recorded RX chunk arrives, as a burst of UART interrupts
+ */
+static void replay_timer_entry(void *parameter)
+{
+    modbus_replay_t *replay = (modbus_replay_t *)parameter;
+    rt_device_t dev = &replay->serial.parent;
+    modbus_capture_record_t record;
+
+    if (!replay->rx_pending ||
+        modbus_capture_next(replay->data, replay->length, &replay->pos, &record) != RT_EOK) {
+        replay->rx_pending = RT_FALSE;
+        return;
+    }
+
+    rt_ringbuffer_put(&replay->rx_rb, record.bytes, record.length);
+    replay->rx_records++;
+    if (dev->rx_indicate) {
+        dev->rx_indicate(dev, rt_ringbuffer_data_len(&replay->rx_rb));
+    }
+
+    replay_schedule(replay);
+}
+
+static rt_err_t replay_open(rt_device_t dev, rt_uint16_t oflag)
+{
+    RT_UNUSED(dev);
+    RT_UNUSED(oflag);
+    return RT_EOK;
+}
+
+static rt_err_t replay_close(rt_device_t dev)
+{
+    modbus_replay_t *replay = (modbus_replay_t *)dev;
+
+    rt_timer_stop(&replay->timer);
+    return RT_EOK;
+}
+
+static rt_ssize_t replay_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+    modbus_replay_t *replay = (modbus_replay_t *)dev;
+    rt_base_t level;
+    rt_size_t n;
+
+    RT_UNUSED(pos);
+
+    level = rt_hw_interrupt_disable();
+    n = rt_ringbuffer_get(&replay->rx_rb, buffer, size);
+    rt_hw_interrupt_enable(level);
+
+    return n;
+}
+
+/**
+ * A request lines up with the next TX record; replies not yet delivered
+ * to the previous one are overtaken, as the master has moved on.
+ */
+static rt_ssize_t replay_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+    modbus_replay_t *replay = (modbus_replay_t *)dev;
+    const rt_uint8_t *request = (const rt_uint8_t *)buffer;
+    modbus_capture_record_t record;
+    rt_size_t next, compared = 0;
+    rt_bool_t same = RT_TRUE;
+    rt_base_t level;
+
+    RT_UNUSED(pos);
+
+    rt_timer_stop(&replay->timer);
+    level = rt_hw_interrupt_disable();
+    replay->rx_pending = RT_FALSE;
+    rt_hw_interrupt_enable(level);
+    replay->requests++;
+
+    /* Skip to the next TX record */
+    for (;;) {
+        next = replay->pos;
+        if (modbus_capture_next(replay->data, replay->length, &next, &record) != RT_EOK) {
+            replay->exhausted++;
+            return size;
+        }
+        if (record.direction == MODBUS_TAP_TX) {
+            break;
+        }
+        replay->pos = next;
+        replay->skipped++;
+    }
+
+    /* Requests longer than a chunk were recorded as back-to-back TX records */
+    while (compared < size) {
+        next = replay->pos;
+        if (modbus_capture_next(replay->data, replay->length, &next, &record) != RT_EOK ||
+            record.direction != MODBUS_TAP_TX || (compared > 0 && record.delta_tick != 0)) {
+            break;
+        }
+        if (record.length > size - compared ||
+            rt_memcmp(record.bytes, &request[compared], record.length) != 0) {
+            same = RT_FALSE;
+        }
+        compared += record.length;
+        replay->pos = next;
+    }
+    if (same && compared == size) {
+        replay->matched++;
+    } else {
+        replay->mismatched++;
+    }
+
+    replay->rx_base = rt_tick_get();
+    replay->rx_offset = 0;
+    replay_schedule(replay);
+
+    return size;
+}
+
+static rt_err_t replay_control(rt_device_t dev, int cmd, void *args)
+{
+    modbus_replay_t *replay = (modbus_replay_t *)dev;
+
+    if (cmd == RT_DEVICE_CTRL_CONFIG && args) {
+        replay->serial.config = *(struct serial_configure *)args;
+    } else if (cmd == IFX_UART_CTRL_SET_DE && !args) {
+        return -RT_EINVAL;
+    }
+
+    return RT_EOK;
+}
+
+#ifdef RT_USING_DEVICE_OPS
+static const struct rt_device_ops replay_ops =
+{
+    RT_NULL,
+    replay_open,
+    replay_close,
+    replay_read,
+    replay_write,
+    replay_control
+};
+#endif
+
+/**
+ * Load a capture file into memory
+ */
+static rt_uint8_t *replay_load(const char *path, rt_size_t *length)
+{
+    struct stat st;
+    rt_uint8_t *data;
+    int fd;
+
+    if (stat(path, &st) != 0 || st.st_size <= 0) {
+        return RT_NULL;
+    }
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return RT_NULL;
+    }
+
+    data = (rt_uint8_t *)rt_malloc(st.st_size);
+    if (data && read(fd, data, st.st_size) != st.st_size) {
+        rt_free(data);
+        data = RT_NULL;
+    }
+    close(fd);
+
+    *length = st.st_size;
+    return data;
+}
+
+/**
+ * Register serial device 'name' answering from the capture at path
+ * speed_percent 100 keeps the recorded timing, 200 halves every delay.
+ */
+modbus_replay_t *modbus_replay_create(const char *name, const char *path, rt_uint32_t speed_percent)
+{
+    struct serial_configure config = RT_SERIAL_CONFIG_DEFAULT;
+    modbus_replay_t *replay;
+    rt_device_t dev;
+
+    if (!name || !path || speed_percent == 0) {
+        return RT_NULL;
+    }
+
+    replay = (modbus_replay_t *)rt_malloc(sizeof(modbus_replay_t));
+    if (!replay) {
+        return RT_NULL;
+    }
+    rt_memset(replay, 0, sizeof(modbus_replay_t));
+
+    replay->data = replay_load(path, &replay->length);
+    if (!replay->data ||
+        modbus_capture_parse(replay->data, replay->length, &replay->header, &replay->pos) != RT_EOK) {
+        rt_kprintf("[MB_REPLAY] Error: %s is not a Modbus capture\n", path);
+        rt_free(replay->data);
+        rt_free(replay);
+        return RT_NULL;
+    }
+    replay->speed_percent = speed_percent;
+
+    /* The master picks up the recorded baud rate and its timing rules */
+    config.baud_rate = replay->header->baud_rate;
+    replay->serial.config = config;
+
+    rt_ringbuffer_init(&replay->rx_rb, replay->rx_pool, sizeof(replay->rx_pool));
+    rt_timer_init(&replay->timer, name, replay_timer_entry, replay, 1,
+                  RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_HARD_TIMER);
+
+    dev = &replay->serial.parent;
+    dev->type = RT_Device_Class_Char;
+#ifdef RT_USING_DEVICE_OPS
+    dev->ops = &replay_ops;
+#else
+    dev->open = replay_open;
+    dev->close = replay_close;
+    dev->read = replay_read;
+    dev->write = replay_write;
+    dev->control = replay_control;
+#endif
+
+    if (rt_device_register(dev, name, RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_INT_RX) != RT_EOK) {
+        rt_timer_detach(&replay->timer);
+        rt_free(replay->data);
+        rt_free(replay);
+        return RT_NULL;
+    }
+
+    return replay;
+}
+
+/**
+ * Unregister a replay device and free its capture
+ */
+void modbus_replay_destroy(modbus_replay_t *replay)
+{
+    if (!replay) {
+        return;
+    }
+
+    rt_timer_stop(&replay->timer);
+    rt_timer_detach(&replay->timer);
+    rt_device_unregister(&replay->serial.parent);
+    rt_free(replay->data);
+    rt_free(replay);
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Serial device replaying a Modbus bus capture
+ */
+
+#ifndef MODBUS_REPLAY_H__
+#define MODBUS_REPLAY_H__
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "modbus_capture.h"
+
+#define MODBUS_REPLAY_RX_POOL_SIZE  512
+
+/*
+ * Virtual serial port that answers the master from a capture. Each request
+ * written is lined up with the next TX record, and the RX records that
+ * followed it in the field are delivered at their recorded offsets, divided
+ * by speed_percent / 100. The master's parser, timeouts, retries and queue
+ * run unchanged, so a field trace becomes a repeatable benchmark.
+ */
+typedef struct {
+    struct rt_serial_device serial;          /* Must be first: opened as a serial device */
+    rt_uint8_t *data;                        /* Whole capture file */
+    rt_size_t length;
+    const modbus_capture_header_t *header;
+    rt_size_t pos;                           /* Next record not yet replayed */
+    rt_uint32_t speed_percent;               /* 100 = recorded timing */
+
+    /* RX records answering the last request */
+    rt_tick_t rx_base;                       /* Tick the request was written */
+    rt_uint32_t rx_offset;                   /* Recorded ticks from the request to the next RX record */
+    rt_bool_t rx_pending;
+    struct rt_timer timer;
+
+    /* Bytes already "received" by the master's UART */
+    struct rt_ringbuffer rx_rb;
+    rt_uint8_t rx_pool[MODBUS_REPLAY_RX_POOL_SIZE];
+
+    /* Statistics */
+    rt_uint32_t requests;
+    rt_uint32_t matched;                     /* Request identical to the recorded one */
+    rt_uint32_t mismatched;
+    rt_uint32_t rx_records;                  /* Delivered */
+    rt_uint32_t skipped;                     /* RX records overtaken by the next request */
+    rt_uint32_t exhausted;                   /* Requests past the end of the capture */
+} modbus_replay_t;
+
+modbus_replay_t *modbus_replay_create(const char *name, const char *path, rt_uint32_t speed_percent);
+void modbus_replay_destroy(modbus_replay_t *replay);
+
+#endif /* MODBUS_REPLAY_H__ */
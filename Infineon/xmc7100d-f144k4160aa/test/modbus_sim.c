@@ -0,0 +1,663 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Simulated Modbus RTU slave on a virtual serial port
+ * 2026-10-16     Developer    Several virtual slaves on one segment
+ * 2026-10-16     Developer    Measurement cycle with sample age accounting
+ * 2026-10-16     Developer    Busy, corrupted and dropped reply injection
+ * 2026-10-16     Developer    FC16, FC23 and broadcast writes
+ * 2026-10-16     Developer    Per-slave latency, latency jitter and random drops
+ * 2026-10-16     Developer    RS-485 line turnaround timing
+ * 2026-10-16     Developer    S8 register map, line noise, lost bytes and split replies
+ * 2026-10-16     Developer    Calibration ongoing bit driven by calibration commands
+ * 2026-10-16     Developer    Shared test verdict and simulated bus setup
+ * 2026-10-16     Developer    Refused calibration writes, command registers cleared by the sensor
+ */
+
+#include "modbus_sim.h"
+#include "s8_regmap.h"
+#include "s8_sensor.h"
+#include "drv_uart.h"
+
+/* 8N1 plus the idle bit the Modbus timing rules assume */
+#define SIM_BITS_PER_CHAR   11
+
+/**
+ * Time a number of characters occupy on the wire
+ */
+rt_uint32_t modbus_sim_wire_time_us(modbus_sim_t *sim, rt_size_t bytes)
+{
+    return (rt_uint32_t)((rt_uint64_t)bytes * SIM_BITS_PER_CHAR * 1000000UL / sim->serial.config.baud_rate);
+}
+
+/**
+ * Next value of the jitter and drop generator, uniform in 0 .. range - 1
+ */
+static rt_uint32_t sim_random(modbus_sim_t *sim, rt_uint32_t range)
+{
+    sim->random = sim->random * 1103515245UL + 12345UL;
+    return (sim->random >> 8) % range;
+}
+
+/**
+ * IR4 of one virtual slave under the measurement cycle, with age accounting
+ */
+static rt_uint16_t sim_measurement(modbus_sim_t *sim, rt_uint8_t slave)
+{
+    rt_tick_t period = rt_tick_from_millisecond(sim->update_period_ms);
+    rt_tick_t since, age;
+    rt_uint32_t index;
+
+    /* Slave i's first update is at epoch + offset; before that it holds index 0 */
+    since = rt_tick_get() - sim->update_epoch -
+            rt_tick_from_millisecond(slave * MODBUS_SIM_PHASE_STEP_MS % sim->update_period_ms);
+    if ((rt_int32_t)since < 0) {
+        since = 0;
+    }
+    index = since / period;
+    age = since - index * period;
+
+    if (sim->served_update[slave] == index + 1) {
+        sim->duplicate_reads++;
+    } else {
+        sim->fresh_reads++;
+        age = age * 1000 / RT_TICK_PER_SECOND;
+        sim->age_sum_ms += age;
+        if (age > sim->age_max_ms) {
+            sim->age_max_ms = age;
+        }
+    }
+    sim->served_update[slave] = index + 1;
+
+    /* Always differs from the previous update's value */
+    return (rt_uint16_t)(400 + (index * 7 + slave) % 500);
+}
+
+/**
+ * Append the CRC to a reply of n bytes, returns the frame length
+ */
+static rt_size_t sim_seal(rt_uint8_t *out, rt_size_t n)
+{
+    rt_uint16_t crc = modbus_crc16(out, (rt_uint16_t)n);
+
+    out[n++] = crc >> 8;
+    out[n++] = crc & 0xFF;
+    return n;
+}
+
+/**
+ * Length a request frame should have according to its header, 0 if too short to tell
+ */
+static rt_size_t sim_request_length(const rt_uint8_t *req, rt_size_t len)
+{
+    if (len < 8) {
+        return 0;
+    }
+
+    switch (req[1]) {
+    case MODBUS_FUNC_WRITE_MULTIPLE_REGS:
+        return 9 + req[6];
+    case MODBUS_FUNC_READ_WRITE_REGS:
+        return (len >= 11) ? 13 + req[10] : 0;
+    default:
+        return 8;
+    }
+}
+
+/**
+ * Store register values from a request into the holding registers
+ */
+static void sim_store(modbus_sim_t *sim, rt_uint16_t start, rt_uint16_t count, const rt_uint8_t *data)
+{
+    rt_uint16_t i;
+
+    for (i = 0; i < count; i++) {
+        sim->holding_regs[start + i] = (data[i * 2] << 8) | data[i * 2 + 1];
+    }
+}
+
+/**
+ * Whether a holding register is one of the calibration commands
+ */
+static rt_bool_t sim_cal_register(rt_uint16_t reg)
+{
+    return reg == S8_REG_ZERO_CAL || reg == S8_REG_BACKGROUND_CAL || reg == S8_REG_SINGLE_POINT_CAL;
+}
+
+/**
+ * A write to a calibration register, returns RT_FALSE if it is refused
+ */
+static rt_bool_t sim_calibrate(modbus_sim_t *sim, rt_uint16_t reg, rt_uint16_t value)
+{
+    if (!sim_cal_register(reg)) {
+        return RT_TRUE;
+    }
+    if (sim->cal_refuse_writes > 0) {
+        sim->cal_refuse_writes--;
+        return RT_FALSE;
+    }
+    if (sim->cal_duration_ms == 0) {
+        return RT_TRUE;
+    }
+
+    if (value != S8_CAL_COMMAND_STOP) {
+        sim->cal_active = RT_TRUE;
+        sim->cal_until = rt_tick_get() + rt_tick_from_millisecond(sim->cal_duration_ms);
+        sim->cal_commands++;
+    } else if (reg != S8_REG_SINGLE_POINT_CAL) {
+        sim->cal_active = RT_FALSE;
+    }
+    return RT_TRUE;
+}
+
+/**
+ * Whether IR1 shows a calibration in progress
+ */
+static rt_bool_t sim_calibrating(modbus_sim_t *sim)
+{
+    if (sim->cal_active && (rt_int32_t)(sim->cal_until - rt_tick_get()) <= 0) {
+        sim->cal_active = RT_FALSE;
+    }
+    return sim->cal_active;
+}
+
+/**
+ * Build the reply for one request frame, returns reply length (0 = no reply)
+ */
+static rt_size_t sim_build_reply(modbus_sim_t *sim, const rt_uint8_t *req, rt_size_t len)
+{
+    rt_uint8_t *out = sim->reply;
+    rt_uint16_t start, count, waddr, wcount, i, value;
+    rt_size_t n;
+    rt_uint8_t slave;
+    const rt_uint16_t *regs;
+
+    if (len != sim_request_length(req, len) ||
+        modbus_crc16((rt_uint8_t *)req, (rt_uint16_t)(len - 2)) != ((req[len - 2] << 8) | req[len - 1])) {
+        sim->bad_requests++;
+        return 0;
+    }
+
+    if (req[0] == S8_MODBUS_ADDRESS || req[0] == MODBUS_BROADCAST_ADDRESS) {
+        slave = 0;
+    } else if (req[0] >= sim->slave_addr && req[0] - sim->slave_addr < sim->slave_count) {
+        slave = (req[0] - sim->slave_addr) % MODBUS_SIM_MAX_SLAVES;
+    } else {
+        return 0;   /* Nobody at this address */
+    }
+    sim->slave_requests[slave]++;
+    sim->reply_slave = slave;
+
+    start = (req[2] << 8) | req[3];
+    count = (req[4] << 8) | req[5];
+    out[0] = req[0];
+    out[1] = req[1];
+
+    if (sim->drop_replies > 0) {
+        sim->drop_replies--;
+        return 0;
+    }
+    if (sim->drop_permille && sim_random(sim, 1000) < sim->drop_permille) {
+        return 0;
+    }
+    if (sim->busy_replies > 0) {
+        sim->busy_replies--;
+        out[1] |= 0x80;
+        out[2] = MODBUS_EX_SLAVE_BUSY;
+        return sim_seal(out, 3);
+    }
+
+    switch (req[1]) {
+    case MODBUS_FUNC_READ_INPUT_REGS:
+    case MODBUS_FUNC_READ_HOLDING_REGS:
+        if (count == 0 || start + count > MODBUS_SIM_REG_COUNT) {
+            out[1] |= 0x80;
+            out[2] = 0x02;  /* Illegal data address */
+            n = 3;
+            break;
+        }
+        regs = (req[1] == MODBUS_FUNC_READ_INPUT_REGS) ? sim->input_regs : sim->holding_regs;
+        out[2] = (rt_uint8_t)(count * 2);
+        for (i = 0; i < count; i++) {
+            value = regs[start + i];
+            if (regs == sim->input_regs && start + i == MODBUS_SIM_CO2_REG && sim->update_period_ms) {
+                value = sim_measurement(sim, slave);
+            }
+            if (regs == sim->input_regs && start + i == S8_REG_METER_STATUS && sim_calibrating(sim)) {
+                value |= S8_METER_STATUS_CAL_ONGOING;
+            }
+            out[3 + i * 2] = value >> 8;
+            out[4 + i * 2] = value & 0xFF;
+        }
+        n = 3 + count * 2;
+        break;
+
+    case MODBUS_FUNC_WRITE_SINGLE_REG:
+        if (start < MODBUS_SIM_REG_COUNT && !sim_calibrate(sim, start, count)) {
+            out[1] |= 0x80;
+            out[2] = 0x04;  /* Slave device failure */
+            n = 3;
+            break;
+        }
+        if (start < MODBUS_SIM_REG_COUNT) {
+            sim->holding_regs[start] = (sim->cal_clear_commands && sim_cal_register(start)) ? 0 : count;
+        }
+        rt_memcpy(out, req, 6);  /* Echo */
+        n = 6;
+        break;
+
+    case MODBUS_FUNC_WRITE_MULTIPLE_REGS:
+        if (count == 0 || start + count > MODBUS_SIM_REG_COUNT || req[6] != count * 2) {
+            out[1] |= 0x80;
+            out[2] = 0x02;  /* Illegal data address */
+            n = 3;
+            break;
+        }
+        sim_store(sim, start, count, &req[7]);
+        rt_memcpy(out, req, 6);  /* Address and quantity */
+        n = 6;
+        break;
+
+    case MODBUS_FUNC_READ_WRITE_REGS:
+        waddr = (req[6] << 8) | req[7];
+        wcount = (req[8] << 8) | req[9];
+        if (count == 0 || start + count > MODBUS_SIM_REG_COUNT ||
+            wcount == 0 || waddr + wcount > MODBUS_SIM_REG_COUNT || req[10] != wcount * 2) {
+            out[1] |= 0x80;
+            out[2] = 0x02;  /* Illegal data address */
+            n = 3;
+            break;
+        }
+        sim_store(sim, waddr, wcount, &req[11]);    /* Write happens before the read */
+        out[2] = (rt_uint8_t)(count * 2);
+        for (i = 0; i < count; i++) {
+            out[3 + i * 2] = sim->holding_regs[start + i] >> 8;
+            out[4 + i * 2] = sim->holding_regs[start + i] & 0xFF;
+        }
+        n = 3 + count * 2;
+        break;
+
+    default:
+        out[1] |= 0x80;
+        out[2] = 0x01;  /* Illegal function */
+        n = 3;
+        break;
+    }
+
+    if (req[0] == MODBUS_BROADCAST_ADDRESS) {
+        return 0;   /* Applied, never answered */
+    }
+    return sim_seal(out, n);
+}
+
+/**
+ * Hard timer: push reply bytes into the RX ring at line rate, like the UART ISR
+ */
+static void sim_timer_entry(void *parameter)
+{
+    modbus_sim_t *sim = (modbus_sim_t *)parameter;
+    rt_device_t dev = &sim->serial.parent;
+    rt_size_t delivered = 0;
+    rt_tick_t period = 1;
+    rt_uint8_t byte;
+
+    if ((rt_int32_t)(rt_tick_get() - sim->reply_due) >= 0) {
+        sim->bit_credit += sim->serial.config.baud_rate;
+        while (sim->reply_pos < sim->reply_len &&
+               sim->bit_credit >= SIM_BITS_PER_CHAR * RT_TICK_PER_SECOND) {
+            sim->bit_credit -= SIM_BITS_PER_CHAR * RT_TICK_PER_SECOND;
+            if (sim->noise_pending > 0) {
+                /* Noise occupies the line like any character */
+                sim->noise_pending--;
+                byte = (rt_uint8_t)sim_random(sim, 256);
+            } else if (sim->split_at && sim->reply_pos == sim->split_at) {
+                /* Slave stalls mid-frame, then carries on */
+                sim->split_at = 0;
+                sim->bit_credit = 0;
+                sim->reply_due = rt_tick_get() + rt_tick_from_millisecond(sim->split_gap_ms);
+                break;
+            } else {
+                byte = sim->reply[sim->reply_pos++];
+                if (sim->byte_drop_permille && sim_random(sim, 1000) < sim->byte_drop_permille) {
+                    sim->lost_bytes++;
+                    continue;
+                }
+            }
+            rt_ringbuffer_put(&sim->rx_rb, &byte, 1);
+            delivered++;
+        }
+    }
+
+    if (delivered > 0 && dev->rx_indicate) {
+        dev->rx_indicate(dev, rt_ringbuffer_data_len(&sim->rx_rb));
+    }
+
+    if (sim->reply_pos < sim->reply_len) {
+        rt_timer_control(&sim->timer, RT_TIMER_CTRL_SET_TIME, &period);
+        rt_timer_start(&sim->timer);
+    } else {
+        sim->replies++;
+    }
+}
+
+/**
+ * Hard timer: the request's last stop bit is out, as the UART "done" interrupt
+ */
+static void sim_tx_timer_entry(void *parameter)
+{
+    modbus_sim_t *sim = (modbus_sim_t *)parameter;
+    rt_device_t dev = &sim->serial.parent;
+
+    if (dev->tx_complete) {
+        dev->tx_complete(dev, RT_NULL);
+    }
+}
+
+/**
+ * Line idle between the master releasing its driver and the reply starting
+ * A negative gap means the reply collided with the driver: the characters
+ * it overlapped never reach the master, and reply_pos skips them.
+ */
+static void sim_turnaround(modbus_sim_t *sim, rt_uint32_t wire_us, rt_tick_t delay)
+{
+    rt_uint32_t release_us = wire_us + (sim->de_control ? 0 : sim->auto_direction_us);
+    rt_uint32_t char_us = modbus_sim_wire_time_us(sim, 1);
+    rt_int32_t gap;
+
+    gap = (rt_int32_t)(delay * (1000000UL / RT_TICK_PER_SECOND)) - (rt_int32_t)release_us;
+    sim->last_gap_us = gap;
+    if (sim->gaps == 0 || gap < sim->gap_min_us) {
+        sim->gap_min_us = gap;
+    }
+    if (sim->gaps == 0 || gap > sim->gap_max_us) {
+        sim->gap_max_us = gap;
+    }
+    sim->gaps++;
+
+    if (gap < 0) {
+        sim->clipped_replies++;
+        sim->reply_pos = (rt_size_t)((-gap + char_us - 1) / char_us);
+        if (sim->reply_pos > sim->reply_len) {
+            sim->reply_pos = sim->reply_len;
+        }
+    }
+}
+
+static rt_err_t sim_open(rt_device_t dev, rt_uint16_t oflag)
+{
+    RT_UNUSED(dev);
+    RT_UNUSED(oflag);
+    return RT_EOK;
+}
+
+static rt_err_t sim_close(rt_device_t dev)
+{
+    modbus_sim_t *sim = (modbus_sim_t *)dev;
+
+    rt_timer_stop(&sim->timer);
+    rt_timer_stop(&sim->tx_timer);
+    return RT_EOK;
+}
+
+static rt_ssize_t sim_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+    modbus_sim_t *sim = (modbus_sim_t *)dev;
+    rt_base_t level;
+    rt_size_t n;
+
+    RT_UNUSED(pos);
+
+    level = rt_hw_interrupt_disable();
+    n = rt_ringbuffer_get(&sim->rx_rb, buffer, size);
+    rt_hw_interrupt_enable(level);
+
+    return n;
+}
+
+static rt_ssize_t sim_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+    modbus_sim_t *sim = (modbus_sim_t *)dev;
+    rt_uint32_t wire_us = modbus_sim_wire_time_us(sim, size);
+    rt_tick_t delay;
+
+    RT_UNUSED(pos);
+
+    /* Driver released after the last stop bit, replied to or not */
+    if (sim->de_control) {
+        delay = rt_tick_from_millisecond((wire_us + 999) / 1000);
+        rt_timer_control(&sim->tx_timer, RT_TIMER_CTRL_SET_TIME, &delay);
+        rt_timer_start(&sim->tx_timer);
+    }
+
+    sim->requests++;
+    if (sim->reply_pos < sim->reply_len) {
+        /* Still answering the previous request; a real slave would be deaf */
+        return size;
+    }
+
+    sim->reply_len = sim_build_reply(sim, (const rt_uint8_t *)buffer, size);
+    sim->reply_pos = 0;
+    sim->bit_credit = 0;
+    if (sim->reply_len == 0) {
+        return size;
+    }
+    if (sim->corrupt_replies > 0 ||
+        (sim->corrupt_permille && sim_random(sim, 1000) < sim->corrupt_permille)) {
+        if (sim->corrupt_replies > 0) {
+            sim->corrupt_replies--;
+        }
+        sim->reply[sim->reply_len / 2] ^= 0x04;
+        sim->corrupted++;
+    }
+    sim->noise_pending = 0;
+    if (sim->noise_permille && sim_random(sim, 1000) < sim->noise_permille) {
+        sim->noise_pending = (rt_uint8_t)(1 + sim_random(sim, MODBUS_SIM_NOISE_MAX));
+        sim->noise_bursts++;
+    }
+    sim->split_at = 0;
+    if (sim->split_permille && sim->reply_len > 2 && sim_random(sim, 1000) < sim->split_permille) {
+        sim->split_at = 1 + sim_random(sim, sim->reply_len - 1);
+        sim->split_replies++;
+    }
+
+    /* Request leaves the master's FIFO at line rate, then the slave turns around */
+    delay = rt_tick_from_millisecond((wire_us + 999) / 1000 + sim->latency_ms +
+                                     sim->slave_latency_ms[sim->reply_slave] +
+                                     (sim->jitter_ms ? sim_random(sim, sim->jitter_ms + 1) : 0));
+    sim->reply_due = rt_tick_get() + delay;
+    sim_turnaround(sim, wire_us, delay);
+    if (sim->reply_pos >= sim->reply_len) {
+        sim->reply_len = 0;     /* Lost entirely under the master's driver */
+        return size;
+    }
+    if (delay == 0) {
+        delay = 1;
+    }
+    rt_timer_control(&sim->timer, RT_TIMER_CTRL_SET_TIME, &delay);
+    rt_timer_start(&sim->timer);
+
+    return size;
+}
+
+static rt_err_t sim_control(rt_device_t dev, int cmd, void *args)
+{
+    modbus_sim_t *sim = (modbus_sim_t *)dev;
+
+    if (cmd == RT_DEVICE_CTRL_CONFIG && args) {
+        sim->serial.config = *(struct serial_configure *)args;
+    } else if (cmd == IFX_UART_CTRL_SET_DE) {
+        if (!args) {
+            return -RT_EINVAL;
+        }
+        rt_timer_stop(&sim->tx_timer);
+        sim->de_control = ((struct ifx_uart_de *)args)->pin >= 0;
+    }
+
+    return RT_EOK;
+}
+
+#ifdef RT_USING_DEVICE_OPS
+static const struct rt_device_ops sim_ops =
+{
+    RT_NULL,
+    sim_open,
+    sim_close,
+    sim_read,
+    sim_write,
+    sim_control
+};
+#endif
+
+/**
+ * Create and register a simulated slave as serial device 'name'
+ */
+modbus_sim_t *modbus_sim_create(const char *name, rt_uint32_t baud_rate, rt_uint8_t slave_addr)
+{
+    struct serial_configure config = RT_SERIAL_CONFIG_DEFAULT;
+    modbus_sim_t *sim;
+    rt_device_t dev;
+
+    sim = (modbus_sim_t *)rt_malloc(sizeof(modbus_sim_t));
+    if (!sim) {
+        return RT_NULL;
+    }
+
+    rt_memset(sim, 0, sizeof(modbus_sim_t));
+    config.baud_rate = baud_rate;
+    sim->serial.config = config;
+    sim->slave_addr = slave_addr;
+    sim->slave_count = 1;
+    sim->latency_ms = 2;
+    sim->random = 1;
+    sim->split_gap_ms = 2;
+
+    /* Register map of a healthy S8 LP */
+    sim->input_regs[S8_REG_METER_STATUS] = 0x0000;
+    sim->input_regs[S8_REG_ALARM_STATUS] = 0x0000;
+    sim->input_regs[S8_REG_OUTPUT_STATUS] = 0x0001;
+    sim->input_regs[MODBUS_SIM_CO2_REG] = 450;   /* CO2 ppm */
+    sim->input_regs[S8_REG_SENSOR_TYPE_HIGH] = 0x0001;
+    sim->input_regs[S8_REG_SENSOR_TYPE_LOW] = 0x0108;
+    sim->input_regs[S8_REG_MEMORY_MAP] = 0x0006;
+    sim->input_regs[S8_REG_FIRMWARE_VERSION] = 0x0503;
+    sim->holding_regs[S8_REG_ALARM_THRESHOLD] = 1000;
+
+    rt_ringbuffer_init(&sim->rx_rb, sim->rx_pool, sizeof(sim->rx_pool));
+    rt_timer_init(&sim->timer, name, sim_timer_entry, sim, 1,
+                  RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_HARD_TIMER);
+    rt_timer_init(&sim->tx_timer, name, sim_tx_timer_entry, sim, 1,
+                  RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_HARD_TIMER);
+
+    dev = &sim->serial.parent;
+    dev->type = RT_Device_Class_Char;
+#ifdef RT_USING_DEVICE_OPS
+    dev->ops = &sim_ops;
+#else
+    dev->open = sim_open;
+    dev->close = sim_close;
+    dev->read = sim_read;
+    dev->write = sim_write;
+    dev->control = sim_control;
+#endif
+
+    if (rt_device_register(dev, name, RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_INT_RX) != RT_EOK) {
+        rt_timer_detach(&sim->timer);
+        rt_timer_detach(&sim->tx_timer);
+        rt_free(sim);
+        return RT_NULL;
+    }
+
+    return sim;
+}
+
+/**
+ * Unregister and free a simulated slave
+ */
+void modbus_sim_destroy(modbus_sim_t *sim)
+{
+    if (!sim) {
+        return;
+    }
+
+    rt_timer_stop(&sim->timer);
+    rt_timer_detach(&sim->timer);
+    rt_timer_stop(&sim->tx_timer);
+    rt_timer_detach(&sim->tx_timer);
+    rt_device_unregister(&sim->serial.parent);
+    rt_free(sim);
+}
+
+/* Verdict of the test running */
+static const char *modbus_test_tag = "[TEST]";
+static rt_uint32_t modbus_test_failures;
+
+/**
+ * Start a test; tag prefixes its failure messages
+ */
+void modbus_test_begin(const char *tag)
+{
+    modbus_test_tag = tag;
+    modbus_test_failures = 0;
+}
+
+/**
+ * Record one expectation of the running test
+ */
+void modbus_test_check(rt_bool_t condition, const char *what)
+{
+    if (!condition) {
+        rt_kprintf("%s FAIL: %s\n", modbus_test_tag, what);
+        modbus_test_failures++;
+    }
+}
+
+/**
+ * Print the verdict of the running test, returns its failure count
+ */
+rt_uint32_t modbus_test_end(const char *name)
+{
+    rt_kprintf("\n=== %s: %s (%d failures) ===\n", name,
+               modbus_test_failures ? "FAIL" : "PASS", modbus_test_failures);
+    return modbus_test_failures;
+}
+
+/**
+ * Simulated slave on MODBUS_SIM_NAME and, if mb is given, a master on it
+ * Reports what failed and returns RT_NULL, leaving nothing behind.
+ */
+modbus_sim_t *modbus_test_setup(rt_uint32_t baud_rate, rt_uint8_t slave_addr, modbus_rtu_device_t **mb)
+{
+    modbus_sim_t *sim;
+
+    sim = modbus_sim_create(MODBUS_SIM_NAME, baud_rate, slave_addr);
+    if (!sim) {
+        rt_kprintf("%s Failed to create simulated UART\n", modbus_test_tag);
+        return RT_NULL;
+    }
+    if (!mb) {
+        return sim;
+    }
+
+    *mb = modbus_rtu_init(MODBUS_SIM_NAME);
+    if (!*mb) {
+        rt_kprintf("%s Modbus init on simulated UART failed\n", modbus_test_tag);
+        modbus_sim_destroy(sim);
+        return RT_NULL;
+    }
+    return sim;
+}
+
+/**
+ * Undo modbus_test_setup(); mb may be RT_NULL
+ */
+void modbus_test_teardown(modbus_sim_t *sim, modbus_rtu_device_t *mb)
+{
+    if (mb) {
+        modbus_rtu_deinit(mb);
+    }
+    modbus_sim_destroy(sim);
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Simulated Modbus RTU slave on a virtual serial port
+ * 2026-10-16     Developer    Several virtual slaves on one segment
+ * 2026-10-16     Developer    Measurement cycle with sample age accounting
+ * 2026-10-16     Developer    Busy, corrupted and dropped reply injection
+ * 2026-10-16     Developer    Per-slave latency, latency jitter and random drops
+ * 2026-10-16     Developer    RS-485 line turnaround timing
+ * 2026-10-16     Developer    S8 register map, line noise, lost bytes and split replies
+ * 2026-10-16     Developer    Calibration ongoing bit driven by calibration commands
+ * 2026-10-16     Developer    Shared test verdict and simulated bus setup
+ * 2026-10-16     Developer    Refused calibration writes, command registers cleared by the sensor
+ */
+
+#ifndef MODBUS_SIM_H__
+#define MODBUS_SIM_H__
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "modbus_rtu.h"
+
+#define MODBUS_SIM_REG_COUNT        32
+#define MODBUS_SIM_RX_POOL_SIZE     512
+#define MODBUS_SIM_MAX_SLAVES       16
+#define MODBUS_SIM_CO2_REG          3       /* IR4 */
+#define MODBUS_SIM_PHASE_STEP_MS    311     /* Update offset between neighbouring slaves */
+#define MODBUS_SIM_NOISE_MAX        3       /* Longest noise burst ahead of a reply, bytes */
+#define MODBUS_SIM_NAME             "mbsim" /* Serial device the tests open */
+
+/*
+ * Virtual serial port that answers Modbus RTU requests like an S8 sensor.
+ * Register it, then pass its name to modbus_rtu_init(). Replies are delivered
+ * byte by byte from a hard timer at the configured baud rate, so the master
+ * sees the same RX indications it would get from the UART ISR.
+ */
+typedef struct {
+    struct rt_serial_device serial;          /* Must be first: opened as a serial device */
+    rt_uint8_t slave_addr;                   /* Also answers the 0xFE broadcast address */
+    rt_uint8_t slave_count;                  /* Answers slave_addr .. slave_addr + slave_count - 1 */
+    rt_uint32_t latency_ms;                  /* Slave turnaround before the first reply byte */
+    rt_uint32_t jitter_ms;                   /* Uniform 0..jitter_ms added to each turnaround */
+    rt_uint32_t slave_latency_ms[MODBUS_SIM_MAX_SLAVES];  /* Extra turnaround, e.g. a long line */
+    rt_uint16_t input_regs[MODBUS_SIM_REG_COUNT];
+    rt_uint16_t holding_regs[MODBUS_SIM_REG_COUNT];
+
+    /* Measurement cycle: IR4 takes a new value every update_period_ms from
+     * update_epoch on, slave i offset by i * MODBUS_SIM_PHASE_STEP_MS.
+     * 0 leaves IR4 as set in input_regs. */
+    rt_uint32_t update_period_ms;
+    rt_tick_t update_epoch;
+    rt_uint32_t served_update[MODBUS_SIM_MAX_SLAVES];   /* Last update index read, plus one */
+
+    /* Calibration: a start written to a calibration register sets the
+     * calibration ongoing bit of IR1 for cal_duration_ms, and a stop
+     * clears it. 0 leaves IR1 as set in input_regs. */
+    rt_uint32_t cal_duration_ms;
+    rt_uint32_t cal_refuse_writes;           /* Calibration writes answered with exception 04, counts down */
+    rt_bool_t cal_clear_commands;            /* Calibration registers read back 0 once acted on */
+    rt_bool_t cal_active;
+    rt_tick_t cal_until;
+    rt_uint32_t cal_commands;                /* Calibration starts kept */
+
+    /* Fault injection, each counts down per answered request */
+    rt_uint32_t busy_replies;                /* Answer with exception 06, slave device busy */
+    rt_uint32_t corrupt_replies;             /* Flip a bit in the reply so its CRC fails */
+    rt_uint32_t drop_replies;                /* Stay silent */
+    rt_uint16_t drop_permille;               /* Share of requests left unanswered at random */
+    rt_uint32_t random;                      /* Jitter and drop generator state */
+
+    /* Line faults, drawn at random per reply or per reply byte */
+    rt_uint16_t corrupt_permille;            /* Replies with a flipped bit */
+    rt_uint16_t noise_permille;              /* Replies preceded by a burst of noise bytes */
+    rt_uint16_t byte_drop_permille;          /* Reply bytes lost to framing errors */
+    rt_uint16_t split_permille;              /* Replies that stall part way through */
+    rt_uint32_t split_gap_ms;                /* Length of that stall */
+
+    /* Half-duplex line: the master's driver stays on until it is released.
+     * Under driver-enable control (IFX_UART_CTRL_SET_DE) that is the last
+     * stop bit, and tx_complete fires then; otherwise the transceiver holds
+     * the line auto_direction_us longer. Reply bytes that start while the
+     * master still drives the line are lost. */
+    rt_bool_t de_control;
+    rt_uint32_t auto_direction_us;           /* Driver hold after the last stop bit without DE control */
+    rt_int32_t last_gap_us;                  /* Driver released -> reply start, < 0 = overlap */
+    rt_int32_t gap_min_us;
+    rt_int32_t gap_max_us;
+    rt_uint32_t gaps;                        /* Replies the gap figures cover */
+    rt_uint32_t clipped_replies;             /* Replies that lost bytes to the master's driver */
+    struct rt_timer tx_timer;                /* Transmit complete of the request */
+
+    /* Reply in flight */
+    rt_uint8_t reply[MODBUS_MAX_BUFFER_SIZE];
+    rt_size_t reply_len;
+    rt_size_t reply_pos;
+    rt_uint32_t bit_credit;                  /* Line bits elapsed, scaled by RT_TICK_PER_SECOND */
+    rt_tick_t reply_due;                     /* Tick the first reply byte starts */
+    rt_uint8_t reply_slave;                  /* Virtual slave answering */
+    rt_uint8_t noise_pending;                /* Noise bytes still to go out before the reply */
+    rt_size_t split_at;                      /* Reply byte the stall comes before, 0 = none */
+    struct rt_timer timer;
+
+    /* Bytes already "received" by the master's UART */
+    struct rt_ringbuffer rx_rb;
+    rt_uint8_t rx_pool[MODBUS_SIM_RX_POOL_SIZE];
+
+    /* Statistics */
+    rt_uint32_t requests;
+    rt_uint32_t replies;
+    rt_uint32_t bad_requests;
+    rt_uint32_t slave_requests[MODBUS_SIM_MAX_SLAVES];  /* Answered, per virtual slave */
+    rt_uint32_t fresh_reads;                 /* IR4 reads that returned a new measurement */
+    rt_uint32_t duplicate_reads;             /* IR4 reads that returned the last one again */
+    rt_uint32_t age_sum_ms;                  /* Measurement age when first read */
+    rt_uint32_t age_max_ms;
+    rt_uint32_t corrupted;                   /* Line fault counters */
+    rt_uint32_t noise_bursts;
+    rt_uint32_t lost_bytes;
+    rt_uint32_t split_replies;
+} modbus_sim_t;
+
+modbus_sim_t *modbus_sim_create(const char *name, rt_uint32_t baud_rate, rt_uint8_t slave_addr);
+void modbus_sim_destroy(modbus_sim_t *sim);
+rt_uint32_t modbus_sim_wire_time_us(modbus_sim_t *sim, rt_size_t bytes);
+
+/*
+ * Test fixture shared by the test drivers. A test opens with
+ * modbus_test_begin(), reports each expectation through modbus_test_check()
+ * and closes with modbus_test_end(), which prints the verdict line. Tests
+ * run one at a time from the shell, so there is one verdict at a time.
+ */
+void modbus_test_begin(const char *tag);
+void modbus_test_check(rt_bool_t condition, const char *what);
+rt_uint32_t modbus_test_end(const char *name);
+
+/* Simulated slave on MODBUS_SIM_NAME, with a master on it when mb is given */
+modbus_sim_t *modbus_test_setup(rt_uint32_t baud_rate, rt_uint8_t slave_addr, modbus_rtu_device_t **mb);
+void modbus_test_teardown(modbus_sim_t *sim, modbus_rtu_device_t *mb);
+
+#endif /* MODBUS_SIM_H__ */
@@ -6,9 +6,11 @@
  * Change Logs:
  * Date           Author       Notes
  * 2025-11-22     Developer    CRC-16 Modbus test
+ * 2026-10-16     Developer    Table engine vectors and throughput benchmark
  */
 
 #include <rtthread.h>
+#include <stdlib.h>
 #include "modbus_rtu.h"
 
 /**
@@ -47,4 +49,156 @@ static void test_crc_examples(void)
     rt_kprintf("\n=== CRC Test Complete ===\n");
 }
 
+/**
+ * Previous bit-by-bit implementation, kept as reference for the benchmark
+ */
+static rt_uint16_t crc16_bitwise(const rt_uint8_t *data, rt_size_t length)
+{
+    rt_uint16_t crc_value = 0xFFFF;
+    rt_size_t i;
+    rt_uint8_t j;
+
+    for (i = 0; i < length; i++) {
+        crc_value ^= data[i];
+        for (j = 0; j < 8; j++) {
+            if (crc_value & 0x0001) {
+                crc_value = (crc_value >> 1) ^ 0xA001;
+            } else {
+                crc_value = (crc_value >> 1);
+            }
+        }
+    }
+
+    return (rt_uint16_t)((crc_value >> 8) | (crc_value << 8));
+}
+
+/**
+ * Check manual vectors, incremental API and frames longer than 255 bytes
+ */
+static int test_crc_vectors(void)
+{
+    rt_uint8_t s8_read_co2[] = {0xFE, 0x04, 0x00, 0x03, 0x00, 0x01};
+    rt_uint8_t *long_frame;
+    rt_uint16_t crc, crc_ref;
+    rt_size_t i, split;
+    int failures = 0;
+
+    rt_kprintf("\n=== CRC-16 Engine Vectors (slice-by-%d) ===\n", MODBUS_CRC_SLICE_BY);
+
+    /* S8 manual: FE 04 00 03 00 01 -> D5 C5 */
+    crc = modbus_crc16(s8_read_co2, sizeof(s8_read_co2));
+    if (crc == 0xD5C5) {
+        rt_kprintf("[VEC1] PASS: FE 04 00 03 00 01 -> %02X %02X\n", crc >> 8, crc & 0xFF);
+    } else {
+        rt_kprintf("[VEC1] FAIL: expected D5 C5, got %02X %02X\n", crc >> 8, crc & 0xFF);
+        failures++;
+    }
+
+    /* Incremental update, one byte at a time as the RX ISR would feed it */
+    crc = modbus_crc16_init();
+    for (i = 0; i < sizeof(s8_read_co2); i++) {
+        crc = modbus_crc16_update(crc, &s8_read_co2[i], 1);
+    }
+    crc = modbus_crc16_final(crc);
+    if (crc == 0xD5C5) {
+        rt_kprintf("[VEC2] PASS: byte-wise incremental update\n");
+    } else {
+        rt_kprintf("[VEC2] FAIL: byte-wise incremental got %04X\n", crc);
+        failures++;
+    }
+
+    /* Frames above 255 bytes, every split point against the reference */
+    long_frame = (rt_uint8_t *)rt_malloc(600);
+    if (long_frame == RT_NULL) {
+        rt_kprintf("[VEC3] FAIL: out of memory\n");
+        return failures + 1;
+    }
+    for (i = 0; i < 600; i++) {
+        long_frame[i] = (rt_uint8_t)(i * 31 + 7);
+    }
+
+    crc_ref = crc16_bitwise(long_frame, 600);
+    if (modbus_crc16(long_frame, 600) != crc_ref) {
+        rt_kprintf("[VEC3] FAIL: 600-byte frame mismatch\n");
+        failures++;
+    } else {
+        rt_kprintf("[VEC3] PASS: 600-byte frame %04X\n", crc_ref);
+    }
+
+    for (split = 0; split <= 600; split++) {
+        crc = modbus_crc16_update(modbus_crc16_init(), long_frame, split);
+        crc = modbus_crc16_final(modbus_crc16_update(crc, long_frame + split, 600 - split));
+        if (crc != crc_ref) {
+            rt_kprintf("[VEC4] FAIL: split at %d gives %04X\n", split, crc);
+            failures++;
+            break;
+        }
+    }
+    if (split > 600) {
+        rt_kprintf("[VEC4] PASS: all 601 split points match\n");
+    }
+
+    rt_free(long_frame);
+    return failures;
+}
+
+/**
+ * Measure throughput of the bitwise reference and the table engine
+ */
+static void test_crc_bench(int argc, char *argv[])
+{
+    rt_uint32_t loops = 200;
+    rt_size_t size = 1024;
+    rt_uint8_t *buffer;
+    rt_tick_t start, ticks_bit, ticks_tab;
+    volatile rt_uint16_t sink = 0;
+    rt_uint32_t n;
+    rt_size_t i;
+
+    if (argc > 1) {
+        loops = atoi(argv[1]);
+        if (loops == 0) {
+            loops = 1;
+        }
+    }
+
+    if (test_crc_vectors() != 0) {
+        rt_kprintf("[BENCH] Vector check failed, benchmark skipped\n");
+        return;
+    }
+
+    buffer = (rt_uint8_t *)rt_malloc(size);
+    if (buffer == RT_NULL) {
+        rt_kprintf("[BENCH] Out of memory\n");
+        return;
+    }
+    for (i = 0; i < size; i++) {
+        buffer[i] = (rt_uint8_t)(i ^ 0x5A);
+    }
+
+    start = rt_tick_get();
+    for (n = 0; n < loops; n++) {
+        sink ^= crc16_bitwise(buffer, size);
+    }
+    ticks_bit = rt_tick_get() - start;
+
+    start = rt_tick_get();
+    for (n = 0; n < loops; n++) {
+        sink ^= modbus_crc16(buffer, (rt_uint16_t)size);
+    }
+    ticks_tab = rt_tick_get() - start;
+
+    rt_kprintf("\n=== CRC-16 Throughput (%d x %d bytes) ===\n", loops, size);
+    rt_kprintf("  bitwise : %d ticks, %d bytes/s\n", ticks_bit,
+               ticks_bit ? (rt_uint32_t)((rt_uint64_t)loops * size * RT_TICK_PER_SECOND / ticks_bit) : 0);
+    rt_kprintf("  slice-%d : %d ticks, %d bytes/s\n", MODBUS_CRC_SLICE_BY, ticks_tab,
+               ticks_tab ? (rt_uint32_t)((rt_uint64_t)loops * size * RT_TICK_PER_SECOND / ticks_tab) : 0);
+
+    rt_free(buffer);
+    RT_UNUSED(sink);
+}
+
 /* Export to msh */
+MSH_CMD_EXPORT(test_crc_examples, CRC-16 Modbus manual examples);
+MSH_CMD_EXPORT(test_crc_bench, CRC-16 engine vectors and throughput benchmark);
+
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Learned response timeout tests and throughput comparison
+ * 2026-10-16     Developer    Verdict and simulated bus from the shared test fixture
+ * 2026-10-16     Developer    Bus timeout above the learned ceiling kept for unknown slaves
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <stdlib.h>
+#include "modbus_rtu.h"
+#include "modbus_sim.h"
+
+#define ADAPT_FIRST_SLAVE       1
+#define ADAPT_SLAVES            3
+#define ADAPT_LATENCY_MS        3
+#define ADAPT_JITTER_MS         6
+#define ADAPT_DROP_PERMILLE     150
+#define ADAPT_LONG_LINE_MS      400     /* Beyond twice the fixed timeout */
+#define ADAPT_LONG_LINE_GAP_MS  500     /* Lets a late reply drain before the next read */
+
+/**
+ * One IR1-IR4 read under the default retry policy, through a transaction so retries are visible
+ */
+static rt_err_t adapt_read(modbus_rtu_device_t *mb, rt_uint8_t slave_addr, modbus_txn_t *txn)
+{
+    static rt_uint16_t values[4];
+
+    rt_memset(txn, 0, sizeof(modbus_txn_t));
+    txn->slave_addr = slave_addr;
+    txn->function_code = MODBUS_FUNC_READ_INPUT_REGS;
+    txn->reg_count = 4;
+    txn->values = values;
+
+    return modbus_transact(mb, txn);
+}
+
+/**
+ * Turnaround learned for each slave of the segment with jittery latency
+ */
+static void adapt_learning_tests(modbus_rtu_device_t *mb)
+{
+    modbus_adapt_slot_t slot;
+    modbus_txn_t txn;
+    rt_tick_t wait, timeout;
+    rt_uint32_t turn_ms, i;
+    rt_uint8_t slave;
+
+    for (i = 0; i < 20 * ADAPT_SLAVES; i++) {
+        adapt_read(mb, ADAPT_FIRST_SLAVE + i % ADAPT_SLAVES, &txn);
+    }
+
+    for (slave = ADAPT_FIRST_SLAVE; slave < ADAPT_FIRST_SLAVE + ADAPT_SLAVES; slave++) {
+        if (modbus_adapt_get(mb, slave, &slot, &wait) != RT_EOK) {
+            modbus_test_check(RT_FALSE, "every slave sampled");
+            continue;
+        }
+        turn_ms = slot.srtt8 * 1000 / (8 * RT_TICK_PER_SECOND);
+        rt_kprintf("  Slave %d: %d samples, turnaround %d ms, deviation %d ms, wait %d ms\n",
+                   slave, slot.samples, turn_ms, slot.rttvar8 * 1000 / (8 * RT_TICK_PER_SECOND),
+                   wait * 1000 / RT_TICK_PER_SECOND);
+        modbus_test_check(slot.samples == 20 && slot.backoff == 0, "one sample per first attempt");
+        modbus_test_check(turn_ms >= ADAPT_LATENCY_MS && turn_ms <= ADAPT_LATENCY_MS + ADAPT_JITTER_MS + 4,
+                          "turnaround tracks the slave latency");
+        modbus_test_check(wait < rt_tick_from_millisecond(MODBUS_RESPONSE_TIMEOUT_MS / 2),
+                          "learned wait well below the fixed timeout");
+    }
+
+    modbus_test_check(modbus_adapt_get(mb, 0x40, RT_NULL, &wait) == -RT_EEMPTY &&
+                      wait == mb->timeout_tick, "unknown slave waits the bus timeout");
+
+    /* A bus configured slower than the ceiling keeps its timeout until sampled */
+    timeout = mb->timeout_tick;
+    mb->timeout_tick = mb->adapt.max_tick * 2;
+    modbus_test_check(modbus_adapt_get(mb, 0x40, RT_NULL, &wait) == -RT_EEMPTY &&
+                      wait == mb->timeout_tick, "long bus timeout not cut to the ceiling");
+    modbus_test_check(modbus_adapt_get(mb, ADAPT_FIRST_SLAVE, RT_NULL, &wait) == RT_EOK &&
+                      wait < timeout, "sampled slave still waits its learned time");
+    mb->timeout_tick = timeout;
+}
+
+/**
+ * Round-robin polling while replies go missing, returns reads per second
+ */
+static rt_uint32_t adapt_poll(modbus_rtu_device_t *mb, rt_bool_t enabled, rt_uint32_t reads)
+{
+    modbus_txn_t txn;
+    modbus_hist_t latency;
+    rt_uint32_t ok = 0, retried = 0, elapsed_ms, i;
+    rt_tick_t start, begin;
+
+    modbus_adapt_config(mb, enabled, 0, 0);
+    rt_memset(&latency, 0, sizeof(latency));
+
+    begin = rt_tick_get();
+    for (i = 0; i < reads; i++) {
+        start = rt_tick_get();
+        if (adapt_read(mb, ADAPT_FIRST_SLAVE + i % ADAPT_SLAVES, &txn) == RT_EOK) {
+            ok++;
+        }
+        if (txn.retries > 0) {
+            retried++;
+        }
+        modbus_hist_add(&latency, rt_tick_get() - start);
+    }
+    elapsed_ms = (rt_tick_get() - begin) * 1000 / RT_TICK_PER_SECOND;
+
+    rt_kprintf("  %-8s %d/%d read, %d retried, %d ms, %d reads/s, p50 %d ms, p99 %d ms\n",
+               enabled ? "learned" : "fixed", ok, reads, retried, elapsed_ms,
+               elapsed_ms ? reads * 1000 / elapsed_ms : 0,
+               modbus_hist_percentile(&latency, 50), modbus_hist_percentile(&latency, 99));
+    modbus_test_check(ok >= reads * 9 / 10, "polls recover from dropped replies");
+
+    return elapsed_ms ? reads * 1000 / elapsed_ms : 0;
+}
+
+/**
+ * A slave slower than the fixed timeout: never answered in time unless learned
+ */
+static rt_uint32_t adapt_long_line(modbus_rtu_device_t *mb, rt_uint8_t slave_addr, rt_uint32_t reads,
+                                   rt_uint32_t *first_attempt)
+{
+    modbus_txn_t txn;
+    rt_uint32_t ok = 0, i;
+
+    *first_attempt = 0;
+    for (i = 0; i < reads; i++) {
+        if (adapt_read(mb, slave_addr, &txn) == RT_EOK) {
+            ok++;
+            if (txn.retries == 0) {
+                (*first_attempt)++;
+            }
+        }
+        rt_thread_mdelay(ADAPT_LONG_LINE_GAP_MS);
+    }
+
+    return ok;
+}
+
+/**
+ * Learned response timeouts against simulated slaves with variable latency
+ * Usage: test_mb_adapt [reads]
+ */
+static void test_mb_adapt(int argc, char *argv[])
+{
+    modbus_sim_t *sim;
+    modbus_rtu_device_t *mb;
+    modbus_adapt_slot_t slot;
+    modbus_txn_t txn;
+    rt_uint32_t reads, fixed_rate, learned_rate, ok, first_attempt;
+    rt_uint8_t slow = ADAPT_FIRST_SLAVE + ADAPT_SLAVES - 1;
+    rt_tick_t wait;
+
+    modbus_test_begin("[MB_ADAPT]");
+    reads = (argc > 1) ? atoi(argv[1]) : 120;
+
+    sim = modbus_test_setup(9600, ADAPT_FIRST_SLAVE, &mb);
+    if (!sim) {
+        return;
+    }
+    sim->slave_count = ADAPT_SLAVES;
+    sim->latency_ms = ADAPT_LATENCY_MS;
+    sim->jitter_ms = ADAPT_JITTER_MS;
+
+    adapt_learning_tests(mb);
+
+    rt_kprintf("  %d reads over %d slaves, %d.%d%% of replies dropped:\n", reads, ADAPT_SLAVES,
+               ADAPT_DROP_PERMILLE / 10, ADAPT_DROP_PERMILLE % 10);
+    sim->drop_permille = ADAPT_DROP_PERMILLE;
+    fixed_rate = adapt_poll(mb, RT_FALSE, reads);
+    learned_rate = adapt_poll(mb, RT_TRUE, reads);
+    sim->drop_permille = 0;
+    modbus_test_check(learned_rate * 10 >= fixed_rate * 13, "learned timeouts raise throughput by 30%");
+
+    /* Slave 3 behind a line with 400 ms turnaround */
+    sim->slave_latency_ms[slow - ADAPT_FIRST_SLAVE] = ADAPT_LONG_LINE_MS;
+    modbus_adapt_reset(mb);
+    modbus_adapt_config(mb, RT_FALSE, 0, 0);
+    ok = adapt_long_line(mb, slow, 3, &first_attempt);
+    rt_kprintf("  %d ms slave, fixed:   %d/3 read\n", ADAPT_LONG_LINE_MS, ok);
+    modbus_test_check(ok == 0, "fixed timeout never waits long enough");
+
+    modbus_adapt_reset(mb);
+    modbus_adapt_config(mb, RT_TRUE, 0, 1000);
+    ok = adapt_long_line(mb, slow, 8, &first_attempt);
+    modbus_adapt_get(mb, slow, &slot, &wait);
+    rt_kprintf("  %d ms slave, learned: %d/8 read, %d on the first attempt, turnaround %d ms, wait %d ms\n",
+               ADAPT_LONG_LINE_MS, ok, first_attempt, slot.srtt8 * 1000 / (8 * RT_TICK_PER_SECOND),
+               wait * 1000 / RT_TICK_PER_SECOND);
+    modbus_test_check(ok == 8 && first_attempt >= 6, "slow slave learned through back-off");
+    modbus_test_check(slot.srtt8 / 8 >= rt_tick_from_millisecond(ADAPT_LONG_LINE_MS) &&
+                      wait <= rt_tick_from_millisecond(1000), "slow turnaround learned within the bound");
+
+    /* Fast slaves relearn their own wait beside the slow one */
+    for (ok = 0; ok < 5; ok++) {
+        adapt_read(mb, ADAPT_FIRST_SLAVE, &txn);
+    }
+    modbus_adapt_get(mb, ADAPT_FIRST_SLAVE, RT_NULL, &wait);
+    modbus_test_check(wait < rt_tick_from_millisecond(MODBUS_RESPONSE_TIMEOUT_MS / 2),
+                      "other slaves keep their own wait");
+
+    modbus_test_end("Modbus Learned Timeouts");
+
+    modbus_test_teardown(sim, mb);
+}
+MSH_CMD_EXPORT(test_mb_adapt, Modbus learned response timeout tests);
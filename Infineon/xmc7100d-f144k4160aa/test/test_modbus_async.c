@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Modbus transaction queue under concurrent load
+ * 2026-10-16     Developer    Burst submitted as interactive to reach the full queue depth
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <stdlib.h>
+#include "modbus_rtu.h"
+#include "modbus_sim.h"
+
+#define MB_ASYNC_PRODUCERS      4
+
+static modbus_rtu_device_t *async_device;
+static rt_sem_t async_finished;
+static rt_uint32_t async_per_producer;
+static volatile rt_uint32_t async_ok;
+static volatile rt_uint32_t async_bad_value;
+static volatile rt_uint32_t async_callbacks;
+static volatile rt_uint32_t async_wait_ticks;
+static volatile rt_uint32_t async_max_wait;
+
+/**
+ * Completion callback, runs in the bus thread
+ */
+static void async_txn_done(modbus_txn_t *txn)
+{
+    rt_uint32_t wait = txn->start_tick - txn->queued_tick;
+
+    async_callbacks++;
+    async_wait_ticks += wait;
+    if (wait > async_max_wait) {
+        async_max_wait = wait;
+    }
+}
+
+/**
+ * Producer: blocking reads from several threads share one bus
+ */
+static void async_producer_entry(void *parameter)
+{
+    modbus_txn_t txn;
+    rt_uint16_t value;
+    rt_uint32_t i;
+
+    for (i = 0; i < async_per_producer; i++) {
+        rt_memset(&txn, 0, sizeof(txn));
+        txn.slave_addr = S8_MODBUS_ADDRESS;
+        txn.function_code = MODBUS_FUNC_READ_INPUT_REGS;
+        txn.start_addr = S8_CO2_REG_ADDR;
+        txn.reg_count = 1;
+        txn.values = &value;
+        txn.callback = async_txn_done;
+
+        if (modbus_transact(async_device, &txn) == RT_EOK) {
+            if (value == 450) {
+                async_ok++;
+            } else {
+                async_bad_value++;
+            }
+        }
+    }
+
+    rt_sem_release(async_finished);
+}
+
+/**
+ * Fill the queue without blocking; the slot past depth must be refused
+ */
+static rt_bool_t async_burst_test(void)
+{
+    modbus_txn_t txn[MODBUS_TXN_QUEUE_DEPTH + 2];
+    rt_uint16_t values[MODBUS_TXN_QUEUE_DEPTH + 2];
+    struct rt_semaphore done;
+    rt_uint32_t accepted = 0, refused = 0, i;
+    rt_bool_t passed = RT_TRUE;
+
+    rt_sem_init(&done, "mb_burst", 0, RT_IPC_FLAG_FIFO);
+
+    for (i = 0; i < MODBUS_TXN_QUEUE_DEPTH + 2; i++) {
+        rt_memset(&txn[i], 0, sizeof(txn[i]));
+        txn[i].slave_addr = S8_MODBUS_ADDRESS;
+        txn[i].function_code = MODBUS_FUNC_READ_INPUT_REGS;
+        txn[i].start_addr = S8_CO2_REG_ADDR;
+        txn[i].reg_count = 1;
+        txn[i].values = &values[i];
+        txn[i].done = &done;
+        txn[i].priority = MODBUS_PRIO_INTERACTIVE;   /* Background stays out of the reserved slots */
+
+        if (modbus_submit(async_device, &txn[i]) == RT_EOK) {
+            accepted++;
+        } else {
+            refused++;
+        }
+    }
+
+    /* Bus thread may already have dequeued one, so depth or depth+1 fit */
+    if (accepted < MODBUS_TXN_QUEUE_DEPTH || refused == 0) {
+        rt_kprintf("[MB_ASYNC] FAIL: burst accepted %d, refused %d\n", accepted, refused);
+        passed = RT_FALSE;
+    }
+
+    for (i = 0; i < accepted; i++) {
+        rt_sem_take(&done, RT_WAITING_FOREVER);
+    }
+    for (i = 0; i < accepted; i++) {
+        if (txn[i].result != RT_EOK || values[i] != 450) {
+            rt_kprintf("[MB_ASYNC] FAIL: burst txn %d result %d value %d\n",
+                       i, txn[i].result, values[i]);
+            passed = RT_FALSE;
+        }
+    }
+
+    rt_sem_detach(&done);
+    return passed;
+}
+
+/**
+ * Concurrent producers plus a non-blocking burst against the simulated S8
+ * Usage: test_mb_async [per_producer] [baud]
+ */
+static void test_mb_async(int argc, char *argv[])
+{
+    modbus_sim_t *sim;
+    rt_thread_t producer;
+    char name[RT_NAME_MAX];
+    rt_uint32_t baud = 9600;
+    rt_uint32_t total, i;
+    rt_bool_t burst_passed;
+    rt_tick_t start, elapsed;
+
+    async_per_producer = 10;
+    if (argc > 1) {
+        async_per_producer = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        baud = atoi(argv[2]);
+    }
+    if (async_per_producer == 0 || baud == 0) {
+        rt_kprintf("Usage: test_mb_async [per_producer] [baud]\n");
+        return;
+    }
+
+    async_ok = 0;
+    async_bad_value = 0;
+    async_callbacks = 0;
+    async_wait_ticks = 0;
+    async_max_wait = 0;
+
+    sim = modbus_sim_create("mbsim", baud, S8_MODBUS_ADDRESS);
+    if (!sim) {
+        rt_kprintf("[MB_ASYNC] Failed to create simulated UART\n");
+        return;
+    }
+
+    async_device = modbus_rtu_init("mbsim");
+    async_finished = rt_sem_create("mb_fin", 0, RT_IPC_FLAG_FIFO);
+    if (!async_device || !async_finished) {
+        rt_kprintf("[MB_ASYNC] Setup failed\n");
+        goto cleanup;
+    }
+
+    start = rt_tick_get();
+    for (i = 0; i < MB_ASYNC_PRODUCERS; i++) {
+        rt_snprintf(name, sizeof(name), "mb_prod%d", i);
+        producer = rt_thread_create(name, async_producer_entry, RT_NULL, 1024, 15, 10);
+        if (producer) {
+            rt_thread_startup(producer);
+        } else {
+            rt_sem_release(async_finished);
+        }
+    }
+    for (i = 0; i < MB_ASYNC_PRODUCERS; i++) {
+        rt_sem_take(async_finished, RT_WAITING_FOREVER);
+    }
+    elapsed = rt_tick_get() - start;
+
+    burst_passed = async_burst_test();
+
+    total = MB_ASYNC_PRODUCERS * async_per_producer;
+    rt_kprintf("\n=== Modbus Async Queue (%d baud, %d producers x %d) ===\n",
+               baud, MB_ASYNC_PRODUCERS, async_per_producer);
+    rt_kprintf("  Successful : %d/%d (%d wrong value)\n", async_ok, total, async_bad_value);
+    rt_kprintf("  Callbacks  : %d\n", async_callbacks);
+    rt_kprintf("  Throughput : %d txn/s\n",
+               elapsed ? async_ok * RT_TICK_PER_SECOND / elapsed : 0);
+    if (async_callbacks > 0) {
+        rt_kprintf("  Queue wait : avg %d ms, max %d ms\n",
+                   async_wait_ticks * 1000 / RT_TICK_PER_SECOND / async_callbacks,
+                   async_max_wait * 1000 / RT_TICK_PER_SECOND);
+    }
+    rt_kprintf("  Burst      : %s\n", burst_passed ? "PASS" : "FAIL");
+    rt_kprintf("  Sim stats  : %d requests, %d replies, %d bad\n",
+               sim->requests, sim->replies, sim->bad_requests);
+
+cleanup:
+    if (async_finished) {
+        rt_sem_delete(async_finished);
+        async_finished = RT_NULL;
+    }
+    if (async_device) {
+        modbus_rtu_deinit(async_device);
+        async_device = RT_NULL;
+    }
+    modbus_sim_destroy(sim);
+}
+MSH_CMD_EXPORT(test_mb_async, Modbus transaction queue with concurrent producers);
@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Modbus and S8 read benchmark against the simulated sensor
+ * 2026-10-16     Developer    Verdict and simulated bus from the shared test fixture
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <stdlib.h>
+#include "modbus_rtu.h"
+#include "modbus_sim.h"
+#include "s8_sensor.h"
+
+#define BENCH_SAMPLES           4096    /* Latencies kept per run for percentiles */
+#define BENCH_OUTAGE_MS         2000    /* Longest acceptable run of failures on a faulty line */
+
+/* Line conditions a run is made under */
+typedef struct {
+    const char *name;
+    rt_uint16_t drop_permille;
+    rt_uint16_t corrupt_permille;
+    rt_uint16_t noise_permille;
+    rt_uint16_t byte_drop_permille;
+    rt_uint16_t split_permille;
+    rt_uint32_t split_gap_ms;
+} bench_profile_t;
+
+static const bench_profile_t bench_profiles[] =
+{
+    {"clean",  0,  0,  0, 0,  0, 0},
+    {"faulty", 50, 50, 50, 3, 50, 8},     /* Splits longer than T3.5 at 9600 baud */
+};
+
+typedef struct {
+    modbus_rtu_device_t *mb;
+    s8_sensor_device_t *sensor;
+} bench_target_t;
+
+/* One operation of a workload, RT_TRUE when it returned good data */
+typedef rt_bool_t (*bench_op_t)(bench_target_t *target);
+
+static rt_bool_t bench_read_input(bench_target_t *target)
+{
+    rt_uint16_t values[S8_QUERY_REGS_CYCLE];
+
+    return modbus_read_input_registers(target->mb, S8_MODBUS_ADDRESS, S8_QUERY_FIRST_CYCLE,
+                                       S8_QUERY_REGS_CYCLE, values) == RT_EOK &&
+           S8_QUERY_VALUE(values, CYCLE, CO2_CONCENTRATION) == 450;
+}
+
+static rt_bool_t bench_read_co2(bench_target_t *target)
+{
+    return s8_read_co2_data(target->sensor) == S8_STATUS_OK && target->sensor->data.co2_ppm == 450;
+}
+
+static rt_bool_t bench_refresh_co2(bench_target_t *target)
+{
+    return s8_refresh_co2_data(target->sensor) == S8_STATUS_OK && target->sensor->data.co2_ppm == 450;
+}
+
+/* cached: whether the sensor's measurement cache rule stays in place for the run */
+static const struct {
+    const char *name;
+    bench_op_t op;
+    rt_bool_t cached;
+} bench_workloads[] =
+{
+    {"read_input_registers", bench_read_input, RT_FALSE},
+    {"s8_read_co2_data", bench_read_co2, RT_TRUE},          /* As the application calls it */
+    {"s8_refresh_co2_data", bench_refresh_co2, RT_TRUE},
+};
+
+/* Outcome of one workload under one profile */
+typedef struct {
+    rt_uint32_t ops;
+    rt_uint32_t failed;
+    rt_uint32_t bus_requests;
+    rt_uint32_t retries;
+    rt_uint32_t timeouts;
+    rt_uint32_t crc_errors;
+    rt_uint32_t outage_ms;               /* Longest time from a failure to the next success */
+    rt_uint32_t elapsed_ms;
+    rt_uint32_t samples;
+    rt_tick_t latency[BENCH_SAMPLES];
+} bench_result_t;
+
+static int bench_tick_compare(const void *a, const void *b)
+{
+    rt_tick_t x = *(const rt_tick_t *)a, y = *(const rt_tick_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * Latency percentile of a run in ms, from its sorted samples
+ */
+static rt_uint32_t bench_percentile(const bench_result_t *result, rt_uint32_t percent)
+{
+    rt_uint32_t index;
+
+    if (result->samples == 0) {
+        return 0;
+    }
+    index = (result->samples * percent + 99) / 100;
+    index = index ? index - 1 : 0;
+    return result->latency[index] * 1000 / RT_TICK_PER_SECOND;
+}
+
+/**
+ * Sum the bus counters over all statistics slots
+ */
+static void bench_counters(modbus_rtu_device_t *mb, modbus_stats_t *stats, rt_uint32_t *retries,
+                           rt_uint32_t *timeouts, rt_uint32_t *crc_errors)
+{
+    rt_uint32_t i;
+
+    modbus_stats_get(mb, stats);
+    *retries = *timeouts = *crc_errors = 0;
+    for (i = 0; i < MODBUS_STATS_SLOTS; i++) {
+        *retries += stats->slots[i].retries;
+        *timeouts += stats->slots[i].timeouts;
+        *crc_errors += stats->slots[i].crc_errors;
+    }
+}
+
+/**
+ * Run one workload back to back for run_ms
+ */
+static void bench_run(bench_target_t *target, modbus_sim_t *sim, bench_op_t op, rt_uint32_t run_ms,
+                      modbus_stats_t *stats, bench_result_t *result)
+{
+    rt_tick_t begin, start, end, first_failure = 0;
+    rt_uint32_t requests = sim->requests, outage;
+    rt_bool_t failing = RT_FALSE;
+
+    rt_memset(result, 0, sizeof(bench_result_t));
+    modbus_stats_reset(target->mb);
+
+    begin = rt_tick_get();
+    end = begin + rt_tick_from_millisecond(run_ms);
+    while ((rt_int32_t)(rt_tick_get() - end) < 0) {
+        start = rt_tick_get();
+        if (op(target)) {
+            if (failing) {
+                outage = (rt_tick_get() - first_failure) * 1000 / RT_TICK_PER_SECOND;
+                if (outage > result->outage_ms) {
+                    result->outage_ms = outage;
+                }
+                failing = RT_FALSE;
+            }
+        } else {
+            result->failed++;
+            if (!failing) {
+                first_failure = start;
+                failing = RT_TRUE;
+            }
+        }
+        if (result->samples < BENCH_SAMPLES) {
+            result->latency[result->samples++] = rt_tick_get() - start;
+        }
+        result->ops++;
+    }
+    result->elapsed_ms = (rt_tick_get() - begin) * 1000 / RT_TICK_PER_SECOND;
+    if (failing) {
+        /* Still failing when the run ended */
+        outage = (rt_tick_get() - first_failure) * 1000 / RT_TICK_PER_SECOND;
+        if (outage > result->outage_ms) {
+            result->outage_ms = outage;
+        }
+    }
+
+    result->bus_requests = sim->requests - requests;
+    bench_counters(target->mb, stats, &result->retries, &result->timeouts, &result->crc_errors);
+    qsort(result->latency, result->samples, sizeof(rt_tick_t), bench_tick_compare);
+}
+
+/**
+ * Apply a profile's line faults to the simulated sensor
+ */
+static void bench_apply(modbus_sim_t *sim, const bench_profile_t *profile)
+{
+    sim->drop_permille = profile->drop_permille;
+    sim->corrupt_permille = profile->corrupt_permille;
+    sim->noise_permille = profile->noise_permille;
+    sim->byte_drop_permille = profile->byte_drop_permille;
+    sim->split_permille = profile->split_permille;
+    sim->split_gap_ms = profile->split_gap_ms;
+}
+
+/**
+ * Throughput, latency and error recovery of the Modbus read paths
+ * against the simulated S8, on a clean and on a faulty line
+ * Usage: test_mb_bench [run_ms] [baud]
+ */
+static void test_mb_bench(int argc, char *argv[])
+{
+    bench_target_t target;
+    bench_result_t *result;
+    modbus_stats_t *stats;
+    modbus_sim_t *sim = RT_NULL;
+    rt_uint32_t run_ms, baud, p, w, rate;
+
+    modbus_test_begin("[MB_BENCH]");
+    run_ms = (argc > 1) ? atoi(argv[1]) : 2000;
+    baud = (argc > 2) ? atoi(argv[2]) : 9600;
+    if (run_ms == 0 || baud == 0) {
+        rt_kprintf("Usage: test_mb_bench [run_ms] [baud]\n");
+        return;
+    }
+
+    result = (bench_result_t *)rt_malloc(sizeof(bench_result_t));
+    stats = (modbus_stats_t *)rt_malloc(sizeof(modbus_stats_t));
+    target.mb = RT_NULL;
+    if (!result || !stats) {
+        rt_kprintf("[MB_BENCH] Out of memory\n");
+        goto out;
+    }
+    sim = modbus_test_setup(baud, S8_MODBUS_ADDRESS, &target.mb);
+    if (!sim) {
+        goto out;
+    }
+
+    /* The sensor shares the bus reference taken above */
+    target.sensor = s8_sensor_init(MODBUS_SIM_NAME);
+    if (!target.sensor) {
+        rt_kprintf("[MB_BENCH] Sensor setup failed\n");
+        goto out;
+    }
+
+    rt_kprintf("  %d baud, %d ms per run, slave turnaround %d ms\n", baud, run_ms, sim->latency_ms);
+    rt_kprintf("  %-7s %-21s %6s %6s %4s %4s %4s %4s %6s %5s %5s %5s %7s\n", "line", "workload",
+               "ops/s", "bus/s", "p50", "p90", "p99", "max", "failed", "retry", "t/o", "crc", "outage");
+    for (p = 0; p < sizeof(bench_profiles) / sizeof(bench_profiles[0]); p++) {
+        bench_apply(sim, &bench_profiles[p]);
+        for (w = 0; w < sizeof(bench_workloads) / sizeof(bench_workloads[0]); w++) {
+            modbus_cache_set_ttl(target.mb, S8_REG_FUNC_METER_STATUS, S8_QUERY_FIRST_CYCLE, S8_QUERY_REGS_CYCLE,
+                                 bench_workloads[w].cached ? S8_MEASUREMENT_TTL_MS : 0);
+            bench_run(&target, sim, bench_workloads[w].op, run_ms, stats, result);
+            rate = result->elapsed_ms ? result->ops * 1000 / result->elapsed_ms : 0;
+            rt_kprintf("  %-7s %-21s %6d %6d %4d %4d %4d %4d %6d %5d %5d %5d %4d ms\n",
+                       bench_profiles[p].name, bench_workloads[w].name, rate,
+                       result->elapsed_ms ? result->bus_requests * 1000 / result->elapsed_ms : 0,
+                       bench_percentile(result, 50), bench_percentile(result, 90),
+                       bench_percentile(result, 99), bench_percentile(result, 100),
+                       result->failed, result->retries, result->timeouts, result->crc_errors,
+                       result->outage_ms);
+
+            modbus_test_check(result->ops > 0, "workload ran");
+            if (bench_profiles[p].name == bench_profiles[0].name) {
+                modbus_test_check(result->failed * 100 <= result->ops, "clean line nearly error free");
+            } else {
+                modbus_test_check(result->failed * 10 <= result->ops && result->outage_ms < BENCH_OUTAGE_MS,
+                                  "faulty line recovered from");
+            }
+        }
+    }
+    rt_kprintf("  Line faults injected: %d corrupted, %d noise bursts, %d bytes lost, %d split replies\n",
+               sim->corrupted, sim->noise_bursts, sim->lost_bytes, sim->split_replies);
+
+    modbus_test_end("Modbus Benchmark");
+
+    s8_sensor_deinit(target.sensor);
+
+out:
+    if (sim) {
+        modbus_test_teardown(sim, target.mb);
+    }
+    rt_free(stats);
+    rt_free(result);
+}
+MSH_CMD_EXPORT(test_mb_bench, Modbus and S8 read benchmark on a simulated sensor);
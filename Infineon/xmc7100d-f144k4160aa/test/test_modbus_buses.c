@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Parallel bus scaling against simulated UARTs
+ * 2026-10-16     Developer    Buses saturated by readers of the test's own
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <stdlib.h>
+#include "s8_bus.h"
+#include "modbus_sim.h"
+
+#define MB_BUSES_MAX            4
+#define MB_BUSES_SLAVES         2
+
+/* Reads one sensor as fast as its bus allows */
+typedef struct {
+    s8_sensor_device_t *sensor;
+    volatile rt_bool_t running;
+    rt_uint32_t samples;
+    rt_sem_t done;
+} mb_buses_reader_t;
+
+static void mb_buses_reader_entry(void *parameter)
+{
+    mb_buses_reader_t *reader = (mb_buses_reader_t *)parameter;
+
+    while (reader->running) {
+        if (s8_read_co2_data(reader->sensor) == S8_STATUS_OK) {
+            reader->samples++;
+        }
+    }
+    rt_sem_release(reader->done);
+}
+
+/**
+ * Saturate 1..N simulated buses and report aggregate samples/s per bus count
+ * Usage: test_mb_buses [max_buses] [seconds] [baud]
+ */
+static void test_mb_buses(int argc, char *argv[])
+{
+    static char names[MB_BUSES_MAX][RT_NAME_MAX];
+    static s8_bus_config_t configs[MB_BUSES_MAX];
+    static s8_bus_t buses[MB_BUSES_MAX];
+    static mb_buses_reader_t readers[MB_BUSES_MAX][MB_BUSES_SLAVES];
+    rt_thread_t thread;
+    modbus_sim_t *sims[MB_BUSES_MAX];
+    rt_uint32_t max_buses = MB_BUSES_MAX, seconds = 3, baud = 9600;
+    rt_uint32_t rate, single_rate = 0;
+    rt_uint32_t n, i, j, samples;
+    rt_tick_t start, elapsed;
+
+    if (argc > 1) {
+        max_buses = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        seconds = atoi(argv[2]);
+    }
+    if (argc > 3) {
+        baud = atoi(argv[3]);
+    }
+    if (max_buses == 0 || max_buses > MB_BUSES_MAX || seconds == 0 || baud == 0) {
+        rt_kprintf("Usage: test_mb_buses [max_buses 1-%d] [seconds] [baud]\n", MB_BUSES_MAX);
+        return;
+    }
+
+    rt_memset(sims, 0, sizeof(sims));
+    for (i = 0; i < max_buses; i++) {
+        rt_snprintf(names[i], sizeof(names[i]), "mbsim%d", i);
+        sims[i] = modbus_sim_create(names[i], baud, 1);
+        if (!sims[i]) {
+            rt_kprintf("[MB_BUSES] Failed to create %s\n", names[i]);
+            goto cleanup;
+        }
+        sims[i]->slave_count = MB_BUSES_SLAVES;
+
+        /* Back-to-back polling: the interval is far below one transaction */
+        rt_memset(&configs[i], 0, sizeof(configs[i]));
+        configs[i].bus.uart_name = names[i];
+        configs[i].interval_ms = S8_POLL_TRACK;
+        configs[i].slave_count = MB_BUSES_SLAVES;
+        configs[i].slaves[0] = 1;
+        configs[i].slaves[1] = 2;
+    }
+
+    rt_kprintf("\n=== Parallel Modbus Buses (%d baud, %d slaves/bus, %d s each) ===\n",
+               baud, MB_BUSES_SLAVES, seconds);
+    rt_kprintf("Buses  Samples/s  Per bus  Scaling\n");
+
+    /*
+     * The pollers only sample once per measurement, through the sensors'
+     * acquisition services; readers of the test's own keep the buses busy.
+     */
+    for (n = 1; n <= max_buses; n++) {
+        rt_memset(readers, 0, sizeof(readers));
+        for (i = 0; i < n; i++) {
+            if (s8_bus_start(&buses[i], &configs[i]) != RT_EOK) {
+                rt_kprintf("[MB_BUSES] Failed to start bus %d\n", i);
+                continue;
+            }
+            /* Measure the bus, not the read cache */
+            modbus_cache_set_ttl(buses[i].sensors[0]->modbus, MODBUS_FUNC_READ_INPUT_REGS,
+                                 S8_REG_METER_STATUS, 4, 0);
+            for (j = 0; j < buses[i].sensor_count; j++) {
+                readers[i][j].sensor = buses[i].sensors[j];
+                readers[i][j].running = RT_TRUE;
+                readers[i][j].done = rt_sem_create("mb_rdx", 0, RT_IPC_FLAG_FIFO);
+                thread = rt_thread_create("mb_rd", mb_buses_reader_entry, &readers[i][j], 1024, 20, 10);
+                if (!readers[i][j].done || !thread) {
+                    rt_kprintf("[MB_BUSES] Failed to start a reader on bus %d\n", i);
+                    readers[i][j].running = RT_FALSE;
+                    continue;
+                }
+                rt_thread_startup(thread);
+            }
+        }
+
+        start = rt_tick_get();
+        rt_thread_mdelay(seconds * 1000);
+        elapsed = rt_tick_get() - start;
+
+        samples = 0;
+        for (i = 0; i < n; i++) {
+            for (j = 0; j < MB_BUSES_SLAVES; j++) {
+                if (readers[i][j].running) {
+                    readers[i][j].running = RT_FALSE;
+                    rt_sem_take(readers[i][j].done, RT_WAITING_FOREVER);
+                }
+                if (readers[i][j].done) {
+                    rt_sem_delete(readers[i][j].done);
+                }
+                samples += readers[i][j].samples;
+            }
+            s8_bus_stop(&buses[i]);
+        }
+
+        rate = elapsed ? samples * RT_TICK_PER_SECOND / elapsed : 0;
+        if (n == 1) {
+            single_rate = rate;
+        }
+        rt_kprintf("%5d  %9d  %7d  %4d.%02dx\n", n, rate, rate / n,
+                   single_rate ? rate / single_rate : 0,
+                   single_rate ? (rate * 100 / single_rate) % 100 : 0);
+    }
+
+cleanup:
+    for (i = 0; i < max_buses; i++) {
+        if (sims[i]) {
+            modbus_sim_destroy(sims[i]);
+        }
+    }
+}
+MSH_CMD_EXPORT(test_mb_buses, Aggregate throughput across parallel simulated buses);
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Modbus read cache tests
+ * 2026-10-16     Developer    Verdict and simulated bus from the shared test fixture
+ * 2026-10-16     Developer    Broadcast write invalidation
+ * 2026-10-16     Developer    Writes invalidate input register reads too
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "modbus_rtu.h"
+#include "modbus_sim.h"
+
+#define CACHE_SLAVE_ADDR        0x21    /* Also answers 0xFE */
+
+/**
+ * TTL, per-range rules, write invalidation and counters against the simulated S8
+ * Usage: test_mb_cache
+ */
+static void test_mb_cache(int argc, char *argv[])
+{
+    modbus_sim_t *sim;
+    modbus_rtu_device_t *mb;
+    rt_uint16_t values[4];
+    rt_uint32_t requests;
+
+    RT_UNUSED(argc);
+    RT_UNUSED(argv);
+
+    modbus_test_begin("[MB_CACHE]");
+
+    sim = modbus_test_setup(9600, CACHE_SLAVE_ADDR, &mb);
+    if (!sim) {
+        return;
+    }
+
+    /* No rules: every read goes to the bus and nothing is counted */
+    requests = sim->requests;
+    modbus_read_input_registers(mb, S8_MODBUS_ADDRESS, 0, 4, values);
+    modbus_read_input_registers(mb, S8_MODBUS_ADDRESS, 0, 4, values);
+    modbus_test_check(sim->requests - requests == 2, "no caching without a rule");
+    modbus_test_check(mb->cache.hits + mb->cache.misses == 0, "uncached reads are not counted");
+
+    /* Short TTL on IR1-IR4, long TTL on the holding registers */
+    modbus_cache_set_ttl(mb, MODBUS_FUNC_READ_INPUT_REGS, 0x0000, 4, 200);
+    modbus_cache_set_ttl(mb, MODBUS_FUNC_READ_HOLDING_REGS, 0x0010, 8, 10000);
+
+    requests = sim->requests;
+    modbus_test_check(modbus_read_input_registers(mb, S8_MODBUS_ADDRESS, 0, 4, values) == RT_EOK, "first read");
+    modbus_test_check(modbus_read_input_registers(mb, S8_MODBUS_ADDRESS, 0, 4, values) == RT_EOK, "second read");
+    modbus_test_check(sim->requests - requests == 1, "second read served from cache");
+    modbus_test_check(values[3] == 450, "cached value is correct");
+    modbus_test_check(mb->cache.hits == 1 && mb->cache.misses == 1, "one hit, one miss");
+
+    /* Same registers, different key: not a hit */
+    requests = sim->requests;
+    modbus_read_input_registers(mb, S8_MODBUS_ADDRESS, 3, 1, values);
+    modbus_test_check(sim->requests - requests == 1, "different count is a different key");
+
+    /* Outside every rule: never cached */
+    requests = sim->requests;
+    modbus_read_input_registers(mb, S8_MODBUS_ADDRESS, 0x19, 1, values);
+    modbus_read_input_registers(mb, S8_MODBUS_ADDRESS, 0x19, 1, values);
+    modbus_test_check(sim->requests - requests == 2, "reads outside the rules bypass the cache");
+
+    /* Expiry */
+    rt_thread_mdelay(250);
+    requests = sim->requests;
+    modbus_read_input_registers(mb, S8_MODBUS_ADDRESS, 0, 4, values);
+    modbus_test_check(sim->requests - requests == 1, "expired entry goes back to the bus");
+
+    /* Writes invalidate overlapping holding registers only */
+    sim->holding_regs[0x11] = 1;
+    modbus_read_holding_registers(mb, S8_MODBUS_ADDRESS, 0x10, 4, values);
+    modbus_read_input_registers(mb, S8_MODBUS_ADDRESS, 0, 4, values);
+    requests = sim->requests;
+    modbus_write_single_register(mb, S8_MODBUS_ADDRESS, 0x11, 7);
+    rt_thread_mdelay(50);   /* FC06 does not wait for the echo; let it drain */
+    modbus_read_holding_registers(mb, S8_MODBUS_ADDRESS, 0x10, 4, values);
+    modbus_test_check(values[1] == 7, "read after write sees the new value");
+    modbus_read_input_registers(mb, S8_MODBUS_ADDRESS, 0, 4, values);
+    modbus_test_check(sim->requests - requests == 2, "write invalidated only the overlapping entry");
+    modbus_test_check(mb->cache.invalidations == 1, "one invalidation counted");
+
+    /* A write elsewhere leaves the entry alone */
+    requests = sim->requests;
+    modbus_write_single_register(mb, S8_MODBUS_ADDRESS, 0x14, 9);
+    rt_thread_mdelay(50);
+    modbus_read_holding_registers(mb, S8_MODBUS_ADDRESS, 0x10, 4, values);
+    modbus_test_check(sim->requests - requests == 1, "non-overlapping write keeps the entry");
+
+    /* An overlapping write drops input register reads as well */
+    modbus_read_input_registers(mb, S8_MODBUS_ADDRESS, 0, 4, values);
+    requests = sim->requests;
+    modbus_write_single_register(mb, S8_MODBUS_ADDRESS, 0x02, 3);
+    rt_thread_mdelay(50);
+    modbus_read_input_registers(mb, S8_MODBUS_ADDRESS, 0, 4, values);
+    modbus_test_check(sim->requests - requests == 2, "write invalidated the overlapping FC04 entry");
+
+    /* A broadcast write reaches every slave, so it drops the entry too */
+    modbus_read_holding_registers(mb, CACHE_SLAVE_ADDR, 0x10, 4, values);
+    requests = sim->requests;
+    modbus_write_single_register(mb, MODBUS_BROADCAST_ADDRESS, 0x12, 5);
+    rt_thread_mdelay(50);
+    modbus_read_holding_registers(mb, CACHE_SLAVE_ADDR, 0x10, 4, values);
+    modbus_test_check(values[2] == 5, "read after broadcast sees the new value");
+    modbus_test_check(sim->requests - requests == 2, "broadcast write invalidated the entry");
+
+    /* TTL 0 removes the rule */
+    modbus_cache_set_ttl(mb, MODBUS_FUNC_READ_INPUT_REGS, 0x0000, 4, 0);
+    requests = sim->requests;
+    modbus_read_input_registers(mb, S8_MODBUS_ADDRESS, 0, 4, values);
+    modbus_read_input_registers(mb, S8_MODBUS_ADDRESS, 0, 4, values);
+    modbus_test_check(sim->requests - requests == 2, "TTL 0 disables the rule");
+
+    modbus_test_end("Modbus Read Cache");
+    rt_kprintf("  Hits %d, misses %d, invalidations %d\n",
+               mb->cache.hits, mb->cache.misses, mb->cache.invalidations);
+
+    modbus_test_teardown(sim, mb);
+}
+MSH_CMD_EXPORT(test_mb_cache, Modbus read cache tests);
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Compile-time request frame tests
+ * 2026-10-16     Developer    Verdict and simulated bus from the shared test fixture
+ * 2026-10-16     Developer    One transaction per batched read
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "modbus_rtu.h"
+#include "modbus_sim.h"
+#include "s8_sensor.h"
+
+/* Read IR4 from the manual: FE 04 00 03 00 01 D5 C5 */
+MODBUS_FRAME_DEFINE(frames_manual, 0xFE, MODBUS_FUNC_READ_INPUT_REGS, 0x0003, 1);
+
+/**
+ * Compile-time frames against the run-time builder
+ */
+static void frames_const_tests(void)
+{
+    static const rt_uint8_t manual[8] = {0xFE, 0x04, 0x00, 0x03, 0x00, 0x01, 0xD5, 0xC5};
+    modbus_frame_t built;
+    rt_uint16_t addr, count;
+    rt_uint8_t query;
+
+    modbus_test_check(rt_memcmp(frames_manual.bytes, manual, sizeof(manual)) == 0,
+                      "manual example frame");
+
+    for (query = 0; query < S8_QUERY_COUNT; query++) {
+        addr = (s8_query_frames[query].bytes[2] << 8) | s8_query_frames[query].bytes[3];
+        count = (s8_query_frames[query].bytes[4] << 8) | s8_query_frames[query].bytes[5];
+        modbus_frame_build(&built, S8_MODBUS_ADDRESS, s8_query_frames[query].bytes[1], addr, count);
+        modbus_test_check(rt_memcmp(built.bytes, s8_query_frames[query].bytes, sizeof(built.bytes)) == 0,
+                          "query frame matches the run-time builder");
+    }
+
+    modbus_test_check(S8_QUERY_FIRST_CYCLE == S8_REG_METER_STATUS && S8_QUERY_REGS_CYCLE == 4,
+                      "cycle query covers IR1-IR4");
+    modbus_test_check(S8_QUERY_FIRST_INFO == S8_REG_SENSOR_TYPE_HIGH && S8_QUERY_REGS_INFO == 4,
+                      "info query covers IR26-IR29");
+}
+
+/**
+ * Sensor reads through the prebuilt frames, at 0xFE and at a multi-drop address
+ */
+static void frames_sensor_tests(void)
+{
+    modbus_sim_t *sim;
+    s8_sensor_device_t *sensor;
+    s8_sensor_info_t info;
+    rt_uint16_t status;
+    rt_uint32_t bad, requests;
+
+    sim = modbus_test_setup(9600, 0x21, RT_NULL);
+    if (!sim) {
+        modbus_test_check(RT_FALSE, "simulated UART");
+        return;
+    }
+    sim->input_regs[0] = 0x0004;    /* IR1 meter status */
+    sim->input_regs[1] = 0x0001;    /* IR2 alarm status */
+    sim->input_regs[0x19] = 0x0001;
+    sim->input_regs[0x1C] = 0x0203;
+
+    sensor = s8_sensor_init_slave(MODBUS_SIM_NAME, S8_MODBUS_ADDRESS);
+    if (sensor) {
+        bad = sim->bad_requests;
+        requests = sim->requests;
+        modbus_test_check(s8_read_co2_data(sensor) == S8_STATUS_OK && sensor->data.co2_ppm == 450,
+                          "cycle read with the flash frame");
+        modbus_test_check(sim->requests - requests == 1, "cycle read is one transaction");
+        modbus_test_check(sensor->data.meter_status == 0x0004 && sensor->data.alarm_status == 0x0001,
+                          "status registers decoded from the cycle read");
+        modbus_test_check(sensor->plan_saved == 2, "cycle read reports two saved");
+        requests = sim->requests;
+        modbus_test_check(s8_read_status(sensor, &status) == S8_STATUS_OK && status == 0x0004, "status read");
+        modbus_test_check(sim->requests - requests <= 1, "status read is at most one transaction");
+        modbus_test_check(sim->bad_requests == bad, "flash frame accepted by the slave");
+        s8_sensor_deinit(sensor);
+    }
+
+    sensor = s8_sensor_init_slave(MODBUS_SIM_NAME, 0x21);
+    if (sensor) {
+        bad = sim->bad_requests;
+        modbus_test_check(s8_read_co2_data(sensor) == S8_STATUS_OK, "cycle read at 0x21");
+        requests = sim->requests;
+        modbus_test_check(s8_read_sensor_info(sensor, &info) == S8_STATUS_OK &&
+                          info.sensor_type == 0x0001 && info.firmware_version == 0x0203,
+                          "info read at 0x21");
+        modbus_test_check(sim->requests - requests == 1, "info read is one transaction");
+        modbus_test_check(sim->bad_requests == bad, "built frames accepted by the slave");
+        modbus_test_check(sensor->frames[S8_QUERY_CYCLE].bytes[0] == 0x21, "frame built for 0x21");
+        s8_sensor_deinit(sensor);
+    }
+
+    modbus_test_teardown(sim, RT_NULL);
+}
+
+/**
+ * Compile-time request frame tests
+ * Usage: test_mb_frames
+ */
+static void test_mb_frames(int argc, char *argv[])
+{
+    RT_UNUSED(argc);
+    RT_UNUSED(argv);
+
+    modbus_test_begin("[MB_FRAMES]");
+    frames_const_tests();
+    frames_sensor_tests();
+
+    modbus_test_end("Modbus Request Frames");
+}
+MSH_CMD_EXPORT(test_mb_frames, Compile-time request frame tests);
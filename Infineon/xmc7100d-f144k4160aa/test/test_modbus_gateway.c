@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Modbus TCP gateway tests and load measurement
+ * 2026-10-16     Developer    Verdict and simulated bus from the shared test fixture
+ * 2026-10-16     Developer    Broadcast write ends read sharing
+ * 2026-10-16     Developer    Read pipelined behind a write goes to the bus
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include "modbus_rtu.h"
+#include "modbus_gateway.h"
+#include "modbus_sim.h"
+
+#define GW_TEST_PORT            15020
+#define GW_TEST_SILENT_UNIT     0x40
+#define GW_TEST_CLIENTS         MODBUS_GW_MAX_CLIENTS
+
+/**
+ * Connect a client to the gateway over loopback
+ */
+static int gw_connect(void)
+{
+    struct sockaddr_in addr;
+    struct timeval timeout = {2, 0};
+    int sock;
+
+    sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) {
+        return -1;
+    }
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    rt_memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(GW_TEST_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        closesocket(sock);
+        return -1;
+    }
+
+    return sock;
+}
+
+/**
+ * Receive exactly 'len' bytes
+ */
+static rt_bool_t gw_recv_all(int sock, rt_uint8_t *buf, rt_size_t len)
+{
+    rt_size_t got = 0;
+    int n;
+
+    while (got < len) {
+        n = recv(sock, buf + got, len - got, 0);
+        if (n <= 0) {
+            return RT_FALSE;
+        }
+        got += n;
+    }
+    return RT_TRUE;
+}
+
+/**
+ * Wrap a PDU in an MBAP header, returns the ADU length
+ */
+static rt_size_t gw_adu(rt_uint8_t *adu, rt_uint16_t tid, rt_uint8_t unit, const rt_uint8_t *pdu,
+                        rt_size_t pdu_len)
+{
+    adu[0] = tid >> 8;
+    adu[1] = tid & 0xFF;
+    adu[2] = 0;
+    adu[3] = 0;
+    adu[4] = (rt_uint8_t)((pdu_len + 1) >> 8);
+    adu[5] = (rt_uint8_t)((pdu_len + 1) & 0xFF);
+    adu[6] = unit;
+    rt_memcpy(adu + MODBUS_GW_MBAP_SIZE, pdu, pdu_len);
+    return MODBUS_GW_MBAP_SIZE + pdu_len;
+}
+
+/**
+ * Send an MBAP request with the given PDU and wait for the reply
+ * Returns the reply PDU length, or 0 on failure or transaction ID mismatch.
+ */
+static rt_size_t gw_request(int sock, rt_uint16_t tid, rt_uint8_t unit, const rt_uint8_t *pdu,
+                            rt_size_t pdu_len, rt_uint8_t *reply_pdu)
+{
+    rt_uint8_t adu[MODBUS_GW_ADU_MAX];
+    rt_size_t len;
+
+    len = gw_adu(adu, tid, unit, pdu, pdu_len);
+    if (send(sock, adu, len, 0) != (int)len) {
+        return 0;
+    }
+
+    if (!gw_recv_all(sock, adu, MODBUS_GW_MBAP_SIZE)) {
+        return 0;
+    }
+    len = ((adu[4] << 8) | adu[5]) - 1;
+    if (((adu[0] << 8) | adu[1]) != tid || adu[6] != unit || len + MODBUS_GW_MBAP_SIZE > sizeof(adu) ||
+        !gw_recv_all(sock, reply_pdu, len)) {
+        return 0;
+    }
+    return len;
+}
+
+/**
+ * Request/reply behaviour for each supported function and the error paths
+ */
+static void gw_protocol_tests(modbus_sim_t *sim)
+{
+    static const rt_uint8_t read_ir[] = {0x04, 0x00, 0x00, 0x00, 0x04};
+    static const rt_uint8_t write_block[] = {0x10, 0x00, 0x10, 0x00, 0x02, 0x04, 0x01, 0x2C, 0x02, 0x58};
+    static const rt_uint8_t read_back[] = {0x03, 0x00, 0x10, 0x00, 0x02};
+    static const rt_uint8_t write_single[] = {0x06, 0x00, 0x10, 0x00, 0x4D};
+    static const rt_uint8_t write_later[] = {0x06, 0x00, 0x10, 0x00, 0x58};
+    static const rt_uint8_t unsupported[] = {0x2B, 0x0E, 0x01, 0x00, 0x00};
+    rt_uint8_t reply[MODBUS_GW_ADU_MAX];
+    rt_uint8_t split[MODBUS_GW_MBAP_SIZE + sizeof(read_ir)] = {0x12, 0x34, 0, 0, 0, 6, S8_MODBUS_ADDRESS};
+    rt_uint8_t pipelined[3 * MODBUS_GW_MBAP_SIZE + 2 * sizeof(read_back) + sizeof(write_later)];
+    rt_uint16_t later = 0;
+    rt_size_t len;
+    int sock, i;
+
+    sock = gw_connect();
+    if (sock < 0) {
+        modbus_test_check(RT_FALSE, "connect to the gateway");
+        return;
+    }
+
+    len = gw_request(sock, 1, S8_MODBUS_ADDRESS, read_ir, sizeof(read_ir), reply);
+    modbus_test_check(len == 10 && reply[0] == 0x04 && reply[1] == 8 && ((reply[8] << 8) | reply[9]) == 450,
+                      "FC04 forwarded");
+
+    len = gw_request(sock, 2, S8_MODBUS_ADDRESS, write_block, sizeof(write_block), reply);
+    modbus_test_check(len == 5 && reply[0] == 0x10 && sim->holding_regs[0x10] == 300 && sim->holding_regs[0x11] == 600,
+                      "FC16 forwarded");
+    len = gw_request(sock, 3, S8_MODBUS_ADDRESS, read_back, sizeof(read_back), reply);
+    modbus_test_check(len == 6 && ((reply[2] << 8) | reply[3]) == 300 && ((reply[4] << 8) | reply[5]) == 600,
+                      "FC03 reads the write back");
+
+    /* A broadcast write must not leave that read to be handed out again */
+    len = gw_request(sock, 6, MODBUS_BROADCAST_ADDRESS, write_single, sizeof(write_single), reply);
+    modbus_test_check(len == 5 && sim->holding_regs[0x10] == 77, "broadcast FC06 forwarded");
+    len = gw_request(sock, 7, S8_MODBUS_ADDRESS, read_back, sizeof(read_back), reply);
+    modbus_test_check(len == 6 && ((reply[2] << 8) | reply[3]) == 77, "FC03 after a broadcast reads the bus");
+
+    /* Read, write, read in one segment: the second read must not join the first */
+    len = gw_adu(pipelined, 8, S8_MODBUS_ADDRESS, read_back, sizeof(read_back));
+    len += gw_adu(pipelined + len, 9, S8_MODBUS_ADDRESS, write_later, sizeof(write_later));
+    len += gw_adu(pipelined + len, 10, S8_MODBUS_ADDRESS, read_back, sizeof(read_back));
+    send(sock, pipelined, len, 0);
+    for (i = 0; i < 3; i++) {
+        if (!gw_recv_all(sock, reply, MODBUS_GW_MBAP_SIZE)) {
+            break;
+        }
+        len = ((reply[4] << 8) | reply[5]) - 1;
+        if (len + MODBUS_GW_MBAP_SIZE > sizeof(reply) || !gw_recv_all(sock, reply + MODBUS_GW_MBAP_SIZE, len)) {
+            break;
+        }
+        if (((reply[0] << 8) | reply[1]) == 10 && len == 6) {
+            later = (reply[MODBUS_GW_MBAP_SIZE + 2] << 8) | reply[MODBUS_GW_MBAP_SIZE + 3];
+        }
+    }
+    modbus_test_check(i == 3 && later == 0x58, "FC03 queued behind a write reads the bus");
+
+    len = gw_request(sock, 4, S8_MODBUS_ADDRESS, unsupported, sizeof(unsupported), reply);
+    modbus_test_check(len == 2 && reply[0] == 0xAB && reply[1] == MODBUS_EX_ILLEGAL_FUNCTION,
+                      "unsupported function answered locally");
+
+    len = gw_request(sock, 5, GW_TEST_SILENT_UNIT, read_ir, sizeof(read_ir), reply);
+    modbus_test_check(len == 2 && reply[0] == 0x84 && reply[1] == MODBUS_EX_GATEWAY_TARGET,
+                      "silent slave reported as exception 0B");
+
+    /* A request split across TCP segments */
+    rt_memcpy(split + MODBUS_GW_MBAP_SIZE, read_ir, sizeof(read_ir));
+    send(sock, split, 4, 0);
+    rt_thread_mdelay(20);
+    send(sock, split + 4, sizeof(split) - 4, 0);
+    modbus_test_check(gw_recv_all(sock, reply, MODBUS_GW_MBAP_SIZE + 10) && reply[0] == 0x12 && reply[1] == 0x34,
+                      "request split across segments");
+
+    closesocket(sock);
+}
+
+typedef struct {
+    rt_uint32_t requests;
+    rt_uint32_t wrong;
+    modbus_hist_t latency;
+    rt_sem_t done;
+} gw_client_t;
+
+static rt_uint32_t gw_load_requests;
+
+/**
+ * Load client: back-to-back IR1-IR4 reads, the S8 measurement poll
+ */
+static void gw_client_entry(void *parameter)
+{
+    static const rt_uint8_t read_ir[] = {0x04, 0x00, 0x00, 0x00, 0x04};
+    gw_client_t *client = (gw_client_t *)parameter;
+    rt_uint8_t reply[MODBUS_GW_ADU_MAX];
+    rt_tick_t start;
+    rt_uint32_t i;
+    int sock;
+
+    sock = gw_connect();
+    for (i = 0; sock >= 0 && i < gw_load_requests; i++) {
+        start = rt_tick_get();
+        if (gw_request(sock, (rt_uint16_t)i, S8_MODBUS_ADDRESS, read_ir, sizeof(read_ir), reply) != 10 ||
+            ((reply[8] << 8) | reply[9]) != 450) {
+            client->wrong++;
+        }
+        modbus_hist_add(&client->latency, rt_tick_get() - start);
+        client->requests++;
+    }
+    if (sock >= 0) {
+        closesocket(sock);
+    }
+
+    rt_sem_release(client->done);
+}
+
+/**
+ * Several clients polling the same registers, with a given coalescing window
+ */
+static void gw_load(modbus_gateway_t *gateway, modbus_sim_t *sim, rt_uint32_t coalesce_ms)
+{
+    gw_client_t clients[GW_TEST_CLIENTS];
+    modbus_hist_t all;
+    rt_uint32_t requests = 0, wrong = 0, bus_before, coalesced_before, elapsed_ms, i;
+    rt_tick_t start;
+    rt_thread_t thread;
+
+    gateway->coalesce_tick = rt_tick_from_millisecond(coalesce_ms);
+    bus_before = sim->requests;
+    coalesced_before = gateway->coalesced;
+    rt_memset(clients, 0, sizeof(clients));
+    rt_memset(&all, 0, sizeof(all));
+
+    start = rt_tick_get();
+    for (i = 0; i < GW_TEST_CLIENTS; i++) {
+        clients[i].done = rt_sem_create("gwc", 0, RT_IPC_FLAG_FIFO);
+        thread = rt_thread_create("gwc", gw_client_entry, &clients[i], 2048, MODBUS_GW_THREAD_PRIORITY + 2, 10);
+        if (thread) {
+            rt_thread_startup(thread);
+        } else {
+            rt_sem_release(clients[i].done);
+        }
+    }
+    for (i = 0; i < GW_TEST_CLIENTS; i++) {
+        rt_sem_take(clients[i].done, RT_WAITING_FOREVER);
+        rt_sem_delete(clients[i].done);
+        requests += clients[i].requests;
+        wrong += clients[i].wrong;
+        modbus_hist_merge(&all, &clients[i].latency);
+    }
+    elapsed_ms = (rt_tick_get() - start) * 1000 / RT_TICK_PER_SECOND;
+
+    rt_kprintf("  %2d ms window: %d requests in %d ms (%d/s), %d on the bus, %d coalesced, "
+               "p50 %d ms, p99 %d ms, max %d ms\n",
+               coalesce_ms, requests, elapsed_ms, elapsed_ms ? requests * 1000 / elapsed_ms : 0,
+               sim->requests - bus_before, gateway->coalesced - coalesced_before,
+               modbus_hist_percentile(&all, 50), modbus_hist_percentile(&all, 99), all.max_ms);
+
+    modbus_test_check(requests == GW_TEST_CLIENTS * gw_load_requests && wrong == 0, "every load request answered");
+    modbus_test_check(sim->requests - bus_before < requests, "duplicate reads shared bus transactions");
+    modbus_test_check(modbus_hist_percentile(&all, 99) < 4 * MODBUS_RESPONSE_TIMEOUT_MS, "p99 latency bounded");
+}
+
+/**
+ * Modbus TCP gateway tests over loopback, RTU side on the simulated S8
+ * Usage: test_mb_gateway [requests_per_client]
+ */
+static void test_mb_gateway(int argc, char *argv[])
+{
+    modbus_sim_t *sim;
+    modbus_rtu_device_t *mb;
+    modbus_gateway_t *gateway;
+
+    modbus_test_begin("[MB_GW]");
+    gw_load_requests = (argc > 1) ? atoi(argv[1]) : 50;
+
+    sim = modbus_test_setup(9600, 1, &mb);
+    if (!sim) {
+        return;
+    }
+
+    gateway = modbus_gateway_start(mb, GW_TEST_PORT);
+    if (!gateway) {
+        rt_kprintf("[MB_GW] Gateway start failed\n");
+        modbus_test_teardown(sim, mb);
+        return;
+    }
+
+    gw_protocol_tests(sim);
+
+    rt_kprintf("  %d clients x %d reads of IR1-IR4:\n", GW_TEST_CLIENTS, gw_load_requests);
+    gw_load(gateway, sim, 0);
+    gw_load(gateway, sim, MODBUS_GW_COALESCE_MS);
+    modbus_gateway_dump(gateway);
+
+    modbus_test_end("Modbus TCP Gateway");
+
+    modbus_gateway_stop(gateway);
+    modbus_test_teardown(sim, mb);
+}
+MSH_CMD_EXPORT(test_mb_gateway, Modbus TCP gateway tests);
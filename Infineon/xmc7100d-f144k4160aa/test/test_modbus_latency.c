@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Modbus transaction latency against a simulated UART
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <stdlib.h>
+#include "modbus_rtu.h"
+#include "modbus_sim.h"
+
+/**
+ * Time read-input-register transactions against the simulated S8
+ * Usage: test_mb_latency [count] [baud]
+ */
+static void test_mb_latency(int argc, char *argv[])
+{
+    modbus_sim_t *sim;
+    modbus_rtu_device_t *mb_device;
+    rt_uint32_t count = 50;
+    rt_uint32_t baud = 9600;
+    rt_uint32_t i, ok = 0;
+    rt_uint32_t min_tick = 0xFFFFFFFF, max_tick = 0, total_tick = 0;
+    rt_uint32_t wire_us;
+    rt_uint16_t co2_value;
+    rt_tick_t start, elapsed;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        baud = atoi(argv[2]);
+    }
+    if (count == 0 || baud == 0) {
+        rt_kprintf("Usage: test_mb_latency [count] [baud]\n");
+        return;
+    }
+
+    sim = modbus_sim_create("mbsim", baud, S8_MODBUS_ADDRESS);
+    if (!sim) {
+        rt_kprintf("[MB_LAT] Failed to create simulated UART\n");
+        return;
+    }
+
+    mb_device = modbus_rtu_init("mbsim");
+    if (!mb_device) {
+        rt_kprintf("[MB_LAT] Modbus init on simulated UART failed\n");
+        modbus_sim_destroy(sim);
+        return;
+    }
+
+    for (i = 0; i < count; i++) {
+        start = rt_tick_get();
+        if (modbus_read_input_registers(mb_device, S8_MODBUS_ADDRESS,
+                                        S8_CO2_REG_ADDR, 1, &co2_value) == RT_EOK) {
+            elapsed = rt_tick_get() - start;
+            ok++;
+            total_tick += elapsed;
+            if (elapsed < min_tick) {
+                min_tick = elapsed;
+            }
+            if (elapsed > max_tick) {
+                max_tick = elapsed;
+            }
+        }
+    }
+
+    /* 8-byte request + 7-byte reply on the wire, slave turnaround, T3.5 */
+    wire_us = modbus_sim_wire_time_us(sim, 8 + 7);
+
+    rt_kprintf("\n=== Modbus Latency (%d baud, %d transactions) ===\n", baud, count);
+    rt_kprintf("  Successful : %d/%d\n", ok, count);
+    if (ok > 0) {
+        rt_kprintf("  Latency    : min %d ms, avg %d ms, max %d ms\n",
+                   min_tick * 1000 / RT_TICK_PER_SECOND,
+                   total_tick * 1000 / RT_TICK_PER_SECOND / ok,
+                   max_tick * 1000 / RT_TICK_PER_SECOND);
+    }
+    rt_kprintf("  Wire time  : %d us + %d ms turnaround + %d tick T3.5\n",
+               wire_us, sim->latency_ms, mb_device->t35_tick);
+    rt_kprintf("  Sim stats  : %d requests, %d replies, %d bad\n",
+               sim->requests, sim->replies, sim->bad_requests);
+
+    modbus_rtu_deinit(mb_device);
+    modbus_sim_destroy(sim);
+}
+MSH_CMD_EXPORT(test_mb_latency, Modbus transaction latency on simulated UART);
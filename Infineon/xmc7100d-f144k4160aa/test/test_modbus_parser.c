@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Modbus frame parser fuzz and throughput test
+ */
+
+#include <rtthread.h>
+#include <stdlib.h>
+#include "modbus_rtu.h"
+
+#define PARSER_TEST_ADDR    0xFE
+
+/**
+ * Build a read-input-registers reply or an exception reply
+ */
+static rt_size_t build_reply(rt_uint8_t *frame, rt_uint16_t reg_count, rt_bool_t exception)
+{
+    rt_uint16_t crc, i;
+    rt_size_t n;
+
+    frame[0] = PARSER_TEST_ADDR;
+    if (exception) {
+        frame[1] = MODBUS_FUNC_READ_INPUT_REGS | 0x80;
+        frame[2] = 0x06;    /* Slave device busy */
+        n = 3;
+    } else {
+        frame[1] = MODBUS_FUNC_READ_INPUT_REGS;
+        frame[2] = (rt_uint8_t)(reg_count * 2);
+        for (i = 0; i < reg_count * 2; i++) {
+            frame[3 + i] = (rt_uint8_t)rand();
+        }
+        n = 3 + reg_count * 2;
+    }
+
+    crc = modbus_crc16(frame, (rt_uint16_t)n);
+    frame[n++] = crc >> 8;
+    frame[n++] = crc & 0xFF;
+    return n;
+}
+
+/**
+ * Feed a stream in random chunk sizes until a frame completes
+ */
+static rt_bool_t feed_chunked(modbus_parser_t *parser, const rt_uint8_t *stream, rt_size_t len)
+{
+    rt_size_t pos = 0, chunk;
+
+    while (pos < len && parser->state != MODBUS_PARSE_COMPLETE) {
+        chunk = 1 + rand() % 9;
+        if (chunk > len - pos) {
+            chunk = len - pos;
+        }
+        pos += modbus_parser_feed(parser, stream + pos, chunk);
+    }
+
+    return parser->state == MODBUS_PARSE_COMPLETE;
+}
+
+/**
+ * The unread FC06 echo left in the ring ahead of an FC04 reply
+ */
+static int test_parser_stale_echo(void)
+{
+    static const rt_uint8_t stream[] = {
+        0xFE, 0x06, 0x00, 0x12, 0x00, 0x01, 0xFC, 0x00,    /* Stale FC06 echo */
+        0xFE, 0x04, 0x02, 0x01, 0x90, 0xAC, 0xD8           /* FC04 reply: 400 ppm */
+    };
+    modbus_parser_t parser;
+
+    rt_memset(&parser, 0, sizeof(parser));
+    modbus_parser_reset(&parser, 0xFE, MODBUS_FUNC_READ_INPUT_REGS, 2);
+    modbus_parser_feed(&parser, stream, 5);
+    modbus_parser_feed(&parser, stream + 5, sizeof(stream) - 5);
+
+    if (parser.state == MODBUS_PARSE_COMPLETE && parser.length == 7 &&
+        parser.buf[3] == 0x01 && parser.buf[4] == 0x90) {
+        rt_kprintf("[PARSER] PASS: stale FC06 echo skipped (%d bytes dropped)\n", parser.dropped_bytes);
+        return 0;
+    }
+
+    rt_kprintf("[PARSER] FAIL: stale echo case, state %d\n", parser.state);
+    return 1;
+}
+
+/**
+ * Random garbage, random frames, random chunking
+ * Usage: test_mb_parser [iterations]
+ */
+static void test_mb_parser(int argc, char *argv[])
+{
+    static modbus_parser_t parser;
+    static rt_uint8_t stream[MODBUS_MAX_BUFFER_SIZE];
+    rt_uint8_t frame[MODBUS_MAX_BUFFER_SIZE];
+    rt_uint32_t iterations = 2000;
+    rt_uint32_t i, failures = 0, total_bytes = 0;
+    rt_uint16_t reg_count;
+    rt_size_t frame_len, garbage, g;
+    rt_bool_t exception;
+    rt_tick_t start, elapsed;
+
+    if (argc > 1) {
+        iterations = atoi(argv[1]);
+    }
+
+    rt_kprintf("\n=== Modbus Frame Parser Test ===\n");
+    failures += test_parser_stale_echo();
+
+    srand(rt_tick_get());
+    rt_memset(&parser, 0, sizeof(parser));
+    start = rt_tick_get();
+
+    for (i = 0; i < iterations; i++) {
+        reg_count = 1 + rand() % 32;
+        exception = (rand() % 8) == 0;
+        frame_len = build_reply(frame, reg_count, exception);
+
+        /* Garbage never contains the slave address, so it cannot fake a frame start */
+        garbage = rand() % 24;
+        if (garbage + frame_len > sizeof(stream)) {
+            garbage = sizeof(stream) - frame_len;
+        }
+        for (g = 0; g < garbage; g++) {
+            do {
+                stream[g] = (rt_uint8_t)rand();
+            } while (stream[g] == PARSER_TEST_ADDR);
+        }
+
+        /* Occasionally lead with a corrupted copy of the frame */
+        if (garbage >= frame_len && (rand() % 4) == 0) {
+            rt_memcpy(stream, frame, frame_len);
+            stream[3 % frame_len] ^= 0x5A;
+        }
+        rt_memcpy(stream + garbage, frame, frame_len);
+
+        modbus_parser_reset(&parser, PARSER_TEST_ADDR, MODBUS_FUNC_READ_INPUT_REGS,
+                            exception ? 0 : reg_count * 2);
+        if (!feed_chunked(&parser, stream, garbage + frame_len) ||
+            parser.length != frame_len || rt_memcmp(parser.buf, frame, frame_len) != 0) {
+            if (failures < 5) {
+                rt_kprintf("[PARSER] FAIL: iteration %d (garbage %d, frame %d)\n",
+                           i, garbage, frame_len);
+            }
+            failures++;
+        }
+        total_bytes += garbage + frame_len;
+    }
+
+    elapsed = rt_tick_get() - start;
+
+    rt_kprintf("[PARSER] %d/%d frames recovered\n", iterations + 1 - failures, iterations + 1);
+    rt_kprintf("[PARSER] %d frames, %d CRC rejects, %d bytes dropped\n",
+               parser.frames, parser.crc_errors, parser.dropped_bytes);
+    rt_kprintf("[PARSER] %d bytes in %d ticks (%d bytes/s)\n", total_bytes, elapsed,
+               elapsed ? (rt_uint32_t)((rt_uint64_t)total_bytes * RT_TICK_PER_SECOND / elapsed) : 0);
+    rt_kprintf("[PARSER] %s\n", failures ? "FAILED" : "PASSED");
+}
+MSH_CMD_EXPORT(test_mb_parser, Modbus frame parser fuzz test);
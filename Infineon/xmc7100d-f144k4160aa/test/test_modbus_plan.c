@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Register batch planner tests
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "modbus_plan.h"
+#include "modbus_sim.h"
+#include "s8_sensor.h"
+
+/**
+ * Span merging without touching the bus
+ */
+static void plan_merge_tests(void)
+{
+    modbus_plan_t plan;
+    rt_uint16_t v[MODBUS_PLAN_MAX_REGS];
+
+    /* Cycle read: IR1, IR2, IR4 -> one span 0..3 */
+    modbus_plan_init(&plan, 2);
+    modbus_plan_add(&plan, S8_REG_CO2_CONCENTRATION, &v[0]);
+    modbus_plan_add(&plan, S8_REG_METER_STATUS, &v[1]);
+    modbus_plan_add(&plan, S8_REG_ALARM_STATUS, &v[2]);
+    modbus_plan_build(&plan);
+    modbus_test_check(plan.span_count == 1, "cycle read merges into one span");
+    modbus_test_check(plan.spans[0].start == 0 && plan.spans[0].count == 4, "cycle span covers IR1-IR4");
+    modbus_test_check(plan.saved == 2, "cycle read saves two transactions");
+
+    /* Info read: IR26, IR27, IR29 -> one span, or two with no gap allowed */
+    modbus_plan_init(&plan, 2);
+    modbus_plan_add(&plan, S8_REG_SENSOR_TYPE_HIGH, &v[0]);
+    modbus_plan_add(&plan, S8_REG_SENSOR_TYPE_LOW, &v[1]);
+    modbus_plan_add(&plan, S8_REG_FIRMWARE_VERSION, &v[2]);
+    modbus_plan_build(&plan);
+    modbus_test_check(plan.span_count == 1 && plan.spans[0].count == 4, "info read merges across IR28");
+
+    plan.max_gap = 0;
+    modbus_plan_build(&plan);
+    modbus_test_check(plan.span_count == 2 && plan.saved == 1, "gap 0 keeps IR29 separate");
+
+    /* Far apart registers stay separate, duplicates cost nothing */
+    modbus_plan_init(&plan, 2);
+    modbus_plan_add(&plan, 0x0003, &v[0]);
+    modbus_plan_add(&plan, 0x0003, &v[1]);
+    modbus_plan_add(&plan, 0x0019, &v[2]);
+    modbus_plan_build(&plan);
+    modbus_test_check(plan.span_count == 2 && plan.saved == 0, "distant registers are not merged");
+
+    /* Span limit splits a contiguous run */
+    modbus_plan_init(&plan, MODBUS_PLAN_MAX_SPAN);
+    modbus_plan_add(&plan, 0, &v[0]);
+    modbus_plan_add(&plan, MODBUS_PLAN_MAX_SPAN - 1, &v[1]);
+    modbus_plan_add(&plan, MODBUS_PLAN_MAX_SPAN, &v[2]);
+    modbus_plan_build(&plan);
+    modbus_test_check(plan.span_count == 2 && plan.spans[0].count == MODBUS_PLAN_MAX_SPAN,
+                      "span length is capped");
+
+    /* The fixed S8 queries are what the planner makes of their registers */
+    modbus_test_check(s8_query_saved[S8_QUERY_CYCLE] == 2 && s8_query_saved[S8_QUERY_INFO] == 2,
+                      "query map checked against the planner at init");
+}
+
+/**
+ * Plans and batched S8 reads against the simulated sensor count transactions on the wire
+ */
+static void plan_bus_tests(void)
+{
+    modbus_rtu_device_t *mb;
+    modbus_sim_t *sim;
+    modbus_plan_t plan;
+    s8_sensor_device_t *sensor;
+    rt_uint16_t co2 = 0, meter = 0, alarm = 0;
+    rt_uint32_t requests;
+
+    sim = modbus_test_setup(9600, S8_MODBUS_ADDRESS, &mb);
+    if (!sim) {
+        modbus_test_check(RT_FALSE, "simulated UART");
+        return;
+    }
+    sim->input_regs[0] = 0x0004;    /* IR1 meter status */
+    sim->input_regs[1] = 0x0001;    /* IR2 alarm status */
+
+    /* Values are scattered only once every span has been read */
+    modbus_plan_init(&plan, 0);
+    modbus_plan_add(&plan, S8_REG_CO2_CONCENTRATION, &co2);
+    modbus_plan_add(&plan, S8_REG_METER_STATUS, &meter);
+    modbus_plan_add(&plan, S8_REG_ALARM_STATUS, &alarm);
+    requests = sim->requests;
+    modbus_test_check(modbus_plan_execute(&plan, mb, S8_MODBUS_ADDRESS) == RT_EOK, "plan executed");
+    modbus_test_check(sim->requests - requests == plan.span_count && plan.span_count == 2,
+                      "one transaction per span");
+    modbus_test_check(co2 == 450 && meter == 0x0004 && alarm == 0x0001, "values scattered");
+    modbus_test_teardown(sim, mb);
+
+    sim = modbus_test_setup(9600, S8_MODBUS_ADDRESS, RT_NULL);
+    if (!sim) {
+        modbus_test_check(RT_FALSE, "simulated UART");
+        return;
+    }
+    sensor = s8_sensor_init_slave(MODBUS_SIM_NAME, S8_MODBUS_ADDRESS);
+    if (sensor) {
+        requests = sim->requests;
+        modbus_test_check(s8_read_co2_data(sensor) == S8_STATUS_OK, "cycle read");
+        modbus_test_check(sim->requests - requests == 1 && sensor->plan_saved == 2,
+                          "cycle read on the bus saves two");
+        if (S8_MEASUREMENT_TTL_MS > 0) {
+            requests = sim->requests;
+            modbus_test_check(s8_read_co2_data(sensor) == S8_STATUS_OK, "cycle read again");
+            modbus_test_check(sim->requests == requests && sensor->plan_saved == 0,
+                              "cached reply saves nothing by batching");
+        }
+        modbus_test_check(sensor->plan_saved_total == 2, "saving totalled per transaction sent");
+        s8_sensor_deinit(sensor);
+    }
+    modbus_test_teardown(sim, RT_NULL);
+}
+
+/**
+ * Register batch planner tests
+ * Usage: test_mb_plan
+ */
+static void test_mb_plan(int argc, char *argv[])
+{
+    RT_UNUSED(argc);
+    RT_UNUSED(argv);
+
+    modbus_test_begin("[MB_PLAN]");
+    plan_merge_tests();
+    plan_bus_tests();
+
+    modbus_test_end("Modbus Batch Planner");
+}
+MSH_CMD_EXPORT(test_mb_plan, Modbus register batch planner tests);
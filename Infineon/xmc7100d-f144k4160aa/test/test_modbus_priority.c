@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Priority classes under background load
+ * 2026-10-16     Developer    Verdict and simulated bus from the shared test fixture
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <stdlib.h>
+#include "modbus_rtu.h"
+#include "modbus_sim.h"
+
+#define PRIO_LOAD_THREADS       4       /* Logger, monitor and pollers sharing the bus */
+#define PRIO_COMMAND_TXNS       3       /* s8_info: type, firmware and sensor ID */
+#define PRIO_STARVE_MS          3000
+
+static volatile rt_bool_t prio_loading;
+
+typedef struct {
+    modbus_rtu_device_t *mb;
+    rt_uint8_t priority;
+    rt_uint32_t reads;
+    rt_uint32_t commands;
+    rt_uint32_t max_wait_ms;             /* Queued -> picked up */
+    modbus_hist_t latency;               /* Whole command */
+    rt_sem_t done;
+} prio_worker_t;
+
+/**
+ * One IR1-IR4 read with a given priority
+ */
+static rt_err_t prio_read(modbus_rtu_device_t *mb, rt_uint8_t priority, modbus_txn_t *txn)
+{
+    static rt_uint16_t values[4];
+
+    rt_memset(txn, 0, sizeof(modbus_txn_t));
+    txn->slave_addr = S8_MODBUS_ADDRESS;
+    txn->function_code = MODBUS_FUNC_READ_INPUT_REGS;
+    txn->reg_count = 4;
+    txn->values = values;
+    txn->priority = priority;
+
+    return modbus_transact(mb, txn);
+}
+
+/**
+ * Load thread: back-to-back reads until told to stop
+ */
+static void prio_load_entry(void *parameter)
+{
+    prio_worker_t *worker = (prio_worker_t *)parameter;
+    modbus_txn_t txn;
+    rt_uint32_t wait_ms;
+
+    while (prio_loading) {
+        if (prio_read(worker->mb, worker->priority, &txn) == RT_EOK) {
+            worker->reads++;
+        }
+        wait_ms = (txn.start_tick - txn.queued_tick) * 1000 / RT_TICK_PER_SECOND;
+        if (wait_ms > worker->max_wait_ms) {
+            worker->max_wait_ms = wait_ms;
+        }
+    }
+
+    rt_sem_release(worker->done);
+}
+
+/**
+ * Shell stand-in: s8_info-sized commands one after another, timed end to end
+ */
+static void prio_command_entry(void *parameter)
+{
+    prio_worker_t *worker = (prio_worker_t *)parameter;
+    modbus_txn_t txn;
+    rt_tick_t start;
+    rt_uint32_t i, n;
+
+    for (i = 0; i < worker->commands; i++) {
+        start = rt_tick_get();
+        for (n = 0; n < PRIO_COMMAND_TXNS; n++) {
+            prio_read(worker->mb, worker->priority, &txn);
+        }
+        modbus_hist_add(&worker->latency, rt_tick_get() - start);
+        rt_thread_mdelay(30);
+    }
+
+    rt_sem_release(worker->done);
+}
+
+/**
+ * Start a worker thread under the given name
+ */
+static rt_bool_t prio_start(prio_worker_t *worker, const char *name, void (*entry)(void *),
+                            modbus_rtu_device_t *mb, rt_uint8_t priority)
+{
+    rt_thread_t thread;
+
+    rt_memset(worker, 0, sizeof(prio_worker_t));
+    worker->mb = mb;
+    worker->priority = priority;
+    worker->done = rt_sem_create(name, 0, RT_IPC_FLAG_FIFO);
+    thread = rt_thread_create(name, entry, worker, 2048, MODBUS_BUS_THREAD_PRIORITY + 4, 10);
+    if (!worker->done || !thread) {
+        modbus_test_check(RT_FALSE, "worker thread");
+        return RT_FALSE;
+    }
+    rt_thread_startup(thread);
+    return RT_TRUE;
+}
+
+static void prio_join(prio_worker_t *worker)
+{
+    rt_sem_take(worker->done, RT_WAITING_FOREVER);
+    rt_sem_delete(worker->done);
+}
+
+/**
+ * Shell command latency with every poller busy, as FIFO and with its class
+ * Returns the p99 command latency in ms.
+ */
+static rt_uint32_t prio_interactive(modbus_rtu_device_t *mb, rt_uint8_t priority, rt_uint32_t commands)
+{
+    prio_worker_t load[PRIO_LOAD_THREADS], shell;
+    rt_uint32_t reads = 0, i;
+
+    prio_loading = RT_TRUE;
+    for (i = 0; i < PRIO_LOAD_THREADS; i++) {
+        prio_start(&load[i], "mbp_bg", prio_load_entry, mb, MODBUS_PRIO_AUTO);
+    }
+    rt_thread_mdelay(100);
+
+    /* Runs as the shell thread, so AUTO resolves to interactive */
+    if (prio_start(&shell, FINSH_THREAD_NAME, prio_command_entry, mb, priority)) {
+        shell.commands = commands;
+        prio_join(&shell);
+    }
+
+    prio_loading = RT_FALSE;
+    for (i = 0; i < PRIO_LOAD_THREADS; i++) {
+        prio_join(&load[i]);
+        reads += load[i].reads;
+    }
+
+    rt_kprintf("  %-11s %d commands: p50 %d ms, p99 %d ms, max %d ms (%d background reads)\n",
+               priority == MODBUS_PRIO_BACKGROUND ? "FIFO" : "interactive", commands,
+               modbus_hist_percentile(&shell.latency, 50), modbus_hist_percentile(&shell.latency, 99),
+               shell.latency.max_ms, reads);
+    modbus_test_check(modbus_hist_count(&shell.latency) == commands, "every command completed");
+    modbus_test_check(reads > 0, "background load ran");
+
+    return modbus_hist_percentile(&shell.latency, priority == MODBUS_PRIO_BACKGROUND ? 50 : 99);
+}
+
+/**
+ * Background reads keep moving while urgent requests saturate the bus
+ */
+static void prio_starvation(modbus_rtu_device_t *mb)
+{
+    prio_worker_t urgent[PRIO_LOAD_THREADS - 1], background;
+    rt_uint32_t reads = 0, i;
+
+    prio_loading = RT_TRUE;
+    for (i = 0; i < PRIO_LOAD_THREADS - 1; i++) {
+        prio_start(&urgent[i], "mbp_urg", prio_load_entry, mb, MODBUS_PRIO_URGENT);
+    }
+    prio_start(&background, "mbp_bg", prio_load_entry, mb, MODBUS_PRIO_BACKGROUND);
+    rt_thread_mdelay(PRIO_STARVE_MS);
+
+    prio_loading = RT_FALSE;
+    for (i = 0; i < PRIO_LOAD_THREADS - 1; i++) {
+        prio_join(&urgent[i]);
+        reads += urgent[i].reads;
+    }
+    prio_join(&background);
+
+    rt_kprintf("  Under urgent load: %d urgent reads, %d background reads, background waited at most %d ms\n",
+               reads, background.reads, background.max_wait_ms);
+    modbus_test_check(background.reads > 0, "background not starved");
+    modbus_test_check(background.max_wait_ms < 2 * MODBUS_PRIO_AGING_MS + 100, "background wait bounded by aging");
+}
+
+static struct rt_semaphore prio_async_done;
+
+/**
+ * A queue full of polls still takes a shell command, which then runs next
+ */
+static void prio_reserved_slots(modbus_rtu_device_t *mb)
+{
+    static modbus_txn_t txns[MODBUS_TXN_QUEUE_DEPTH + 1];
+    static rt_uint16_t values[MODBUS_TXN_QUEUE_DEPTH + 1][4];
+    modbus_txn_t *interactive;
+    rt_uint32_t accepted = 0, later = 0, i;
+
+    rt_sem_init(&prio_async_done, "mbp_as", 0, RT_IPC_FLAG_FIFO);
+    for (i = 0; i < MODBUS_TXN_QUEUE_DEPTH; i++) {
+        rt_memset(&txns[i], 0, sizeof(modbus_txn_t));
+        txns[i].slave_addr = S8_MODBUS_ADDRESS;
+        txns[i].function_code = MODBUS_FUNC_READ_INPUT_REGS;
+        txns[i].reg_count = 4;
+        txns[i].values = values[i];
+        txns[i].done = &prio_async_done;
+        txns[i].priority = MODBUS_PRIO_BACKGROUND;
+        if (modbus_submit(mb, &txns[i]) != RT_EOK) {
+            break;
+        }
+        accepted++;
+    }
+    modbus_test_check(accepted < MODBUS_TXN_QUEUE_DEPTH &&
+                      accepted <= MODBUS_TXN_QUEUE_DEPTH - MODBUS_PRIO_RESERVED + 1,
+                      "background kept out of the reserved slots");
+
+    interactive = &txns[MODBUS_TXN_QUEUE_DEPTH];
+    rt_memset(interactive, 0, sizeof(modbus_txn_t));
+    interactive->slave_addr = S8_MODBUS_ADDRESS;
+    interactive->function_code = MODBUS_FUNC_READ_INPUT_REGS;
+    interactive->reg_count = 4;
+    interactive->values = values[MODBUS_TXN_QUEUE_DEPTH];
+    interactive->done = &prio_async_done;
+    interactive->priority = MODBUS_PRIO_INTERACTIVE;
+    modbus_test_check(modbus_submit(mb, interactive) == RT_EOK, "interactive request admitted to a full queue");
+
+    for (i = 0; i <= accepted; i++) {
+        rt_sem_take(&prio_async_done, RT_WAITING_FOREVER);
+    }
+    for (i = 0; i < accepted; i++) {
+        if ((rt_int32_t)(txns[i].done_tick - interactive->done_tick) > 0) {
+            later++;
+        }
+    }
+    rt_kprintf("  Full queue: %d background accepted, interactive overtook %d of them\n", accepted, later);
+    modbus_test_check(interactive->result == RT_EOK && later + 2 >= accepted, "interactive ran ahead of queued polls");
+    rt_sem_detach(&prio_async_done);
+}
+
+/**
+ * Priority classes on a simulated S8 under full background load
+ * Usage: test_mb_priority [commands]
+ */
+static void test_mb_priority(int argc, char *argv[])
+{
+    modbus_sim_t *sim;
+    modbus_rtu_device_t *mb;
+    rt_uint32_t commands, fifo_p50, prio_p99;
+
+    modbus_test_begin("[MB_PRIO]");
+    commands = (argc > 1) ? atoi(argv[1]) : 20;
+
+    sim = modbus_test_setup(9600, 1, &mb);
+    if (!sim) {
+        return;
+    }
+
+    rt_kprintf("  %d-transaction commands, %d pollers busy:\n", PRIO_COMMAND_TXNS, PRIO_LOAD_THREADS);
+    fifo_p50 = prio_interactive(mb, MODBUS_PRIO_BACKGROUND, commands);
+    prio_p99 = prio_interactive(mb, MODBUS_PRIO_AUTO, commands);
+    modbus_test_check(prio_p99 < fifo_p50, "interactive p99 below FIFO p50");
+
+    prio_starvation(mb);
+    prio_reserved_slots(mb);
+
+    modbus_test_end("Modbus Priority Classes");
+
+    modbus_test_teardown(sim, mb);
+}
+MSH_CMD_EXPORT(test_mb_priority, Modbus priority class tests);
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Capture and replay of Modbus bus traffic
+ * 2026-10-16     Developer    Verdict and simulated bus from the shared test fixture
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include "modbus_rtu.h"
+#include "modbus_capture.h"
+#include "modbus_sim.h"
+#include "modbus_replay.h"
+
+#define REPLAY_READS_MAX        200
+#define REPLAY_AGREE_PERCENT    90      /* Learned timeouts may tip a marginal read either way */
+#define REPLAY_TIMING_PERCENT   25      /* Replay at 100% within this of the recorded run */
+
+/**
+ * IR1-IR4 reads back to back on uart_name, outcome of each in ok[]
+ * Returns the elapsed time in ms, or 0 if the bus could not be opened.
+ */
+static rt_uint32_t replay_reads(const char *uart_name, rt_uint32_t reads, rt_bool_t *ok,
+                                rt_uint32_t *succeeded)
+{
+    modbus_rtu_device_t *mb;
+    rt_uint16_t values[4];
+    rt_tick_t begin;
+    rt_uint32_t i;
+
+    mb = modbus_rtu_init(uart_name);
+    if (!mb) {
+        return 0;
+    }
+
+    *succeeded = 0;
+    begin = rt_tick_get();
+    for (i = 0; i < reads; i++) {
+        ok[i] = modbus_read_input_registers(mb, S8_MODBUS_ADDRESS, 0, 4, values) == RT_EOK &&
+                values[3] == 450;
+        if (ok[i]) {
+            (*succeeded)++;
+        }
+    }
+    begin = rt_tick_get() - begin;
+
+    modbus_rtu_deinit(mb);
+    return begin * 1000 / RT_TICK_PER_SECOND + 1;
+}
+
+/**
+ * Record reads from a simulated S8 on a faulty line
+ */
+static rt_uint32_t replay_record(const char *path, rt_uint32_t reads, rt_bool_t *ok, rt_uint32_t *succeeded)
+{
+    modbus_capture_t *capture;
+    modbus_sim_t *sim;
+    rt_uint32_t elapsed = 0;
+
+    sim = modbus_test_setup(9600, S8_MODBUS_ADDRESS, RT_NULL);
+    if (!sim) {
+        modbus_test_check(RT_FALSE, "simulated sensor created");
+        return 0;
+    }
+    sim->jitter_ms = 3;
+    sim->drop_permille = 50;
+    sim->corrupt_permille = 50;
+    sim->noise_permille = 50;
+    sim->byte_drop_permille = 3;
+    sim->split_permille = 50;
+    sim->split_gap_ms = 8;
+
+    capture = modbus_capture_start(MODBUS_SIM_NAME, path);
+    modbus_test_check(capture != RT_NULL, "capture started");
+    if (capture) {
+        elapsed = replay_reads(MODBUS_SIM_NAME, reads, ok, succeeded);
+        rt_kprintf("  recorded: %d/%d read in %d ms, %d requests, %d corrupted, %d noise, %d split\n",
+                   *succeeded, reads, elapsed, sim->requests, sim->corrupted, sim->noise_bursts,
+                   sim->split_replies);
+        modbus_test_check(capture->records > 0 && capture->dropped == 0, "every record kept");
+        modbus_test_check(modbus_capture_stop(capture) == RT_EOK, "capture written");
+    }
+
+    modbus_test_teardown(sim, RT_NULL);
+    return elapsed;
+}
+
+/**
+ * Replay a capture at speed_percent, outcome of each read in ok[]
+ */
+static rt_uint32_t replay_run(const char *path, rt_uint32_t speed_percent, rt_uint32_t reads, rt_bool_t *ok,
+                              rt_uint32_t *succeeded)
+{
+    modbus_replay_t *replay;
+    rt_uint32_t elapsed;
+
+    replay = modbus_replay_create("mbrep", path, speed_percent);
+    if (!replay) {
+        modbus_test_check(RT_FALSE, "capture loaded for replay");
+        return 0;
+    }
+
+    elapsed = replay_reads("mbrep", reads, ok, succeeded);
+    rt_kprintf("  replay %3d%%: %d/%d read in %d ms, %d requests, %d matched, %d mismatched, "
+               "%d replies, %d skipped, %d past the end\n",
+               speed_percent, *succeeded, reads, elapsed, replay->requests, replay->matched,
+               replay->mismatched, replay->rx_records, replay->skipped, replay->exhausted);
+    if (speed_percent == 100) {
+        modbus_test_check(replay->mismatched == 0 && replay->exhausted == 0, "master sent the recorded requests");
+    }
+
+    modbus_replay_destroy(replay);
+    return elapsed;
+}
+
+/**
+ * Record a faulty bus, then replay it at recorded and at 4x speed
+ * Usage: test_mb_replay [path] [reads]
+ */
+static void test_mb_replay(int argc, char *argv[])
+{
+    static rt_bool_t recorded[REPLAY_READS_MAX], replayed[REPLAY_READS_MAX];
+    const char *path;
+    rt_uint32_t reads, i, agree, ok_recorded, ok_replayed;
+    rt_uint32_t t_recorded, t_replayed, t_fast;
+
+    modbus_test_begin("[MB_REPLAY]");
+    path = (argc > 1) ? argv[1] : MODBUS_CAPTURE_DIR "/replay_test.mbc";
+    reads = (argc > 2) ? atoi(argv[2]) : 100;
+    if (reads == 0 || reads > REPLAY_READS_MAX) {
+        rt_kprintf("Usage: test_mb_replay [path] [reads <= %d]\n", REPLAY_READS_MAX);
+        return;
+    }
+    if (argc <= 1) {
+        mkdir(MODBUS_CAPTURE_DIR, 0777);
+    }
+
+    t_recorded = replay_record(path, reads, recorded, &ok_recorded);
+    if (t_recorded == 0) {
+        goto out;
+    }
+
+    t_replayed = replay_run(path, 100, reads, replayed, &ok_replayed);
+    agree = 0;
+    for (i = 0; i < reads; i++) {
+        if (recorded[i] == replayed[i]) {
+            agree++;
+        }
+    }
+    rt_kprintf("  outcome agreement: %d/%d reads\n", agree, reads);
+    modbus_test_check(agree * 100 >= reads * REPLAY_AGREE_PERCENT, "replay reproduces the recorded outcomes");
+    modbus_test_check(t_replayed * 100 >= t_recorded * (100 - REPLAY_TIMING_PERCENT) &&
+                      t_replayed * 100 <= t_recorded * (100 + REPLAY_TIMING_PERCENT),
+                      "replay keeps the recorded timing");
+
+    /* Timeouts still run at full length, so 4x speed only bounds the replies */
+    t_fast = replay_run(path, 400, reads, replayed, &ok_replayed);
+    modbus_test_check(t_fast > 0 && t_fast < t_replayed, "faster than recorded");
+
+out:
+    modbus_test_end("Modbus Capture Replay");
+}
+MSH_CMD_EXPORT(test_mb_replay, Modbus bus capture and replay tests);
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Exception and retry policy tests
+ * 2026-10-16     Developer    Verdict and simulated bus from the shared test fixture
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "modbus_rtu.h"
+#include "modbus_sim.h"
+#include "s8_sensor.h"
+
+#define RETRY_SILENT_SLAVE      0x40
+
+/**
+ * One IR1-IR4 read through a transaction, so retries and exception are visible
+ */
+static rt_err_t retry_read(modbus_rtu_device_t *mb, rt_uint8_t slave_addr, rt_uint16_t start,
+                           const modbus_retry_t *policy, modbus_txn_t *txn, rt_uint16_t *values)
+{
+    rt_memset(txn, 0, sizeof(modbus_txn_t));
+    txn->slave_addr = slave_addr;
+    txn->function_code = MODBUS_FUNC_READ_INPUT_REGS;
+    txn->start_addr = start;
+    txn->reg_count = 4;
+    txn->values = values;
+    txn->retry = policy;
+
+    return modbus_transact(mb, txn);
+}
+
+/**
+ * Each failure class against the default policy, and a policy without retries
+ */
+static void retry_master_tests(modbus_sim_t *sim, modbus_rtu_device_t *mb)
+{
+    static const modbus_retry_t no_retry = {0, 0, 0, 0, MODBUS_RETRY_GAP_CHARS, MODBUS_RETRY_BUSY_MS};
+    modbus_txn_t txn;
+    rt_uint16_t values[4];
+    rt_tick_t start, elapsed;
+    rt_err_t result;
+
+    /* A corrupted reply is re-sent after a few character times */
+    sim->corrupt_replies = 1;
+    result = retry_read(mb, S8_MODBUS_ADDRESS, 0, RT_NULL, &txn, values);
+    modbus_test_check(result == RT_EOK && txn.retries == 1 && values[3] == 450, "recovers from a corrupted reply");
+
+    /* Without retries it fails fast, well inside the response timeout */
+    sim->corrupt_replies = 1;
+    start = rt_tick_get();
+    result = retry_read(mb, S8_MODBUS_ADDRESS, 0, &no_retry, &txn, values);
+    elapsed = rt_tick_get() - start;
+    modbus_test_check(result == -RT_EIO && txn.retries == 0, "corrupted reply reported as -RT_EIO");
+    modbus_test_check(elapsed < rt_tick_from_millisecond(MODBUS_RESPONSE_TIMEOUT_MS / 2),
+                      "corrupted reply does not wait out the timeout");
+
+    /* A busy slave is given time before the re-send */
+    sim->busy_replies = 1;
+    start = rt_tick_get();
+    result = retry_read(mb, S8_MODBUS_ADDRESS, 0, RT_NULL, &txn, values);
+    elapsed = rt_tick_get() - start;
+    modbus_test_check(result == RT_EOK && txn.retries == 1, "recovers from slave busy");
+    modbus_test_check(elapsed >= rt_tick_from_millisecond(MODBUS_RETRY_BUSY_MS), "busy back-off applied");
+
+    /* A slave that stays busy exhausts its budget */
+    sim->busy_replies = 10;
+    result = retry_read(mb, S8_MODBUS_ADDRESS, 0, RT_NULL, &txn, values);
+    modbus_test_check(result == -RT_EBUSY && txn.exception == MODBUS_EX_SLAVE_BUSY &&
+                      txn.retries == MODBUS_RETRY_BUSY, "busy budget bounded");
+    sim->busy_replies = 0;
+
+    /* Other exceptions are final */
+    result = retry_read(mb, S8_MODBUS_ADDRESS, MODBUS_SIM_REG_COUNT - 2, RT_NULL, &txn, values);
+    modbus_test_check(result == -RT_ERROR && txn.exception == MODBUS_EX_ILLEGAL_ADDRESS &&
+                      txn.retries == 0, "illegal data address not retried");
+
+    /* A dropped reply gets one more chance */
+    sim->drop_replies = 1;
+    result = retry_read(mb, S8_MODBUS_ADDRESS, 0, RT_NULL, &txn, values);
+    modbus_test_check(result == RT_EOK && txn.retries == 1, "recovers from a dropped reply");
+
+    /* A silent slave is not hammered */
+    result = retry_read(mb, RETRY_SILENT_SLAVE, 0, RT_NULL, &txn, values);
+    modbus_test_check(result == -RT_ETIMEOUT && txn.retries == MODBUS_RETRY_TIMEOUTS, "timeout budget bounded");
+}
+
+/**
+ * Final outcome and retry count as the S8 driver sees them
+ */
+static void retry_sensor_tests(modbus_sim_t *sim)
+{
+    s8_sensor_device_t *sensor;
+
+    sensor = s8_sensor_init_slave(MODBUS_SIM_NAME, S8_MODBUS_ADDRESS);
+    if (!sensor) {
+        modbus_test_check(RT_FALSE, "sensor on simulated UART");
+        return;
+    }
+
+    sim->corrupt_replies = 1;
+    modbus_test_check(s8_refresh_co2_data(sensor) == S8_STATUS_OK && sensor->last_retries == 1,
+                      "sensor read survives a corrupted reply");
+
+    sim->busy_replies = 10;
+    modbus_test_check(s8_refresh_co2_data(sensor) == S8_STATUS_EXCEPTION &&
+                      sensor->health.last_exception == MODBUS_EX_SLAVE_BUSY &&
+                      sensor->last_retries == MODBUS_RETRY_BUSY, "busy sensor reported as exception");
+    sim->busy_replies = 0;
+
+    modbus_test_check(sensor->health.retries == 1 + MODBUS_RETRY_BUSY, "retries accumulated in health");
+
+    s8_sensor_deinit(sensor);
+}
+
+/**
+ * Exception and retry policy tests against the simulated S8
+ * Usage: test_mb_retry
+ */
+static void test_mb_retry(int argc, char *argv[])
+{
+    modbus_sim_t *sim;
+    modbus_rtu_device_t *mb;
+
+    RT_UNUSED(argc);
+    RT_UNUSED(argv);
+
+    modbus_test_begin("[MB_RETRY]");
+
+    sim = modbus_test_setup(9600, 1, &mb);
+    if (!sim) {
+        return;
+    }
+    sim->input_regs[MODBUS_SIM_CO2_REG] = 450;
+
+    retry_master_tests(sim, mb);
+    modbus_rtu_deinit(mb);
+
+    retry_sensor_tests(sim);
+
+    modbus_test_end("Modbus Retry Policy");
+
+    modbus_test_teardown(sim, RT_NULL);
+}
+MSH_CMD_EXPORT(test_mb_retry, Exception and retry policy tests);
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    RS-485 driver-enable turnaround tests
+ * 2026-10-16     Developer    Verdict and simulated bus from the shared test fixture
+ * 2026-10-16     Developer    Driver enable from the bus config, only on its own bus
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <stdlib.h>
+#include "modbus_rtu.h"
+#include "modbus_sim.h"
+
+#define RS485_DE_PIN            GET_PIN(20, 1)
+#define RS485_HOLD_US           3000    /* Fixed-delay direction switch of an auto-direction transceiver */
+#define RS485_MAX_LATENCY_MS    4
+
+/**
+ * IR1-IR4 reads at one slave turnaround, returns how many succeeded
+ */
+static rt_uint32_t rs485_poll(modbus_rtu_device_t *mb, modbus_sim_t *sim, rt_uint32_t latency_ms,
+                              rt_uint32_t reads)
+{
+    rt_uint16_t values[4];
+    rt_uint32_t ok = 0, i;
+
+    sim->latency_ms = latency_ms;
+    sim->gaps = 0;
+    sim->clipped_replies = 0;
+    for (i = 0; i < reads; i++) {
+        if (modbus_read_input_registers(mb, S8_MODBUS_ADDRESS, 0, 4, values) == RT_EOK && values[3] == 450) {
+            ok++;
+        }
+    }
+
+    return ok;
+}
+
+/**
+ * Reads across slave turnarounds, with and without driver-enable control
+ */
+static void rs485_sweep(modbus_rtu_device_t *mb, modbus_sim_t *sim, rt_bool_t de, rt_uint32_t reads)
+{
+    rt_uint32_t latency, ok;
+
+    rt_kprintf("  %s:\n", de ? "DE released on transmit complete" : "auto-direction, 3 ms hold");
+    for (latency = 0; latency <= RS485_MAX_LATENCY_MS; latency++) {
+        ok = rs485_poll(mb, sim, latency, reads);
+        rt_kprintf("    slave turnaround %d ms: %2d/%d read, line gap %d..%d us, %d clipped\n",
+                   latency, ok, reads, sim->gap_min_us, sim->gap_max_us, sim->clipped_replies);
+        if (de) {
+            modbus_test_check(ok == reads && sim->clipped_replies == 0 && sim->gap_min_us >= 0,
+                              "no reply lost under driver-enable control");
+        } else if (latency * 1000 + 999 < RS485_HOLD_US) {
+            modbus_test_check(ok == 0 && sim->clipped_replies == reads, "fast replies clipped by the driver hold");
+        }
+    }
+}
+
+/**
+ * Turnaround statistics start at the transmit-complete event
+ */
+static void rs485_turnaround_stats(modbus_rtu_device_t *mb, modbus_sim_t *sim, rt_uint32_t reads)
+{
+    modbus_stats_t *stats;
+    rt_uint32_t i, p50 = 0;
+
+    stats = (modbus_stats_t *)rt_malloc(sizeof(modbus_stats_t));
+    if (!stats) {
+        modbus_test_check(RT_FALSE, "stats buffer");
+        return;
+    }
+
+    modbus_stats_reset(mb);
+    rs485_poll(mb, sim, 3, reads);
+    modbus_stats_get(mb, stats);
+    for (i = 0; i < MODBUS_STATS_SLOTS; i++) {
+        if (stats->slots[i].slave_addr == S8_MODBUS_ADDRESS &&
+            stats->slots[i].function_code == MODBUS_FUNC_READ_INPUT_REGS) {
+            p50 = modbus_hist_percentile(&stats->slots[i].hist[MODBUS_PHASE_TURNAROUND], 50);
+        }
+    }
+    rt_free(stats);
+
+    rt_kprintf("  3 ms slave: turnaround p50 %d ms after transmit complete\n", p50);
+    modbus_test_check(p50 >= 3 && p50 <= 5, "turnaround measured from the released driver");
+}
+
+/**
+ * RS-485 direction control against a simulated half-duplex line
+ * Usage: test_mb_rs485 [reads]
+ */
+static void test_mb_rs485(int argc, char *argv[])
+{
+    modbus_sim_t *sim;
+    modbus_rtu_device_t *mb, *shared;
+    modbus_bus_config_t bus = {RT_NULL, 0, 0, MODBUS_DE_NONE, PIN_LOW};
+    modbus_retry_t single = {0};         /* A clipped reply fails the same way every time */
+    rt_uint32_t reads;
+
+    modbus_test_begin("[MB_RS485]");
+    reads = (argc > 1) ? atoi(argv[1]) : 10;
+
+    sim = modbus_test_setup(9600, 1, &mb);
+    if (!sim) {
+        return;
+    }
+    sim->auto_direction_us = RS485_HOLD_US;
+    modbus_set_retry(mb, &single);
+
+    rs485_sweep(mb, sim, RT_FALSE, reads);
+
+    modbus_test_check(modbus_set_driver_enable(mb, RS485_DE_PIN, PIN_LOW) == RT_EOK && sim->de_control,
+                      "driver enable handed to the UART");
+    rs485_sweep(mb, sim, RT_TRUE, reads);
+    rs485_turnaround_stats(mb, sim, reads);
+
+    modbus_rtu_deinit(mb);
+    modbus_test_check(!sim->de_control, "driver enable released on deinit");
+
+    /* From the bus table: set up once with the bus, left alone by a bus without one */
+    bus.uart_name = MODBUS_SIM_NAME;
+    bus.de_pin = RS485_DE_PIN;
+    mb = modbus_rtu_init_config(&bus);
+    modbus_test_check(mb && sim->de_control, "driver enable set from the bus config");
+    bus.de_pin = MODBUS_DE_NONE;
+    shared = modbus_rtu_init_config(&bus);
+    modbus_test_check(shared == mb && sim->de_control, "sharing the bus keeps its driver enable");
+    modbus_rtu_deinit(shared);
+    modbus_rtu_deinit(mb);
+    modbus_test_check(!sim->de_control, "driver enable released with the bus");
+    mb = modbus_rtu_init_config(&bus);
+    modbus_test_check(mb && !sim->de_control, "no driver enable on a bus without one");
+    modbus_rtu_deinit(mb);
+
+    modbus_test_end("Modbus RS-485 Turnaround");
+
+    modbus_test_teardown(sim, RT_NULL);
+}
+MSH_CMD_EXPORT(test_mb_rs485, Modbus RS-485 driver-enable turnaround tests);
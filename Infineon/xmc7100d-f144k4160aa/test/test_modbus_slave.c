@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Slave endpoint and S8 export tests
+ * 2026-10-16     Developer    Verdict and simulated bus from the shared test fixture
+ * 2026-10-16     Developer    Bus configs name no driver enable pin
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "modbus_rtu.h"
+#include "modbus_slave.h"
+#include "modbus_link.h"
+#include "s8_export.h"
+#include "modbus_sim.h"
+
+#define SLAVE_LINK_MASTER       "mblnk_m"
+#define SLAVE_LINK_SLAVE        "mblnk_s"
+#define SLAVE_ADDR              0x11
+#define SLAVE_BLOCK_REGS        16
+#define SLAVE_TORN_POLLS        200
+
+static volatile rt_bool_t slave_publishing;
+
+/**
+ * Reads, exceptions and addressing against the endpoint
+ */
+static void slave_protocol_tests(modbus_slave_t *slave, modbus_rtu_device_t *mb)
+{
+    static const modbus_retry_t no_retry = {0, 0, 0, 0, MODBUS_RETRY_GAP_CHARS, MODBUS_RETRY_BUSY_MS};
+    rt_uint16_t image[MODBUS_SLAVE_REGS], values[8];
+    modbus_txn_t txn;
+    rt_uint32_t i;
+
+    for (i = 0; i < MODBUS_SLAVE_REGS; i++) {
+        image[i] = (rt_uint16_t)(1000 + i * 3);
+    }
+    modbus_test_check(modbus_slave_publish(slave, 0, MODBUS_SLAVE_REGS, image) == RT_EOK, "publish full image");
+    modbus_test_check(modbus_slave_publish(slave, MODBUS_SLAVE_REGS - 1, 2, image) == -RT_ERROR,
+                      "publish past the image refused");
+
+    /* FC03 and FC04 serve the same image */
+    modbus_test_check(modbus_read_holding_registers(mb, SLAVE_ADDR, 0, 8, values) == RT_EOK &&
+                      values[0] == 1000 && values[7] == 1021, "FC03 read");
+    modbus_test_check(modbus_read_input_registers(mb, SLAVE_ADDR, MODBUS_SLAVE_REGS - 2, 2, values) == RT_EOK &&
+                      values[1] == image[MODBUS_SLAVE_REGS - 1], "FC04 read at the end of the image");
+
+    rt_memset(&txn, 0, sizeof(txn));
+    txn.slave_addr = SLAVE_ADDR;
+    txn.function_code = MODBUS_FUNC_READ_HOLDING_REGS;
+    txn.start_addr = MODBUS_SLAVE_REGS - 2;
+    txn.reg_count = 4;
+    txn.values = values;
+    modbus_test_check(modbus_transact(mb, &txn) == -RT_ERROR && txn.exception == MODBUS_EX_ILLEGAL_ADDRESS,
+                      "read past the image answered with exception 02");
+
+    modbus_test_check(modbus_write_single_register(mb, SLAVE_ADDR, 0, 1) == -RT_ERROR &&
+                      slave->exceptions == 2, "write answered with exception 01");
+
+    /* Another slave's address: the endpoint stays silent */
+    rt_memset(&txn, 0, sizeof(txn));
+    txn.slave_addr = SLAVE_ADDR + 1;
+    txn.function_code = MODBUS_FUNC_READ_HOLDING_REGS;
+    txn.reg_count = 1;
+    txn.values = values;
+    txn.retry = &no_retry;
+    modbus_test_check(modbus_transact(mb, &txn) == -RT_ETIMEOUT && slave->other_slaves == 1,
+                      "other slave address ignored");
+
+    modbus_test_check(slave->crc_errors == 0, "no framing errors");
+    modbus_test_check(slave->requests == 4, "request count");
+}
+
+/**
+ * Publisher: rewrites a block with one value per update, as fast as it can
+ */
+static void slave_publisher_entry(void *parameter)
+{
+    modbus_slave_t *slave = (modbus_slave_t *)parameter;
+    rt_uint16_t block[SLAVE_BLOCK_REGS], value = 0, i;
+
+    while (slave_publishing) {
+        value++;
+        for (i = 0; i < SLAVE_BLOCK_REGS; i++) {
+            block[i] = value;
+        }
+        modbus_slave_publish(slave, 0, SLAVE_BLOCK_REGS, block);
+        rt_thread_yield();
+    }
+}
+
+/**
+ * Polls under a busy publisher: never a mixed block, reply turnaround bounded
+ */
+static void slave_snapshot_tests(modbus_slave_t *slave, modbus_rtu_device_t *mb)
+{
+    rt_uint16_t values[SLAVE_BLOCK_REGS];
+    rt_uint32_t polls, torn = 0, failed = 0, changes = 0, i;
+    rt_uint16_t last = 0;
+    rt_thread_t publisher;
+
+    slave->max_response_tick = 0;
+    slave_publishing = RT_TRUE;
+    publisher = rt_thread_create("mbs_pub", slave_publisher_entry, slave, 1024,
+                                 MODBUS_SLAVE_THREAD_PRIORITY + 5, 10);
+    if (!publisher) {
+        modbus_test_check(RT_FALSE, "publisher thread");
+        return;
+    }
+    rt_thread_startup(publisher);
+
+    for (polls = 0; polls < SLAVE_TORN_POLLS; polls++) {
+        if (modbus_read_holding_registers(mb, SLAVE_ADDR, 0, SLAVE_BLOCK_REGS, values) != RT_EOK) {
+            failed++;
+            continue;
+        }
+        for (i = 1; i < SLAVE_BLOCK_REGS; i++) {
+            if (values[i] != values[0]) {
+                torn++;
+                break;
+            }
+        }
+        if (values[0] != last) {
+            changes++;
+            last = values[0];
+        }
+    }
+    slave_publishing = RT_FALSE;
+    rt_thread_mdelay(10);
+
+    rt_kprintf("  %d polls under load: %d torn, %d failed, %d distinct updates seen\n",
+               polls, torn, failed, changes);
+    rt_kprintf("  Worst turnaround %d ms after the request, T3.5 %d ms\n",
+               slave->max_response_tick * 1000 / RT_TICK_PER_SECOND,
+               slave->t35_tick * 1000 / RT_TICK_PER_SECOND);
+    modbus_test_check(torn == 0, "every poll saw one complete update");
+    modbus_test_check(failed == 0, "every poll answered");
+    modbus_test_check(changes > polls / 2, "polls followed the publisher");
+    modbus_test_check(slave->max_response_tick <= slave->t35_tick + rt_tick_from_millisecond(5),
+                      "reply within T3.5 plus 5 ms");
+}
+
+/**
+ * Register map filled from a sensor's cached reading
+ */
+static void slave_export_tests(modbus_rtu_device_t *mb)
+{
+    static const rt_uint16_t readings[] = {600, 450, 900};
+    modbus_bus_config_t bus = {SLAVE_LINK_SLAVE, 0, 0, MODBUS_DE_NONE, 0};
+    s8_sensor_device_t sensor;
+    s8_export_t *exporter;
+    rt_uint16_t regs[S8_EXPORT_REG_COUNT];
+    rt_uint32_t i;
+
+    /* No Modbus device: a refresh that touched the sensor bus would crash */
+    rt_memset(&sensor, 0, sizeof(sensor));
+    sensor.slave_addr = S8_MODBUS_ADDRESS;
+    sensor.health.state = S8_HEALTH_ONLINE;
+
+    exporter = s8_export_start(&sensor, &bus, SLAVE_ADDR);
+    if (!exporter) {
+        modbus_test_check(RT_FALSE, "export on the link");
+        return;
+    }
+
+    modbus_test_check(modbus_read_input_registers(mb, SLAVE_ADDR, 0, S8_EXPORT_REG_COUNT, regs) == RT_EOK &&
+                      regs[S8_EXPORT_VALID] == 0 && regs[S8_EXPORT_AGE] == 0xFFFF,
+                      "no reading yet reported as invalid");
+
+    for (i = 0; i < sizeof(readings) / sizeof(readings[0]); i++) {
+        sensor.data.co2_ppm = readings[i];
+        sensor.data.timestamp = rt_tick_get() - 3 + i;     /* Distinct, not in the future */
+        sensor.data.data_valid = RT_TRUE;
+        s8_export_refresh(exporter);
+        s8_export_refresh(exporter);        /* Same sample twice counts once */
+    }
+    sensor.data.alarm_state = 1;
+    s8_export_refresh(exporter);
+
+    modbus_test_check(modbus_read_holding_registers(mb, SLAVE_ADDR, 0, S8_EXPORT_REG_COUNT, regs) == RT_EOK,
+                      "export read");
+    modbus_test_check(regs[S8_EXPORT_CO2] == 900 && regs[S8_EXPORT_CO2_MIN] == 450 &&
+                      regs[S8_EXPORT_CO2_MAX] == 900 && regs[S8_EXPORT_CO2_AVG] == 650, "CO2 statistics");
+    modbus_test_check(regs[S8_EXPORT_SAMPLES_HI] == 0 && regs[S8_EXPORT_SAMPLES_LO] == 3, "sample count");
+    modbus_test_check(regs[S8_EXPORT_ALARM] == 1 && regs[S8_EXPORT_VALID] == 1 && regs[S8_EXPORT_AGE] == 0 &&
+                      regs[S8_EXPORT_HEALTH] == S8_HEALTH_ONLINE, "alarm, age and health");
+
+    s8_export_reset(exporter);
+    s8_export_refresh(exporter);
+    modbus_test_check(modbus_read_holding_registers(mb, SLAVE_ADDR, S8_EXPORT_CO2_MIN, 1, regs) == RT_EOK &&
+                      regs[0] == 900, "statistics restart after reset");
+
+    s8_export_stop(exporter);
+}
+
+/**
+ * Slave endpoint tests, master and slave on a null-modem link
+ * Usage: test_mb_slave
+ */
+static void test_mb_slave(int argc, char *argv[])
+{
+    modbus_bus_config_t bus = {SLAVE_LINK_SLAVE, 0, 0, MODBUS_DE_NONE, 0};
+    modbus_link_t *link;
+    modbus_slave_t *slave;
+    modbus_rtu_device_t *mb;
+
+    RT_UNUSED(argc);
+    RT_UNUSED(argv);
+
+    modbus_test_begin("[MB_SLAVE]");
+
+    link = modbus_link_create(SLAVE_LINK_MASTER, SLAVE_LINK_SLAVE, 9600);
+    if (!link) {
+        rt_kprintf("[MB_SLAVE] Failed to create serial link\n");
+        return;
+    }
+
+    mb = modbus_rtu_init(SLAVE_LINK_MASTER);
+    if (!mb) {
+        rt_kprintf("[MB_SLAVE] Modbus init on the link failed\n");
+        modbus_link_destroy(link);
+        return;
+    }
+
+    slave = modbus_slave_start(&bus, SLAVE_ADDR);
+    if (!slave) {
+        rt_kprintf("[MB_SLAVE] Slave endpoint on the link failed\n");
+        modbus_rtu_deinit(mb);
+        modbus_link_destroy(link);
+        return;
+    }
+    modbus_test_check(modbus_slave_start(&bus, SLAVE_ADDR + 1) == RT_NULL, "second endpoint on one UART refused");
+
+    slave_protocol_tests(slave, mb);
+    slave_snapshot_tests(slave, mb);
+    modbus_slave_dump(slave);
+    modbus_slave_stop(slave);
+
+    slave_export_tests(mb);
+
+    modbus_test_end("Modbus Slave Endpoint");
+
+    modbus_rtu_deinit(mb);
+    modbus_link_destroy(link);
+}
+MSH_CMD_EXPORT(test_mb_slave, Modbus slave endpoint tests);
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Modbus latency histogram and utilisation tests
+ * 2026-10-16     Developer    Silent slave attempts include retries
+ * 2026-10-16     Developer    Verdict and simulated bus from the shared test fixture
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "modbus_rtu.h"
+#include "modbus_sim.h"
+
+#define STATS_LATENCY_MS        10
+#define STATS_READS             20
+#define STATS_SILENT_SLAVE      0x40
+
+static modbus_stats_slot_t *stats_find(modbus_stats_t *stats, rt_uint8_t slave_addr,
+                                       rt_uint8_t function_code)
+{
+    rt_uint8_t i;
+
+    for (i = 0; i < MODBUS_STATS_SLOTS; i++) {
+        if (stats->slots[i].slave_addr == slave_addr &&
+            stats->slots[i].function_code == function_code) {
+            return &stats->slots[i];
+        }
+    }
+    return RT_NULL;
+}
+
+/**
+ * Phase histograms, error counters, slot overflow and utilisation against the simulated S8
+ * Usage: test_mb_stats
+ */
+static void test_mb_stats(int argc, char *argv[])
+{
+    modbus_sim_t *sim;
+    modbus_rtu_device_t *mb;
+    modbus_stats_t *stats;
+    modbus_stats_slot_t *slot;
+    rt_uint16_t values[4];
+    rt_uint32_t turnaround, total, i;
+
+    RT_UNUSED(argc);
+    RT_UNUSED(argv);
+
+    modbus_test_begin("[MB_STATS]");
+
+    stats = (modbus_stats_t *)rt_malloc(sizeof(modbus_stats_t));
+    if (!stats) {
+        rt_kprintf("[MB_STATS] Out of memory\n");
+        return;
+    }
+
+    sim = modbus_test_setup(9600, 1, &mb);
+    if (!sim) {
+        rt_free(stats);
+        return;
+    }
+    sim->slave_count = 12;
+    sim->latency_ms = STATS_LATENCY_MS;
+    modbus_stats_reset(mb);
+
+    /* Successful reads fill every phase */
+    for (i = 0; i < STATS_READS; i++) {
+        modbus_read_input_registers(mb, S8_MODBUS_ADDRESS, 0, 4, values);
+    }
+    modbus_stats_get(mb, stats);
+    slot = stats_find(stats, S8_MODBUS_ADDRESS, MODBUS_FUNC_READ_INPUT_REGS);
+    modbus_test_check(slot != RT_NULL, "slot for 0xFE/FC04");
+    if (slot) {
+        modbus_test_check(slot->transactions == STATS_READS, "every read counted");
+        modbus_test_check(slot->timeouts == 0 && slot->errors == 0 && slot->invalid == 0, "no errors");
+        modbus_test_check(modbus_hist_count(&slot->hist[MODBUS_PHASE_TOTAL]) == STATS_READS &&
+                          modbus_hist_count(&slot->hist[MODBUS_PHASE_TURNAROUND]) == STATS_READS,
+                          "one histogram sample per read");
+
+        /* Turnaround reflects the slave latency; 13 reply bytes take ~14 ms at 9600 */
+        turnaround = modbus_hist_percentile(&slot->hist[MODBUS_PHASE_TURNAROUND], 50);
+        total = modbus_hist_percentile(&slot->hist[MODBUS_PHASE_TOTAL], 50);
+        modbus_test_check(turnaround >= STATS_LATENCY_MS / 2 && turnaround <= STATS_LATENCY_MS * 2,
+                          "turnaround close to the slave latency");
+        modbus_test_check(total > turnaround && total <= 64, "total covers the whole exchange");
+        modbus_test_check(slot->hist[MODBUS_PHASE_RX].max_ms >= 8, "reply takes its wire time");
+    }
+    modbus_test_check(stats->wire_permille > 0 && stats->wire_permille <= stats->busy_permille,
+                      "line utilisation below bus occupancy");
+
+    /* A silent slave times out, retries included, without touching the histograms of replies */
+    modbus_read_input_registers(mb, STATS_SILENT_SLAVE, 0, 4, values);
+    modbus_read_input_registers(mb, STATS_SILENT_SLAVE, 0, 4, values);
+    modbus_stats_get(mb, stats);
+    slot = stats_find(stats, STATS_SILENT_SLAVE, MODBUS_FUNC_READ_INPUT_REGS);
+    modbus_test_check(slot && slot->timeouts == 2 * (1 + MODBUS_RETRY_TIMEOUTS) &&
+                      slot->retries == 2 * MODBUS_RETRY_TIMEOUTS, "timeouts counted");
+    modbus_test_check(slot && modbus_hist_count(&slot->hist[MODBUS_PHASE_TOTAL]) == 2,
+                      "one total sample per read");
+    modbus_test_check(slot && modbus_hist_count(&slot->hist[MODBUS_PHASE_TURNAROUND]) == 0,
+                      "no turnaround without a reply");
+    modbus_test_check(slot && slot->hist[MODBUS_PHASE_TOTAL].max_ms >= MODBUS_RESPONSE_TIMEOUT_MS,
+                      "timeout shows in the total latency");
+
+    /* More (slave, function) pairs than slots: the rest share the overflow slot */
+    for (i = 1; i <= 10; i++) {
+        modbus_read_holding_registers(mb, (rt_uint8_t)i, 0, 1, values);
+    }
+    modbus_stats_get(mb, stats);
+    slot = &stats->slots[MODBUS_STATS_SLOTS - 1];
+    modbus_test_check(slot->function_code == 0 && slot->transactions == 10 - (MODBUS_STATS_SLOTS - 3),
+                      "overflow slot collects the remaining pairs");
+
+    rt_kprintf("  Busy %d.%d%%, line %d.%d%% over %d ms\n",
+               stats->busy_permille / 10, stats->busy_permille % 10,
+               stats->wire_permille / 10, stats->wire_permille % 10,
+               stats->elapsed_tick * 1000 / RT_TICK_PER_SECOND);
+
+    /* Reset starts a fresh window */
+    modbus_stats_reset(mb);
+    modbus_stats_get(mb, stats);
+    modbus_test_check(stats->slots[0].transactions == 0 && stats->busy_tick == 0, "reset clears everything");
+
+    modbus_test_end("Modbus Statistics");
+
+    modbus_test_teardown(sim, mb);
+    rt_free(stats);
+}
+MSH_CMD_EXPORT(test_mb_stats, Modbus latency histogram and utilisation tests);
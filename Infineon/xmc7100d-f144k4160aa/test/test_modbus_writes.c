@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    FC06, FC16 and FC23 tests
+ * 2026-10-16     Developer    Verdict and simulated bus from the shared test fixture
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "modbus_rtu.h"
+#include "modbus_sim.h"
+
+#define WRITES_BASE_REG         0x10
+
+/**
+ * Frame builders against the examples in the Modbus application protocol spec
+ */
+static void writes_frame_tests(void)
+{
+    static const rt_uint8_t fc16[] = {0x11, 0x10, 0x00, 0x01, 0x00, 0x02, 0x04,
+                                      0x00, 0x0A, 0x01, 0x02, 0xC6, 0xF0};
+    static const rt_uint8_t fc23[] = {0x11, 0x17, 0x00, 0x03, 0x00, 0x06, 0x00, 0x0E, 0x00, 0x03, 0x06,
+                                      0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x4B, 0x54};
+    static const rt_uint16_t fc16_values[] = {0x000A, 0x0102};
+    static const rt_uint16_t fc23_values[] = {0x00FF, 0x00FF, 0x00FF};
+    rt_uint8_t buf[MODBUS_MAX_BUFFER_SIZE];
+    rt_size_t len;
+
+    len = modbus_frame_build_write(buf, 0x11, 0x0001, 2, fc16_values);
+    modbus_test_check(len == sizeof(fc16) && rt_memcmp(buf, fc16, len) == 0, "FC16 example frame");
+
+    len = modbus_frame_build_read_write(buf, 0x11, 0x0003, 6, 0x000E, 3, fc23_values);
+    modbus_test_check(len == sizeof(fc23) && rt_memcmp(buf, fc23, len) == 0, "FC23 example frame");
+
+    modbus_test_check(modbus_frame_build_write(buf, 0x11, 0, MODBUS_MAX_WRITE_REGS + 1, fc16_values) == 0,
+                      "FC16 quantity limit");
+    modbus_test_check(modbus_frame_build_read_write(buf, 0x11, 0, 1, 0, 0, fc23_values) == 0,
+                      "FC23 empty write rejected");
+}
+
+/**
+ * Writes against the simulated S8, each confirmed by the slave
+ */
+static void writes_bus_tests(modbus_sim_t *sim, modbus_rtu_device_t *mb)
+{
+    static const rt_uint16_t block[] = {400, 0, 1, 0xFF00};
+    rt_uint16_t values[4], rw[2] = {0x1234, 0x5678};
+    rt_tick_t start, single, multiple;
+    rt_uint32_t replies, requests, i;
+    rt_err_t result;
+
+    /* FC06 waits for the echo, so nothing is left behind for the next read */
+    modbus_test_check(modbus_write_single_register(mb, S8_MODBUS_ADDRESS, WRITES_BASE_REG, 7) == RT_EOK &&
+                      sim->holding_regs[WRITES_BASE_REG] == 7, "FC06 confirmed");
+    modbus_test_check(modbus_read_input_registers(mb, S8_MODBUS_ADDRESS, 0, 4, values) == RT_EOK &&
+                      values[3] == 450, "read after FC06 sees no stale echo");
+
+    sim->corrupt_replies = 1;
+    modbus_test_check(modbus_write_single_register(mb, S8_MODBUS_ADDRESS, WRITES_BASE_REG, 8) == RT_EOK &&
+                      sim->holding_regs[WRITES_BASE_REG] == 8, "FC06 re-sent after a corrupted echo");
+
+    /* FC16 sets a block in one round trip */
+    result = modbus_write_multiple_registers(mb, S8_MODBUS_ADDRESS, WRITES_BASE_REG, 4, block);
+    modbus_test_check(result == RT_EOK, "FC16 confirmed");
+    for (i = 0; i < 4; i++) {
+        modbus_test_check(sim->holding_regs[WRITES_BASE_REG + i] == block[i], "FC16 values stored");
+    }
+    modbus_test_check(modbus_write_multiple_registers(mb, S8_MODBUS_ADDRESS, MODBUS_SIM_REG_COUNT - 1,
+                                                      4, block) == -RT_ERROR, "FC16 out of range refused");
+
+    /* FC23 writes first, then reads back across the written range */
+    result = modbus_read_write_registers(mb, S8_MODBUS_ADDRESS, WRITES_BASE_REG + 2, 4, values,
+                                         WRITES_BASE_REG + 4, 2, rw);
+    modbus_test_check(result == RT_EOK && values[0] == block[2] && values[1] == block[3] &&
+                      values[2] == rw[0] && values[3] == rw[1], "FC23 read sees its own write");
+
+    /* Broadcast: applied by every slave, answered by none */
+    replies = sim->replies;
+    requests = sim->requests;
+    modbus_test_check(modbus_write_single_register(mb, MODBUS_BROADCAST_ADDRESS, WRITES_BASE_REG, 9) == RT_EOK,
+                      "broadcast FC06 completes");
+    rt_thread_mdelay(20);
+    modbus_test_check(sim->requests == requests + 1 && sim->replies == replies &&
+                      sim->holding_regs[WRITES_BASE_REG] == 9, "broadcast applied without reply");
+
+    /* A four-register update: one FC16 against four FC06 round trips */
+    start = rt_tick_get();
+    for (i = 0; i < 4; i++) {
+        modbus_write_single_register(mb, S8_MODBUS_ADDRESS, WRITES_BASE_REG + i, block[i]);
+    }
+    single = rt_tick_get() - start;
+    start = rt_tick_get();
+    modbus_write_multiple_registers(mb, S8_MODBUS_ADDRESS, WRITES_BASE_REG, 4, block);
+    multiple = rt_tick_get() - start;
+    rt_kprintf("  4 registers: %d ms as FC06, %d ms as one FC16\n",
+               single * 1000 / RT_TICK_PER_SECOND, multiple * 1000 / RT_TICK_PER_SECOND);
+    modbus_test_check(multiple * 2 < single, "FC16 at least twice as fast");
+}
+
+/**
+ * FC06, FC16 and FC23 tests against the simulated S8
+ * Usage: test_mb_writes
+ */
+static void test_mb_writes(int argc, char *argv[])
+{
+    modbus_sim_t *sim;
+    modbus_rtu_device_t *mb;
+
+    RT_UNUSED(argc);
+    RT_UNUSED(argv);
+
+    modbus_test_begin("[MB_WRITES]");
+    writes_frame_tests();
+
+    sim = modbus_test_setup(9600, 1, &mb);
+    if (!sim) {
+        return;
+    }
+    sim->input_regs[MODBUS_SIM_CO2_REG] = 450;
+
+    writes_bus_tests(sim, mb);
+
+    modbus_test_end("Modbus Writes");
+
+    modbus_test_teardown(sim, mb);
+}
+MSH_CMD_EXPORT(test_mb_writes, FC06 FC16 and FC23 tests);
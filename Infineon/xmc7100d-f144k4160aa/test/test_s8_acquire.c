@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Acquisition service fan-out tests
+ * 2026-10-16     Developer    Verdict and simulated bus from the shared test fixture
+ * 2026-10-16     Developer    Unsubscribe while the receiver waits
+ * 2026-10-16     Developer    Shared sensor instance, poller and one-off reads on the service
+ * 2026-10-16     Developer    Service read by the scheduler of its bus
+ * 2026-10-16     Developer    One-off sample from a read started after the request
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <stdlib.h>
+#include "s8_acquire.h"
+#include "s8_poller.h"
+#include "modbus_sim.h"
+
+#define ACQ_WARMUP_MS           8000    /* Excluded: the service locks onto the sensor's cycle */
+#define ACQ_PERIOD_MS           2000    /* Simulated sensor update period */
+
+/* A consumer as the application threads have them */
+typedef struct {
+    s8_subscriber_t *subscriber;
+    rt_uint32_t received;
+    rt_uint32_t bad;                /* Failed or wrong samples */
+    rt_uint32_t last_sequence;
+    rt_thread_t thread;             /* Queue consumers only */
+    volatile rt_bool_t running;
+    rt_sem_t exit_sem;
+} acq_consumer_t;
+
+static void acq_count(acq_consumer_t *consumer, const s8_sample_t *sample)
+{
+    if (sample->status != S8_STATUS_OK || !sample->data.data_valid ||
+        sample->sequence <= consumer->last_sequence) {
+        consumer->bad++;
+    }
+    consumer->last_sequence = sample->sequence;
+    consumer->received++;
+}
+
+static void acq_callback(void *context, const s8_sample_t *sample)
+{
+    acq_count((acq_consumer_t *)context, sample);
+}
+
+static void acq_queue_entry(void *parameter)
+{
+    acq_consumer_t *consumer = (acq_consumer_t *)parameter;
+    s8_sample_t sample;
+
+    while (consumer->running) {
+        if (s8_acquire_receive(consumer->subscriber, &sample, rt_tick_from_millisecond(50)) == RT_EOK) {
+            acq_count(consumer, &sample);
+        }
+    }
+    rt_sem_release(consumer->exit_sem);
+}
+
+/**
+ * Subscribe a consumer, with a thread draining its queue when queued
+ */
+static rt_bool_t acq_consumer_start(acq_consumer_t *consumer, s8_acquire_t *acquire,
+                                    rt_uint32_t interval_ms, rt_bool_t queued)
+{
+    rt_memset(consumer, 0, sizeof(acq_consumer_t));
+    if (!queued) {
+        consumer->subscriber = s8_acquire_subscribe(acquire, interval_ms, acq_callback, consumer);
+        return consumer->subscriber != RT_NULL;
+    }
+
+    consumer->subscriber = s8_acquire_subscribe_queue(acquire, interval_ms);
+    consumer->exit_sem = rt_sem_create("acq_x", 0, RT_IPC_FLAG_FIFO);
+    consumer->thread = rt_thread_create("acq_q", acq_queue_entry, consumer, 1024, 20, 10);
+    if (!consumer->subscriber || !consumer->exit_sem || !consumer->thread) {
+        return RT_FALSE;
+    }
+    consumer->running = RT_TRUE;
+    rt_thread_startup(consumer->thread);
+    return RT_TRUE;
+}
+
+static void acq_consumer_stop(acq_consumer_t *consumer, s8_acquire_t *acquire)
+{
+    if (consumer->running) {
+        consumer->running = RT_FALSE;
+        rt_sem_take(consumer->exit_sem, RT_WAITING_FOREVER);
+    }
+    if (consumer->exit_sem) {
+        rt_sem_delete(consumer->exit_sem);
+    }
+    if (consumer->subscriber) {
+        s8_acquire_unsubscribe(acquire, consumer->subscriber);
+    }
+}
+
+/* A receiver that waits for samples until its subscription is closed */
+typedef struct {
+    s8_subscriber_t *subscriber;
+    rt_err_t result;
+    rt_sem_t done;
+} acq_closer_t;
+
+static void acq_closed_entry(void *parameter)
+{
+    acq_closer_t *closer = (acq_closer_t *)parameter;
+    s8_sample_t sample;
+
+    do {
+        closer->result = s8_acquire_receive(closer->subscriber, &sample, RT_WAITING_FOREVER);
+    } while (closer->result == RT_EOK);
+    rt_sem_release(closer->done);
+}
+
+/**
+ * Unsubscribe from another thread while the receiver is blocked
+ */
+static void acq_close_tests(s8_acquire_t *acquire)
+{
+    acq_closer_t closer;
+    rt_thread_t thread;
+
+    rt_memset(&closer, 0, sizeof(closer));
+    closer.subscriber = s8_acquire_subscribe_queue(acquire, 60000);
+    closer.done = rt_sem_create("acq_c", 0, RT_IPC_FLAG_FIFO);
+    thread = rt_thread_create("acq_c", acq_closed_entry, &closer, 1024, 20, 10);
+    if (!closer.subscriber || !closer.done || !thread) {
+        modbus_test_check(RT_FALSE, "closing receiver set up");
+        return;
+    }
+    rt_thread_startup(thread);
+    rt_thread_mdelay(ACQ_PERIOD_MS);
+
+    modbus_test_check(closer.subscriber->receivers == 1, "receiver waiting");
+    modbus_test_check(s8_acquire_unsubscribe(acquire, closer.subscriber) == RT_EOK, "unsubscribed under it");
+    modbus_test_check(rt_sem_take(closer.done, RT_TICK_PER_SECOND) == RT_EOK && closer.result == -RT_ERROR,
+                      "receiver woken with the subscription closed");
+    modbus_test_check(!closer.subscriber->used && closer.subscriber->queue == RT_NULL,
+                      "queue freed after the receiver left");
+    rt_sem_delete(closer.done);
+}
+
+/**
+ * Bus requests over a window, with the sensor updates it spanned
+ */
+static rt_uint32_t acq_window(modbus_sim_t *sim, acq_consumer_t *consumers, rt_uint32_t count,
+                              rt_uint32_t seconds, rt_uint32_t *fresh)
+{
+    rt_uint32_t requests = sim->requests, i;
+
+    sim->fresh_reads = 0;
+    for (i = 0; i < count; i++) {
+        consumers[i].received = 0;
+        consumers[i].bad = 0;
+    }
+    rt_thread_mdelay(seconds * 1000);
+
+    *fresh = sim->fresh_reads;
+    return sim->requests - requests;
+}
+
+/**
+ * One reader for many consumers of a simulated S8
+ * Usage: test_s8_acquire [seconds]
+ */
+static void test_s8_acquire(int argc, char *argv[])
+{
+    static const struct {
+        rt_uint32_t interval_ms;
+        rt_bool_t queued;
+    } plan[] =
+    {
+        {500, RT_FALSE},                    /* Faster than the sensor: every update */
+        {2000, RT_FALSE},                   /* s8_monitor, tf_rt */
+        {1000, RT_TRUE},                    /* co2_monitor */
+        {5000, RT_TRUE},                    /* tf_mon_persist */
+    };
+    acq_consumer_t consumers[sizeof(plan) / sizeof(plan[0])];
+    s8_sensor_device_t *sensor, *again;
+    s8_poller_t *poller = RT_NULL;
+    s8_sample_t sample;
+    s8_acquire_t *acquire;
+    modbus_sim_t *sim;
+    rt_uint32_t seconds, updates, alone, shared, fresh, expected, before, i;
+    rt_tick_t asked;
+
+    modbus_test_begin("[S8_ACQ]");
+    seconds = (argc > 1) ? atoi(argv[1]) : 20;
+    if (seconds < 10) {
+        rt_kprintf("Usage: test_s8_acquire [seconds >= 10]\n");
+        return;
+    }
+    updates = seconds * 1000 / ACQ_PERIOD_MS;
+
+    sim = modbus_test_setup(9600, 1, RT_NULL);
+    if (!sim) {
+        return;
+    }
+    sim->update_period_ms = ACQ_PERIOD_MS;
+    sim->update_epoch = rt_tick_get();
+
+    sensor = s8_sensor_init_slave(MODBUS_SIM_NAME, 1);
+    acquire = sensor ? s8_acquire_get(sensor) : RT_NULL;
+    if (!acquire) {
+        rt_kprintf("[S8_ACQ] Sensor setup failed\n");
+        goto out;
+    }
+    modbus_test_check(s8_acquire_get(sensor) == acquire, "one service per sensor");
+    again = s8_sensor_init_slave(MODBUS_SIM_NAME, 1);
+    modbus_test_check(again == sensor && sensor->refcount == 2, "one instance per sensor");
+    s8_sensor_deinit(again);
+    rt_memset(consumers, 0, sizeof(consumers));
+
+    /* One consumer */
+    modbus_test_check(acq_consumer_start(&consumers[0], acquire, plan[0].interval_ms, plan[0].queued),
+                      "first subscriber");
+    rt_thread_mdelay(ACQ_WARMUP_MS);
+    alone = acq_window(sim, consumers, 1, seconds, &fresh);
+    rt_kprintf("  1 subscriber:  %d bus reads, %d new measurements, %d sensor updates\n", alone, fresh, updates);
+
+    /* All of them, a poller and one-off reads */
+    for (i = 1; i < sizeof(plan) / sizeof(plan[0]); i++) {
+        modbus_test_check(acq_consumer_start(&consumers[i], acquire, plan[i].interval_ms, plan[i].queued),
+                          "subscriber added");
+    }
+    poller = s8_poller_get(sensor);
+    modbus_test_check(poller && poller->count == 1, "sensor on its bus scheduler");
+    modbus_test_check(poller && s8_poller_add(poller, sensor, S8_POLL_TRACK) == RT_EOK &&
+                      s8_poller_start(poller) == RT_EOK, "poller subscribed");
+    before = acquire->reads;
+    asked = rt_tick_get();
+    modbus_test_check(s8_acquire_sample(acquire, &sample, rt_tick_from_millisecond(S8_ACQUIRE_SAMPLE_WAIT_MS)) ==
+                      S8_STATUS_OK && sample.data.data_valid, "one-off sample");
+    modbus_test_check(sample.read > before && (rt_int32_t)(sample.start - asked) >= 0,
+                      "one-off sample read after the request");
+    shared = acq_window(sim, consumers, sizeof(plan) / sizeof(plan[0]), seconds, &fresh);
+    rt_kprintf("  %d subscribers and a poller: %d bus reads, %d new measurements, %d sensor updates\n",
+               (int)(sizeof(plan) / sizeof(plan[0])), shared, fresh, updates);
+
+    /* About one bus read per sensor update, however many consumers */
+    modbus_test_check(fresh * 100 >= updates * 90, "every sensor update read");
+    modbus_test_check(shared * 100 <= updates * 120, "one bus read per sensor update");
+    modbus_test_check(shared <= alone + 2, "bus traffic independent of the consumer count");
+
+    for (i = 0; i < sizeof(plan) / sizeof(plan[0]); i++) {
+        expected = seconds * 1000 / (plan[i].interval_ms > ACQ_PERIOD_MS ? plan[i].interval_ms : ACQ_PERIOD_MS);
+        rt_kprintf("  %4d ms %-8s: %2d samples (expected %d), %d bad, %d lost\n",
+                   plan[i].interval_ms, plan[i].queued ? "queue" : "callback",
+                   consumers[i].received, expected, consumers[i].bad, consumers[i].subscriber->overflows);
+        modbus_test_check(consumers[i].received + 1 >= expected && consumers[i].received <= expected + 1,
+                          "subscriber decimated to its interval");
+        modbus_test_check(consumers[i].bad == 0 && consumers[i].subscriber->overflows == 0, "samples intact");
+    }
+    s8_acquire_dump(acquire);
+    if (poller) {
+        s8_poller_dump(poller);
+        modbus_test_check(poller->entries[0].samples > 0 && poller->entries[0].polls <= acquire->samples,
+                          "poller sampled through the service");
+        modbus_test_check(poller->reads > 0 && poller->reads <= acquire->reads, "reads made by the bus scheduler");
+        s8_poller_stop(poller);
+        s8_poller_remove(poller, sensor);
+    }
+
+    for (i = 0; i < sizeof(plan) / sizeof(plan[0]); i++) {
+        acq_consumer_stop(&consumers[i], acquire);
+    }
+    acq_close_tests(acquire);
+    modbus_test_check(acquire->period == 0, "idle without subscribers");
+
+out:
+    modbus_test_end("S8 Acquisition Service");
+
+    if (sensor) {
+        s8_sensor_deinit(sensor);
+    }
+    modbus_test_teardown(sim, RT_NULL);
+}
+MSH_CMD_EXPORT(test_s8_acquire, One S8 reader fanned out to several subscribers);
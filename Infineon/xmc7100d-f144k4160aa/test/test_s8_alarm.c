@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Alarm input latency, debounce and queue tests
+ * 2026-10-16     Developer    Verdict and simulated bus from the shared test fixture
+ * 2026-10-16     Developer    Full queue keeps the newest changes
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <stdlib.h>
+#include "s8_alarm.h"
+#include "modbus_sim.h"
+
+/* Line the test drives. On the board, jumper a spare output to P19_3 (IO2),
+ * point this at it and keep the sensor's alarm output idle. */
+#ifndef S8_ALARM_TEST_PIN
+#define S8_ALARM_TEST_PIN       S8_ALARM_PIN
+#endif
+
+#define ALARM_LATENCY_MAX_MS    (S8_ALARM_DEBOUNCE_MS + 2)  /* Debounce plus tick granularity */
+#define ALARM_SETTLE_MS         20                          /* Well past any debounce */
+
+/**
+ * Drop queued events, returning how many there were
+ */
+static rt_uint32_t alarm_drain(s8_alarm_t *alarm, s8_alarm_event_t *last)
+{
+    s8_alarm_event_t event;
+    rt_uint32_t count = 0;
+
+    while (s8_alarm_wait(alarm, &event, 0) == RT_EOK) {
+        if (last) {
+            *last = event;
+        }
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * Drive the line through a burst of edges ending at level
+ */
+static void alarm_burst(rt_uint8_t level, rt_uint32_t edges)
+{
+    rt_uint32_t i;
+
+    for (i = 0; i < edges; i++) {
+        rt_pin_write(S8_ALARM_TEST_PIN, (edges - i) % 2 ? level : !level);
+    }
+}
+
+/**
+ * Edge-to-consumer latency, debounce and queue overflow of the alarm input
+ * Usage: test_s8_alarm [toggles]
+ */
+static void test_s8_alarm(int argc, char *argv[])
+{
+    s8_alarm_t *alarm;
+    s8_alarm_event_t event;
+    rt_uint32_t toggles, latency, latency_sum = 0, latency_max = 0, sequence, i;
+    rt_uint32_t glitches, overflows;
+    rt_uint8_t level;
+    rt_tick_t start;
+
+    modbus_test_begin("[S8_ALARM]");
+    toggles = (argc > 1) ? atoi(argv[1]) : 20;
+    if (toggles < 2) {
+        rt_kprintf("Usage: test_s8_alarm [toggles >= 2]\n");
+        return;
+    }
+
+    alarm = s8_alarm_get();
+    if (!alarm) {
+        rt_kprintf("[S8_ALARM] Alarm input setup failed\n");
+        return;
+    }
+    modbus_test_check(s8_alarm_get() == alarm, "one alarm input per board");
+    modbus_test_check(alarm->pin >= 0, "edge interrupt attached");
+
+    if (S8_ALARM_TEST_PIN != S8_ALARM_PIN) {
+        rt_pin_mode(S8_ALARM_TEST_PIN, PIN_MODE_OUTPUT);
+    }
+    rt_pin_write(S8_ALARM_TEST_PIN, PIN_LOW);
+    rt_thread_mdelay(ALARM_SETTLE_MS);
+    alarm_drain(alarm, RT_NULL);
+    modbus_test_check(s8_alarm_state(alarm) == 0, "alarm clear at start");
+
+    /* Each change reaches a waiting consumer about a millisecond after the edge */
+    sequence = alarm->changes;
+    for (i = 0; i < toggles; i++) {
+        level = !s8_alarm_state(alarm);
+        start = rt_tick_get();
+        rt_pin_write(S8_ALARM_TEST_PIN, level);
+        if (s8_alarm_wait(alarm, &event, rt_tick_from_millisecond(100)) != RT_EOK) {
+            modbus_test_check(RT_FALSE, "change reported");
+            continue;
+        }
+        latency = (rt_tick_get() - start) * 1000 / RT_TICK_PER_SECOND;
+        latency_sum += latency;
+        if (latency > latency_max) {
+            latency_max = latency;
+        }
+        modbus_test_check(event.state == level, "event carries the new level");
+        modbus_test_check(event.tick - start <= 1, "event stamped with the edge");
+        modbus_test_check(event.sequence == ++sequence, "events in order");
+        rt_thread_mdelay(2);
+    }
+    rt_kprintf("  %d changes: latency avg %d.%d ms, max %d ms (debounce %d ms)\n", toggles,
+               latency_sum / toggles, latency_sum * 10 / toggles % 10, latency_max, S8_ALARM_DEBOUNCE_MS);
+    modbus_test_check(latency_max <= ALARM_LATENCY_MAX_MS, "alarm latency about a millisecond");
+
+    /* A bouncing edge is one change; a glitch that returns is none */
+    level = !s8_alarm_state(alarm);
+    glitches = alarm->glitches;
+    alarm_burst(level, 7);
+    rt_thread_mdelay(ALARM_SETTLE_MS);
+    modbus_test_check(alarm_drain(alarm, &event) == 1 && event.state == level, "bounces debounced to one change");
+    alarm_burst(level, 6);
+    rt_thread_mdelay(ALARM_SETTLE_MS);
+    modbus_test_check(alarm_drain(alarm, RT_NULL) == 0, "glitch ignored");
+    modbus_test_check(alarm->glitches == glitches + 1, "glitch counted");
+    rt_kprintf("  bursts: %d edges taken, %d glitches\n", alarm->edges, alarm->glitches);
+
+    /* A consumer that falls behind loses the oldest changes; the level stays current */
+    overflows = alarm->overflows;
+    sequence = alarm->changes;
+    level = s8_alarm_state(alarm);
+    for (i = 0; i < S8_ALARM_QUEUE_DEPTH + 4; i++) {
+        rt_pin_write(S8_ALARM_TEST_PIN, !s8_alarm_state(alarm));
+        rt_thread_mdelay(S8_ALARM_DEBOUNCE_MS + 4);
+    }
+    modbus_test_check(s8_alarm_wait(alarm, &event, 0) == RT_EOK && event.sequence == sequence + 5,
+                      "oldest changes overwritten");
+    modbus_test_check(alarm_drain(alarm, &event) + 1 == S8_ALARM_QUEUE_DEPTH, "queue full");
+    modbus_test_check(alarm->overflows == overflows + 4, "overflow counted");
+    modbus_test_check(event.sequence == sequence + S8_ALARM_QUEUE_DEPTH + 4, "newest change kept");
+    modbus_test_check(s8_alarm_state(alarm) == ((S8_ALARM_QUEUE_DEPTH + 4) % 2 ? !level : level),
+                      "level current despite the overflow");
+    s8_alarm_dump(alarm);
+
+    rt_pin_write(S8_ALARM_TEST_PIN, PIN_LOW);
+    rt_thread_mdelay(ALARM_SETTLE_MS);
+    alarm_drain(alarm, RT_NULL);
+
+    modbus_test_end("S8 Alarm Input");
+}
+MSH_CMD_EXPORT(test_s8_alarm, S8 alarm edge latency and debounce test);
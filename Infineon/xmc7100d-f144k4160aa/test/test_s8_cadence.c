@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Fixed-interval vs cadence-tracking sample freshness
+ * 2026-10-16     Developer    Fixed interval above the measurement period
+ * 2026-10-16     Developer    Modes run on the schedule of the slaves' bus
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <stdlib.h>
+#include "s8_poller.h"
+#include "modbus_sim.h"
+
+#define CADENCE_MAX_SLAVES      4
+#define CADENCE_WARMUP_MS       20000   /* Excluded: acquisition and period learning */
+
+/* Shorter intervals follow the sensor's cycle too, see s8_acquire.h */
+#define CADENCE_FIXED_MS        (S8_MEASUREMENT_PERIOD_MS + 100)
+
+typedef struct {
+    rt_uint32_t fresh;
+    rt_uint32_t duplicates;
+    rt_uint32_t updates;        /* Measurements the slaves produced */
+    rt_uint32_t avg_age_ms;     /* True age of new samples, from the simulator */
+    rt_uint32_t max_age_ms;
+    rt_uint32_t est_age_ms;     /* Poller's own upper-bound estimate */
+    rt_uint32_t resyncs;
+} cadence_result_t;
+
+/**
+ * Poll every slave in one mode and collect the simulator's ground truth
+ */
+static void cadence_run(modbus_sim_t *sim, s8_sensor_device_t **sensors, rt_uint32_t slaves,
+                        rt_uint32_t interval_ms, rt_uint32_t seconds, cadence_result_t *result)
+{
+    s8_poller_t *poller;
+    rt_uint32_t i, age_sum = 0, age_count = 0;
+
+    rt_memset(result, 0, sizeof(cadence_result_t));
+    poller = s8_poller_get(sensors[0]);
+    if (!poller) {
+        return;
+    }
+    for (i = 0; i < slaves; i++) {
+        s8_poller_add(poller, sensors[i], interval_ms);
+    }
+
+    s8_poller_start(poller);
+    rt_thread_mdelay(CADENCE_WARMUP_MS);
+
+    sim->fresh_reads = 0;
+    sim->duplicate_reads = 0;
+    sim->age_sum_ms = 0;
+    sim->age_max_ms = 0;
+    for (i = 0; i < slaves; i++) {
+        poller->entries[i].cadence.age_sum = 0;
+        poller->entries[i].cadence.age_count = 0;
+        poller->entries[i].cadence.resyncs = 0;
+    }
+
+    rt_thread_mdelay(seconds * 1000);
+    s8_poller_stop(poller);
+
+    s8_poller_dump(poller);
+    for (i = 0; i < slaves; i++) {
+        age_sum += poller->entries[i].cadence.age_sum;
+        age_count += poller->entries[i].cadence.age_count;
+        result->resyncs += poller->entries[i].cadence.resyncs;
+        s8_poller_remove(poller, sensors[i]);
+    }
+
+    result->fresh = sim->fresh_reads;
+    result->duplicates = sim->duplicate_reads;
+    result->updates = slaves * seconds * 1000 / sim->update_period_ms;
+    result->avg_age_ms = sim->fresh_reads ? sim->age_sum_ms / sim->fresh_reads : 0;
+    result->max_age_ms = sim->age_max_ms;
+    result->est_age_ms = age_count ? age_sum / age_count * 1000 / RT_TICK_PER_SECOND : 0;
+}
+
+static void cadence_print(const char *mode, cadence_result_t *r)
+{
+    rt_uint32_t reads = r->fresh + r->duplicates;
+
+    rt_kprintf("%-8s  %5d  %6d/%-6d  %4d%%  %6d ms  %6d ms  %6d ms  %4d\n",
+               mode, reads, r->fresh, r->updates,
+               reads ? r->duplicates * 100 / reads : 0,
+               r->avg_age_ms, r->max_age_ms, r->est_age_ms, r->resyncs);
+}
+
+/**
+ * Compare fixed-interval and cadence-tracking polling against simulated
+ * sensors that update on their own clock
+ * Usage: test_s8_cadence [slaves] [seconds] [sensor_period_ms]
+ */
+static void test_s8_cadence(int argc, char *argv[])
+{
+    s8_sensor_device_t *sensors[CADENCE_MAX_SLAVES];
+    cadence_result_t fixed, tracked;
+    modbus_sim_t *sim;
+    rt_uint32_t slaves = 3, seconds = 30, period_ms = 2020;
+    rt_uint32_t failures = 0, i;
+
+    if (argc > 1) {
+        slaves = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        seconds = atoi(argv[2]);
+    }
+    if (argc > 3) {
+        period_ms = atoi(argv[3]);
+    }
+    if (slaves == 0 || slaves > CADENCE_MAX_SLAVES || seconds == 0 || period_ms < 500) {
+        rt_kprintf("Usage: test_s8_cadence [slaves 1-%d] [seconds] [sensor_period_ms >= 500]\n",
+                   CADENCE_MAX_SLAVES);
+        return;
+    }
+
+    sim = modbus_sim_create("mbsim", 9600, 1);
+    if (!sim) {
+        rt_kprintf("[CADENCE] Failed to create simulated UART\n");
+        return;
+    }
+    sim->slave_count = slaves;
+    sim->update_period_ms = period_ms;
+    sim->update_epoch = rt_tick_get();
+
+    rt_memset(sensors, 0, sizeof(sensors));
+    for (i = 0; i < slaves; i++) {
+        sensors[i] = s8_sensor_init_slave("mbsim", (rt_uint8_t)(i + 1));
+        if (!sensors[i]) {
+            rt_kprintf("[CADENCE] Setup failed at slave %d\n", i + 1);
+            failures++;
+            goto cleanup;
+        }
+    }
+
+    rt_kprintf("\n=== S8 Cadence (%d slaves, sensor period %d ms, tracker nominal %d ms) ===\n",
+               slaves, period_ms, S8_MEASUREMENT_PERIOD_MS);
+    cadence_run(sim, sensors, slaves, CADENCE_FIXED_MS, seconds, &fixed);
+    cadence_run(sim, sensors, slaves, S8_POLL_TRACK, seconds, &tracked);
+
+    rt_kprintf("\nMode      Reads  Fresh/Updates  Dup%%   AvgAge     MaxAge     EstAge  Resyncs\n");
+    cadence_print("fixed", &fixed);
+    cadence_print("track", &tracked);
+
+    /* One fresh sample per update, few wasted reads, and fresher than fixed */
+    if (tracked.fresh * 100 < tracked.updates * 90) {
+        rt_kprintf("[CADENCE] FAIL: tracking missed updates\n");
+        failures++;
+    }
+    if (tracked.duplicates * 100 > (tracked.fresh + tracked.duplicates) * 15) {
+        rt_kprintf("[CADENCE] FAIL: tracking duplicate rate too high\n");
+        failures++;
+    }
+    if (tracked.avg_age_ms > 150 || tracked.avg_age_ms >= fixed.avg_age_ms) {
+        rt_kprintf("[CADENCE] FAIL: tracked samples are not fresh\n");
+        failures++;
+    }
+    if (tracked.est_age_ms < tracked.avg_age_ms) {
+        rt_kprintf("[CADENCE] FAIL: age estimate is below the true age\n");
+        failures++;
+    }
+    rt_kprintf("  Result: %s\n", failures ? "FAIL" : "PASS");
+
+cleanup:
+    for (i = 0; i < slaves; i++) {
+        if (sensors[i]) {
+            s8_sensor_deinit(sensors[i]);
+        }
+    }
+    modbus_sim_destroy(sim);
+}
+MSH_CMD_EXPORT(test_s8_cadence, Compare fixed and cadence-tracking S8 polling);
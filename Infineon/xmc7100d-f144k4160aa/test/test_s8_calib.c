@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Calibration state machine tests
+ * 2026-10-16     Developer    Verdict and simulated bus from the shared test fixture
+ * 2026-10-16     Developer    Unreported calibration after an accepted command is unconfirmed
+ * 2026-10-16     Developer    Refused commands, command registers the sensor clears
+ * 2026-10-16     Developer    Calibration stepped by the bus scheduler
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "s8_calib.h"
+#include "s8_acquire.h"
+#include "modbus_sim.h"
+
+#define CAL_DURATION_MS         3000    /* Simulated calibration run time */
+#define CAL_PERIOD_MS           2000    /* Simulated sensor update period */
+#define CAL_WAIT_MS             20000   /* Longer than any outcome takes */
+
+/* Normal sampling, as the application has it */
+static rt_uint32_t cal_samples;
+
+static void cal_sample(void *context, const s8_sample_t *sample)
+{
+    RT_UNUSED(context);
+    if (sample->status == S8_STATUS_OK) {
+        cal_samples++;
+    }
+}
+
+/**
+ * Run one calibration to its end, returning the outcome
+ * *lag is how long after the simulated end the state machine noticed it.
+ */
+static s8_cal_state_t cal_run(s8_cal_t *cal, modbus_sim_t *sim, s8_cal_kind_t kind, rt_uint32_t *lag)
+{
+    s8_cal_state_t state;
+    rt_tick_t start;
+
+    start = rt_tick_get();
+    modbus_test_check(s8_cal_start(cal, kind, 420) == RT_EOK, "calibration started");
+    modbus_test_check(rt_tick_get() - start <= 1, "start returns at once");
+    modbus_test_check(s8_cal_busy(cal), "busy while calibrating");
+    modbus_test_check(rt_thread_find("s8_cal") == RT_NULL, "no calibration thread");
+    modbus_test_check(s8_cal_start(cal, kind, 420) == -RT_EBUSY, "one calibration at a time");
+
+    state = s8_cal_wait(cal, rt_tick_from_millisecond(CAL_WAIT_MS));
+    if (lag) {
+        *lag = (cal->end_tick - sim->cal_until) * 1000 / RT_TICK_PER_SECOND;
+    }
+    return state;
+}
+
+/**
+ * Calibration from command to completion against a simulated S8
+ * Usage: test_s8_calib
+ */
+static void test_s8_calib(int argc, char *argv[])
+{
+    s8_sensor_device_t *sensor;
+    s8_subscriber_t *subscriber = RT_NULL;
+    s8_cal_t *cal;
+    modbus_sim_t *sim;
+    rt_uint32_t lag, samples, i;
+    s8_cal_state_t state;
+
+    RT_UNUSED(argc);
+    RT_UNUSED(argv);
+    modbus_test_begin("[S8_CAL]");
+
+    sim = modbus_test_setup(9600, 1, RT_NULL);
+    if (!sim) {
+        return;
+    }
+    sim->update_period_ms = CAL_PERIOD_MS;
+    sim->update_epoch = rt_tick_get();
+    sim->cal_duration_ms = CAL_DURATION_MS;
+
+    sensor = s8_sensor_init_slave(MODBUS_SIM_NAME, 1);
+    cal = sensor ? s8_cal_get(sensor) : RT_NULL;
+    if (!cal) {
+        rt_kprintf("[S8_CAL] Sensor setup failed\n");
+        goto out;
+    }
+    modbus_test_check(s8_cal_get(sensor) == cal, "one state machine per sensor");
+    modbus_test_check(s8_cal_state_name(s8_cal_wait(cal, 0))[0] == 'i', "idle before the first calibration");
+    subscriber = s8_acquire_subscribe(s8_acquire_get(sensor), CAL_PERIOD_MS, cal_sample, RT_NULL);
+    modbus_test_check(subscriber != RT_NULL, "sampling subscribed");
+    rt_thread_mdelay(CAL_PERIOD_MS);
+
+    /* First run: polling backs off, sampling carries on */
+    samples = cal_samples;
+    state = cal_run(cal, sim, S8_CAL_ZERO, &lag);
+    rt_kprintf("  zero, first:   %-9s seen %d ms after the end, %d polls, %d own reads, %d samples meanwhile\n",
+               s8_cal_state_name(state), lag, cal->polls, cal->own_reads, cal_samples - samples);
+    modbus_test_check(state == S8_CAL_STATE_DONE, "calibration completes");
+    modbus_test_check(sim->holding_regs[S8_REG_ZERO_CAL] == S8_CAL_COMMAND_START, "command kept by the sensor");
+    modbus_test_check(cal->write_attempts == 1, "command written once");
+    modbus_test_check(lag <= S8_CAL_POLL_MAX_MS + 100, "end seen within the longest poll interval");
+    modbus_test_check(cal_samples - samples + 1 >= CAL_DURATION_MS / CAL_PERIOD_MS, "sampling continued");
+    modbus_test_check(cal->own_reads < cal->polls, "published readings stand in for polls");
+
+    /* Second run: the learned run time brings the poll in */
+    state = cal_run(cal, sim, S8_CAL_ZERO, &lag);
+    rt_kprintf("  zero, learned: %-9s seen %d ms after the end, %d polls\n",
+               s8_cal_state_name(state), lag, cal->polls);
+    modbus_test_check(state == S8_CAL_STATE_DONE, "calibration completes again");
+    /* One fast poll, on a reading up to one fast poll old */
+    modbus_test_check(lag <= 2 * S8_CAL_POLL_MIN_MS + 100, "end seen promptly once the run time is known");
+
+    /* A command the sensor refused is sent again */
+    sim->cal_refuse_writes = 1;
+    state = cal_run(cal, sim, S8_CAL_SINGLE_POINT, RT_NULL);
+    rt_kprintf("  single point:  %-9s after %d command writes\n", s8_cal_state_name(state), cal->write_attempts);
+    modbus_test_check(state == S8_CAL_STATE_DONE && cal->write_attempts == 2, "refused write retried");
+    modbus_test_check(sim->holding_regs[S8_REG_SINGLE_POINT_CAL] == 420, "single point target kept");
+
+    sim->cal_refuse_writes = S8_CAL_WRITE_ATTEMPTS;
+    state = cal_run(cal, sim, S8_CAL_BACKGROUND, RT_NULL);
+    rt_kprintf("  refused:       %-9s after %d command writes\n", s8_cal_state_name(state), cal->write_attempts);
+    modbus_test_check(state == S8_CAL_STATE_FAILED, "command never accepted fails");
+
+    /* Abort reaches the sensor */
+    sim->cal_duration_ms = 60000;
+    modbus_test_check(s8_cal_start(cal, S8_CAL_BACKGROUND, 0) == RT_EOK, "long calibration started");
+    for (i = 0; i < 100 && cal->state != S8_CAL_STATE_RUNNING; i++) {
+        rt_thread_mdelay(50);
+    }
+    modbus_test_check(cal->state == S8_CAL_STATE_RUNNING, "sensor reported the calibration");
+    modbus_test_check(s8_cal_abort(cal) == RT_EOK, "abort accepted");
+    state = s8_cal_wait(cal, rt_tick_from_millisecond(CAL_WAIT_MS));
+    rt_kprintf("  abort:         %-9s sensor %s\n", s8_cal_state_name(state),
+               sim->cal_active ? "still calibrating" : "stopped");
+    modbus_test_check(state == S8_CAL_STATE_ABORTED, "calibration aborted");
+    modbus_test_check(!sim->cal_active, "sensor calibration cancelled");
+
+    /* A sensor that never reports the calibration */
+    sim->cal_duration_ms = 0;
+    state = cal_run(cal, sim, S8_CAL_ZERO, RT_NULL);
+    rt_kprintf("  never started: %-9s after %d ms\n", s8_cal_state_name(state),
+               (cal->end_tick - cal->start_tick) * 1000 / RT_TICK_PER_SECOND);
+    modbus_test_check(state == S8_CAL_STATE_UNCONFIRMED, "unreported calibration left unconfirmed");
+
+    /* A sensor that clears its command registers: the echo is enough */
+    sim->cal_clear_commands = RT_TRUE;
+    sim->cal_duration_ms = CAL_DURATION_MS;
+    state = cal_run(cal, sim, S8_CAL_ZERO, RT_NULL);
+    rt_kprintf("  cleared:       %-9s after %d command writes\n", s8_cal_state_name(state), cal->write_attempts);
+    modbus_test_check(state == S8_CAL_STATE_DONE && cal->write_attempts == 1, "cleared command accepted");
+    modbus_test_check(s8_cancel_calibration(sensor) == S8_STATUS_OK, "cancel accepted without a read-back");
+    modbus_test_check(s8_set_alarm_threshold(sensor, 1200) == S8_STATUS_OK &&
+                      sim->holding_regs[S8_REG_ALARM_THRESHOLD] == 1200, "setting still read back");
+    sim->cal_clear_commands = RT_FALSE;
+    s8_cal_dump(cal);
+
+out:
+    modbus_test_end("S8 Calibration");
+
+    if (subscriber) {
+        s8_acquire_unsubscribe(sensor->acquire, subscriber);
+    }
+    if (sensor) {
+        s8_sensor_deinit(sensor);
+    }
+    modbus_test_teardown(sim, RT_NULL);
+}
+MSH_CMD_EXPORT(test_s8_calib, S8 calibration state machine test);
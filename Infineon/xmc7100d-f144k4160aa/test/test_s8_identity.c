@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Kept sensor identity and its invalidation tests
+ * 2026-10-16     Developer    Verdict and simulated bus from the shared test fixture
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "s8_sensor.h"
+#include "modbus_sim.h"
+
+#define IDENTITY_QUERIES        20      /* Identity queries that must stay off the bus */
+
+/**
+ * Fail cycle reads until the sensor has been silent for silent_ms
+ */
+static void identity_silence(s8_sensor_device_t *sensor, modbus_sim_t *sim, rt_uint32_t silent_ms)
+{
+    rt_tick_t until = rt_tick_get() + rt_tick_from_millisecond(silent_ms);
+
+    sim->drop_permille = 1000;
+    while ((rt_int32_t)(until - rt_tick_get()) > 0) {
+        s8_read_co2_data(sensor);
+    }
+    sim->drop_permille = 0;
+}
+
+/**
+ * Identity queries answered from the device until it is invalidated
+ * Usage: test_s8_identity
+ */
+static void test_s8_identity(int argc, char *argv[])
+{
+    s8_sensor_device_t *sensor, *again;
+    s8_sensor_info_t info;
+    modbus_sim_t *sim;
+    rt_uint16_t value;
+    rt_uint32_t requests, i;
+    rt_tick_t start;
+
+    RT_UNUSED(argc);
+    RT_UNUSED(argv);
+    modbus_test_begin("[S8_ID]");
+
+    sim = modbus_test_setup(9600, S8_MODBUS_ADDRESS, RT_NULL);
+    if (!sim) {
+        return;
+    }
+
+    sensor = s8_sensor_init(MODBUS_SIM_NAME);
+    if (!sensor) {
+        rt_kprintf("[S8_ID] Sensor setup failed\n");
+        modbus_test_teardown(sim, RT_NULL);
+        return;
+    }
+
+    /* One bus read, then free */
+    requests = sim->requests;
+    modbus_test_check(s8_read_sensor_info(sensor, &info) == S8_STATUS_OK, "identity read");
+    modbus_test_check(info.sensor_type == sim->input_regs[S8_REG_SENSOR_TYPE_HIGH] &&
+                      info.firmware_version == sim->input_regs[S8_REG_FIRMWARE_VERSION], "identity decoded");
+    start = rt_tick_get();
+    for (i = 0; i < IDENTITY_QUERIES; i++) {
+        modbus_test_check(s8_read_sensor_info(sensor, &info) == S8_STATUS_OK, "kept identity read");
+        modbus_test_check(s8_read_sensor_type(sensor, &value) == S8_STATUS_OK &&
+                          value == info.sensor_type, "sensor type");
+        modbus_test_check(s8_read_firmware_version(sensor, &value) == S8_STATUS_OK &&
+                          value == info.firmware_version, "firmware version");
+    }
+    rt_kprintf("  %d identity queries: %d bus requests, %d ms\n", 1 + IDENTITY_QUERIES * 3,
+               sim->requests - requests, (rt_tick_get() - start) * 1000 / RT_TICK_PER_SECOND);
+    modbus_test_check(sim->requests - requests == 1 && sensor->info_reads == 1, "one bus read");
+
+    /* A refresh reaches the sensor, past the bus cache */
+    sim->input_regs[S8_REG_FIRMWARE_VERSION] = 0x0601;
+    modbus_test_check(s8_read_sensor_info(sensor, &info) == S8_STATUS_OK &&
+                      info.firmware_version == 0x0503, "kept identity until refreshed");
+    modbus_test_check(s8_refresh_sensor_info(sensor, &info) == S8_STATUS_OK &&
+                      info.firmware_version == 0x0601, "refresh reads the sensor");
+    modbus_test_check(sim->requests - requests == 2, "refresh is one bus read");
+
+    /* A short outage keeps it */
+    identity_silence(sensor, sim, S8_IDENTITY_LOSS_MS / 4);
+    modbus_test_check(s8_read_co2_data(sensor) == S8_STATUS_OK, "sensor back");
+    modbus_test_check(sensor->info_valid, "identity kept through a short outage");
+
+    /* A long one drops it */
+    sim->input_regs[S8_REG_FIRMWARE_VERSION] = 0x0702;
+    start = rt_tick_get();
+    identity_silence(sensor, sim, S8_IDENTITY_LOSS_MS + 1000);
+    modbus_test_check(!sensor->info_valid, "identity dropped after a long outage");
+    modbus_test_check(s8_read_co2_data(sensor) == S8_STATUS_OK, "sensor back again");
+    modbus_test_check(s8_read_sensor_info(sensor, &info) == S8_STATUS_OK &&
+                      info.firmware_version == 0x0702, "identity read again after the outage");
+    rt_kprintf("  outage of %d ms: identity read %d times\n",
+               (rt_tick_get() - start) * 1000 / RT_TICK_PER_SECOND, sensor->info_reads);
+
+    /* Nothing survives a re-init, not even in the shared bus cache */
+    sim->input_regs[S8_REG_FIRMWARE_VERSION] = 0x0803;
+    again = s8_sensor_init(MODBUS_SIM_NAME);
+    modbus_test_check(again != RT_NULL, "sensor initialised again");
+    if (again) {
+        modbus_test_check(!again->info_valid, "no identity after init");
+        modbus_test_check(s8_read_sensor_info(again, &info) == S8_STATUS_OK &&
+                          info.firmware_version == 0x0803, "identity read after re-init");
+        s8_sensor_deinit(again);
+    }
+
+    modbus_test_end("S8 Identity");
+
+    s8_sensor_deinit(sensor);
+    modbus_test_teardown(sim, RT_NULL);
+}
+MSH_CMD_EXPORT(test_s8_identity, S8 kept identity and invalidation test);
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Multi-drop polling against simulated slaves
+ * 2026-10-16     Developer    Slaves share the one scheduler of their bus
+ * 2026-10-16     Developer    Alarm pin not reported for slaves off the S8 connector
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <stdlib.h>
+#include "s8_poller.h"
+#include "modbus_sim.h"
+
+/**
+ * Poll N virtual slaves plus one absent slave on a shared simulated bus
+ * Usage: test_s8_multidrop [slaves] [interval_ms] [seconds] [baud]
+ */
+static void test_s8_multidrop(int argc, char *argv[])
+{
+    s8_sensor_device_t *sensors[S8_POLLER_MAX_SLAVES];
+    s8_poller_t *poller = RT_NULL;
+    modbus_sim_t *sim;
+    rt_uint32_t slaves = 8, interval_ms = 200, seconds = 5, baud = 9600;
+    rt_uint32_t cycle_us, failures = 0, i;
+    rt_uint32_t total = 0;
+    rt_tick_t elapsed;
+
+    if (argc > 1) {
+        slaves = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        interval_ms = atoi(argv[2]);
+    }
+    if (argc > 3) {
+        seconds = atoi(argv[3]);
+    }
+    if (argc > 4) {
+        baud = atoi(argv[4]);
+    }
+    if (slaves == 0 || slaves >= S8_POLLER_MAX_SLAVES || interval_ms == 0 || seconds == 0 || baud == 0) {
+        rt_kprintf("Usage: test_s8_multidrop [slaves 1-%d] [interval_ms] [seconds] [baud]\n",
+                   S8_POLLER_MAX_SLAVES - 1);
+        return;
+    }
+
+    sim = modbus_sim_create("mbsim", baud, 1);
+    if (!sim) {
+        rt_kprintf("[MULTIDROP] Failed to create simulated UART\n");
+        return;
+    }
+    sim->slave_count = slaves;
+
+    rt_memset(sensors, 0, sizeof(sensors));
+
+    /* Slaves 1..N answer, slave N+1 is on the schedule but absent */
+    for (i = 0; i <= slaves; i++) {
+        sensors[i] = s8_sensor_init_slave("mbsim", (rt_uint8_t)(i + 1));
+        if (sensors[i] && !poller) {
+            poller = s8_poller_get(sensors[i]);
+        }
+        if (!sensors[i] || !poller || s8_poller_add(poller, sensors[i], interval_ms) != RT_EOK) {
+            rt_kprintf("[MULTIDROP] Setup failed at slave %d\n", i + 1);
+            failures++;
+            goto cleanup;
+        }
+        if (sensors[i]->modbus != sensors[0]->modbus || s8_poller_get(sensors[i]) != poller) {
+            rt_kprintf("[MULTIDROP] FAIL: slave %d did not share the bus and its scheduler\n", i + 1);
+            failures++;
+        }
+    }
+
+    /* Measure the bus, not the read cache */
+    modbus_cache_set_ttl(sensors[0]->modbus, MODBUS_FUNC_READ_INPUT_REGS, S8_REG_METER_STATUS, 4, 0);
+
+    s8_poller_start(poller);
+    rt_thread_mdelay(seconds * 1000);
+    elapsed = rt_tick_get() - poller->start_tick;
+
+    rt_kprintf("\n=== Multi-drop Poll (%d slaves + 1 absent, %d ms target, %d baud) ===\n",
+               slaves, interval_ms, baud);
+    s8_poller_dump(poller);
+    s8_poller_stop(poller);
+
+    if (poller->count != slaves + 1) {
+        rt_kprintf("[MULTIDROP] FAIL: %d sensors on the bus scheduler\n", poller->count);
+        failures++;
+    }
+
+    for (i = 0; i < slaves; i++) {
+        total += poller->entries[i].samples;
+        if (sensors[i]->health.state != S8_HEALTH_ONLINE || sim->slave_requests[i] == 0) {
+            rt_kprintf("[MULTIDROP] FAIL: slave %d not online\n", i + 1);
+            failures++;
+        }
+        if (s8_get_alarm_state(sensors[i]) != S8_ALARM_UNAVAILABLE) {
+            rt_kprintf("[MULTIDROP] FAIL: slave %d reported the board's alarm pin\n", i + 1);
+            failures++;
+        }
+    }
+    if (sensors[slaves]->health.state != S8_HEALTH_OFFLINE) {
+        rt_kprintf("[MULTIDROP] FAIL: absent slave reported %s\n",
+                   s8_health_name(sensors[slaves]->health.state));
+        failures++;
+    }
+
+    /* One IR1-IR4 cycle: 8-byte request, 13-byte reply, turnaround, T3.5 */
+    cycle_us = modbus_sim_wire_time_us(sim, 8 + 13) + sim->latency_ms * 1000 +
+               sensors[0]->modbus->t35_tick * 1000000 / RT_TICK_PER_SECOND;
+    rt_kprintf("  Aggregate  : %d samples/s (bus limit ~%d/s, target %d/s)\n",
+               elapsed ? total * RT_TICK_PER_SECOND / elapsed : 0,
+               1000000 / cycle_us,
+               slaves * 1000 / interval_ms);
+    rt_kprintf("  Result     : %s\n", failures ? "FAIL" : "PASS");
+
+cleanup:
+    if (poller) {
+        s8_poller_stop(poller);
+    }
+    for (i = 0; i <= slaves; i++) {
+        if (sensors[i]) {
+            s8_sensor_deinit(sensors[i]);
+        }
+    }
+    modbus_sim_destroy(sim);
+}
+MSH_CMD_EXPORT(test_s8_multidrop, Poll several simulated S8 slaves on one bus);
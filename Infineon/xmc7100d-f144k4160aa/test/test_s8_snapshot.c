@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2006-2023, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-16     Developer    Seqlock snapshot stress test
+ * 2026-10-16     Developer    Verdict and simulated bus from the shared test fixture
+ * 2026-10-16     Developer    Writer preempted by a higher priority reader
+ */
+
+#include <rtthread.h>
+#include <stdlib.h>
+#include "s8_sensor.h"
+#include "modbus_sim.h"
+
+#define SNAP_READERS            3
+#define SNAP_COST_READS         1000000 /* Snapshots timed for the per-read cost */
+
+/* Writer and readers share one sensor; no bus is attached */
+typedef struct {
+    s8_sensor_device_t sensor;
+    volatile rt_bool_t running;
+    rt_sem_t exit_sem;
+    rt_uint32_t published;
+} snap_test_t;
+
+typedef struct {
+    snap_test_t *test;
+    rt_bool_t plain;                /* Copy without the sequence count, for contrast */
+    rt_bool_t preempts;             /* Above the writer's priority, wakes every tick */
+    rt_uint32_t reads;
+    rt_uint32_t torn;
+    rt_uint32_t backwards;          /* Older reading after a newer one */
+} snap_reader_t;
+
+/* Every field is derived from the timestamp, so a mix of two writes shows */
+static void snap_pattern(s8_sensor_data_t *data, rt_uint32_t k)
+{
+    data->co2_ppm = (rt_uint16_t)k;
+    data->meter_status = (rt_uint16_t)~k;
+    data->alarm_status = (rt_uint16_t)(k ^ 0x5A5A);
+    data->alarm_state = k & 1;
+    data->timestamp = k;
+    data->data_valid = RT_TRUE;
+}
+
+static rt_bool_t snap_consistent(const s8_sensor_data_t *data)
+{
+    s8_sensor_data_t expected;
+
+    snap_pattern(&expected, data->timestamp);
+    return data->data_valid && data->co2_ppm == expected.co2_ppm &&
+           data->meter_status == expected.meter_status &&
+           data->alarm_status == expected.alarm_status &&
+           data->alarm_state == expected.alarm_state;
+}
+
+static void snap_writer_entry(void *parameter)
+{
+    snap_test_t *test = (snap_test_t *)parameter;
+    s8_sensor_data_t data;
+
+    while (test->running) {
+        snap_pattern(&data, ++test->published);
+        s8_sensor_publish(&test->sensor, &data);
+    }
+    rt_sem_release(test->exit_sem);
+}
+
+static void snap_reader_entry(void *parameter)
+{
+    snap_reader_t *reader = (snap_reader_t *)parameter;
+    snap_test_t *test = reader->test;
+    s8_sensor_data_t data;
+    rt_uint32_t last = 0;
+
+    while (test->running) {
+        if (reader->plain) {
+            data = *(volatile s8_sensor_data_t *)&test->sensor.data;
+        } else {
+            s8_sensor_snapshot(&test->sensor, &data);
+        }
+        reader->reads++;
+        if (!snap_consistent(&data)) {
+            reader->torn++;
+            continue;
+        }
+        if (data.timestamp < last) {
+            reader->backwards++;
+        }
+        last = data.timestamp;
+        if (reader->preempts) {
+            rt_thread_delay(1);
+        }
+    }
+    rt_sem_release(test->exit_sem);
+}
+
+/**
+ * One writer against SNAP_READERS readers for a while
+ */
+static void snap_run(snap_test_t *test, snap_reader_t *readers, rt_bool_t plain, rt_uint32_t seconds)
+{
+    s8_sensor_data_t data;
+    rt_thread_t thread;
+    rt_uint32_t i, started = 0;
+
+    test->published = 0;
+    snap_pattern(&data, 0);
+    s8_sensor_publish(&test->sensor, &data);
+    test->running = RT_TRUE;
+
+    /*
+     * Equal priorities and one-tick slices: every thread gets preempted
+     * mid-copy. The first reader outranks the writer and wakes on the tick,
+     * as the timer thread does; it must never find a write left half done.
+     */
+    thread = rt_thread_create("snap_w", snap_writer_entry, test, 1024, 20, 1);
+    if (thread) {
+        rt_thread_startup(thread);
+        started++;
+    }
+    for (i = 0; i < SNAP_READERS; i++) {
+        rt_memset(&readers[i], 0, sizeof(snap_reader_t));
+        readers[i].test = test;
+        readers[i].plain = plain;
+        readers[i].preempts = (i == 0);
+        thread = rt_thread_create("snap_r", snap_reader_entry, &readers[i], 1024,
+                                  readers[i].preempts ? 19 : 20, 1);
+        if (thread) {
+            rt_thread_startup(thread);
+            started++;
+        }
+    }
+    modbus_test_check(started == SNAP_READERS + 1, "stress threads created");
+
+    rt_thread_mdelay(seconds * 1000);
+    test->running = RT_FALSE;
+    while (started--) {
+        rt_sem_take(test->exit_sem, RT_WAITING_FOREVER);
+    }
+}
+
+/**
+ * Uncontended cost of one snapshot
+ */
+static rt_uint32_t snap_cost_ns(snap_test_t *test)
+{
+    s8_sensor_data_t data;
+    rt_tick_t start, elapsed;
+    rt_uint32_t i;
+
+    start = rt_tick_get();
+    for (i = 0; i < SNAP_COST_READS; i++) {
+        s8_sensor_snapshot(&test->sensor, &data);
+    }
+    elapsed = rt_tick_get() - start;
+    modbus_test_check(data.timestamp == test->published, "snapshot value stable");
+
+    /* Ticks to ns without overflowing 32 bits */
+    return (rt_uint32_t)((rt_uint64_t)elapsed * (1000000000UL / RT_TICK_PER_SECOND) / SNAP_COST_READS);
+}
+
+/**
+ * Concurrent readers against a writer publishing as fast as it can
+ * Usage: test_s8_snapshot [seconds]
+ */
+static void test_s8_snapshot(int argc, char *argv[])
+{
+    snap_reader_t readers[SNAP_READERS];
+    s8_sensor_data_t data;
+    snap_test_t *test;
+    rt_uint32_t seconds, reads, torn, backwards, i;
+
+    modbus_test_begin("[SNAP]");
+    seconds = (argc > 1) ? atoi(argv[1]) : 3;
+    if (seconds < 1) {
+        rt_kprintf("Usage: test_s8_snapshot [seconds >= 1]\n");
+        return;
+    }
+
+    test = (snap_test_t *)rt_malloc(sizeof(snap_test_t));
+    if (!test) {
+        rt_kprintf("[SNAP] Out of memory\n");
+        return;
+    }
+    rt_memset(test, 0, sizeof(snap_test_t));
+    test->exit_sem = rt_sem_create("snap_x", 0, RT_IPC_FLAG_FIFO);
+    if (!test->exit_sem) {
+        rt_kprintf("[SNAP] Out of memory\n");
+        rt_free(test);
+        return;
+    }
+
+    /* Nothing published yet */
+    modbus_test_check(s8_get_sensor_data(&test->sensor, &data) == S8_STATUS_INVALID_DATA,
+                      "no reading before the first");
+
+    /* Plain struct copies, as before, for comparison */
+    snap_run(test, readers, RT_TRUE, seconds);
+    for (i = 0, reads = 0, torn = 0; i < SNAP_READERS; i++) {
+        reads += readers[i].reads;
+        torn += readers[i].torn;
+    }
+    rt_kprintf("  plain copy: %d writes, %d reads, %d torn\n", test->published, reads, torn);
+
+    /* Seqlock snapshots */
+    snap_run(test, readers, RT_FALSE, seconds);
+    for (i = 0, reads = 0, torn = 0, backwards = 0; i < SNAP_READERS; i++) {
+        reads += readers[i].reads;
+        torn += readers[i].torn;
+        backwards += readers[i].backwards;
+        modbus_test_check(readers[i].reads > 0, "every reader made progress");
+    }
+    rt_kprintf("  snapshot:   %d writes, %d reads, %d torn, %d out of order\n",
+               test->published, reads, torn, backwards);
+    modbus_test_check(test->published > 0, "writer made progress");
+    modbus_test_check(torn == 0, "no torn reads");
+    modbus_test_check(backwards == 0, "readings never go back in time");
+    modbus_test_check(s8_get_sensor_data(&test->sensor, &data) == S8_STATUS_OK &&
+                      data.timestamp == test->published, "last write visible");
+
+    rt_kprintf("  read cost:  %d ns per snapshot (uncontended)\n", snap_cost_ns(test));
+
+    modbus_test_end("S8 Snapshot");
+
+    rt_sem_delete(test->exit_sem);
+    rt_free(test);
+}
+MSH_CMD_EXPORT(test_s8_snapshot, Torn-read stress test of the S8 reading snapshot);